@@ -1,5 +1,7 @@
 
+#include <float.h>
 #include <math.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <Python.h>
@@ -12,6 +14,16 @@
 #define PyBUF_WRITE 0x200
 #endif
 
+// The full (non-limited) API variant is built as a second module.
+#ifndef ACCEL_MODULE_NAME
+#define ACCEL_MODULE_NAME _singlestoredb_accel
+#endif
+
+#define ACCEL_STR_(x) #x
+#define ACCEL_STR(x) ACCEL_STR_(x)
+#define ACCEL_CONCAT_(a, b) a##b
+#define ACCEL_CONCAT(a, b) ACCEL_CONCAT_(a, b)
+
 #define ACCEL_OUT_TUPLES 0
 #define ACCEL_OUT_STRUCTSEQUENCES 1
 #define ACCEL_OUT_DICTS 2
@@ -20,6 +32,7 @@
 #define ACCEL_OUT_PANDAS 5
 #define ACCEL_OUT_POLARS 6
 #define ACCEL_OUT_ARROW 7
+#define ACCEL_OUT_LAZYROWS 8
 
 #define NUMPY_BOOL 1
 #define NUMPY_INT8 2
@@ -110,6 +123,12 @@
 // 2**24 - 1
 #define MYSQL_MAX_PACKET_LEN 16777215
 
+// Initial size of the socket receive buffer
+#define ACCEL_RECV_BUFFER_SIZE (256 * 1024)
+
+// Smallest read-ahead ring for the prefetch_bytes option
+#define ACCEL_PREFETCH_MIN_SIZE (64 * 1024)
+
 #define ACCEL_OPTION_TIME_TYPE_TIMEDELTA 0
 #define ACCEL_OPTION_TIME_TYPE_TIME 1
 #define ACCEL_OPTION_JSON_TYPE_STRING 0
@@ -117,6 +136,13 @@
 #define ACCEL_OPTION_BIT_TYPE_BYTES 0
 #define ACCEL_OPTION_BIT_TYPE_INT 1
 
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
 #define CHR2INT1(x) ((x)[1] - '0')
 #define CHR2INT2(x) ((((x)[0] - '0') * 10) + ((x)[1] - '0'))
 #define CHR2INT3(x) ((((x)[0] - '0') * 1e2) + (((x)[1] - '0') * 10) + ((x)[2] - '0'))
@@ -339,16 +365,27 @@
 
 #define CHECKRC(x) if ((x) < 0) goto error;
 
+#define DESTROY(x) do { if (x) { free((void*)x); (x) = NULL; } } while (0)
+
+#define ACCEL_DECIMAL_DECIMAL 0
+#define ACCEL_DECIMAL_FLOAT 1
+#define ACCEL_DECIMAL_SCALED_INT 2
+
 typedef struct {
     int results_type;
     int parse_json;
+    int binary_protocol;
+    int decimal_type; // ACCEL_DECIMAL_* type of DECIMAL values in rows
+    int contiguous_vectors; // Collect VECTOR columns into (n_rows, dim) arrays?
+    int lazy_bson; // Return BSON documents as BSONDocument mappings?
+    unsigned long long prefetch_bytes; // Bytes to read ahead on a thread (unbuffered)
     PyObject *invalid_values;
 } MySQLAccelOptions;
 
 inline int IMAX(int a, int b) { return((a) > (b) ? a : b); }
 inline int IMIN(int a, int b) { return((a) < (b) ? a : b); }
 
-static PyObject *create_numpy_array(PyObject *py_memview, char *data_format, int data_type, PyObject *py_objs);
+static char *get_array_base_address(PyObject *py_array);
 
 char *_PyUnicode_AsUTF8(PyObject *unicode) {
     PyObject *bytes = PyUnicode_AsEncodedString(unicode, "utf-8", "strict");
@@ -366,9 +403,30 @@ char *_PyUnicode_AsUTF8(PyObject *unicode) {
 }
 
 //
-// Cached int values for date/time components
+// Cached int values for date/time components (filled in on first use)
 //
-static PyObject *PyInts[62] = {0};
+#define ACCEL_N_PYINTS 10000
+static PyObject *PyInts[ACCEL_N_PYINTS] = {0};
+
+// Return a new reference to an int, cached for small non-negative values.
+static inline PyObject *PyLong_FromCachedLong(long value) {
+    if (value < 0 || value >= ACCEL_N_PYINTS) return PyLong_FromLong(value);
+    if (!PyInts[value]) {
+        PyInts[value] = PyLong_FromLong(value);
+        if (!PyInts[value]) return NULL;
+    }
+    Py_INCREF(PyInts[value]);
+    return PyInts[value];
+}
+
+// Call a function with one argument (vectorcall when the full API is available).
+static inline PyObject *call_one(PyObject *func, PyObject *arg) {
+#if !defined(Py_LIMITED_API) && PY_VERSION_HEX >= 0x03090000
+    return PyObject_CallOneArg(func, arg);
+#else
+    return PyObject_CallFunctionObjArgs(func, arg, NULL);
+#endif
+}
 
 //
 // Cached string values
@@ -393,23 +451,31 @@ typedef struct {
     PyObject *fields;
     PyObject *flags;
     PyObject *scale;
+    PyObject *length;
     PyObject *type_code;
     PyObject *name;
     PyObject *table_name;
     PyObject *_sock;
     PyObject *settimeout;
     PyObject *_rfile;
+    PyObject *_rbuf;
+    PyObject *_rbuf_pos;
     PyObject *read;
+    PyObject *readinto1;
+    PyObject *recv_into;
     PyObject *x_errno;
     PyObject *_result;
     PyObject *_read_timeout;
     PyObject *_next_seq_id;
+    PyObject *_rownumber;
     PyObject *rows;
-    PyObject *namedtuple;
-    PyObject *Row;
+    PyObject *_fields;
+    PyObject *_index;
+    PyObject *_labels;
+    PyObject *isidentifier;
     PyObject *Series;
     PyObject *array;
-    PyObject *vectorize;
+    PyObject *empty;
     PyObject *DataFrame;
     PyObject *Table;
     PyObject *from_pylist;
@@ -422,6 +488,9 @@ typedef struct {
     PyObject *unpack;
     PyObject *decode;
     PyObject *frombuffer;
+    PyObject *ColumnarRows;
+    PyObject *_shape;
+    PyObject *accel;
 } PyStrings;
 
 static PyStrings PyStr = {0};
@@ -436,16 +505,18 @@ typedef struct {
     PyObject *datetime_time;
     PyObject *datetime_timedelta;
     PyObject *datetime_datetime;
-    PyObject *collections_namedtuple;
     PyObject *numpy_array;
     PyObject *numpy_frombuffer;
-    PyObject *numpy_vectorize;
+    PyObject *numpy_empty;
     PyObject *pandas_DataFrame;
     PyObject *polars_DataFrame;
     PyObject *pyarrow_Table;
     PyObject *pyarrow_Table_from_pylist;
     PyObject *struct_unpack;
     PyObject *bson_decode;
+    PyObject *columnar_rows;
+    PyObject *keyword_iskeyword;
+    PyObject *make_row;
 } PyFunctions;
 
 static PyFunctions PyFunc = {0};
@@ -454,1017 +525,7467 @@ static PyFunctions PyFunc = {0};
 // Cached Python objects
 //
 typedef struct {
-    PyObject *namedtuple_kwargs;
     PyObject *create_numpy_array_args;
-    PyObject *create_numpy_array_kwargs;
     PyObject *create_numpy_array_kwargs_vector[7];
     PyObject *struct_unpack_args;
     PyObject *bson_decode_args;
+    PyObject *empty_bytes;
+    PyObject *zero;
+    PyObject *row_types; // Row subtypes of unpickled rows by column names
 } PyObjects;
 
 static PyObjects PyObj = {0};
 
 //
-// State
+// Arrow C Data Interface
+//
+// https://arrow.apache.org/docs/format/CDataInterface.html
 //
 
-static PyTypeObject *StateType = NULL;
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+static PyTypeObject *ArrowColumnType = NULL;
 
+//
+// A single Arrow array built by the row reader.
+//
+// The buffers are bytearrays. Exported ArrowArrays hold a reference to the
+// column, so consumers such as pyarrow, polars, and duckdb can use the
+// buffers in place for as long as they need them.
+//
 typedef struct {
     PyObject_HEAD
-    PyObject *py_conn; // Database connection
-    PyObject *py_fields; // List of table fields
-    PyObject *py_rows; // Output object
-    PyObject *py_rfile; // Socket file I/O
-    PyObject *py_read; // File I/O read method
-    PyObject *py_sock; // Socket
-    PyObject *py_read_timeout; // Socket read timeout value
-    PyObject *py_settimeout; // Socket settimeout method
-    PyObject **py_converters; // List of converter functions
-    PyObject **py_names; // Column names
-    PyObject *py_names_list; // Python list of column names
-    PyObject *py_default_converters; // Dict of default converters
-    PyObject *py_namedtuple; // Generated namedtuple type
-    PyObject *py_namedtuple_args; // Pre-allocated tuple for namedtuple args
-    PyTypeObject *structsequence; // StructSequence type (like C namedtuple)
-    PyStructSequence_Desc structsequence_desc;
-    PyObject **py_encodings; // Encoding for each column as Python string
-    PyObject **py_invalid_values; // Values to use when invalid data exists in a cell
-    const char **encodings; // Encoding for each column
-    unsigned long long n_cols; // Total number of columns
-    unsigned long long n_rows; // Total number of rows read
-    unsigned long long n_rows_in_batch; // Number of rows in current batch (fetchmany size)
-    unsigned long *type_codes; // Type code for each column
-    unsigned long *flags; // Column flags
-    unsigned long *scales; // Column scales
-    unsigned long *offsets; // Column offsets in buffer
-    unsigned long long next_seq_id; // MySQL packet sequence number
-    MySQLAccelOptions options; // Packet reader options
-    int unbuffered; // Are we running in unbuffered mode?
-    int is_eof; // Have we hit the eof packet yet?
-    struct {
-        PyObject *_next_seq_id;
-        PyObject *rows;
-    } py_str;
-    char *encoding_errors;
-} StateObject;
+    char format[32]; // Arrow format string
+    PyObject *py_name; // Field name
+    int64_t length; // Number of values
+    int64_t null_count; // Number of NULLs
+    PyObject *py_validity; // bytearray validity bitmap, or NULL if there are no NULLs
+    PyObject *py_offsets; // bytearray of int64 offsets for variable-width values
+    PyObject *py_data; // bytearray of values
+    PyObject *py_child; // ArrowColumn of list values
+    PyObject *py_dictionary; // ArrowColumn of dictionary values for dictionary-encoded arrays
+} ArrowColumnObject;
 
-static int read_options(MySQLAccelOptions *options, PyObject *dict);
+typedef struct {
+    PyObject *py_owner; // ArrowColumn that owns the buffers
+    const void *buffers[3]; // Buffer pointers handed to the consumer
+} ArrowArrayPrivate;
+
+static void release_arrow_schema(struct ArrowSchema *schema) {
+    if (!schema || !schema->release) return;
+    for (int64_t i = 0; i < schema->n_children; i++) {
+        struct ArrowSchema *child = schema->children[i];
+        if (child->release) child->release(child);
+        free(child);
+    }
+    free(schema->children);
+    if (schema->dictionary) {
+        if (schema->dictionary->release) schema->dictionary->release(schema->dictionary);
+        free(schema->dictionary);
+    }
+    free((void*)schema->format);
+    free((void*)schema->name);
+    schema->release = NULL;
+}
 
-#define DESTROY(x) do { if (x) { free((void*)x); (x) = NULL; } } while (0)
+static void release_arrow_array(struct ArrowArray *array) {
+    if (!array || !array->release) return;
+    for (int64_t i = 0; i < array->n_children; i++) {
+        struct ArrowArray *child = array->children[i];
+        if (child->release) child->release(child);
+        free(child);
+    }
+    free(array->children);
+    if (array->dictionary) {
+        if (array->dictionary->release) array->dictionary->release(array->dictionary);
+        free(array->dictionary);
+    }
 
-int ensure_numpy() {
-    if (PyFunc.numpy_array && PyFunc.numpy_vectorize) goto exit;
+    // Consumers may release arrays from any thread.
+    ArrowArrayPrivate *priv = (ArrowArrayPrivate*)array->private_data;
+    if (priv) {
+        if (Py_IsInitialized()) {
+            PyGILState_STATE gil = PyGILState_Ensure();
+            Py_XDECREF(priv->py_owner);
+            PyGILState_Release(gil);
+        }
+        free(priv);
+    }
+    array->release = NULL;
+}
 
-    // Import numpy if it exists
-    PyObject *numpy_mod = PyImport_ImportModule("numpy");
-    if (!numpy_mod) goto error;
+static void arrow_schema_capsule_destructor(PyObject *capsule) {
+    struct ArrowSchema *schema = PyCapsule_GetPointer(capsule, "arrow_schema");
+    if (!schema) { PyErr_Clear(); return; }
+    if (schema->release) schema->release(schema);
+    free(schema);
+}
 
-    PyFunc.numpy_array = PyObject_GetAttr(numpy_mod, PyStr.array);
-    if (!PyFunc.numpy_array) goto error;
+static void arrow_array_capsule_destructor(PyObject *capsule) {
+    struct ArrowArray *array = PyCapsule_GetPointer(capsule, "arrow_array");
+    if (!array) { PyErr_Clear(); return; }
+    if (array->release) array->release(array);
+    free(array);
+}
 
-    PyFunc.numpy_frombuffer = PyObject_GetAttr(numpy_mod, PyStr.frombuffer);
-    if (!PyFunc.numpy_frombuffer) goto error;
+static int ArrowColumn_export_schema(ArrowColumnObject *self, struct ArrowSchema *out) {
+    PyObject *py_name = NULL;
 
-    PyFunc.numpy_vectorize = PyObject_GetAttr(numpy_mod, PyStr.vectorize);
-    if (!PyFunc.numpy_vectorize) goto error;
+    memset(out, 0, sizeof(struct ArrowSchema));
+    out->release = release_arrow_schema;
+    out->flags = ARROW_FLAG_NULLABLE;
+
+    out->format = strdup(self->format);
+    if (!out->format) goto nomem;
+
+    if (self->py_name && self->py_name != Py_None) {
+        py_name = PyUnicode_AsUTF8String(self->py_name);
+        if (!py_name) goto error;
+        out->name = strdup(PyBytes_AsString(py_name));
+        Py_CLEAR(py_name);
+    } else {
+        out->name = strdup("");
+    }
+    if (!out->name) goto nomem;
+
+    if (self->py_child) {
+        out->children = calloc(1, sizeof(struct ArrowSchema*));
+        if (!out->children) goto nomem;
+        out->children[0] = calloc(1, sizeof(struct ArrowSchema));
+        if (!out->children[0]) goto nomem;
+        out->n_children = 1;
+        if (ArrowColumn_export_schema((ArrowColumnObject*)self->py_child, out->children[0]) < 0) {
+            goto error;
+        }
+    }
+
+    if (self->py_dictionary) {
+        out->dictionary = calloc(1, sizeof(struct ArrowSchema));
+        if (!out->dictionary) goto nomem;
+        if (ArrowColumn_export_schema((ArrowColumnObject*)self->py_dictionary, out->dictionary) < 0) {
+            goto error;
+        }
+    }
 
-exit:
     return 0;
 
+nomem:
+    PyErr_NoMemory();
+
 error:
-    PyErr_Clear();
+    Py_XDECREF(py_name);
+    out->release(out);
     return -1;
 }
 
+static int ArrowColumn_export_array(ArrowColumnObject *self, struct ArrowArray *out) {
+    ArrowArrayPrivate *priv = NULL;
+    char fmt = self->format[0];
 
-int ensure_pandas() {
-    if (PyFunc.pandas_DataFrame) goto exit;
+    memset(out, 0, sizeof(struct ArrowArray));
+    out->release = release_arrow_array;
+    out->length = self->length;
+    out->null_count = self->null_count;
 
-    // Import pandas if it exists
-    PyObject *pandas_mod = PyImport_ImportModule("pandas");
-    if (!pandas_mod) goto error;
+    priv = calloc(1, sizeof(ArrowArrayPrivate));
+    if (!priv) goto nomem;
+    out->private_data = priv;
+    priv->py_owner = (PyObject*)self;
+    Py_INCREF(self);
 
-    PyFunc.pandas_DataFrame = PyObject_GetAttr(pandas_mod, PyStr.DataFrame);
-    if (!PyFunc.pandas_DataFrame) goto error;
+    out->buffers = priv->buffers;
+    if (fmt == 'n') {
+        out->n_buffers = 0;
+    } else {
+        priv->buffers[0] = (self->py_validity) ? PyByteArray_AsString(self->py_validity) : NULL;
+        if (fmt == 'u' || fmt == 'z' || fmt == 'U' || fmt == 'Z') {
+            out->n_buffers = 3;
+            priv->buffers[1] = PyByteArray_AsString(self->py_offsets);
+            priv->buffers[2] = PyByteArray_AsString(self->py_data);
+        } else if (fmt == '+') {
+            out->n_buffers = 1;
+        } else {
+            out->n_buffers = 2;
+            priv->buffers[1] = PyByteArray_AsString(self->py_data);
+        }
+    }
+
+    if (self->py_child) {
+        out->children = calloc(1, sizeof(struct ArrowArray*));
+        if (!out->children) goto nomem;
+        out->children[0] = calloc(1, sizeof(struct ArrowArray));
+        if (!out->children[0]) goto nomem;
+        out->n_children = 1;
+        if (ArrowColumn_export_array((ArrowColumnObject*)self->py_child, out->children[0]) < 0) {
+            goto error;
+        }
+    }
+
+    if (self->py_dictionary) {
+        out->dictionary = calloc(1, sizeof(struct ArrowArray));
+        if (!out->dictionary) goto nomem;
+        if (ArrowColumn_export_array((ArrowColumnObject*)self->py_dictionary, out->dictionary) < 0) {
+            goto error;
+        }
+    }
 
-exit:
     return 0;
 
+nomem:
+    PyErr_NoMemory();
+
 error:
-    PyErr_Clear();
+    out->release(out);
     return -1;
 }
 
+static PyObject *ArrowColumn_arrow_c_schema(ArrowColumnObject *self, PyObject *args) {
+    struct ArrowSchema *schema = calloc(1, sizeof(struct ArrowSchema));
+    if (!schema) return PyErr_NoMemory();
 
-int ensure_polars() {
-    if (PyFunc.polars_DataFrame) goto exit;
-
-    // Import polars if it exists
-    PyObject *polars_mod = PyImport_ImportModule("polars");
-    if (!polars_mod) goto error;
+    if (ArrowColumn_export_schema(self, schema) < 0) {
+        free(schema);
+        return NULL;
+    }
 
-    PyFunc.polars_DataFrame = PyObject_GetAttr(polars_mod, PyStr.DataFrame);
-    if (!PyFunc.polars_DataFrame) goto error;
+    PyObject *py_out = PyCapsule_New(schema, "arrow_schema", arrow_schema_capsule_destructor);
+    if (!py_out) {
+        schema->release(schema);
+        free(schema);
+    }
+    return py_out;
+}
 
-exit:
-    return 0;
+static PyObject *ArrowColumn_arrow_c_array(ArrowColumnObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *py_requested_schema = NULL;
+    PyObject *py_schema = NULL;
+    PyObject *py_array = NULL;
+    PyObject *py_out = NULL;
+    struct ArrowArray *array = NULL;
+    char *keywords[] = {"requested_schema", NULL};
 
-error:
-    PyErr_Clear();
-    return -1;
-}
+    // The requested schema is a hint; consumers cast if it is not honored.
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O", keywords, &py_requested_schema)) {
+        goto error;
+    }
 
+    py_schema = ArrowColumn_arrow_c_schema(self, NULL);
+    if (!py_schema) goto error;
 
-int ensure_pyarrow() {
-    if (PyFunc.pyarrow_Table_from_pylist) goto exit;
+    array = calloc(1, sizeof(struct ArrowArray));
+    if (!array) { PyErr_NoMemory(); goto error; }
 
-    // Import pyarrow if it exists
-    PyObject *pyarrow_mod = PyImport_ImportModule("pyarrow");
-    if (!pyarrow_mod) goto error;
+    if (ArrowColumn_export_array(self, array) < 0) goto error;
 
-    PyFunc.pyarrow_Table = PyObject_GetAttr(pyarrow_mod, PyStr.Table);
-    if (!PyFunc.pyarrow_Table) goto error;
+    py_array = PyCapsule_New(array, "arrow_array", arrow_array_capsule_destructor);
+    if (!py_array) { array->release(array); goto error; }
+    array = NULL;
 
-    PyFunc.pyarrow_Table_from_pylist = PyObject_GetAttr(PyFunc.pyarrow_Table, PyStr.from_pylist);
-    if (!PyFunc.pyarrow_Table_from_pylist) goto error;
+    py_out = PyTuple_Pack(2, py_schema, py_array);
 
 exit:
-    return 0;
+    Py_XDECREF(py_schema);
+    Py_XDECREF(py_array);
+    return py_out;
 
 error:
-    PyErr_Clear();
-    return -1;
+    free(array);
+    Py_CLEAR(py_out);
+    goto exit;
 }
 
+static Py_ssize_t ArrowColumn_len(ArrowColumnObject *self) {
+    return (Py_ssize_t)self->length;
+}
 
-int ensure_bson() {
-    if (PyFunc.bson_decode) goto exit;
+static void ArrowColumn_dealloc(ArrowColumnObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    Py_CLEAR(self->py_name);
+    Py_CLEAR(self->py_validity);
+    Py_CLEAR(self->py_offsets);
+    Py_CLEAR(self->py_data);
+    Py_CLEAR(self->py_child);
+    Py_CLEAR(self->py_dictionary);
+    PyObject_Del(self);
+    Py_DECREF(tp);
+}
 
-    // Import bson if it exists
-    PyObject *bson_mod = PyImport_ImportModule("bson");
-    if (!bson_mod) goto error;
+static PyMethodDef ArrowColumnType_methods[] = {
+    {"__arrow_c_schema__", (PyCFunction)ArrowColumn_arrow_c_schema, METH_NOARGS,
+     "Export the array type as an ArrowSchema PyCapsule"},
+    {"__arrow_c_array__", (PyCFunction)ArrowColumn_arrow_c_array, METH_VARARGS | METH_KEYWORDS,
+     "Export the array as ArrowSchema and ArrowArray PyCapsules"},
+    {NULL, NULL, 0, NULL}
+};
 
-    PyFunc.bson_decode = PyObject_GetAttr(bson_mod, PyStr.decode);
-    if (!PyFunc.bson_decode) goto error;
+static PyType_Slot ArrowColumnType_slots[] = {
+    {Py_tp_dealloc, (destructor)ArrowColumn_dealloc},
+    {Py_tp_methods, ArrowColumnType_methods},
+    {Py_sq_length, (lenfunc)ArrowColumn_len},
+    {Py_tp_doc, "Arrow array exported through the Arrow C Data Interface"},
+    {0, NULL},
+};
 
-exit:
-    return 0;
+static PyType_Spec ArrowColumnType_spec = {
+    .name = ACCEL_STR(ACCEL_MODULE_NAME) ".ArrowColumn",
+    .basicsize = sizeof(ArrowColumnObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = ArrowColumnType_slots,
+};
 
-error:
-    PyErr_Clear();
-    return -1;
+//
+// Build a validity bitmap (1 = valid) from a byte-per-value NULL mask.
+//
+static PyObject *mask_to_validity_bitmap(const char *mask, unsigned long long n) {
+    PyObject *py_out = PyByteArray_FromStringAndSize(NULL, (n + 7) / 8);
+    if (!py_out) return NULL;
+    uint8_t *bits = (uint8_t*)PyByteArray_AsString(py_out);
+    memset(bits, 0, (n + 7) / 8);
+    for (unsigned long long i = 0; i < n; i++) {
+        if (!mask[i]) bits[i >> 3] |= (uint8_t)(1 << (i & 7));
+    }
+    return py_out;
 }
 
-
-static void State_clear_fields(StateObject *self) {
-    if (!self) return;
-    DESTROY(self->offsets);
-    DESTROY(self->scales);
-    DESTROY(self->flags);
-    DESTROY(self->type_codes);
-    DESTROY(self->encodings);
-    DESTROY(self->structsequence_desc.fields);
-    DESTROY(self->encoding_errors);
-    if (self->py_converters) {
-        for (unsigned long i = 0; i < self->n_cols; i++) {
-            Py_CLEAR(self->py_converters[i]);
-        }
-        DESTROY(self->py_converters);
+//
+// Text decoding
+//
+// The codec of each text column is resolved once per result. UTF-8, ASCII
+// and Latin-1 columns call the matching CPython decoder directly instead of
+// looking the codec up by name for every cell, and pure ASCII cells of any
+// ASCII-compatible charset are copied into a new str without decoding.
+//
+#define ACCEL_CODEC_OTHER 0 // Decoded by name with PyUnicode_Decode
+#define ACCEL_CODEC_ASCII_COMPAT 1 // Decoded by name, but ASCII bytes map to themselves
+#define ACCEL_CODEC_UTF8 2
+#define ACCEL_CODEC_ASCII 3
+#define ACCEL_CODEC_LATIN1 4
+
+static int resolve_codec(const char *encoding) {
+    char name[16];
+    size_t n = 0;
+
+    if (!encoding) return ACCEL_CODEC_OTHER;
+
+    // Normalize the name the way Python codec lookups do.
+    for (; encoding[n] && n < sizeof(name) - 1; n++) {
+        char c = encoding[n];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (c == '-' || c == ' ') c = '_';
+        name[n] = c;
     }
-    if (self->py_names) {
-        for (unsigned long i = 0; i < self->n_cols; i++) {
-            Py_CLEAR(self->py_names[i]);
-        }
-        DESTROY(self->py_names);
+    if (encoding[n]) return ACCEL_CODEC_OTHER;
+    name[n] = '\0';
+
+    if (!strcmp(name, "utf8") || !strcmp(name, "utf_8") ||
+        !strcmp(name, "utf8mb4") || !strcmp(name, "utf8mb3")) return ACCEL_CODEC_UTF8;
+    if (!strcmp(name, "ascii") || !strcmp(name, "us_ascii")) return ACCEL_CODEC_ASCII;
+    if (!strcmp(name, "latin1") || !strcmp(name, "latin_1") ||
+        !strcmp(name, "iso8859_1") || !strcmp(name, "iso_8859_1")) return ACCEL_CODEC_LATIN1;
+    if (!strncmp(name, "cp125", 5) || !strncmp(name, "latin", 5) ||
+        !strncmp(name, "iso8859", 7) || !strncmp(name, "iso_8859", 8) ||
+        !strncmp(name, "koi8", 4)) return ACCEL_CODEC_ASCII_COMPAT;
+
+    return ACCEL_CODEC_OTHER;
+}
+
+//
+// Return non-zero if no byte of the string has the high bit set.
+//
+// Checks 32 bytes per step as four 64-bit words.
+//
+static inline int is_ascii(const char *s, unsigned long long s_l) {
+    const uint64_t high = 0x8080808080808080ULL;
+    unsigned long long i = 0;
+    uint64_t w[4];
+
+    for (; i + 32 <= s_l; i += 32) {
+        memcpy(w, s + i, 32);
+        if ((w[0] | w[1] | w[2] | w[3]) & high) return 0;
     }
-    if (self->py_encodings) {
-        for (unsigned long i = 0; i < self->n_cols; i++) {
-            Py_CLEAR(self->py_encodings[i]);
-        }
-        DESTROY(self->py_encodings);
+    for (; i + 8 <= s_l; i += 8) {
+        memcpy(w, s + i, 8);
+        if (w[0] & high) return 0;
     }
-    if (self->py_invalid_values) {
-        for (unsigned long i = 0; i < self->n_cols; i++) {
-            Py_CLEAR(self->py_invalid_values[i]);
-        }
-        DESTROY(self->py_invalid_values);
+    for (; i < s_l; i++) {
+        if ((unsigned char)s[i] & 0x80) return 0;
     }
-    Py_CLEAR(self->structsequence);
-    Py_CLEAR(self->py_namedtuple);
-    Py_CLEAR(self->py_namedtuple_args);
-    Py_CLEAR(self->py_names_list);
-    Py_CLEAR(self->py_default_converters);
-    Py_CLEAR(self->py_settimeout);
-    Py_CLEAR(self->py_read_timeout);
-    Py_CLEAR(self->py_sock);
-    Py_CLEAR(self->py_read);
-    Py_CLEAR(self->py_rfile);
-    Py_CLEAR(self->py_rows);
-    Py_CLEAR(self->py_fields);
-    Py_CLEAR(self->py_conn);
-}
 
-static void State_dealloc(StateObject *self) {
-    State_clear_fields(self);
-    PyObject_Del(self);
+    return 1;
 }
 
-static int State_init(StateObject *self, PyObject *args, PyObject *kwds) {
-    int rc = 0;
-    PyObject *py_res = NULL;
-    PyObject *py_converters = NULL;
-    PyObject *py_options = NULL;
-    PyObject *py_args = NULL;
-    unsigned long long requested_n_rows = 0;
-
-    if (!PyArg_ParseTuple(args, "OK", &py_res, &requested_n_rows)) {
-        return -1;
+//
+// Decode a text cell with the codec resolved for its column.
+//
+static PyObject *decode_text(
+    const char *s,
+    unsigned long long s_l,
+    int codec,
+    const char *encoding,
+    const char *encoding_errors
+) {
+    if (codec != ACCEL_CODEC_OTHER && is_ascii(s, s_l)) {
+#ifdef Py_LIMITED_API
+        return PyUnicode_DecodeLatin1(s, (Py_ssize_t)s_l, NULL);
+#else
+        PyObject *py_out = PyUnicode_New((Py_ssize_t)s_l, 127);
+        if (!py_out) return NULL;
+        memcpy(PyUnicode_1BYTE_DATA(py_out), s, s_l);
+        return py_out;
+#endif
     }
 
-    py_options = PyObject_GetAttr(py_res, PyStr.options);
-    if (!py_options) {
-        Py_INCREF(Py_None);
-        py_options = Py_None;
+    switch (codec) {
+    case ACCEL_CODEC_UTF8:
+        return PyUnicode_DecodeUTF8(s, (Py_ssize_t)s_l, encoding_errors);
+    case ACCEL_CODEC_ASCII:
+        return PyUnicode_DecodeASCII(s, (Py_ssize_t)s_l, encoding_errors);
+    case ACCEL_CODEC_LATIN1:
+        return PyUnicode_DecodeLatin1(s, (Py_ssize_t)s_l, encoding_errors);
     }
 
-    if (PyDict_Check(py_options)) {
-        self->py_default_converters = PyDict_GetItemString(py_options, "default_converters");
-        if (self->py_default_converters && !PyDict_Check(self->py_default_converters)) {
-            self->py_default_converters = NULL;
-        }
-        Py_XINCREF(self->py_default_converters);
-        PyObject *py_unbuffered = PyDict_GetItemString(py_options, "unbuffered");
-        if (py_unbuffered && PyObject_IsTrue(py_unbuffered)) {
-            self->unbuffered = 1;
-        }
-        PyObject *py_encoding_errors = PyDict_GetItemString(py_options, "encoding_errors");
-        if (py_encoding_errors) {
-            self->encoding_errors = _PyUnicode_AsUTF8(py_encoding_errors);
-            if (!self->encoding_errors) goto error;
+    return PyUnicode_Decode(s, s_l, encoding, encoding_errors);
+}
+
+//
+// String tables
+//
+// The distinct values of a text column, keyed by their raw bytes. Row
+// results use them to return the same str object for repeated values, and
+// ENUM / SET columns of DataFrame and Arrow results use the value indexes
+// as dictionary codes.
+//
+
+#define ACCEL_INTERN_MAX_ENTRIES 1024
+#define ACCEL_INTERN_MAX_LENGTH 64
+
+typedef struct {
+    unsigned long long n_entries; // Number of distinct values
+    unsigned long long capacity; // Number of values allocated
+    unsigned long long n_slots; // Number of hash slots (a power of 2)
+    int64_t *slots; // Index + 1 of the value in each hash slot (0 if empty)
+    uint64_t *hashes; // Hash of each value
+    int64_t *offsets; // Offset of each value in data (n_entries + 1 of them)
+    char *data; // Raw bytes of the values
+    unsigned long long data_capacity; // Number of bytes allocated in data
+    PyObject *py_values; // List of decoded values
+} StringTable;
+
+// 64-bit FNV-1a
+static inline uint64_t hash_bytes(const char *s, unsigned long long s_l) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned long long i = 0; i < s_l; i++) {
+        h = (h ^ (unsigned char)s[i]) * 1099511628211ULL;
+    }
+    return h;
+}
+
+static void StringTable_free(StringTable *table) {
+    if (!table) return;
+    DESTROY(table->slots);
+    DESTROY(table->hashes);
+    DESTROY(table->offsets);
+    DESTROY(table->data);
+    Py_CLEAR(table->py_values);
+    free(table);
+}
+
+// Return the index of a value, or -1 if it is not in the table.
+static int64_t StringTable_find(
+    StringTable *table,
+    const char *s,
+    unsigned long long s_l,
+    uint64_t h
+) {
+    if (!table->n_slots) return -1;
+    for (uint64_t k = h & (table->n_slots - 1); table->slots[k];
+         k = (k + 1) & (table->n_slots - 1)) {
+        int64_t idx = table->slots[k] - 1;
+        if (table->hashes[idx] == h &&
+                (unsigned long long)(table->offsets[idx + 1] - table->offsets[idx]) == s_l &&
+                memcmp(table->data + table->offsets[idx], s, s_l) == 0) {
+            return idx;
         }
     }
+    return -1;
+}
 
-    if (!self->encoding_errors) {
-        self->encoding_errors = calloc(7, 1);
-        if (!self->encoding_errors) goto error;
-        memcpy(self->encoding_errors, "strict", 6);
+// Add a value and its decoded object; returns the new index or -1 on error.
+static int64_t StringTable_add(
+    StringTable *table,
+    const char *s,
+    unsigned long long s_l,
+    uint64_t h,
+    PyObject *py_value
+) {
+    unsigned long long idx = table->n_entries;
+
+    if (!table->py_values) {
+        table->py_values = PyList_New(0);
+        if (!table->py_values) return -1;
     }
 
-    if (self->unbuffered) {
-        PyObject *unbuffered_active = PyObject_GetAttr(py_res, PyStr.unbuffered_active);
-        if (!unbuffered_active || !PyObject_IsTrue(unbuffered_active)) {
-            Py_XDECREF(unbuffered_active);
-            goto error;
-        }
-        Py_XDECREF(unbuffered_active);
+    if (idx == table->capacity) {
+        unsigned long long capacity = (table->capacity) ? table->capacity * 2 : 16;
+        uint64_t *hashes = realloc(table->hashes, capacity * sizeof(uint64_t));
+        if (!hashes) goto nomem;
+        table->hashes = hashes;
+        int64_t *offsets = realloc(table->offsets, (capacity + 1) * sizeof(int64_t));
+        if (!offsets) goto nomem;
+        if (!table->offsets) offsets[0] = 0;
+        table->offsets = offsets;
+        table->capacity = capacity;
     }
 
-    // Retrieve type codes for each column.
-    PyObject *py_field_count = PyObject_GetAttr(py_res, PyStr.field_count);
-    if (!py_field_count) goto error;
-    self->n_cols = PyLong_AsUnsignedLong(py_field_count);
-    Py_XDECREF(py_field_count);
+    if (table->offsets[idx] + s_l > table->data_capacity) {
+        unsigned long long capacity = MAX(table->data_capacity * 2, 256);
+        while (capacity < table->offsets[idx] + s_l) capacity *= 2;
+        char *data = realloc(table->data, capacity);
+        if (!data) goto nomem;
+        table->data = data;
+        table->data_capacity = capacity;
+    }
 
-    py_converters = PyObject_GetAttr(py_res, PyStr.converters);
-    if (!py_converters) goto error;
+    // Keep the hash slots at most half full.
+    if ((idx + 1) * 2 > table->n_slots) {
+        unsigned long long n_slots = MAX(table->n_slots * 2, 32);
+        int64_t *slots = calloc(n_slots, sizeof(int64_t));
+        if (!slots) goto nomem;
+        for (unsigned long long j = 0; j < idx; j++) {
+            uint64_t k = table->hashes[j] & (n_slots - 1);
+            while (slots[k]) k = (k + 1) & (n_slots - 1);
+            slots[k] = (int64_t)j + 1;
+        }
+        free(table->slots);
+        table->slots = slots;
+        table->n_slots = n_slots;
+    }
 
-    self->py_converters = calloc(self->n_cols, sizeof(PyObject*));
-    if (!self->py_converters) goto error;
+    if (PyList_Append(table->py_values, py_value) < 0) return -1;
 
-    self->type_codes = calloc(self->n_cols, sizeof(unsigned long));
-    if (!self->type_codes) goto error;
+    if (s_l) memcpy(table->data + table->offsets[idx], s, s_l);
+    table->offsets[idx + 1] = table->offsets[idx] + (int64_t)s_l;
+    table->hashes[idx] = h;
 
-    self->flags = calloc(self->n_cols, sizeof(unsigned long));
-    if (!self->flags) goto error;
+    uint64_t k = h & (table->n_slots - 1);
+    while (table->slots[k]) k = (k + 1) & (table->n_slots - 1);
+    table->slots[k] = (int64_t)idx + 1;
 
-    self->scales = calloc(self->n_cols, sizeof(unsigned long));
-    if (!self->scales) goto error;
+    table->n_entries++;
+    return (int64_t)idx;
 
-    self->encodings = calloc(self->n_cols, sizeof(char*));
-    if (!self->encodings) goto error;
+nomem:
+    PyErr_NoMemory();
+    return -1;
+}
 
-    self->py_encodings = calloc(self->n_cols, sizeof(char*));
-    if (!self->py_encodings) goto error;
+//
+// Decode a text cell, returning the same str object for repeated values.
+//
+// Only short values are interned, and the table stops growing once it
+// holds ACCEL_INTERN_MAX_ENTRIES values.
+//
+static PyObject *decode_interned(
+    StringTable *table,
+    const char *s,
+    unsigned long long s_l,
+    int codec,
+    const char *encoding,
+    const char *encoding_errors
+) {
+    PyObject *py_out = NULL;
+    uint64_t h = 0;
 
-    self->py_invalid_values = calloc(self->n_cols, sizeof(char*));
-    if (!self->py_invalid_values) goto error;
+    if (!table || s_l > ACCEL_INTERN_MAX_LENGTH) {
+        return decode_text(s, s_l, codec, encoding, encoding_errors);
+    }
 
-    self->py_names = calloc(self->n_cols, sizeof(PyObject*));
-    if (!self->py_names) goto error;
+    h = hash_bytes(s, s_l);
+    int64_t idx = StringTable_find(table, s, s_l, h);
+    if (idx >= 0) {
+        py_out = PyList_GetItem(table->py_values, idx);
+        Py_XINCREF(py_out);
+        return py_out;
+    }
 
-    self->py_fields = PyObject_GetAttr(py_res, PyStr.fields);
-    if (!self->py_fields) goto error;
+    py_out = decode_text(s, s_l, codec, encoding, encoding_errors);
+    if (!py_out) return NULL;
 
-    self->py_names_list = PyList_New(self->n_cols);
-    if (!self->py_names_list) goto error;
+    if (table->n_entries < ACCEL_INTERN_MAX_ENTRIES &&
+            StringTable_add(table, s, s_l, h, py_out) < 0) {
+        Py_DECREF(py_out);
+        return NULL;
+    }
 
-    for (unsigned long i = 0; i < self->n_cols; i++) {
-        // Get type codes.
-        PyObject *py_field = PyList_GetItem(self->py_fields, i);
-        if (!py_field) goto error;
+    return py_out;
+}
 
-        PyObject *py_flags = PyObject_GetAttr(py_field, PyStr.flags);
-        if (!py_flags) goto error;
-        self->flags[i] = PyLong_AsUnsignedLong(py_flags);
-        Py_XDECREF(py_flags);
+//
+// Build an Arrow utf8 array of the decoded values of a table.
+//
+static PyObject *StringTable_to_arrow(StringTable *table) {
+    ArrowColumnObject *py_out = NULL;
+    PyObject *py_bytes = NULL;
+    unsigned long long n = table->n_entries;
+    int64_t data_l = 0;
 
-        PyObject *py_scale = PyObject_GetAttr(py_field, PyStr.scale);
-        if (!py_scale) goto error;
-        self->scales[i] = PyLong_AsUnsignedLong(py_scale);
-        Py_XDECREF(py_scale);
+    py_out = (ArrowColumnObject*)PyType_GenericAlloc(ArrowColumnType, 0);
+    if (!py_out) goto error;
 
-        PyObject *py_field_type = PyObject_GetAttr(py_field, PyStr.type_code);
-        if (!py_field_type) goto error;
-        self->type_codes[i] = PyLong_AsUnsignedLong(py_field_type);
-        PyObject *py_default_converter = (self->py_default_converters) ?
-                      PyDict_GetItem(self->py_default_converters, py_field_type) : NULL;
-        PyObject *py_invalid_value = (self->options.invalid_values) ?
-                      PyDict_GetItem(self->options.invalid_values, py_field_type) : NULL;
-        Py_XDECREF(py_field_type);
+    strcpy(py_out->format, "u");
+    py_out->length = (int64_t)n;
 
-        // Get field name.
-        PyObject *py_field_name = PyObject_GetAttr(py_field, PyStr.name);
-        if (!py_field_name) goto error;
+    py_out->py_offsets = PyByteArray_FromStringAndSize(NULL, (n + 1) * sizeof(int32_t));
+    if (!py_out->py_offsets) goto error;
+    py_out->py_data = PyByteArray_FromStringAndSize(NULL, 0);
+    if (!py_out->py_data) goto error;
 
-        // Make sure field name is not a duplicate.
-        int dup_found = 0;
-        for (unsigned long j = 0; j < i; j++) {
-            if (PyUnicode_Compare(self->py_names[j], py_field_name) == 0) {
-                dup_found = 1;
-                break;
-            }
-        }
-        if (dup_found) {
-            PyObject *py_table_name = PyObject_GetAttr(py_field, PyStr.table_name);
-            self->py_names[i] = PyUnicode_FromFormat("%U.%U", py_table_name, py_field_name);
-            Py_XDECREF(py_table_name);
-            if (!self->py_names[i]) goto error;
-        } else {
-            self->py_names[i] = py_field_name;
+    int32_t *offsets = (int32_t*)PyByteArray_AsString(py_out->py_offsets);
+    offsets[0] = 0;
+
+    for (unsigned long long i = 0; i < n; i++) {
+        py_bytes = PyUnicode_AsUTF8String(PyList_GetItem(table->py_values, i));
+        if (!py_bytes) goto error;
+        Py_ssize_t value_l = PyBytes_Size(py_bytes);
+        if (data_l + value_l > INT32_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "dictionary values exceed 2GB");
+            goto error;
         }
+        CHECKRC(PyByteArray_Resize(py_out->py_data, data_l + value_l));
+        memcpy(PyByteArray_AsString(py_out->py_data) + data_l,
+               PyBytes_AsString(py_bytes), value_l);
+        Py_CLEAR(py_bytes);
+        data_l += value_l;
+        offsets = (int32_t*)PyByteArray_AsString(py_out->py_offsets);
+        offsets[i + 1] = (int32_t)data_l;
+    }
 
-        Py_INCREF(self->py_names[i]);  // Extra ref since SetItem steals one
-        rc = PyList_SetItem(self->py_names_list, i, self->py_names[i]);
-        if (rc) goto error;
+    return (PyObject*)py_out;
 
-        // Get field encodings (NULL means binary) and default converters.
-        PyObject *py_tmp = PyList_GetItem(py_converters, i);
-        if (!py_tmp) goto error;
-        PyObject *py_encoding = PyTuple_GetItem(py_tmp, 0);
-        if (!py_encoding) goto error;
-        PyObject *py_converter = PyTuple_GetItem(py_tmp, 1);
-        if (!py_converter) goto error;
+error:
+    Py_XDECREF(py_bytes);
+    Py_XDECREF(py_out);
+    return NULL;
+}
 
-        self->py_encodings[i] = (py_encoding == Py_None) ? NULL : py_encoding;
-        Py_XINCREF(self->py_encodings[i]);
+//
+// Column buffers
+//
+// The numpy, pandas, polars, and arrow results types decode numeric and
+// temporal cells straight into packed per-column buffers with a NULL mask.
+// Other columns collect their Python objects in a list. For arrow results,
+// the buffers use Arrow layouts (including offsets + data for strings) and
+// are handed over as ArrowColumn objects.
+//
 
-        self->encodings[i] = (!py_encoding || py_encoding == Py_None) ?
-                              NULL : _PyUnicode_AsUTF8(py_encoding);
+#define ACCEL_COL_OBJECT 0
+#define ACCEL_COL_INT 1
+#define ACCEL_COL_UINT 2
+#define ACCEL_COL_FLOAT 3
+#define ACCEL_COL_DOUBLE 4
+#define ACCEL_COL_DATE 5
+#define ACCEL_COL_DATETIME 6
+#define ACCEL_COL_TIME 7
+#define ACCEL_COL_DATE64 8
+#define ACCEL_COL_UTF8 9
+#define ACCEL_COL_BINARY 10
+#define ACCEL_COL_DECIMAL128 11
+#define ACCEL_COL_DICT 12
+#define ACCEL_COL_VECTOR 13
+
+#define ACCEL_COL_MIN_CAPACITY 1024
+#define ACCEL_COL_MAX_PRESIZE (64 * 1024)
 
-        self->py_invalid_values[i] = (!py_invalid_value || py_invalid_value == Py_None) ?
-                                      NULL : py_converter;
-        Py_XINCREF(self->py_invalid_values[i]);
+typedef struct {
+    int kind; // ACCEL_COL_* storage kind
+    int itemsize; // Size of each packed value in bytes
+    const char *dtype; // numpy dtype of packed values
+    const char *format; // Arrow format of packed values, or NULL if not exported to Arrow
+    char format_buf[16]; // Storage for parameterized Arrow formats
+    int precision; // Number of digits of DECIMAL values
+    int scale; // Number of fraction digits of DECIMAL values
+    int dim; // Number of elements of each VECTOR value
+    int vector_type; // MYSQL_TYPE_*_VECTOR(_JSON) code of VECTOR values
+    const char *child_format; // Arrow format of VECTOR elements
+    StringTable *dictionary; // Distinct values of dictionary-encoded columns
+    PyObject *py_name; // Column name
+    PyObject *py_values; // bytearray of packed values (or offsets), or list of objects
+    PyObject *py_mask; // bytearray of NULL flags for packed values
+    PyObject *py_data; // bytearray of variable-width values
+    char *values; // Data pointer of py_values
+    char *mask; // Data pointer of py_mask
+    char *data; // Data pointer of py_data
+    unsigned long long length; // Number of values in the current batch
+    unsigned long long capacity; // Number of values allocated
+    unsigned long long n_nulls; // Number of NULLs in the current batch
+    unsigned long long data_length; // Number of bytes used in py_data
+    unsigned long long data_capacity; // Number of bytes allocated in py_data
+    unsigned long long size_hint; // Number of values to allocate up front for the next batch
+    unsigned long long data_size_hint; // Number of bytes to allocate up front for the next batch
+} ColumnBuffer;
+
+static void ColumnBuffer_reset(ColumnBuffer *col) {
+    Py_CLEAR(col->py_values);
+    Py_CLEAR(col->py_mask);
+    Py_CLEAR(col->py_data);
+    col->values = NULL;
+    col->mask = NULL;
+    col->data = NULL;
+    col->length = 0;
+    col->capacity = 0;
+    col->n_nulls = 0;
+    col->data_length = 0;
+    col->data_capacity = 0;
+}
 
-        self->py_converters[i] = ((!py_converter || py_converter == py_default_converter)
-                                   // TODO: Need C accelerated converters for extended types
-                                   // && self->type_codes[i] < 256
-                                   ) ?
-                                 NULL : py_converter;
-        Py_XINCREF(self->py_converters[i]);
+static inline int is_var_width_column(ColumnBuffer *col) {
+    return col->kind == ACCEL_COL_UTF8 || col->kind == ACCEL_COL_BINARY;
+}
+
+static int ColumnBuffer_grow(ColumnBuffer *col) {
+    unsigned long long capacity = (col->capacity) ? col->capacity * 2 :
+                                  MAX(col->size_hint, ACCEL_COL_MIN_CAPACITY);
+
+    // Variable-width columns store n + 1 offsets.
+    unsigned long long n_values = capacity + is_var_width_column(col);
+
+    if (!col->py_values) {
+        col->py_values = PyByteArray_FromStringAndSize(NULL, n_values * col->itemsize);
+        if (!col->py_values) goto error;
+        col->py_mask = PyByteArray_FromStringAndSize(NULL, capacity);
+        if (!col->py_mask) goto error;
+        if (is_var_width_column(col)) {
+            memset(PyByteArray_AsString(col->py_values), 0, col->itemsize);
+        }
+    } else {
+        CHECKRC(PyByteArray_Resize(col->py_values, n_values * col->itemsize));
+        CHECKRC(PyByteArray_Resize(col->py_mask, capacity));
     }
 
-    // Loop over all data packets.
-    self->py_conn = PyObject_GetAttr(py_res, PyStr.connection);
-    if (!self->py_conn) goto error;
+    col->values = PyByteArray_AsString(col->py_values);
+    col->mask = PyByteArray_AsString(col->py_mask);
+    col->capacity = capacity;
 
-    // Cache socket timeout and read methods.
-    self->py_sock = PyObject_GetAttr(self->py_conn, PyStr._sock);
-    if (!self->py_sock) goto error;
-    self->py_settimeout = PyObject_GetAttr(self->py_sock, PyStr.settimeout);
-    if (!self->py_settimeout) goto error;
-    self->py_read_timeout = PyObject_GetAttr(self->py_conn, PyStr._read_timeout);
-    if (!self->py_read_timeout) goto error;
+    return 0;
 
-    self->py_rfile = PyObject_GetAttr(self->py_conn, PyStr._rfile);
-    if (!self->py_rfile) goto error;
-    self->py_read = PyObject_GetAttr(self->py_rfile, PyStr.read);
-    if (!self->py_read) goto error;
+error:
+    ColumnBuffer_reset(col);
+    return -1;
+}
 
-    PyObject *py_next_seq_id = PyObject_GetAttr(self->py_conn, PyStr._next_seq_id);
-    if (!py_next_seq_id) goto error;
-    self->next_seq_id = PyLong_AsUnsignedLongLong(py_next_seq_id);
-    Py_XDECREF(py_next_seq_id);
+// Reserve the next packed value and return a pointer to it.
+static inline char *ColumnBuffer_append(ColumnBuffer *col, int is_null) {
+    if (col->length == col->capacity && ColumnBuffer_grow(col) < 0) return NULL;
+    col->mask[col->length] = (char)is_null;
+    col->n_nulls += is_null;
+    return col->values + col->itemsize * col->length++;
+}
 
-    if (py_options && PyDict_Check(py_options)) {
-        rc = read_options(&self->options, py_options);
-        if (rc) goto error;
+// Append a variable-width value (NULLs have zero length).
+static int ColumnBuffer_append_bytes(
+    ColumnBuffer *col,
+    const char *value,
+    unsigned long long value_l,
+    int is_null
+) {
+    if (col->length == col->capacity && ColumnBuffer_grow(col) < 0) return -1;
+
+    if (col->data_length + value_l > col->data_capacity) {
+        unsigned long long capacity = (col->data_capacity) ? col->data_capacity * 2 :
+                                      MAX(col->data_size_hint, ACCEL_COL_MIN_CAPACITY * 16);
+        while (capacity < col->data_length + value_l) capacity *= 2;
+        if (!col->py_data) {
+            col->py_data = PyByteArray_FromStringAndSize(NULL, capacity);
+            if (!col->py_data) return -1;
+        } else if (PyByteArray_Resize(col->py_data, capacity)) {
+            return -1;
+        }
+        col->data = PyByteArray_AsString(col->py_data);
+        col->data_capacity = capacity;
     }
 
-    switch (self->options.results_type) {
-    case ACCEL_OUT_NAMEDTUPLES:
-    case ACCEL_OUT_STRUCTSEQUENCES:
-        if (self->options.results_type == ACCEL_OUT_NAMEDTUPLES)
-        {
-            py_args = PyTuple_New(2);
-            if (!py_args) goto error;
+    if (value_l) memcpy(col->data + col->data_length, value, value_l);
+    col->data_length += value_l;
 
-            rc = PyTuple_SetItem(py_args, 0, PyStr.Row);
-            if (rc) goto error;
-            Py_INCREF(PyStr.Row);
+    col->mask[col->length] = (char)is_null;
+    col->n_nulls += is_null;
+    ((int64_t*)col->values)[++col->length] = (int64_t)col->data_length;
 
-            rc = PyTuple_SetItem(py_args, 1, self->py_names_list);
-            if (rc) goto error;
-            Py_INCREF(self->py_names_list);
+    return 0;
+}
 
-            self->py_namedtuple = PyObject_Call(
-                                      PyFunc.collections_namedtuple,
-                                      py_args, PyObj.namedtuple_kwargs);
-            if (!self->py_namedtuple) goto error;
+static int ColumnBuffer_append_object(ColumnBuffer *col, PyObject *py_item) {
+    if (!col->py_values) {
+        col->py_values = PyList_New(0);
+        if (!col->py_values) return -1;
+    }
+    col->length++;
+    return PyList_Append(col->py_values, py_item);
+}
 
-            self->py_namedtuple_args = PyTuple_New(self->n_cols);
-            if (!self->py_namedtuple_args) goto error;
-        }
-        else
-        {
-            self->structsequence_desc.name = "singlestoredb.Row";
-            self->structsequence_desc.doc = "Row of data values";
-            self->structsequence_desc.n_in_sequence = (int)self->n_cols;
-            self->structsequence_desc.fields = calloc(self->n_cols + 1, sizeof(PyStructSequence_Field));
-            if (!self->structsequence_desc.fields) goto error;
-            for (unsigned long i = 0; i < self->n_cols; i++) {
-                self->structsequence_desc.fields[i].name = _PyUnicode_AsUTF8(self->py_names[i]);
-                self->structsequence_desc.fields[i].doc = NULL;
-            }
-            self->structsequence = PyStructSequence_NewType(&self->structsequence_desc);
-            if (!self->structsequence) goto error;
+// Hand the current batch over as an ArrowColumn.
+static PyObject *ColumnBuffer_finish_arrow(ColumnBuffer *col) {
+    ArrowColumnObject *py_out = NULL;
+    unsigned long long n_values = col->length + is_var_width_column(col);
+
+    col->size_hint = col->length;
+    col->data_size_hint = col->data_length;
+
+    py_out = (ArrowColumnObject*)PyType_GenericAlloc(ArrowColumnType, 0);
+    if (!py_out) goto error;
+
+    strncpy(py_out->format, col->format, sizeof(py_out->format) - 1);
+    py_out->length = (int64_t)col->length;
+    py_out->null_count = (int64_t)col->n_nulls;
+    py_out->py_name = col->py_name;
+    Py_XINCREF(py_out->py_name);
+
+    if (!col->py_values) {
+        // Empty batch
+        py_out->py_data = PyByteArray_FromStringAndSize(NULL, 8);
+        if (!py_out->py_data) goto error;
+        memset(PyByteArray_AsString(py_out->py_data), 0, 8);
+        if (is_var_width_column(col)) {
+            py_out->py_offsets = py_out->py_data;
+            Py_INCREF(py_out->py_offsets);
         }
+        goto exit;
+    }
 
-        // Fall through
+    CHECKRC(PyByteArray_Resize(col->py_values, n_values * col->itemsize));
 
-    default:
-        // For fetchone, reuse the same list every time.
-        //if (requested_n_rows == 1) {
-        //    self->py_rows = PyList_New(1);
-        //    PyList_SetItem(self->py_rows, 0, Py_None);
-        //} else {
-            self->py_rows = PyList_New(0);
-        //}
-        if (!self->py_rows) goto error;
+    if (col->n_nulls) {
+        py_out->py_validity = mask_to_validity_bitmap(col->mask, col->length);
+        if (!py_out->py_validity) goto error;
+    }
 
-        PyObject_SetAttr(py_res, PyStr.rows, self->py_rows);
+    if (is_var_width_column(col)) {
+        py_out->py_offsets = col->py_values;
+        col->py_values = NULL;
+        if (!col->py_data) {
+            col->py_data = PyByteArray_FromStringAndSize(NULL, 0);
+            if (!col->py_data) goto error;
+        } else {
+            CHECKRC(PyByteArray_Resize(col->py_data, col->data_length));
+        }
+        py_out->py_data = col->py_data;
+        col->py_data = NULL;
+    } else {
+        py_out->py_data = col->py_values;
+        col->py_values = NULL;
     }
 
 exit:
-    Py_XDECREF(py_args);
-    Py_XDECREF(py_converters);
-    Py_XDECREF(py_options);
-    if (PyErr_Occurred()) {
-        PyErr_Print();
+    if (py_out && col->dictionary) {
+        py_out->py_dictionary = StringTable_to_arrow(col->dictionary);
+        if (!py_out->py_dictionary) Py_CLEAR(py_out);
     }
-    return rc;
+    if (py_out && col->kind == ACCEL_COL_VECTOR) {
+        // The packed rows are the elements of the fixed-size lists.
+        ArrowColumnObject *py_child = (ArrowColumnObject*)PyType_GenericAlloc(ArrowColumnType, 0);
+        if (!py_child) {
+            Py_CLEAR(py_out);
+        } else {
+            strcpy(py_child->format, col->child_format);
+            py_child->length = py_out->length * col->dim;
+            py_child->py_name = PyUnicode_FromString("item");
+            py_child->py_data = py_out->py_data;
+            py_out->py_data = NULL;
+            py_out->py_child = (PyObject*)py_child;
+            if (!py_child->py_name) Py_CLEAR(py_out);
+        }
+    }
+    ColumnBuffer_reset(col);
+    return (PyObject*)py_out;
 
 error:
-    State_clear_fields(self);
-    rc = -1;
+    Py_CLEAR(py_out);
     goto exit;
 }
 
-static int State_reset_batch(
-    StateObject *self,
-    PyObject *py_res,
-    unsigned long long requested_n_rows
-) {
-    int rc = 0;
-    PyObject *py_tmp = NULL;
+// Hand the current batch over as a (values, dtype, mask) tuple.
+static PyObject *ColumnBuffer_finish(ColumnBuffer *col) {
+    PyObject *py_out = NULL;
 
-    self->n_rows_in_batch = 0;
+    if (col->format && col->kind != ACCEL_COL_OBJECT) {
+        return ColumnBuffer_finish_arrow(col);
+    }
 
-    //if (requested_n_rows != 1) {
-        py_tmp = self->py_rows;
-        self->py_rows = PyList_New(0);
-        Py_XDECREF(py_tmp);
-        if (!self->py_rows) { rc = -1; goto error; }
-        rc = PyObject_SetAttr(py_res, PyStr.rows, self->py_rows);
-    //}
+    // Batches of a stream tend to be the same size, so the next one
+    // starts out with room for as many values as this one.
+    col->size_hint = col->length;
 
-exit:
-    return rc;
+    if (col->kind == ACCEL_COL_OBJECT) {
+        if (!col->py_values) {
+            col->py_values = PyList_New(0);
+            if (!col->py_values) goto error;
+        }
+        py_out = Py_BuildValue("(OOO)", col->py_values, Py_None, Py_None);
+        goto exit;
+    }
 
-error:
-    goto exit;
-}
+    if (!col->py_values) {
+        col->py_values = PyByteArray_FromStringAndSize(NULL, 0);
+        if (!col->py_values) goto error;
+    } else {
+        CHECKRC(PyByteArray_Resize(col->py_values, col->length * col->itemsize));
+    }
 
-static PyType_Slot StateType_slots[] = {
-    {Py_tp_init, (initproc)State_init},
-    {Py_tp_dealloc, (destructor)State_dealloc},
-    {Py_tp_doc, "PyMySQL accelerator"},
-    {0, NULL},
-};
+    if (col->n_nulls) {
+        CHECKRC(PyByteArray_Resize(col->py_mask, col->length));
+    }
 
-static PyType_Spec StateType_spec = {
-    .name = "_singlestoredb_accel.State",
-    .basicsize = sizeof(StateObject),
-    .itemsize = 0,
-    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
-    .slots = StateType_slots,
-};
+    if (col->dictionary) {
+        // Categories only grow, so codes of earlier batches stay valid.
+        PyObject *py_categories = (col->dictionary->py_values) ?
+            PyList_GetSlice(col->dictionary->py_values, 0, col->dictionary->n_entries) :
+            PyList_New(0);
+        if (!py_categories) goto error;
+        py_out = Py_BuildValue("(OsON)", col->py_values, col->dtype,
+                               (col->n_nulls) ? col->py_mask : Py_None, py_categories);
+    } else if (col->kind == ACCEL_COL_VECTOR) {
+        // Subarray dtype, so numpy.frombuffer gives an (n_rows, dim) array
+        PyObject *py_dtype = PyUnicode_FromFormat("(%d,)%s", col->dim, col->dtype);
+        if (!py_dtype) goto error;
+        py_out = Py_BuildValue("(ONO)", col->py_values, py_dtype,
+                               (col->n_nulls) ? col->py_mask : Py_None);
+    } else {
+        py_out = Py_BuildValue("(OsO)", col->py_values, col->dtype,
+                               (col->n_nulls) ? col->py_mask : Py_None);
+    }
+
+exit:
+    ColumnBuffer_reset(col);
+    return py_out;
+
+error:
+    Py_CLEAR(py_out);
+    goto exit;
+}
 
 //
-// End State
+// Rows
+//
+// The namedtuples and structsequences results types return Row objects:
+// tuples that can also be read by column name, as attributes or with
+// row['name']. Each column layout gets a Row subtype that holds the column
+// names in _labels, the attribute names in _fields (renamed as by
+// namedtuple(rename=True)) and a dict of both to indexes in _index, so a
+// row is allocated in one block exactly like a tuple and carries no state
+// of its own.
 //
 
-static int read_options(MySQLAccelOptions *options, PyObject *dict) {
-    if (!options || !dict) return 0;
+static PyTypeObject *RowType = NULL;
 
-    PyObject *key = NULL;
-    PyObject *value = NULL;
-    Py_ssize_t pos = 0;
-    int rc = 0;
+// _index of the Row subtype looked up last. All rows of a result share a
+// subtype, so this saves a type attribute lookup on each access by name.
+static PyObject *row_index_type = NULL;
+static PyObject *row_index = NULL;
 
-    while (PyDict_Next(dict, &pos, &key, &value)) {
-        if (PyUnicode_CompareWithASCIIString(key, "results_type") == 0) {
-            if (PyUnicode_CompareWithASCIIString(value, "dict") == 0 ||
-                PyUnicode_CompareWithASCIIString(value, "dicts") == 0 ) {
-                options->results_type = ACCEL_OUT_DICTS;
-            }
-            else if (PyUnicode_CompareWithASCIIString(value, "namedtuple") == 0 ||
-                     PyUnicode_CompareWithASCIIString(value, "namedtuples") == 0) {
-                options->results_type = ACCEL_OUT_NAMEDTUPLES;
-            }
-            else if (PyUnicode_CompareWithASCIIString(value, "structsequence") == 0 ||
-                     PyUnicode_CompareWithASCIIString(value, "structsequences") == 0) {
-                options->results_type = ACCEL_OUT_STRUCTSEQUENCES;
-            }
-            else if (PyUnicode_CompareWithASCIIString(value, "numpy") == 0) {
-                options->results_type = ACCEL_OUT_NUMPY;
-                rc = ensure_numpy();
-            }
-            else if (PyUnicode_CompareWithASCIIString(value, "pandas") == 0) {
-                options->results_type = ACCEL_OUT_PANDAS;
-                rc = ensure_pandas();
-            }
-            else if (PyUnicode_CompareWithASCIIString(value, "polars") == 0) {
-                options->results_type = ACCEL_OUT_POLARS;
-                rc = ensure_polars();
-            }
-            else if (PyUnicode_CompareWithASCIIString(value, "arrow") == 0 ||
-                     PyUnicode_CompareWithASCIIString(value, "pyarrow") == 0) {
-                options->results_type = ACCEL_OUT_ARROW;
-                rc = ensure_pyarrow();
-            }
-            else {
-                options->results_type = ACCEL_OUT_TUPLES;
-            }
-        } else if (PyUnicode_CompareWithASCIIString(key, "parse_json") == 0) {
-            options->parse_json = PyObject_IsTrue(value);
-        } else if (PyUnicode_CompareWithASCIIString(key, "invalid_values") == 0) {
-            if (PyDict_Check(value)) {
-                options->invalid_values = value;
-            }
+//
+// Return the index of a column name, or -1 if there is no such column.
+//
+static Py_ssize_t Row_find(PyObject *self, PyObject *py_name) {
+    Py_ssize_t i = -1;
+    PyObject *py_type = (PyObject*)Py_TYPE(self);
+
+    if (py_type != row_index_type) {
+        PyObject *py_old_type = row_index_type;
+        PyObject *py_old_index = row_index;
+        PyObject *py_index = PyObject_GetAttr(py_type, PyStr._index);
+        if (!py_index || !PyDict_Check(py_index)) {
+            Py_XDECREF(py_index);
+            PyErr_Clear();
+            return -1;
         }
+        Py_INCREF(py_type);
+        row_index_type = py_type;
+        row_index = py_index;
+        Py_XDECREF(py_old_type);
+        Py_XDECREF(py_old_index);
     }
 
-    return rc;
+    PyObject *py_i = PyDict_GetItem(row_index, py_name);
+    if (py_i) i = PyLong_AsSsize_t(py_i);
+    return (i < PyTuple_Size(self)) ? i : -1;
 }
 
-static void raise_exception(
-    PyObject *self,
-    char *err_type,
-    unsigned long long err_code,
-    char *err_str
-) {
-    PyObject *py_exc = NULL;
-    PyObject *py_val = NULL;
+//
+// Create a row of the given Row subtype from an iterable of values.
+//
+static PyObject *Row_new(PyObject *py_type, PyObject *py_iterable) {
+    PyObject *py_values = NULL;
+    PyObject *py_fields = NULL;
+    PyObject *py_out = NULL;
+    Py_ssize_t n = 0;
 
-    py_exc = PyObject_GetAttrString(self, err_type);
-    if (!py_exc) goto error;
+    py_values = PySequence_Tuple(py_iterable);
+    if (!py_values) goto error;
+    py_fields = PyObject_GetAttr(py_type, PyStr._fields);
+    if (!py_fields) goto error;
 
-    py_val = Py_BuildValue("(Ks)", err_code, err_str);
-    if (!py_val) goto error;
+    n = PyTuple_Size(py_values);
+    if (n != PyTuple_Size(py_fields)) {
+        PyErr_Format(PyExc_TypeError, "Expected %zd arguments, got %zd",
+                     PyTuple_Size(py_fields), n);
+        goto error;
+    }
 
-    PyErr_SetObject(py_exc, py_val);
+    py_out = PyType_GenericAlloc((PyTypeObject*)py_type, n);
+    if (!py_out) goto error;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *py_item = PyTuple_GetItem(py_values, i);
+        Py_INCREF(py_item);
+        CHECKRC(PyTuple_SetItem(py_out, i, py_item));
+    }
 
 exit:
-    if (py_exc) { Py_DECREF(py_exc); }
-    if (py_val) { Py_DECREF(py_val); }
-    return;
+    Py_XDECREF(py_values);
+    Py_XDECREF(py_fields);
+    return py_out;
 
 error:
+    Py_CLEAR(py_out);
     goto exit;
 }
 
-static int is_error_packet(char *buff_bytes) {
-    return buff_bytes && *(uint8_t*)buff_bytes == 0xFF;
+static PyObject *Row_get_item(PyObject *self, Py_ssize_t i) {
+    PyObject *py_item = PyTuple_GetItem(self, i);
+    Py_XINCREF(py_item);
+    return py_item;
 }
 
-static void force_close(PyObject *py_conn) {
-    PyObject *py_sock = NULL;
+static PyObject *Row_getattro(PyObject *self, PyObject *py_name) {
+    Py_ssize_t i = Row_find(self, py_name);
+    if (i >= 0) return Row_get_item(self, i);
+    return PyObject_GenericGetAttr(self, py_name);
+}
 
-    py_sock = PyObject_GetAttr(py_conn, PyStr._sock);
-    if (!py_sock) goto error;
+static PyObject *Row_subscript(PyObject *self, PyObject *py_key) {
+    Py_ssize_t n = PyTuple_Size(self);
 
-    Py_XDECREF(PyObject_CallMethod(py_sock, "close", NULL));
-    PyErr_Clear();
+    if (PyUnicode_Check(py_key)) {
+        Py_ssize_t i = Row_find(self, py_key);
+        if (i < 0) {
+            PyErr_SetObject(PyExc_KeyError, py_key);
+            return NULL;
+        }
+        return Row_get_item(self, i);
+    }
 
-    PyObject_SetAttr(py_conn, PyStr._sock, Py_None);
-    PyObject_SetAttr(py_conn, PyStr._rfile, Py_None);
+    if (PySlice_Check(py_key)) {
+        Py_ssize_t start = 0, stop = 0, step = 0, slice_l = 0;
+        PyObject *py_out = NULL;
+        if (PySlice_Unpack(py_key, &start, &stop, &step) < 0) return NULL;
+        slice_l = PySlice_AdjustIndices(n, &start, &stop, step);
+        if (step == 1) return PyTuple_GetSlice(self, start, stop);
+        py_out = PyTuple_New(slice_l);
+        if (!py_out) return NULL;
+        for (Py_ssize_t j = 0; j < slice_l; j++, start += step) {
+            PyTuple_SetItem(py_out, j, Row_get_item(self, start));
+        }
+        return py_out;
+    }
+
+    Py_ssize_t i = PyNumber_AsSsize_t(py_key, PyExc_IndexError);
+    if (i == -1 && PyErr_Occurred()) return NULL;
+    if (i < 0) i += n;
+    return Row_get_item(self, i);
+}
+
+//
+// Return a list of the column names (0), values (1), or (name, value)
+// pairs (2), or a dict of the values by field name (3).
+//
+static PyObject *Row_fields(PyObject *self, int what) {
+    PyObject *py_fields = PyObject_GetAttr((PyObject*)Py_TYPE(self),
+                                           (what == 3) ? PyStr._fields : PyStr._labels);
+    PyObject *py_out = NULL;
+    Py_ssize_t n = 0;
+
+    if (!py_fields) return NULL;
+    n = MIN(PyTuple_Size(py_fields), PyTuple_Size(self));
+    py_out = (what == 3) ? PyDict_New() : PyList_New(n);
+    if (!py_out) goto exit;
+
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyObject *py_name = PyTuple_GetItem(py_fields, i);
+        PyObject *py_value = PyTuple_GetItem(self, i);
+        switch (what) {
+        case 0:
+            Py_INCREF(py_name);
+            PyList_SetItem(py_out, i, py_name);
+            break;
+        case 1:
+            Py_INCREF(py_value);
+            PyList_SetItem(py_out, i, py_value);
+            break;
+        case 2:
+            PyList_SetItem(py_out, i, PyTuple_Pack(2, py_name, py_value));
+            if (!PyList_GetItem(py_out, i)) { Py_CLEAR(py_out); goto exit; }
+            break;
+        default:
+            if (PyDict_SetItem(py_out, py_name, py_value)) { Py_CLEAR(py_out); goto exit; }
+        }
+    }
 
 exit:
-    Py_XDECREF(py_sock);
-    return;
+    Py_DECREF(py_fields);
+    return py_out;
+}
 
-error:
-    goto exit;
+static PyObject *Row_keys(PyObject *self, PyObject *args) {
+    return Row_fields(self, 0);
 }
 
-static PyObject *read_bytes(StateObject *py_state, unsigned long long num_bytes) {
-    PyObject *py_num_bytes = NULL;
-    PyObject *py_data = NULL;
-    PyObject *py_exc = NULL;
+static PyObject *Row_values(PyObject *self, PyObject *args) {
+    return Row_fields(self, 1);
+}
 
-    if (py_state->py_read_timeout && py_state->py_read_timeout != Py_None) {
-        Py_XDECREF(PyObject_CallFunctionObjArgs(py_state->py_settimeout,
-                                                py_state->py_read_timeout, NULL));
-        if (PyErr_Occurred()) goto error;
-    }
+static PyObject *Row_items(PyObject *self, PyObject *args) {
+    return Row_fields(self, 2);
+}
 
-    py_num_bytes = PyLong_FromUnsignedLongLong(num_bytes);
-    if (!py_num_bytes) goto error;
+static PyObject *Row_asdict(PyObject *self, PyObject *args) {
+    return Row_fields(self, 3);
+}
 
-    while (1) {
-        py_data = PyObject_CallFunctionObjArgs(py_state->py_read, py_num_bytes, NULL);
+static PyObject *Row_get(PyObject *self, PyObject *args) {
+    PyObject *py_key = NULL;
+    PyObject *py_default = Py_None;
+    Py_ssize_t i = -1;
 
-        if ((py_exc = PyErr_Occurred())) {
-            if (PyErr_ExceptionMatches(PyExc_IOError) || PyErr_ExceptionMatches(PyExc_OSError)) {
-                PyObject *py_errno = PyObject_GetAttr(py_exc, PyStr.x_errno);
-                if (!py_errno) goto error;
+    if (!PyArg_ParseTuple(args, "O|O", &py_key, &py_default)) return NULL;
+    if (PyUnicode_Check(py_key)) i = Row_find(self, py_key);
+    if (i >= 0) return Row_get_item(self, i);
+    Py_INCREF(py_default);
+    return py_default;
+}
 
-                unsigned long long err = PyLong_AsUnsignedLongLong(py_errno);
-                Py_DECREF(py_errno);
+static PyObject *Row_make(PyObject *cls, PyObject *py_iterable) {
+    return Row_new(cls, py_iterable);
+}
 
-                if (err == 4 /* errno.EINTER */) {
-                    continue;
-                }
+static PyObject *Row_replace(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *py_values = NULL;
+    PyObject *py_key = NULL;
+    PyObject *py_value = NULL;
+    PyObject *py_out = NULL;
+    Py_ssize_t pos = 0;
 
-                force_close(py_state->py_conn);
-                raise_exception(py_state->py_conn, "OperationalError", 0,
-                                "Lost connection to SingleStoreDB server during query");
-                goto error;
-            }
-            else if (PyErr_ExceptionMatches(PyExc_BaseException)) {
-                // Don't convert unknown exception to MySQLError.
-                force_close(py_state->py_conn);
-                goto error;
-            }
-        }
+    if (PyTuple_Size(args)) {
+        PyErr_SetString(PyExc_TypeError, "_replace() takes only keyword arguments");
+        return NULL;
+    }
 
-        if (py_data) {
-            break;
+    py_values = PySequence_List(self);
+    if (!py_values) goto error;
+
+    while (kwargs && PyDict_Next(kwargs, &pos, &py_key, &py_value)) {
+        Py_ssize_t i = Row_find(self, py_key);
+        if (i < 0) {
+            PyErr_Format(PyExc_ValueError, "Got unexpected field name: %R", py_key);
+            goto error;
         }
+        Py_INCREF(py_value);
+        CHECKRC(PyList_SetItem(py_values, i, py_value));
     }
 
-    if (PyBytes_Size(py_data) < (long int)num_bytes) {
-        force_close(py_state->py_conn);
-        raise_exception(py_state->py_conn, "OperationalError", 0,
-                        "Lost connection to SingleStoreDB server during query");
-        goto error;
-    }
+    py_out = Row_new((PyObject*)Py_TYPE(self), py_values);
 
 exit:
-    Py_XDECREF(py_num_bytes);
-    return py_data;
+    Py_XDECREF(py_values);
+    return py_out;
 
 error:
-    Py_CLEAR(py_data);
+    Py_CLEAR(py_out);
     goto exit;
 }
 
-static PyObject *read_packet(StateObject *py_state) {
-    PyObject *py_buff = NULL;
-    PyObject *py_new_buff = NULL;
-    PyObject *py_packet_header = NULL;
-    PyObject *py_bytes_to_read = NULL;
-    PyObject *py_recv_data = NULL;
-    unsigned long long bytes_to_read = 0;
-    char *buff = NULL;
-    uint64_t btrl = 0;
-    uint8_t btrh = 0;
-    uint8_t packet_number = 0;
+//
+// Layout subtypes are not importable, so rows are pickled with their
+// column names and rebuilt by _make_row.
+//
+static PyObject *Row_reduce(PyObject *self, PyObject *args) {
+    PyObject *py_labels = PyObject_GetAttr((PyObject*)Py_TYPE(self), PyStr._labels);
+    PyObject *py_tuple = NULL;
+    PyObject *py_out = NULL;
+    if (!py_labels) return NULL;
+    py_tuple = PyTuple_GetSlice(self, 0, PyTuple_Size(self));
+    if (py_tuple) py_out = Py_BuildValue("(O(OO))", PyFunc.make_row, py_labels, py_tuple);
+    Py_XDECREF(py_tuple);
+    Py_DECREF(py_labels);
+    return py_out;
+}
 
-    py_buff = PyByteArray_FromStringAndSize(NULL, 0);
-    if (!py_buff) goto error;
+static PyObject *Row_repr(PyObject *self) {
+    PyObject *py_items = Row_fields(self, 2);
+    PyObject *py_sep = NULL;
+    PyObject *py_body = NULL;
+    PyObject *py_out = NULL;
 
-    while (1) {
-        py_packet_header = read_bytes(py_state, 4);
-        if (!py_packet_header) goto error;
+    if (!py_items) goto exit;
+    for (Py_ssize_t i = 0; i < PyList_Size(py_items); i++) {
+        PyObject *py_item = PyList_GetItem(py_items, i);
+        PyObject *py_str = PyUnicode_FromFormat("%U=%R", PyTuple_GetItem(py_item, 0),
+                                                PyTuple_GetItem(py_item, 1));
+        if (!py_str) goto exit;
+        PyList_SetItem(py_items, i, py_str);
+    }
 
-        buff = PyBytes_AsString(py_packet_header);
+    py_sep = PyUnicode_FromString(", ");
+    if (!py_sep) goto exit;
+    py_body = PyUnicode_Join(py_sep, py_items);
+    if (!py_body) goto exit;
+    py_out = PyUnicode_FromFormat("Row(%U)", py_body);
 
-        btrl = *(uint16_t*)buff;
-        btrh = *(uint8_t*)(buff+2);
-        packet_number = *(uint8_t*)(buff+3);
-        bytes_to_read = btrl + (btrh << 16);
+exit:
+    Py_XDECREF(py_body);
+    Py_XDECREF(py_sep);
+    Py_XDECREF(py_items);
+    return py_out;
+}
 
-        Py_CLEAR(py_packet_header);
+static PyMethodDef RowType_methods[] = {
+    {"get", (PyCFunction)Row_get, METH_VARARGS,
+     "Return the value of a column, or the default if there is no such column"},
+    {"keys", (PyCFunction)Row_keys, METH_NOARGS, "List of column names"},
+    {"values", (PyCFunction)Row_values, METH_NOARGS, "List of column values"},
+    {"items", (PyCFunction)Row_items, METH_NOARGS, "List of (name, value) pairs"},
+    {"_asdict", (PyCFunction)Row_asdict, METH_NOARGS, "Dict of the values by field name"},
+    {"_make", (PyCFunction)Row_make, METH_O | METH_CLASS, "Make a row from an iterable"},
+    {"_replace", (PyCFunction)Row_replace, METH_VARARGS | METH_KEYWORDS,
+     "Return a new row with the given columns replaced"},
+    {"__reduce__", (PyCFunction)Row_reduce, METH_NOARGS, "Pickle the row with its column names"},
+    {NULL, NULL, 0, NULL}
+};
 
-        if (packet_number != py_state->next_seq_id) {
-            force_close(py_state->py_conn);
-            if (packet_number == 0) {
-                raise_exception(py_state->py_conn, "OperationalError", 0,
-                                "Lost connection to SingleStoreDB server during query");
+static PyType_Slot RowType_slots[] = {
+    {Py_tp_getattro, (getattrofunc)Row_getattro},
+    {Py_tp_repr, (reprfunc)Row_repr},
+    {Py_tp_methods, RowType_methods},
+    {Py_mp_subscript, (binaryfunc)Row_subscript},
+    {Py_tp_doc, "Tuple of row values that can also be read by column name"},
+    {0, NULL},
+};
 
-                goto error;
-            }
-            raise_exception(py_state->py_conn, "InternalError", 0,
-                            "Packet sequence number wrong");
-            goto error;
-        }
+static PyType_Spec RowType_spec = {
+    .name = ACCEL_STR(ACCEL_MODULE_NAME) ".Row",
+    .basicsize = 0,
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .slots = RowType_slots,
+};
 
-        py_state->next_seq_id = (py_state->next_seq_id + 1) % 256;
+static PyType_Slot RowLayoutType_slots[] = {
+    {0, NULL},
+};
 
-        py_recv_data = read_bytes(py_state, bytes_to_read);
-        if (!py_recv_data) goto error;
+static PyType_Spec RowLayoutType_spec = {
+    .name = ACCEL_STR(ACCEL_MODULE_NAME) ".Row",
+    .basicsize = 0,
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = RowLayoutType_slots,
+};
 
-        py_new_buff = PyByteArray_Concat(py_buff, py_recv_data);
-        Py_CLEAR(py_recv_data);
-        Py_CLEAR(py_buff);
-        if (!py_new_buff) goto error;
+//
+// Return 1 if a column name can be used as a field name, as decided by
+// namedtuple(rename=True), or -1 on error.
+//
+static int is_field_name(PyObject *py_name, PyObject *py_seen) {
+    PyObject *py_res = NULL;
+    int rc = 0;
 
-        py_buff = py_new_buff;
-        py_new_buff = NULL;
+    if (!PyUnicode_Check(py_name) || PyUnicode_GetLength(py_name) == 0) return 0;
+    if (PyUnicode_ReadChar(py_name, 0) == '_') return 0;
 
-        if (bytes_to_read == 0xFFFFFF) {
-            continue;
-        }
+    rc = PySet_Contains(py_seen, py_name);
+    if (rc) return (rc < 0) ? -1 : 0;
 
-        if (bytes_to_read < MYSQL_MAX_PACKET_LEN) {
-            break;
-        }
+    py_res = PyObject_CallMethodObjArgs(py_name, PyStr.isidentifier, NULL);
+    if (!py_res) return -1;
+    rc = PyObject_IsTrue(py_res);
+    Py_DECREF(py_res);
+    if (rc <= 0) return rc;
+
+    py_res = call_one(PyFunc.keyword_iskeyword, py_name);
+    if (!py_res) return -1;
+    rc = PyObject_IsTrue(py_res);
+    Py_DECREF(py_res);
+    return (rc < 0) ? -1 : !rc;
+}
+
+//
+// Add name -> index entries to a Row index, keeping existing entries.
+//
+static int add_row_index(PyObject *py_index, PyObject *py_names) {
+    for (Py_ssize_t i = 0; i < PyTuple_Size(py_names); i++) {
+        PyObject *py_name = PyTuple_GetItem(py_names, i);
+        if (PyDict_GetItem(py_index, py_name)) continue;
+        PyObject *py_i = PyLong_FromSsize_t(i);
+        if (!py_i) return -1;
+        int rc = PyDict_SetItem(py_index, py_name, py_i);
+        Py_DECREF(py_i);
+        if (rc) return -1;
     }
+    return 0;
+}
 
-    if (is_error_packet(PyByteArray_AsString(py_buff))) {
-        PyObject *py_result = PyObject_GetAttr(py_state->py_conn, PyStr._result);
-        if (py_result && py_result != Py_None) {
-            PyObject *py_unbuffered_active = PyObject_GetAttr(py_result, PyStr.unbuffered_active);
-            if (py_unbuffered_active == Py_True) {
-                PyObject_SetAttr(py_result, PyStr.unbuffered_active, Py_False);
-            }
-            Py_XDECREF(py_unbuffered_active);
+//
+// Create the Row subtype of a column layout.
+//
+static PyObject *create_row_type(PyObject *py_names_list) {
+    PyObject *py_labels = NULL;
+    PyObject *py_fields = NULL;
+    PyObject *py_seen = NULL;
+    PyObject *py_index = NULL;
+    PyObject *py_bases = NULL;
+    PyObject *py_type = NULL;
+
+    py_labels = PyList_AsTuple(py_names_list);
+    if (!py_labels) goto error;
+
+    py_fields = PyTuple_New(PyTuple_Size(py_labels));
+    if (!py_fields) goto error;
+
+    py_seen = PySet_New(NULL);
+    if (!py_seen) goto error;
+
+    for (Py_ssize_t i = 0; i < PyTuple_Size(py_labels); i++) {
+        PyObject *py_label = PyTuple_GetItem(py_labels, i);
+        PyObject *py_field = NULL;
+        int rc = is_field_name(py_label, py_seen);
+        if (rc < 0) goto error;
+        if (rc) {
+            py_field = py_label;
+            Py_INCREF(py_field);
+        } else {
+            py_field = PyUnicode_FromFormat("_%zd", i);
+            if (!py_field) goto error;
         }
-        Py_XDECREF(py_result);
-        Py_XDECREF(PyObject_CallMethod(py_state->py_conn, "_raise_mysql_exception",
-                                       "O", py_buff, NULL));
-        goto error;
+        CHECKRC(PyTuple_SetItem(py_fields, i, py_field));
+        CHECKRC(PySet_Add(py_seen, py_label));
     }
 
+    // Field names take precedence over column names that look like them
+    py_index = PyDict_New();
+    if (!py_index) goto error;
+    CHECKRC(add_row_index(py_index, py_fields));
+    CHECKRC(add_row_index(py_index, py_labels));
+
+    py_bases = PyTuple_Pack(1, (PyObject*)RowType);
+    if (!py_bases) goto error;
+
+    py_type = PyType_FromSpecWithBases(&RowLayoutType_spec, py_bases);
+    if (!py_type) goto error;
+
+    CHECKRC(PyObject_SetAttr(py_type, PyStr._labels, py_labels));
+    CHECKRC(PyObject_SetAttr(py_type, PyStr._fields, py_fields));
+    CHECKRC(PyObject_SetAttr(py_type, PyStr._index, py_index));
+
 exit:
-    Py_XDECREF(py_new_buff);
-    Py_XDECREF(py_bytes_to_read);
-    Py_XDECREF(py_recv_data);
-    Py_XDECREF(py_packet_header);
-    return py_buff;
+    Py_XDECREF(py_bases);
+    Py_XDECREF(py_index);
+    Py_XDECREF(py_seen);
+    Py_XDECREF(py_fields);
+    Py_XDECREF(py_labels);
+    return py_type;
 
 error:
-    Py_CLEAR(py_buff);
+    Py_CLEAR(py_type);
     goto exit;
 }
 
-static int is_eof_packet(char *data, unsigned long long data_l) {
-    return data && (uint8_t)*(uint8_t*)data == 0xFE && data_l < 9;
+//
+// Rebuild a pickled row. Rows with the same column names share a subtype.
+//
+static PyObject *make_row(PyObject *self, PyObject *args) {
+    PyObject *py_labels = NULL;
+    PyObject *py_values = NULL;
+    PyObject *py_names_list = NULL;
+    PyObject *py_type = NULL;
+    PyObject *py_out = NULL;
+
+    if (!PyArg_ParseTuple(args, "O!O", &PyTuple_Type, &py_labels, &py_values)) return NULL;
+
+    py_type = PyDict_GetItem(PyObj.row_types, py_labels);
+    if (py_type) return Row_new(py_type, py_values);
+
+    py_names_list = PySequence_List(py_labels);
+    if (!py_names_list) goto exit;
+    py_type = create_row_type(py_names_list);
+    if (!py_type) goto exit;
+    if (PyDict_SetItem(PyObj.row_types, py_labels, py_type)) goto exit;
+    py_out = Row_new(py_type, py_values);
+
+exit:
+    Py_XDECREF(py_names_list);
+    Py_XDECREF(py_type);
+    return py_out;
 }
 
-static int check_packet_is_eof(
-    char **data,
-    unsigned long long *data_l,
-    unsigned long long *warning_count,
-    int *has_next
-) {
-    uint16_t server_status = 0;
-    if (!data || !data_l) {
-        if (has_next) *has_next = 0;
-        if (warning_count) *warning_count = 0;
+//
+// State
+//
+
+static PyTypeObject *StateType = NULL;
+
+#define ACCEL_DATE_MEMO_SIZE 256
+
+typedef struct {
+    int32_t key; // Packed year / month / day
+    PyObject *py_value; // Date object
+} DateMemo;
+
+typedef struct {
+    char text[32]; // Text of the last cell
+    unsigned char text_l; // Length of the text
+    PyObject *py_value; // Object created from the text
+} TemporalMemo;
+
+//
+// Column layout of a result. Layouts are cached by the connection (see
+// ResultShape in singlestoredb/mysql/connection.py) and shared by all
+// later results with the same column definitions.
+//
+#define ACCEL_SHAPE_CAPSULE "singlestoredb.ResultShape"
+
+typedef struct {
+    unsigned long long n_cols; // Number of columns
+    unsigned long *type_codes; // Type code for each column
+    unsigned long *flags; // Column flags
+    unsigned long *scales; // Column scales
+    const char **encodings; // Encoding for each column (owned by the layout)
+    PyObject **py_encodings; // Encoding for each column as Python string
+    PyObject **py_converters; // Converter of each column (NULL for the default)
+    PyObject **py_invalid_values; // Values to use when invalid data exists in a cell
+    PyObject **py_names; // Column names
+    PyObject *py_row_type; // Row subtype of the layout
+} ResultShape;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *py_conn; // Database connection
+    PyObject *py_fields; // List of table fields
+    PyObject *py_rows; // Output object
+    PyObject *py_rfile; // Socket file I/O
+    PyObject *py_read; // File I/O read method
+    PyObject *py_readinto1; // File I/O readinto1 method (NULL if unavailable)
+    PyObject *py_sock; // Socket
+    PyObject *py_read_timeout; // Socket read timeout value
+    PyObject *py_settimeout; // Socket settimeout method
+    PyObject **py_converters; // List of converter functions
+    PyObject **py_names; // Column names
+    PyObject *py_names_list; // Python list of column names
+    PyObject *py_default_converters; // Dict of default converters
+    PyObject *py_shape; // Capsule of the cached ResultShape (NULL if not cached)
+    PyObject *py_row_type; // Row subtype of the layout (namedtuple results)
+    PyObject **py_encodings; // Encoding for each column as Python string
+    PyObject **py_invalid_values; // Values to use when invalid data exists in a cell
+    const char **encodings; // Encoding for each column
+    int *codecs; // Text codec of each column (ACCEL_CODEC_*)
+    unsigned long long n_cols; // Total number of columns
+    unsigned long long n_rows; // Total number of rows read
+    unsigned long long n_rows_in_batch; // Number of rows in current batch (fetchmany size)
+    unsigned long *type_codes; // Type code for each column
+    unsigned long *flags; // Column flags
+    unsigned long *scales; // Column scales
+    unsigned long *offsets; // Column offsets in buffer
+    unsigned long long next_seq_id; // MySQL packet sequence number
+    MySQLAccelOptions options; // Packet reader options
+    int unbuffered; // Are we running in unbuffered mode?
+    int is_eof; // Have we hit the eof packet yet?
+    char *recv_buff; // Socket receive buffer
+    unsigned long long recv_buff_size; // Allocated size of receive buffer
+    unsigned long long recv_buff_pos; // Offset of next unread byte in receive buffer
+    unsigned long long recv_buff_end; // Offset of end of received data
+    PyObject *py_large_packet; // Reusable bytearray for rows spanning multiple packets
+    struct Prefetch *prefetch; // Read-ahead thread (NULL unless running)
+    ColumnBuffer *columns; // Per-column output buffers (NULL unless results are columnar)
+    TemporalMemo *temporal_memo; // Last DATETIME / TIME object of each column
+    StringTable **string_tables; // Interned values (JSON object keys) of each text column
+    DateMemo date_memo[ACCEL_DATE_MEMO_SIZE]; // Recently created date objects
+    PyObject *py_layout; // Detached decoding state shared by lazy rows
+    PyObject *py_name_index; // Dict of column names to indexes (lazy rows)
+    PyObject *py_row_block; // Bytearray that lazy row packets are copied into
+    unsigned long long row_block_pos; // Bytes of py_row_block in use
+    int owns_encodings; // Free the encoding names on clear?
+    struct {
+        PyObject *_next_seq_id;
+        PyObject *rows;
+    } py_str;
+    char *encoding_errors;
+} StateObject;
+
+static int read_options(MySQLAccelOptions *options, PyObject *dict);
+
+int ensure_numpy() {
+    if (PyFunc.numpy_array && PyFunc.numpy_empty) goto exit;
+
+    // Import numpy if it exists
+    PyObject *numpy_mod = PyImport_ImportModule("numpy");
+    if (!numpy_mod) goto error;
+
+    PyFunc.numpy_array = PyObject_GetAttr(numpy_mod, PyStr.array);
+    if (!PyFunc.numpy_array) goto error;
+
+    PyFunc.numpy_frombuffer = PyObject_GetAttr(numpy_mod, PyStr.frombuffer);
+    if (!PyFunc.numpy_frombuffer) goto error;
+
+    PyFunc.numpy_empty = PyObject_GetAttr(numpy_mod, PyStr.empty);
+    if (!PyFunc.numpy_empty) goto error;
+
+exit:
+    return 0;
+
+error:
+    PyErr_Clear();
+    return -1;
+}
+
+
+int ensure_pandas() {
+    if (PyFunc.pandas_DataFrame) goto exit;
+
+    // Import pandas if it exists
+    PyObject *pandas_mod = PyImport_ImportModule("pandas");
+    if (!pandas_mod) goto error;
+
+    PyFunc.pandas_DataFrame = PyObject_GetAttr(pandas_mod, PyStr.DataFrame);
+    if (!PyFunc.pandas_DataFrame) goto error;
+
+exit:
+    return 0;
+
+error:
+    PyErr_Clear();
+    return -1;
+}
+
+
+int ensure_polars() {
+    if (PyFunc.polars_DataFrame) goto exit;
+
+    // Import polars if it exists
+    PyObject *polars_mod = PyImport_ImportModule("polars");
+    if (!polars_mod) goto error;
+
+    PyFunc.polars_DataFrame = PyObject_GetAttr(polars_mod, PyStr.DataFrame);
+    if (!PyFunc.polars_DataFrame) goto error;
+
+exit:
+    return 0;
+
+error:
+    PyErr_Clear();
+    return -1;
+}
+
+
+int ensure_pyarrow() {
+    if (PyFunc.pyarrow_Table_from_pylist) goto exit;
+
+    // Import pyarrow if it exists
+    PyObject *pyarrow_mod = PyImport_ImportModule("pyarrow");
+    if (!pyarrow_mod) goto error;
+
+    PyFunc.pyarrow_Table = PyObject_GetAttr(pyarrow_mod, PyStr.Table);
+    if (!PyFunc.pyarrow_Table) goto error;
+
+    PyFunc.pyarrow_Table_from_pylist = PyObject_GetAttr(PyFunc.pyarrow_Table, PyStr.from_pylist);
+    if (!PyFunc.pyarrow_Table_from_pylist) goto error;
+
+exit:
+    return 0;
+
+error:
+    PyErr_Clear();
+    return -1;
+}
+
+
+int ensure_arrow_c_data() {
+    static int has_arrow_c_data = -1;
+
+    if (has_arrow_c_data >= 0) goto exit;
+    has_arrow_c_data = 0;
+
+    // Arrays are imported from PyCapsules, which requires pyarrow 14+
+    PyObject *pyarrow_mod = PyImport_ImportModule("pyarrow");
+    if (!pyarrow_mod) goto error;
+
+    PyObject *array_type = PyObject_GetAttrString(pyarrow_mod, "Array");
+    Py_DECREF(pyarrow_mod);
+    if (!array_type) goto error;
+
+    has_arrow_c_data = PyObject_HasAttrString(array_type, "_import_from_c_capsule");
+    Py_DECREF(array_type);
+
+exit:
+    return (has_arrow_c_data) ? 0 : -1;
+
+error:
+    PyErr_Clear();
+    return -1;
+}
+
+
+int ensure_bson() {
+    if (PyFunc.bson_decode) goto exit;
+
+    // Import bson if it exists
+    PyObject *bson_mod = PyImport_ImportModule("bson");
+    if (!bson_mod) goto error;
+
+    PyFunc.bson_decode = PyObject_GetAttr(bson_mod, PyStr.decode);
+    if (!PyFunc.bson_decode) goto error;
+
+exit:
+    return 0;
+
+error:
+    PyErr_Clear();
+    return -1;
+}
+
+
+int ensure_columnar() {
+    if (PyFunc.columnar_rows) goto exit;
+
+    // Columnar results are wrapped by a class in the Python package
+    PyObject *results_mod = PyImport_ImportModule("singlestoredb.utils.results");
+    if (!results_mod) goto error;
+
+    PyFunc.columnar_rows = PyObject_GetAttr(results_mod, PyStr.ColumnarRows);
+    Py_DECREF(results_mod);
+    if (!PyFunc.columnar_rows) goto error;
+
+exit:
+    return 0;
+
+error:
+    PyErr_Clear();
+    return -1;
+}
+
+
+//
+// Read-ahead
+//
+// With the prefetch_bytes option, an unbuffered result starts a thread
+// that keeps receiving from the socket into a ring of up to that many
+// bytes while rows are decoded from earlier packets. The thread only
+// holds the GIL to call the socket's recv_into, which releases it while
+// blocked, so TLS sockets and read timeouts work as usual. It watches the
+// packet headers and stops after the packet that ends the result, so it
+// never waits on a server that has nothing more to send.
+//
+// The ring counters are only touched with the GIL held. A side that has
+// to wait sets its *_waiting flag and blocks on its lock with the GIL
+// released; the other side releases that lock once it has made progress.
+//
+
+typedef struct {
+    unsigned char header[4]; // Partial packet header
+    int header_l; // Bytes of the header seen so far
+    unsigned long long length; // Payload length of the current packet
+    unsigned long long remaining; // Payload bytes of the current packet not yet seen
+    int check; // Does the next payload byte start a logical packet?
+    int continued; // Does the next packet continue the current one?
+    int ending; // Is the current logical packet the EOF or error packet?
+} PacketScanner;
+
+typedef struct Prefetch {
+    char *ring; // Received bytes not yet taken by the reader
+    unsigned long long size; // Capacity of the ring
+    unsigned long long head; // Total bytes received
+    unsigned long long tail; // Total bytes taken
+    PacketScanner scanner; // Finds the packet that ends the result
+    PyObject *py_recv_into; // Socket recv_into method
+    PyObject *py_err_type; // Exception raised by the socket
+    PyObject *py_err_value;
+    PyObject *py_err_tb;
+    PyThread_type_lock data_lock; // Released when bytes arrive
+    PyThread_type_lock space_lock; // Released when bytes are taken
+    PyThread_type_lock exit_lock; // Released when the thread exits
+    int reader_waiting; // Is the reader blocked on data_lock?
+    int thread_waiting; // Is the thread blocked on space_lock?
+    int done; // Has the thread stopped receiving?
+    int stop; // Has the reader asked the thread to stop?
+} Prefetch;
+
+//
+// Feed received bytes to the scanner. Returns 1 once all of the EOF or
+// error packet that ends the result has been seen.
+//
+static int PacketScanner_feed(PacketScanner *s, const char *data, unsigned long long n) {
+    while (n > 0) {
+        if (s->remaining == 0) {
+            unsigned long long take = MIN(4 - (unsigned long long)s->header_l, n);
+            memcpy(s->header + s->header_l, data, take);
+            s->header_l += take;
+            data += take;
+            n -= take;
+            if (s->header_l < 4) break;
+
+            s->header_l = 0;
+            s->length = s->header[0] + (s->header[1] << 8) + (s->header[2] << 16);
+            s->remaining = s->length;
+            s->check = !s->continued;
+            s->continued = s->length == MYSQL_MAX_PACKET_LEN;
+            continue;
+        }
+
+        if (s->check) {
+            uint8_t first = *(uint8_t*)data;
+            s->check = 0;
+            s->ending = first == 0xFF || (first == 0xFE && s->length < 9);
+        }
+
+        unsigned long long take = MIN(s->remaining, n);
+        s->remaining -= take;
+        data += take;
+        n -= take;
+
+        if (s->ending && s->remaining == 0 && !s->continued) return 1;
+    }
+    return 0;
+}
+
+static void Prefetch_wake_reader(Prefetch *p) {
+    if (p->reader_waiting) {
+        p->reader_waiting = 0;
+        PyThread_release_lock(p->data_lock);
+    }
+}
+
+static void Prefetch_wake_thread(Prefetch *p) {
+    if (p->thread_waiting) {
+        p->thread_waiting = 0;
+        PyThread_release_lock(p->space_lock);
+    }
+}
+
+static void Prefetch_run(void *arg) {
+    Prefetch *p = (Prefetch*)arg;
+    PyGILState_STATE gil = PyGILState_Ensure();
+
+    while (!p->done && !p->stop) {
+        unsigned long long offset = p->head % p->size;
+        unsigned long long space = MIN(p->size - (p->head - p->tail), p->size - offset);
+        PyObject *py_memview = NULL;
+        PyObject *py_n = NULL;
+        Py_ssize_t n = 0;
+
+        if (space == 0) {
+            p->thread_waiting = 1;
+            Py_BEGIN_ALLOW_THREADS
+            PyThread_acquire_lock(p->space_lock, WAIT_LOCK);
+            Py_END_ALLOW_THREADS
+            continue;
+        }
+
+        py_memview = PyMemoryView_FromMemory(p->ring + offset, space, PyBUF_WRITE);
+        if (py_memview) {
+            py_n = PyObject_CallFunctionObjArgs(p->py_recv_into, py_memview, NULL);
+            Py_DECREF(py_memview);
+        }
+        if (py_n) {
+            n = PyLong_AsSsize_t(py_n);
+            Py_DECREF(py_n);
+        }
+
+        if (PyErr_Occurred()) {
+            PyErr_Fetch(&p->py_err_type, &p->py_err_value, &p->py_err_tb);
+            p->done = 1;
+        } else if (n <= 0) {
+            // The reader reports the lost connection.
+            p->done = 1;
+        } else {
+            if (PacketScanner_feed(&p->scanner, p->ring + offset, n)) p->done = 1;
+            p->head += n;
+        }
+
+        Prefetch_wake_reader(p);
+    }
+
+    p->done = 1;
+    Prefetch_wake_reader(p);
+    PyGILState_Release(gil);
+    PyThread_release_lock(p->exit_lock);
+}
+
+//
+// Copy up to max_l received bytes into out, waiting for the thread if
+// none have arrived. Returns the number of bytes copied, which is 0 once
+// the thread has stopped and everything has been taken.
+//
+static unsigned long long Prefetch_take(Prefetch *p, char *out, unsigned long long max_l) {
+    unsigned long long n = 0;
+    unsigned long long offset = 0;
+    unsigned long long first_l = 0;
+
+    while (p->head == p->tail && !p->done) {
+        p->reader_waiting = 1;
+        Py_BEGIN_ALLOW_THREADS
+        PyThread_acquire_lock(p->data_lock, WAIT_LOCK);
+        Py_END_ALLOW_THREADS
+    }
+
+    n = MIN(p->head - p->tail, max_l);
+    offset = p->tail % p->size;
+    first_l = MIN(n, p->size - offset);
+    memcpy(out, p->ring + offset, first_l);
+    memcpy(out + first_l, p->ring, n - first_l);
+    p->tail += n;
+
+    if (n) Prefetch_wake_thread(p);
+
+    return n;
+}
+
+//
+// Ask the thread to stop and wait for it to exit.
+//
+static void Prefetch_join(Prefetch *p) {
+    p->stop = 1;
+    Prefetch_wake_thread(p);
+    Py_BEGIN_ALLOW_THREADS
+    PyThread_acquire_lock(p->exit_lock, WAIT_LOCK);
+    Py_END_ALLOW_THREADS
+}
+
+static void Prefetch_free(Prefetch *p) {
+    if (!p) return;
+    Py_XDECREF(p->py_recv_into);
+    Py_XDECREF(p->py_err_type);
+    Py_XDECREF(p->py_err_value);
+    Py_XDECREF(p->py_err_tb);
+    if (p->data_lock) PyThread_free_lock(p->data_lock);
+    if (p->space_lock) PyThread_free_lock(p->space_lock);
+    if (p->exit_lock) PyThread_free_lock(p->exit_lock);
+    DESTROY(p->ring);
+    free(p);
+}
+
+static PyThread_type_lock Prefetch_new_lock(void) {
+    PyThread_type_lock lock = PyThread_allocate_lock();
+    // Locks start out held; waiters block until the other side releases.
+    if (lock) PyThread_acquire_lock(lock, WAIT_LOCK);
+    return lock;
+}
+
+//
+// Make room for n more bytes after the data in the receive buffer.
+//
+static int State_reserve_recv_buff(StateObject *self, unsigned long long n) {
+    unsigned long long avail = self->recv_buff_end - self->recv_buff_pos;
+
+    if (self->recv_buff_end + n <= self->recv_buff_size) return 0;
+
+    if (avail && self->recv_buff_pos) {
+        memmove(self->recv_buff, self->recv_buff + self->recv_buff_pos, avail);
+    }
+    self->recv_buff_pos = 0;
+    self->recv_buff_end = avail;
+
+    if (avail + n > self->recv_buff_size) {
+        char *new_buff = realloc(self->recv_buff, avail + n + 1);
+        if (!new_buff) { PyErr_NoMemory(); return -1; }
+        self->recv_buff = new_buff;
+        self->recv_buff_size = avail + n;
+    }
+
+    return 0;
+}
+
+//
+// Start the read-ahead thread of an unbuffered result. This is called at
+// a packet boundary. Bytes already buffered by the connection's file are
+// moved to the receive buffer first so the thread can own the socket.
+//
+static int State_start_prefetch(StateObject *self) {
+    int rc = 0;
+    Prefetch *p = NULL;
+    PacketScanner scanner;
+    PyObject *py_recv_into = NULL;
+    PyObject *py_data = NULL;
+    unsigned long long size = self->options.prefetch_bytes;
+
+    // Only tried once per result.
+    self->options.prefetch_bytes = 0;
+    memset(&scanner, 0, sizeof(scanner));
+
+    if (!self->py_readinto1) goto exit;
+
+    py_recv_into = PyObject_GetAttr(self->py_sock, PyStr.recv_into);
+    if (!py_recv_into) { PyErr_Clear(); goto exit; }
+
+    // Nothing left to prefetch if the end of the result is already here.
+    if (PacketScanner_feed(&scanner, self->recv_buff + self->recv_buff_pos,
+                           self->recv_buff_end - self->recv_buff_pos)) goto exit;
+
+    py_data = PyObject_CallMethod(self->py_rfile, "peek", "i", 1);
+    if (!py_data) { PyErr_Clear(); goto exit; }
+    if (!PyBytes_Check(py_data)) goto exit;
+    PyObject *py_peek = py_data;
+    py_data = PyObject_CallMethod(self->py_rfile, "read", "n", PyBytes_Size(py_peek));
+    Py_DECREF(py_peek);
+    if (!py_data) goto error;
+    if (!PyBytes_Check(py_data)) {
+        PyErr_SetString(PyExc_TypeError, "socket read did not return bytes");
+        goto error;
+    }
+
+    CHECKRC(State_reserve_recv_buff(self, PyBytes_Size(py_data)));
+    memcpy(self->recv_buff + self->recv_buff_end, PyBytes_AsString(py_data),
+           PyBytes_Size(py_data));
+    self->recv_buff_end += PyBytes_Size(py_data);
+    if (PacketScanner_feed(&scanner, PyBytes_AsString(py_data), PyBytes_Size(py_data))) {
+        goto exit;
+    }
+
+    p = calloc(1, sizeof(Prefetch));
+    if (!p) { PyErr_NoMemory(); goto error; }
+
+    p->size = MAX(size, ACCEL_PREFETCH_MIN_SIZE);
+    p->ring = malloc(p->size);
+    if (!p->ring) { PyErr_NoMemory(); goto error; }
+    p->scanner = scanner;
+    p->py_recv_into = py_recv_into;
+    py_recv_into = NULL;
+
+    p->data_lock = Prefetch_new_lock();
+    p->space_lock = Prefetch_new_lock();
+    p->exit_lock = Prefetch_new_lock();
+    if (!p->data_lock || !p->space_lock || !p->exit_lock) {
+        PyErr_SetString(PyExc_RuntimeError, "could not allocate read-ahead locks");
+        goto error;
+    }
+
+    if (PyThread_start_new_thread(Prefetch_run, p) == (unsigned long)-1) {
+        PyErr_SetString(PyExc_RuntimeError, "could not start read-ahead thread");
+        goto error;
+    }
+
+    self->prefetch = p;
+    p = NULL;
+
+exit:
+    Py_XDECREF(py_data);
+    Py_XDECREF(py_recv_into);
+    Prefetch_free(p);
+    return rc;
+
+error:
+    rc = -1;
+    goto exit;
+}
+
+//
+// Stop the read-ahead thread and keep what it received in the receive
+// buffer, so the socket can be read directly again.
+//
+static int State_stop_prefetch(StateObject *self) {
+    int rc = 0;
+    Prefetch *p = self->prefetch;
+
+    if (!p) return 0;
+    self->prefetch = NULL;
+
+    Prefetch_join(p);
+
+    if (p->head > p->tail && self->recv_buff) {
+        rc = State_reserve_recv_buff(self, p->head - p->tail);
+        if (!rc) {
+            self->recv_buff_end += Prefetch_take(p, self->recv_buff + self->recv_buff_end,
+                                                 p->head - p->tail);
+        }
+    }
+
+    Prefetch_free(p);
+    return rc;
+}
+
+
+static void State_clear_fields(StateObject *self) {
+    if (!self) return;
+    if (self->prefetch) {
+        Prefetch_join(self->prefetch);
+        Prefetch_free(self->prefetch);
+        self->prefetch = NULL;
+    }
+    DESTROY(self->recv_buff);
+    self->recv_buff_size = 0;
+    self->recv_buff_pos = 0;
+    self->recv_buff_end = 0;
+    Py_CLEAR(self->py_large_packet);
+    if (self->columns) {
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            ColumnBuffer_reset(&self->columns[i]);
+            StringTable_free(self->columns[i].dictionary);
+        }
+        DESTROY(self->columns);
+    }
+    if (self->string_tables) {
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            StringTable_free(self->string_tables[i]);
+        }
+        DESTROY(self->string_tables);
+    }
+    if (self->temporal_memo) {
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            Py_CLEAR(self->temporal_memo[i].py_value);
+        }
+        DESTROY(self->temporal_memo);
+    }
+    for (unsigned long i = 0; i < ACCEL_DATE_MEMO_SIZE; i++) {
+        Py_CLEAR(self->date_memo[i].py_value);
+    }
+    DESTROY(self->offsets);
+    DESTROY(self->scales);
+    DESTROY(self->flags);
+    DESTROY(self->type_codes);
+    if (self->owns_encodings && self->encodings) {
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            DESTROY(self->encodings[i]);
+        }
+    }
+    DESTROY(self->encodings);
+    DESTROY(self->codecs);
+    DESTROY(self->encoding_errors);
+    if (self->py_converters) {
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            Py_CLEAR(self->py_converters[i]);
+        }
+        DESTROY(self->py_converters);
+    }
+    if (self->py_names) {
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            Py_CLEAR(self->py_names[i]);
+        }
+        DESTROY(self->py_names);
+    }
+    if (self->py_encodings) {
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            Py_CLEAR(self->py_encodings[i]);
+        }
+        DESTROY(self->py_encodings);
+    }
+    if (self->py_invalid_values) {
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            Py_CLEAR(self->py_invalid_values[i]);
+        }
+        DESTROY(self->py_invalid_values);
+    }
+    Py_CLEAR(self->py_layout);
+    Py_CLEAR(self->py_name_index);
+    Py_CLEAR(self->py_row_block);
+    Py_CLEAR(self->py_row_type);
+    Py_CLEAR(self->py_names_list);
+    Py_CLEAR(self->py_default_converters);
+    Py_CLEAR(self->py_settimeout);
+    Py_CLEAR(self->py_read_timeout);
+    Py_CLEAR(self->py_sock);
+    Py_CLEAR(self->py_read);
+    Py_CLEAR(self->py_readinto1);
+    Py_CLEAR(self->py_rfile);
+    Py_CLEAR(self->py_rows);
+    Py_CLEAR(self->py_fields);
+    Py_CLEAR(self->py_conn);
+    // Encoding names may belong to the shape, so it goes last
+    Py_CLEAR(self->py_shape);
+}
+
+static void ResultShape_free(ResultShape *shape) {
+    if (!shape) return;
+    for (unsigned long long i = 0; i < shape->n_cols; i++) {
+        if (shape->encodings) DESTROY(shape->encodings[i]);
+        if (shape->py_encodings) Py_CLEAR(shape->py_encodings[i]);
+        if (shape->py_converters) Py_CLEAR(shape->py_converters[i]);
+        if (shape->py_invalid_values) Py_CLEAR(shape->py_invalid_values[i]);
+        if (shape->py_names) Py_CLEAR(shape->py_names[i]);
+    }
+    DESTROY(shape->type_codes);
+    DESTROY(shape->flags);
+    DESTROY(shape->scales);
+    DESTROY(shape->encodings);
+    DESTROY(shape->py_encodings);
+    DESTROY(shape->py_converters);
+    DESTROY(shape->py_invalid_values);
+    DESTROY(shape->py_names);
+    Py_CLEAR(shape->py_row_type);
+    free(shape);
+}
+
+static void result_shape_capsule_destructor(PyObject *capsule) {
+    ResultShape_free(PyCapsule_GetPointer(capsule, ACCEL_SHAPE_CAPSULE));
+}
+
+//
+// Return the cached layout of the result, or NULL if it has none yet.
+//
+static ResultShape *State_get_shape(StateObject *self) {
+    if (!self->py_shape) return NULL;
+    return PyCapsule_GetPointer(self->py_shape, ACCEL_SHAPE_CAPSULE);
+}
+
+//
+// Copy the column layout from a cached ResultShape.
+//
+static int State_load_shape(StateObject *self, ResultShape *shape) {
+    unsigned long long n = self->n_cols;
+
+    memcpy(self->type_codes, shape->type_codes, n * sizeof(unsigned long));
+    memcpy(self->flags, shape->flags, n * sizeof(unsigned long));
+    memcpy(self->scales, shape->scales, n * sizeof(unsigned long));
+    memcpy(self->encodings, shape->encodings, n * sizeof(char*));
+
+    for (unsigned long long i = 0; i < n; i++) {
+        self->py_names[i] = shape->py_names[i];
+        Py_INCREF(self->py_names[i]);
+        Py_INCREF(self->py_names[i]);  // Extra ref since SetItem steals one
+        if (PyList_SetItem(self->py_names_list, i, self->py_names[i])) return -1;
+        self->py_encodings[i] = shape->py_encodings[i];
+        Py_XINCREF(self->py_encodings[i]);
+        self->py_converters[i] = shape->py_converters[i];
+        Py_XINCREF(self->py_converters[i]);
+        self->py_invalid_values[i] = shape->py_invalid_values[i];
+        Py_XINCREF(self->py_invalid_values[i]);
+    }
+
+    self->py_row_type = shape->py_row_type;
+    Py_XINCREF(self->py_row_type);
+
+    return 0;
+}
+
+//
+// Store the column layout in a new ResultShape attached to `py_shape_obj`.
+//
+// The shape takes over the encoding names of the state.
+//
+static int State_save_shape(StateObject *self, PyObject *py_shape_obj) {
+    unsigned long long n = self->n_cols;
+    PyObject *py_capsule = NULL;
+    ResultShape *shape = calloc(1, sizeof(ResultShape));
+    if (!shape) goto error;
+
+    shape->type_codes = calloc(n + 1, sizeof(unsigned long));
+    shape->flags = calloc(n + 1, sizeof(unsigned long));
+    shape->scales = calloc(n + 1, sizeof(unsigned long));
+    shape->encodings = calloc(n + 1, sizeof(char*));
+    shape->py_encodings = calloc(n + 1, sizeof(PyObject*));
+    shape->py_converters = calloc(n + 1, sizeof(PyObject*));
+    shape->py_invalid_values = calloc(n + 1, sizeof(PyObject*));
+    shape->py_names = calloc(n + 1, sizeof(PyObject*));
+    if (!shape->type_codes || !shape->flags || !shape->scales || !shape->encodings ||
+        !shape->py_encodings || !shape->py_converters || !shape->py_invalid_values ||
+        !shape->py_names) goto error;
+
+    memcpy(shape->type_codes, self->type_codes, n * sizeof(unsigned long));
+    memcpy(shape->flags, self->flags, n * sizeof(unsigned long));
+    memcpy(shape->scales, self->scales, n * sizeof(unsigned long));
+
+    for (unsigned long long i = 0; i < n; i++) {
+        shape->py_names[i] = self->py_names[i];
+        Py_XINCREF(shape->py_names[i]);
+        shape->py_encodings[i] = self->py_encodings[i];
+        Py_XINCREF(shape->py_encodings[i]);
+        shape->py_converters[i] = self->py_converters[i];
+        Py_XINCREF(shape->py_converters[i]);
+        shape->py_invalid_values[i] = self->py_invalid_values[i];
+        Py_XINCREF(shape->py_invalid_values[i]);
+    }
+    shape->n_cols = n;
+
+    py_capsule = PyCapsule_New(shape, ACCEL_SHAPE_CAPSULE, result_shape_capsule_destructor);
+    if (!py_capsule) goto error;
+
+    // Only hand over the encoding names once the capsule owns the shape
+    memcpy(shape->encodings, self->encodings, n * sizeof(char*));
+
+    if (PyObject_SetAttr(py_shape_obj, PyStr.accel, py_capsule)) {
+        memset(shape->encodings, 0, n * sizeof(char*));
+        Py_DECREF(py_capsule);
+        return -1;
+    }
+
+    self->py_shape = py_capsule;
+    return 0;
+
+error:
+    if (shape) shape->n_cols = n;
+    ResultShape_free(shape);
+    PyErr_NoMemory();
+    return -1;
+}
+
+//
+// Create the state that the lazy rows of a result decode their cells with.
+//
+// It holds a copy of the column layout and its own memos, but none of the
+// connection, socket, or receive buffer, so rows that outlive the result
+// do not keep those alive.
+//
+static StateObject *State_new_layout(StateObject *self) {
+    unsigned long long n = self->n_cols;
+    StateObject *py_layout = (StateObject*)PyType_GenericAlloc(StateType, 0);
+    if (!py_layout) return NULL;
+
+    py_layout->n_cols = n;
+    py_layout->options = self->options;
+    py_layout->options.invalid_values = NULL;
+    py_layout->owns_encodings = 1;
+
+    py_layout->type_codes = calloc(n + 1, sizeof(unsigned long));
+    py_layout->flags = calloc(n + 1, sizeof(unsigned long));
+    py_layout->scales = calloc(n + 1, sizeof(unsigned long));
+    py_layout->codecs = calloc(n + 1, sizeof(int));
+    py_layout->encodings = calloc(n + 1, sizeof(char*));
+    py_layout->py_converters = calloc(n + 1, sizeof(PyObject*));
+    py_layout->py_invalid_values = calloc(n + 1, sizeof(PyObject*));
+    py_layout->py_names = calloc(n + 1, sizeof(PyObject*));
+    py_layout->temporal_memo = calloc(n + 1, sizeof(TemporalMemo));
+    py_layout->string_tables = calloc(n + 1, sizeof(StringTable*));
+    py_layout->encoding_errors = calloc(strlen(self->encoding_errors) + 1, 1);
+    if (!py_layout->type_codes || !py_layout->flags || !py_layout->scales ||
+        !py_layout->codecs || !py_layout->encodings || !py_layout->py_converters ||
+        !py_layout->py_invalid_values || !py_layout->py_names ||
+        !py_layout->temporal_memo || !py_layout->string_tables ||
+        !py_layout->encoding_errors) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    memcpy(py_layout->type_codes, self->type_codes, n * sizeof(unsigned long));
+    memcpy(py_layout->flags, self->flags, n * sizeof(unsigned long));
+    memcpy(py_layout->scales, self->scales, n * sizeof(unsigned long));
+    memcpy(py_layout->codecs, self->codecs, n * sizeof(int));
+    strcpy(py_layout->encoding_errors, self->encoding_errors);
+
+    py_layout->py_name_index = PyDict_New();
+    if (!py_layout->py_name_index) goto error;
+
+    for (unsigned long long i = 0; i < n; i++) {
+        if (self->encodings[i]) {
+            py_layout->encodings[i] = calloc(strlen(self->encodings[i]) + 1, 1);
+            if (!py_layout->encodings[i]) { PyErr_NoMemory(); goto error; }
+            strcpy((char*)py_layout->encodings[i], self->encodings[i]);
+        }
+        py_layout->py_converters[i] = self->py_converters[i];
+        Py_XINCREF(py_layout->py_converters[i]);
+        py_layout->py_invalid_values[i] = self->py_invalid_values[i];
+        Py_XINCREF(py_layout->py_invalid_values[i]);
+        py_layout->py_names[i] = self->py_names[i];
+        Py_XINCREF(py_layout->py_names[i]);
+
+        PyObject *py_index = PyLong_FromUnsignedLongLong(i);
+        if (!py_index) goto error;
+        int rc = PyDict_SetItem(py_layout->py_name_index, self->py_names[i], py_index);
+        Py_DECREF(py_index);
+        if (rc) goto error;
+    }
+
+    py_layout->py_names_list = self->py_names_list;
+    Py_XINCREF(py_layout->py_names_list);
+
+    return py_layout;
+
+error:
+    Py_DECREF(py_layout);
+    return NULL;
+}
+
+static void State_dealloc(StateObject *self) {
+    State_clear_fields(self);
+    PyObject_Del(self);
+}
+
+static void set_column_kind(ColumnBuffer *col, int kind, int itemsize, const char *dtype) {
+    col->kind = kind;
+    col->itemsize = itemsize;
+    col->dtype = dtype;
+}
+
+//
+// Return the Arrow format of a packed column, switching to Arrow-specific
+// storage where the layouts differ.
+//
+static const char *arrow_column_format(ColumnBuffer *col) {
+    int is_unsigned = col->kind == ACCEL_COL_UINT;
+
+    switch (col->kind) {
+    case ACCEL_COL_INT:
+    case ACCEL_COL_UINT:
+        switch (col->itemsize) {
+        case 1: return (is_unsigned) ? "C" : "c";
+        case 2: return (is_unsigned) ? "S" : "s";
+        case 4: return (is_unsigned) ? "I" : "i";
+        default: return (is_unsigned) ? "L" : "l";
+        }
+    case ACCEL_COL_FLOAT:
+        return "f";
+    case ACCEL_COL_DOUBLE:
+        return "g";
+    case ACCEL_COL_DATE:
+        // Arrow results use date64 (milliseconds) for dates.
+        set_column_kind(col, ACCEL_COL_DATE64, 8, "datetime64[ms]");
+        return "tdm";
+    case ACCEL_COL_DATETIME:
+        return "tsu:";
+    case ACCEL_COL_TIME:
+        return "tDu";
+    case ACCEL_COL_UTF8:
+        return "U";
+    case ACCEL_COL_BINARY:
+        return "Z";
+    case ACCEL_COL_DECIMAL128:
+        snprintf(col->format_buf, sizeof(col->format_buf), "d:%d,%d",
+                 col->precision, col->scale);
+        return col->format_buf;
+    case ACCEL_COL_DICT:
+        // Dictionary codes; the values are exported as the array dictionary.
+        return "i";
+    case ACCEL_COL_VECTOR:
+        // Fixed-size list; the elements are exported as the child array.
+        snprintf(col->format_buf, sizeof(col->format_buf), "+w:%d", col->dim);
+        return col->format_buf;
+    }
+
+    return NULL;
+}
+
+//
+// Choose Arrow string storage for text and binary columns.
+//
+static void set_arrow_string_kind(StateObject *self, unsigned long i) {
+    ColumnBuffer *col = &self->columns[i];
+
+    if (self->py_converters[i] && self->py_converters[i] != Py_None) return;
+
+    switch (self->type_codes[i]) {
+    case MYSQL_TYPE_JSON:
+        if (self->options.parse_json) return;
+        break;
+    case MYSQL_TYPE_TINY_BLOB:
+    case MYSQL_TYPE_MEDIUM_BLOB:
+    case MYSQL_TYPE_LONG_BLOB:
+    case MYSQL_TYPE_BLOB:
+    case MYSQL_TYPE_GEOMETRY:
+    case MYSQL_TYPE_ENUM:
+    case MYSQL_TYPE_SET:
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_STRING:
+        break;
+    default:
+        return;
+    }
+
+    if (!self->encodings[i]) {
+        set_column_kind(col, ACCEL_COL_BINARY, 8, NULL);
+    } else if (self->codecs[i] == ACCEL_CODEC_UTF8 || self->codecs[i] == ACCEL_CODEC_ASCII) {
+        set_column_kind(col, ACCEL_COL_UTF8, 8, NULL);
+    }
+}
+
+//
+// Return non-zero if a column holds ENUM or SET text values.
+//
+static int is_category_column(StateObject *self, unsigned long i) {
+    if (self->py_converters[i] && self->py_converters[i] != Py_None) return 0;
+    if (!self->encodings[i]) return 0;
+
+    switch (self->type_codes[i]) {
+    case MYSQL_TYPE_ENUM:
+    case MYSQL_TYPE_SET:
+        return 1;
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_STRING:
+        return (self->flags[i] & (MYSQL_FLAG_ENUM | MYSQL_FLAG_SET)) != 0;
+    }
+
+    return 0;
+}
+
+//
+// Return the intern table of a text column, or NULL if it has none.
+//
+static StringTable *State_string_table(StateObject *self, unsigned long i) {
+    switch (self->type_codes[i]) {
+    case MYSQL_TYPE_JSON:
+        // Holds the object keys of parsed documents
+        if (!self->options.parse_json) return NULL;
+        break;
+    case MYSQL_TYPE_BSON:
+        // Lazy documents decode their keys on access
+        if (self->options.lazy_bson) return NULL;
+        break;
+    case MYSQL_TYPE_ENUM:
+    case MYSQL_TYPE_SET:
+    case MYSQL_TYPE_VARCHAR:
+    case MYSQL_TYPE_VAR_STRING:
+    case MYSQL_TYPE_STRING:
+        break;
+    default:
+        return NULL;
+    }
+
+    if (!self->string_tables[i]) {
+        // Interning is an optimization; carry on without it if out of memory.
+        self->string_tables[i] = calloc(1, sizeof(StringTable));
+    }
+
+    return self->string_tables[i];
+}
+
+//
+// Store a VECTOR column as one block of (n_rows, dim) elements.
+//
+// The dimension comes from the field length; columns without one keep
+// per-row objects. JSON vectors are parsed straight into the block.
+//
+static int init_vector_column(StateObject *self, unsigned long i) {
+    static const char *dtypes[] = {"", "float32", "float64", "int8", "int16", "int32", "int64"};
+    static const char *formats[] = {"", "f", "g", "c", "s", "i", "l"};
+    static const int itemsizes[] = {0, 4, 8, 1, 2, 4, 8};
+    ColumnBuffer *col = &self->columns[i];
+    int type_idx = self->type_codes[i] % 1000;
+    long dim = 0;
+
+    PyObject *py_field = PyList_GetItem(self->py_fields, i);
+    if (!py_field) return -1;
+    PyObject *py_length = PyObject_GetAttr(py_field, PyStr.length);
+    if (!py_length) { PyErr_Clear(); return 0; }
+    dim = PyLong_AsLong(py_length);
+    Py_DECREF(py_length);
+    if (dim == -1 && PyErr_Occurred()) return -1;
+    if (dim <= 0 || dim > INT_MAX / 8) return 0;
+
+    set_column_kind(col, ACCEL_COL_VECTOR, (int)dim * itemsizes[type_idx], dtypes[type_idx]);
+    col->dim = (int)dim;
+    col->vector_type = (int)self->type_codes[i];
+    col->child_format = formats[type_idx];
+
+    return 0;
+}
+
+//
+// Number of digits of DECIMAL column `i`. The field length counts the
+// decimal point and, for signed columns, the sign as well. Returns 0 if
+// the length is not known.
+//
+static long decimal_precision(StateObject *self, unsigned long i) {
+    long length = 0;
+
+    PyObject *py_field = PyList_GetItem(self->py_fields, i);
+    if (!py_field) return -1;
+    PyObject *py_length = PyObject_GetAttr(py_field, PyStr.length);
+    if (!py_length) { PyErr_Clear(); return 0; }
+    length = PyLong_AsLong(py_length);
+    Py_DECREF(py_length);
+    if (length == -1 && PyErr_Occurred()) return -1;
+
+    if (self->scales[i] > 0) length--;
+    if (!(self->flags[i] & MYSQL_FLAG_UNSIGNED)) length--;
+    return (length > 0) ? length : 0;
+}
+
+//
+// Choose packed storage for each column that is decoded natively.
+//
+// If use_arrow is set, the columns are built in Arrow layouts.
+//
+static int State_init_columns(StateObject *self, int use_arrow) {
+    self->columns = calloc(self->n_cols, sizeof(ColumnBuffer));
+    if (!self->columns) { PyErr_NoMemory(); return -1; }
+
+    for (unsigned long i = 0; i < self->n_cols; i++) {
+        ColumnBuffer *col = &self->columns[i];
+        int is_unsigned = self->flags[i] & MYSQL_FLAG_UNSIGNED;
+
+        set_column_kind(col, ACCEL_COL_OBJECT, 0, NULL);
+        col->py_name = PyList_GetItem(self->py_names_list, i);
+
+        // ENUM and SET columns have few distinct values, so DataFrame and
+        // Arrow results get them dictionary-encoded (numpy has no such type).
+        if (self->options.results_type != ACCEL_OUT_NUMPY && is_category_column(self, i)) {
+            col->dictionary = calloc(1, sizeof(StringTable));
+            if (!col->dictionary) { PyErr_NoMemory(); return -1; }
+            set_column_kind(col, ACCEL_COL_DICT, 4, "int32");
+            if (use_arrow) col->format = arrow_column_format(col);
+            continue;
+        }
+
+        if (use_arrow) {
+            set_arrow_string_kind(self, i);
+            if (col->kind != ACCEL_COL_OBJECT) {
+                col->format = arrow_column_format(col);
+                continue;
+            }
+        }
+
+        // Polars asks for date/time columns as strings so that it can parse
+        // them itself; packed values are cheaper for it than either.
+        if (self->py_converters[i] == Py_None &&
+            self->options.results_type == ACCEL_OUT_POLARS) {
+            switch (self->type_codes[i]) {
+            case MYSQL_TYPE_NEWDATE:
+            case MYSQL_TYPE_DATE:
+                set_column_kind(col, ACCEL_COL_DATE, 8, "datetime64[D]");
+                break;
+            case MYSQL_TYPE_DATETIME:
+            case MYSQL_TYPE_TIMESTAMP:
+                set_column_kind(col, ACCEL_COL_DATETIME, 8, "datetime64[us]");
+                break;
+            }
+            continue;
+        }
+
+        if (self->py_converters[i]) continue;
+
+        switch (self->type_codes[i]) {
+        case MYSQL_TYPE_TINY:
+            if (is_unsigned) set_column_kind(col, ACCEL_COL_UINT, 1, "uint8");
+            else set_column_kind(col, ACCEL_COL_INT, 1, "int8");
+            break;
+        case MYSQL_TYPE_SHORT:
+            if (is_unsigned) set_column_kind(col, ACCEL_COL_UINT, 2, "uint16");
+            else set_column_kind(col, ACCEL_COL_INT, 2, "int16");
+            break;
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_INT24:
+            if (is_unsigned) set_column_kind(col, ACCEL_COL_UINT, 4, "uint32");
+            else set_column_kind(col, ACCEL_COL_INT, 4, "int32");
+            break;
+        case MYSQL_TYPE_LONGLONG:
+            if (is_unsigned) set_column_kind(col, ACCEL_COL_UINT, 8, "uint64");
+            else set_column_kind(col, ACCEL_COL_INT, 8, "int64");
+            break;
+        case MYSQL_TYPE_YEAR:
+            set_column_kind(col, ACCEL_COL_INT, 2, "int16");
+            break;
+        case MYSQL_TYPE_FLOAT:
+            set_column_kind(col, ACCEL_COL_FLOAT, 4, "float32");
+            break;
+        case MYSQL_TYPE_DOUBLE:
+            set_column_kind(col, ACCEL_COL_DOUBLE, 8, "float64");
+            break;
+        case MYSQL_TYPE_NEWDATE:
+        case MYSQL_TYPE_DATE:
+            set_column_kind(col, ACCEL_COL_DATE, 8, "datetime64[D]");
+            break;
+        case MYSQL_TYPE_DATETIME:
+        case MYSQL_TYPE_TIMESTAMP:
+            set_column_kind(col, ACCEL_COL_DATETIME, 8, "datetime64[us]");
+            break;
+        case MYSQL_TYPE_TIME:
+            set_column_kind(col, ACCEL_COL_TIME, 8, "timedelta64[us]");
+            break;
+        case MYSQL_TYPE_DECIMAL:
+        case MYSQL_TYPE_NEWDECIMAL: {
+            // numpy has no decimal type; other outputs keep Decimal objects,
+            // as do columns too wide for decimal128.
+            long precision = 0;
+            if (!use_arrow) break;
+            precision = decimal_precision(self, i);
+            if (precision < 0) return -1;
+            if (precision > 0 && precision <= 38 && self->scales[i] <= (unsigned long)precision) {
+                set_column_kind(col, ACCEL_COL_DECIMAL128, 16, NULL);
+                col->precision = (int)precision;
+                col->scale = (int)self->scales[i];
+            }
+            break;
+            }
+        case MYSQL_TYPE_FLOAT32_VECTOR:
+        case MYSQL_TYPE_FLOAT64_VECTOR:
+        case MYSQL_TYPE_INT8_VECTOR:
+        case MYSQL_TYPE_INT16_VECTOR:
+        case MYSQL_TYPE_INT32_VECTOR:
+        case MYSQL_TYPE_INT64_VECTOR:
+            if (self->options.contiguous_vectors &&
+                    self->options.results_type != ACCEL_OUT_POLARS &&
+                    init_vector_column(self, i) < 0) return -1;
+            break;
+        case MYSQL_TYPE_FLOAT32_VECTOR_JSON:
+        case MYSQL_TYPE_FLOAT64_VECTOR_JSON:
+        case MYSQL_TYPE_INT8_VECTOR_JSON:
+        case MYSQL_TYPE_INT16_VECTOR_JSON:
+        case MYSQL_TYPE_INT32_VECTOR_JSON:
+        case MYSQL_TYPE_INT64_VECTOR_JSON:
+            if (self->options.contiguous_vectors &&
+                    self->options.results_type != ACCEL_OUT_POLARS &&
+                    self->codecs[i] != ACCEL_CODEC_OTHER &&
+                    init_vector_column(self, i) < 0) return -1;
+            break;
+        }
+
+        if (use_arrow) col->format = arrow_column_format(col);
+    }
+
+    return 0;
+}
+
+static int State_init(StateObject *self, PyObject *args, PyObject *kwds) {
+    int rc = 0;
+    PyObject *py_res = NULL;
+    PyObject *py_converters = NULL;
+    PyObject *py_options = NULL;
+    PyObject *py_shape_obj = NULL;
+    unsigned long long requested_n_rows = 0;
+
+    if (!PyArg_ParseTuple(args, "OK", &py_res, &requested_n_rows)) {
+        return -1;
+    }
+
+    py_options = PyObject_GetAttr(py_res, PyStr.options);
+    if (!py_options) {
+        Py_INCREF(Py_None);
+        py_options = Py_None;
+    }
+
+    if (PyDict_Check(py_options)) {
+        self->py_default_converters = PyDict_GetItemString(py_options, "default_converters");
+        if (self->py_default_converters && !PyDict_Check(self->py_default_converters)) {
+            self->py_default_converters = NULL;
+        }
+        Py_XINCREF(self->py_default_converters);
+        PyObject *py_unbuffered = PyDict_GetItemString(py_options, "unbuffered");
+        if (py_unbuffered && PyObject_IsTrue(py_unbuffered)) {
+            self->unbuffered = 1;
+        }
+        PyObject *py_encoding_errors = PyDict_GetItemString(py_options, "encoding_errors");
+        if (py_encoding_errors) {
+            self->encoding_errors = _PyUnicode_AsUTF8(py_encoding_errors);
+            if (!self->encoding_errors) goto error;
+        }
+    }
+
+    if (!self->encoding_errors) {
+        self->encoding_errors = calloc(7, 1);
+        if (!self->encoding_errors) goto error;
+        memcpy(self->encoding_errors, "strict", 6);
+    }
+
+    if (self->unbuffered) {
+        PyObject *unbuffered_active = PyObject_GetAttr(py_res, PyStr.unbuffered_active);
+        if (!unbuffered_active || !PyObject_IsTrue(unbuffered_active)) {
+            Py_XDECREF(unbuffered_active);
+            goto error;
+        }
+        Py_XDECREF(unbuffered_active);
+    }
+
+    // Retrieve type codes for each column.
+    PyObject *py_field_count = PyObject_GetAttr(py_res, PyStr.field_count);
+    if (!py_field_count) goto error;
+    self->n_cols = PyLong_AsUnsignedLong(py_field_count);
+    Py_XDECREF(py_field_count);
+
+    py_converters = PyObject_GetAttr(py_res, PyStr.converters);
+    if (!py_converters) goto error;
+
+    self->py_converters = calloc(self->n_cols, sizeof(PyObject*));
+    if (!self->py_converters) goto error;
+
+    self->type_codes = calloc(self->n_cols, sizeof(unsigned long));
+    if (!self->type_codes) goto error;
+
+    self->flags = calloc(self->n_cols, sizeof(unsigned long));
+    if (!self->flags) goto error;
+
+    self->scales = calloc(self->n_cols, sizeof(unsigned long));
+    if (!self->scales) goto error;
+
+    self->temporal_memo = calloc(self->n_cols, sizeof(TemporalMemo));
+    if (!self->temporal_memo) goto error;
+
+    self->string_tables = calloc(self->n_cols, sizeof(StringTable*));
+    if (!self->string_tables) goto error;
+
+    self->encodings = calloc(self->n_cols, sizeof(char*));
+    if (!self->encodings) goto error;
+
+    self->codecs = calloc(self->n_cols, sizeof(int));
+    if (!self->codecs) goto error;
+
+    self->py_encodings = calloc(self->n_cols, sizeof(char*));
+    if (!self->py_encodings) goto error;
+
+    self->py_invalid_values = calloc(self->n_cols, sizeof(char*));
+    if (!self->py_invalid_values) goto error;
+
+    self->py_names = calloc(self->n_cols, sizeof(PyObject*));
+    if (!self->py_names) goto error;
+
+    self->py_fields = PyObject_GetAttr(py_res, PyStr.fields);
+    if (!self->py_fields) goto error;
+
+    self->py_names_list = PyList_New(self->n_cols);
+    if (!self->py_names_list) goto error;
+
+    // Reuse the column layout of an earlier result with the same
+    // column definitions if the connection cached one.
+    py_shape_obj = PyObject_GetAttr(py_res, PyStr._shape);
+    if (!py_shape_obj) {
+        PyErr_Clear();
+    } else if (py_shape_obj != Py_None) {
+        PyObject *py_accel = PyObject_GetAttr(py_shape_obj, PyStr.accel);
+        if (!py_accel) goto error;
+        if (PyCapsule_IsValid(py_accel, ACCEL_SHAPE_CAPSULE) &&
+                ((ResultShape*)PyCapsule_GetPointer(py_accel, ACCEL_SHAPE_CAPSULE))->n_cols
+                    == self->n_cols) {
+            self->py_shape = py_accel;
+        } else {
+            Py_DECREF(py_accel);
+        }
+    }
+
+    if (self->py_shape) {
+        rc = State_load_shape(self, State_get_shape(self));
+        if (rc) goto error;
+    }
+
+    for (unsigned long i = 0; !self->py_shape && i < self->n_cols; i++) {
+        // Get type codes.
+        PyObject *py_field = PyList_GetItem(self->py_fields, i);
+        if (!py_field) goto error;
+
+        PyObject *py_flags = PyObject_GetAttr(py_field, PyStr.flags);
+        if (!py_flags) goto error;
+        self->flags[i] = PyLong_AsUnsignedLong(py_flags);
+        Py_XDECREF(py_flags);
+
+        PyObject *py_scale = PyObject_GetAttr(py_field, PyStr.scale);
+        if (!py_scale) goto error;
+        self->scales[i] = PyLong_AsUnsignedLong(py_scale);
+        Py_XDECREF(py_scale);
+
+        PyObject *py_field_type = PyObject_GetAttr(py_field, PyStr.type_code);
+        if (!py_field_type) goto error;
+        self->type_codes[i] = PyLong_AsUnsignedLong(py_field_type);
+        PyObject *py_default_converter = (self->py_default_converters) ?
+                      PyDict_GetItem(self->py_default_converters, py_field_type) : NULL;
+        PyObject *py_invalid_value = (self->options.invalid_values) ?
+                      PyDict_GetItem(self->options.invalid_values, py_field_type) : NULL;
+        Py_XDECREF(py_field_type);
+
+        // Get field name.
+        PyObject *py_field_name = PyObject_GetAttr(py_field, PyStr.name);
+        if (!py_field_name) goto error;
+
+        // Make sure field name is not a duplicate.
+        int dup_found = 0;
+        for (unsigned long j = 0; j < i; j++) {
+            if (PyUnicode_Compare(self->py_names[j], py_field_name) == 0) {
+                dup_found = 1;
+                break;
+            }
+        }
+        if (dup_found) {
+            PyObject *py_table_name = PyObject_GetAttr(py_field, PyStr.table_name);
+            self->py_names[i] = PyUnicode_FromFormat("%U.%U", py_table_name, py_field_name);
+            Py_XDECREF(py_table_name);
+            if (!self->py_names[i]) goto error;
+        } else {
+            self->py_names[i] = py_field_name;
+        }
+
+        Py_INCREF(self->py_names[i]);  // Extra ref since SetItem steals one
+        rc = PyList_SetItem(self->py_names_list, i, self->py_names[i]);
+        if (rc) goto error;
+
+        // Get field encodings (NULL means binary) and default converters.
+        PyObject *py_tmp = PyList_GetItem(py_converters, i);
+        if (!py_tmp) goto error;
+        PyObject *py_encoding = PyTuple_GetItem(py_tmp, 0);
+        if (!py_encoding) goto error;
+        PyObject *py_converter = PyTuple_GetItem(py_tmp, 1);
+        if (!py_converter) goto error;
+
+        self->py_encodings[i] = (py_encoding == Py_None) ? NULL : py_encoding;
+        Py_XINCREF(self->py_encodings[i]);
+
+        self->encodings[i] = (!py_encoding || py_encoding == Py_None) ?
+                              NULL : _PyUnicode_AsUTF8(py_encoding);
+
+        self->py_invalid_values[i] = (!py_invalid_value || py_invalid_value == Py_None) ?
+                                      NULL : py_converter;
+        Py_XINCREF(self->py_invalid_values[i]);
+
+        self->py_converters[i] = ((!py_converter || py_converter == py_default_converter)
+                                   // TODO: Need C accelerated converters for extended types
+                                   // && self->type_codes[i] < 256
+                                   ) ?
+                                 NULL : py_converter;
+        Py_XINCREF(self->py_converters[i]);
+    }
+
+    if (!self->py_shape && py_shape_obj && py_shape_obj != Py_None) {
+        rc = State_save_shape(self, py_shape_obj);
+        if (rc) goto error;
+    }
+
+    for (unsigned long i = 0; i < self->n_cols; i++) {
+        self->codecs[i] = resolve_codec(self->encodings[i]);
+    }
+
+    // Loop over all data packets.
+    self->py_conn = PyObject_GetAttr(py_res, PyStr.connection);
+    if (!self->py_conn) goto error;
+
+    // Cache socket timeout and read methods.
+    self->py_sock = PyObject_GetAttr(self->py_conn, PyStr._sock);
+    if (!self->py_sock) goto error;
+    self->py_settimeout = PyObject_GetAttr(self->py_sock, PyStr.settimeout);
+    if (!self->py_settimeout) goto error;
+    self->py_read_timeout = PyObject_GetAttr(self->py_conn, PyStr._read_timeout);
+    if (!self->py_read_timeout) goto error;
+
+    self->py_rfile = PyObject_GetAttr(self->py_conn, PyStr._rfile);
+    if (!self->py_rfile) goto error;
+    self->py_read = PyObject_GetAttr(self->py_rfile, PyStr.read);
+    if (!self->py_read) goto error;
+
+    // Socket files are BufferedReaders which can receive directly into
+    // our buffer; anything else gets read with exact-length reads.
+    self->py_readinto1 = PyObject_GetAttr(self->py_rfile, PyStr.readinto1);
+    if (!self->py_readinto1) PyErr_Clear();
+
+    self->recv_buff_size = ACCEL_RECV_BUFFER_SIZE;
+    // One spare byte past the end lets decoders peek after the last cell.
+    self->recv_buff = malloc(self->recv_buff_size + 1);
+    if (!self->recv_buff) goto error;
+
+    // Pick up any bytes read ahead by a previous result that the
+    // connection has not consumed yet (_rbuf from offset _rbuf_pos).
+    PyObject *py_rbuf = PyObject_GetAttr(self->py_conn, PyStr._rbuf);
+    if (!py_rbuf) {
+        PyErr_Clear();
+    } else {
+        unsigned long long rbuf_pos = 0;
+        PyObject *py_rbuf_pos = PyObject_GetAttr(self->py_conn, PyStr._rbuf_pos);
+        if (!py_rbuf_pos) {
+            PyErr_Clear();
+        } else {
+            rbuf_pos = PyLong_AsUnsignedLongLong(py_rbuf_pos);
+            Py_DECREF(py_rbuf_pos);
+            if (PyErr_Occurred()) { Py_DECREF(py_rbuf); goto error; }
+        }
+        if (PyBytes_Check(py_rbuf) && PyBytes_Size(py_rbuf) > 0) {
+            unsigned long long rbuf_l = (unsigned long long)PyBytes_Size(py_rbuf);
+            rbuf_l = (rbuf_pos < rbuf_l) ? rbuf_l - rbuf_pos : 0;
+            if (rbuf_l > self->recv_buff_size) {
+                char *new_buff = realloc(self->recv_buff, rbuf_l + 1);
+                if (!new_buff) { Py_DECREF(py_rbuf); goto error; }
+                self->recv_buff = new_buff;
+                self->recv_buff_size = rbuf_l;
+            }
+            if (rbuf_l) memcpy(self->recv_buff, PyBytes_AsString(py_rbuf) + rbuf_pos, rbuf_l);
+            self->recv_buff_end = rbuf_l;
+            rc = PyObject_SetAttr(self->py_conn, PyStr._rbuf, PyObj.empty_bytes);
+            if (!rc) rc = PyObject_SetAttr(self->py_conn, PyStr._rbuf_pos, PyObj.zero);
+            if (rc) { Py_DECREF(py_rbuf); goto error; }
+        }
+        Py_DECREF(py_rbuf);
+    }
+
+    PyObject *py_next_seq_id = PyObject_GetAttr(self->py_conn, PyStr._next_seq_id);
+    if (!py_next_seq_id) goto error;
+    self->next_seq_id = PyLong_AsUnsignedLongLong(py_next_seq_id);
+    Py_XDECREF(py_next_seq_id);
+
+    if (py_options && PyDict_Check(py_options)) {
+        rc = read_options(&self->options, py_options);
+        if (rc) goto error;
+    }
+
+    switch (self->options.results_type) {
+    case ACCEL_OUT_NUMPY:
+    case ACCEL_OUT_PANDAS:
+    case ACCEL_OUT_POLARS:
+    case ACCEL_OUT_ARROW:
+        if (ensure_numpy() == 0 && ensure_columnar() == 0) {
+            rc = State_init_columns(self, self->options.results_type == ACCEL_OUT_ARROW
+                                          && ensure_arrow_c_data() == 0);
+            if (rc) goto error;
+        }
+    }
+
+    if (self->options.results_type == ACCEL_OUT_LAZYROWS) {
+        self->py_layout = (PyObject*)State_new_layout(self);
+        if (!self->py_layout) goto error;
+    }
+
+    switch (self->options.results_type) {
+    case ACCEL_OUT_NAMEDTUPLES:
+    case ACCEL_OUT_STRUCTSEQUENCES:
+        if (!self->py_row_type) {
+            self->py_row_type = create_row_type(self->py_names_list);
+            if (!self->py_row_type) goto error;
+
+            if (State_get_shape(self)) {
+                State_get_shape(self)->py_row_type = self->py_row_type;
+                Py_INCREF(self->py_row_type);
+            }
+        }
+        // Fall through
+
+    default:
+        // For fetchone, reuse the same list every time.
+        //if (requested_n_rows == 1) {
+        //    self->py_rows = PyList_New(1);
+        //    PyList_SetItem(self->py_rows, 0, Py_None);
+        //} else {
+            self->py_rows = PyList_New(0);
+        //}
+        if (!self->py_rows) goto error;
+
+        PyObject_SetAttr(py_res, PyStr.rows, self->py_rows);
+    }
+
+exit:
+    Py_XDECREF(py_shape_obj);
+    Py_XDECREF(py_converters);
+    Py_XDECREF(py_options);
+    if (PyErr_Occurred()) {
+        PyErr_Print();
+    }
+    return rc;
+
+error:
+    State_clear_fields(self);
+    rc = -1;
+    goto exit;
+}
+
+static int State_reset_batch(
+    StateObject *self,
+    PyObject *py_res,
+    unsigned long long requested_n_rows
+) {
+    int rc = 0;
+    PyObject *py_tmp = NULL;
+
+    self->n_rows_in_batch = 0;
+
+    if (self->columns) {
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            ColumnBuffer *col = &self->columns[i];
+            ColumnBuffer_reset(col);
+            if (!col->size_hint && requested_n_rows > 1) {
+                col->size_hint = MIN(requested_n_rows, ACCEL_COL_MAX_PRESIZE);
+            }
+        }
+    }
+
+    //if (requested_n_rows != 1) {
+        py_tmp = self->py_rows;
+        self->py_rows = PyList_New(0);
+        Py_XDECREF(py_tmp);
+        if (!self->py_rows) { rc = -1; goto error; }
+        rc = PyObject_SetAttr(py_res, PyStr.rows, self->py_rows);
+    //}
+
+exit:
+    return rc;
+
+error:
+    goto exit;
+}
+
+//
+// Replace the rows of the current batch with a ColumnarRows object
+// built from the column buffers.
+//
+static int State_finish_columns(StateObject *self, PyObject *py_res) {
+    int rc = 0;
+    PyObject *py_columns = NULL;
+    PyObject *py_rows = NULL;
+
+    if (self->n_cols == 0 || self->columns[0].length == 0) {
+        py_rows = PyList_New(0);
+        if (!py_rows) goto error;
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            ColumnBuffer_reset(&self->columns[i]);
+        }
+    } else {
+        py_columns = PyList_New(self->n_cols);
+        if (!py_columns) goto error;
+
+        for (unsigned long i = 0; i < self->n_cols; i++) {
+            PyObject *py_column = ColumnBuffer_finish(&self->columns[i]);
+            if (!py_column) goto error;
+            CHECKRC(PyList_SetItem(py_columns, i, py_column));
+        }
+
+        py_rows = PyObject_CallFunctionObjArgs(PyFunc.columnar_rows,
+                                               self->py_names_list, py_columns, NULL);
+        if (!py_rows) goto error;
+    }
+
+    Py_XDECREF(self->py_rows);
+    self->py_rows = py_rows;
+    py_rows = NULL;
+
+    rc = PyObject_SetAttr(py_res, PyStr.rows, self->py_rows);
+
+exit:
+    Py_XDECREF(py_columns);
+    Py_XDECREF(py_rows);
+    return rc;
+
+error:
+    rc = -1;
+    goto exit;
+}
+
+//
+// Hand unconsumed bytes in the receive buffer and the packet sequence
+// number back to the connection so that the next reader (Python or C)
+// continues where this one stopped.
+//
+static int State_release_buffer(StateObject *self) {
+    int rc = 0;
+    PyObject *py_rbuf = NULL;
+    PyObject *py_next_seq_id = NULL;
+
+    if (!self->py_conn) goto exit;
+
+    // The socket is handed back too, so the read-ahead thread must stop.
+    if (State_stop_prefetch(self)) { rc = -1; goto exit; }
+
+    py_next_seq_id = PyLong_FromUnsignedLongLong(self->next_seq_id);
+    if (!py_next_seq_id) { rc = -1; goto exit; }
+    rc = PyObject_SetAttr(self->py_conn, PyStr._next_seq_id, py_next_seq_id);
+    Py_DECREF(py_next_seq_id);
+    if (rc || self->recv_buff_pos >= self->recv_buff_end) goto exit;
+
+    py_rbuf = PyBytes_FromStringAndSize(self->recv_buff + self->recv_buff_pos,
+                                        self->recv_buff_end - self->recv_buff_pos);
+    if (!py_rbuf) { rc = -1; goto exit; }
+
+    rc = PyObject_SetAttr(self->py_conn, PyStr._rbuf, py_rbuf);
+    if (!rc) rc = PyObject_SetAttr(self->py_conn, PyStr._rbuf_pos, PyObj.zero);
+
+exit:
+    self->recv_buff_pos = 0;
+    self->recv_buff_end = 0;
+    Py_XDECREF(py_rbuf);
+    return rc;
+}
+
+static PyObject *State_release_buffer_method(StateObject *self, PyObject *args) {
+    if (State_release_buffer(self)) return NULL;
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef StateType_methods[] = {
+    {"release_buffer", (PyCFunction)State_release_buffer_method, METH_NOARGS,
+     "Return bytes read ahead from the socket to the connection"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot StateType_slots[] = {
+    {Py_tp_init, (initproc)State_init},
+    {Py_tp_dealloc, (destructor)State_dealloc},
+    {Py_tp_methods, StateType_methods},
+    {Py_tp_doc, "PyMySQL accelerator"},
+    {0, NULL},
+};
+
+static PyType_Spec StateType_spec = {
+    .name = ACCEL_STR(ACCEL_MODULE_NAME) ".State",
+    .basicsize = sizeof(StateObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE,
+    .slots = StateType_slots,
+};
+
+//
+// End State
+//
+
+static int read_options(MySQLAccelOptions *options, PyObject *dict) {
+    if (!options || !dict) return 0;
+
+    PyObject *key = NULL;
+    PyObject *value = NULL;
+    Py_ssize_t pos = 0;
+    int rc = 0;
+
+    while (PyDict_Next(dict, &pos, &key, &value)) {
+        if (PyUnicode_CompareWithASCIIString(key, "results_type") == 0) {
+            if (PyUnicode_CompareWithASCIIString(value, "dict") == 0 ||
+                PyUnicode_CompareWithASCIIString(value, "dicts") == 0 ) {
+                options->results_type = ACCEL_OUT_DICTS;
+            }
+            else if (PyUnicode_CompareWithASCIIString(value, "namedtuple") == 0 ||
+                     PyUnicode_CompareWithASCIIString(value, "namedtuples") == 0) {
+                options->results_type = ACCEL_OUT_NAMEDTUPLES;
+            }
+            else if (PyUnicode_CompareWithASCIIString(value, "structsequence") == 0 ||
+                     PyUnicode_CompareWithASCIIString(value, "structsequences") == 0) {
+                options->results_type = ACCEL_OUT_STRUCTSEQUENCES;
+            }
+            else if (PyUnicode_CompareWithASCIIString(value, "numpy") == 0) {
+                options->results_type = ACCEL_OUT_NUMPY;
+                rc = ensure_numpy();
+            }
+            else if (PyUnicode_CompareWithASCIIString(value, "pandas") == 0) {
+                options->results_type = ACCEL_OUT_PANDAS;
+                rc = ensure_pandas();
+            }
+            else if (PyUnicode_CompareWithASCIIString(value, "polars") == 0) {
+                options->results_type = ACCEL_OUT_POLARS;
+                rc = ensure_polars();
+            }
+            else if (PyUnicode_CompareWithASCIIString(value, "lazyrow") == 0 ||
+                     PyUnicode_CompareWithASCIIString(value, "lazyrows") == 0) {
+                options->results_type = ACCEL_OUT_LAZYROWS;
+            }
+            else if (PyUnicode_CompareWithASCIIString(value, "arrow") == 0 ||
+                     PyUnicode_CompareWithASCIIString(value, "pyarrow") == 0) {
+                options->results_type = ACCEL_OUT_ARROW;
+                rc = ensure_pyarrow();
+            }
+            else {
+                options->results_type = ACCEL_OUT_TUPLES;
+            }
+        } else if (PyUnicode_CompareWithASCIIString(key, "parse_json") == 0) {
+            options->parse_json = PyObject_IsTrue(value);
+        } else if (PyUnicode_CompareWithASCIIString(key, "binary_protocol") == 0) {
+            options->binary_protocol = PyObject_IsTrue(value);
+        } else if (PyUnicode_CompareWithASCIIString(key, "decimal_type") == 0) {
+            if (!PyUnicode_Check(value)) {
+                options->decimal_type = ACCEL_DECIMAL_DECIMAL;
+            } else if (PyUnicode_CompareWithASCIIString(value, "float") == 0) {
+                options->decimal_type = ACCEL_DECIMAL_FLOAT;
+            } else if (PyUnicode_CompareWithASCIIString(value, "scaled_int") == 0) {
+                options->decimal_type = ACCEL_DECIMAL_SCALED_INT;
+            } else {
+                options->decimal_type = ACCEL_DECIMAL_DECIMAL;
+            }
+        } else if (PyUnicode_CompareWithASCIIString(key, "contiguous_vectors") == 0) {
+            options->contiguous_vectors = PyObject_IsTrue(value);
+        } else if (PyUnicode_CompareWithASCIIString(key, "lazy_bson") == 0) {
+            options->lazy_bson = PyObject_IsTrue(value);
+        } else if (PyUnicode_CompareWithASCIIString(key, "prefetch_bytes") == 0) {
+            options->prefetch_bytes = PyLong_Check(value) ?
+                                      PyLong_AsUnsignedLongLong(value) : 0;
+            if (PyErr_Occurred()) {
+                PyErr_Clear();
+                options->prefetch_bytes = 0;
+            }
+        } else if (PyUnicode_CompareWithASCIIString(key, "invalid_values") == 0) {
+            if (PyDict_Check(value)) {
+                options->invalid_values = value;
+            }
+        }
+    }
+
+    return rc;
+}
+
+static void raise_exception(
+    PyObject *self,
+    char *err_type,
+    unsigned long long err_code,
+    char *err_str
+) {
+    PyObject *py_exc = NULL;
+    PyObject *py_val = NULL;
+
+    py_exc = PyObject_GetAttrString(self, err_type);
+    if (!py_exc) goto error;
+
+    py_val = Py_BuildValue("(Ks)", err_code, err_str);
+    if (!py_val) goto error;
+
+    PyErr_SetObject(py_exc, py_val);
+
+exit:
+    if (py_exc) { Py_DECREF(py_exc); }
+    if (py_val) { Py_DECREF(py_val); }
+    return;
+
+error:
+    goto exit;
+}
+
+static int is_error_packet(char *buff_bytes) {
+    return buff_bytes && *(uint8_t*)buff_bytes == 0xFF;
+}
+
+static void force_close(PyObject *py_conn) {
+    PyObject *py_sock = NULL;
+
+    py_sock = PyObject_GetAttr(py_conn, PyStr._sock);
+    if (!py_sock) goto error;
+
+    Py_XDECREF(PyObject_CallMethod(py_sock, "close", NULL));
+    PyErr_Clear();
+
+    PyObject_SetAttr(py_conn, PyStr._sock, Py_None);
+    PyObject_SetAttr(py_conn, PyStr._rfile, Py_None);
+
+exit:
+    Py_XDECREF(py_sock);
+    return;
+
+error:
+    goto exit;
+}
+
+static void raise_lost_connection(StateObject *py_state) {
+    force_close(py_state->py_conn);
+    raise_exception(py_state->py_conn, "OperationalError", 0,
+                    "Lost connection to SingleStoreDB server during query");
+}
+
+//
+// Make sure at least `num_bytes` unread bytes are in the receive buffer.
+//
+// Data is received in large chunks using the socket file's readinto1 method,
+// so a single call typically pulls in many packets. Unread bytes are moved
+// to the front of the buffer before receiving more, and the buffer is grown
+// if a packet does not fit.
+//
+static int fill_recv_buff(StateObject *py_state, unsigned long long num_bytes) {
+    PyObject *py_memview = NULL;
+    PyObject *py_n_bytes = NULL;
+    PyObject *py_data = NULL;
+    unsigned long long avail = py_state->recv_buff_end - py_state->recv_buff_pos;
+    Py_ssize_t n_recv = 0;
+
+    if (avail >= num_bytes) return 0;
+
+    if (py_state->recv_buff_pos + num_bytes > py_state->recv_buff_size) {
+        if (avail) {
+            memmove(py_state->recv_buff, py_state->recv_buff + py_state->recv_buff_pos, avail);
+        }
+        py_state->recv_buff_pos = 0;
+        py_state->recv_buff_end = avail;
+
+        if (num_bytes > py_state->recv_buff_size) {
+            unsigned long long new_size = py_state->recv_buff_size * 2;
+            if (new_size < num_bytes) new_size = num_bytes;
+            char *new_buff = realloc(py_state->recv_buff, new_size + 1);
+            if (!new_buff) { PyErr_NoMemory(); goto error; }
+            py_state->recv_buff = new_buff;
+            py_state->recv_buff_size = new_size;
+        }
+    }
+
+    if (!py_state->prefetch && py_state->py_read_timeout
+            && py_state->py_read_timeout != Py_None) {
+        Py_XDECREF(PyObject_CallFunctionObjArgs(py_state->py_settimeout,
+                                                py_state->py_read_timeout, NULL));
+        if (PyErr_Occurred()) goto error;
+    }
+
+    while (py_state->recv_buff_end - py_state->recv_buff_pos < num_bytes) {
+        if (py_state->prefetch) {
+            Prefetch *p = py_state->prefetch;
+            n_recv = (Py_ssize_t)Prefetch_take(p, py_state->recv_buff + py_state->recv_buff_end,
+                                               py_state->recv_buff_size - py_state->recv_buff_end);
+            if (n_recv == 0 && p->py_err_type) {
+                PyErr_Restore(p->py_err_type, p->py_err_value, p->py_err_tb);
+                p->py_err_type = p->py_err_value = p->py_err_tb = NULL;
+            } else if (n_recv == 0) {
+                // The thread stopped without an error before the data was
+                // complete; read the rest from the socket directly.
+                if (State_stop_prefetch(py_state)) goto error;
+                continue;
+            }
+        } else if (py_state->py_readinto1) {
+            py_memview = PyMemoryView_FromMemory(
+                py_state->recv_buff + py_state->recv_buff_end,
+                py_state->recv_buff_size - py_state->recv_buff_end,
+                PyBUF_WRITE
+            );
+            if (!py_memview) goto error;
+            py_data = PyObject_CallFunctionObjArgs(py_state->py_readinto1, py_memview, NULL);
+            Py_CLEAR(py_memview);
+            if (py_data) {
+                n_recv = PyLong_AsSsize_t(py_data);
+                Py_CLEAR(py_data);
+                if (n_recv < 0 && PyErr_Occurred()) goto error;
+            }
+        } else {
+            py_n_bytes = PyLong_FromUnsignedLongLong(
+                num_bytes - (py_state->recv_buff_end - py_state->recv_buff_pos));
+            if (!py_n_bytes) goto error;
+            py_data = PyObject_CallFunctionObjArgs(py_state->py_read, py_n_bytes, NULL);
+            Py_CLEAR(py_n_bytes);
+            if (py_data) {
+                if (!PyBytes_Check(py_data)) {
+                    PyErr_SetString(PyExc_TypeError, "socket read did not return bytes");
+                    goto error;
+                }
+                n_recv = PyBytes_Size(py_data);
+                memcpy(py_state->recv_buff + py_state->recv_buff_end,
+                       PyBytes_AsString(py_data), n_recv);
+                Py_CLEAR(py_data);
+            }
+        }
+
+        if (PyErr_Occurred()) {
+            if (PyErr_ExceptionMatches(PyExc_OSError)) {
+                PyObject *py_exc_type = NULL;
+                PyObject *py_exc_value = NULL;
+                PyObject *py_exc_tb = NULL;
+                PyErr_Fetch(&py_exc_type, &py_exc_value, &py_exc_tb);
+                PyErr_NormalizeException(&py_exc_type, &py_exc_value, &py_exc_tb);
+                PyObject *py_errno = (py_exc_value) ?
+                                     PyObject_GetAttr(py_exc_value, PyStr.x_errno) : NULL;
+                long err = (py_errno && py_errno != Py_None) ? PyLong_AsLong(py_errno) : 0;
+                Py_XDECREF(py_errno);
+                Py_XDECREF(py_exc_type);
+                Py_XDECREF(py_exc_value);
+                Py_XDECREF(py_exc_tb);
+                PyErr_Clear();
+
+                if (err == 4 /* errno.EINTR */) {
+                    continue;
+                }
+
+                raise_lost_connection(py_state);
+                goto error;
+            }
+
+            // Don't convert unknown exception to MySQLError.
+            force_close(py_state->py_conn);
+            goto error;
+        }
+
+        if (n_recv <= 0) {
+            raise_lost_connection(py_state);
+            goto error;
+        }
+
+        py_state->recv_buff_end += n_recv;
+    }
+
+    return 0;
+
+error:
+    Py_XDECREF(py_memview);
+    Py_XDECREF(py_n_bytes);
+    Py_XDECREF(py_data);
+    return -1;
+}
+
+//
+// Read the next logical packet and return a pointer into the receive buffer.
+//
+// The returned data is only valid until the next read from the socket. Rows
+// that span several 16MB packets are assembled in a reusable bytearray
+// instead, since their pieces are not contiguous in the receive buffer.
+//
+static int read_packet(StateObject *py_state, char **data, unsigned long long *data_l) {
+    unsigned long long bytes_to_read = 0;
+    unsigned long long buff_l = 0;
+    uint8_t *header = NULL;
+    uint8_t packet_number = 0;
+    char *chunk = NULL;
+    int is_multi_packet = 0;
+    PyObject *py_err_packet = NULL;
+
+    if (py_state->options.prefetch_bytes && py_state->unbuffered && !py_state->is_eof) {
+        CHECKRC(State_start_prefetch(py_state));
+    }
+
+    while (1) {
+        CHECKRC(fill_recv_buff(py_state, 4));
+
+        header = (uint8_t*)(py_state->recv_buff + py_state->recv_buff_pos);
+        bytes_to_read = header[0] + (header[1] << 8) + (header[2] << 16);
+        packet_number = header[3];
+
+        if (packet_number != py_state->next_seq_id) {
+            force_close(py_state->py_conn);
+            if (packet_number == 0) {
+                raise_exception(py_state->py_conn, "OperationalError", 0,
+                                "Lost connection to SingleStoreDB server during query");
+
+                goto error;
+            }
+            raise_exception(py_state->py_conn, "InternalError", 0,
+                            "Packet sequence number wrong");
+            goto error;
+        }
+
+        py_state->next_seq_id = (py_state->next_seq_id + 1) % 256;
+        py_state->recv_buff_pos += 4;
+
+        CHECKRC(fill_recv_buff(py_state, bytes_to_read));
+
+        chunk = py_state->recv_buff + py_state->recv_buff_pos;
+        py_state->recv_buff_pos += bytes_to_read;
+
+        // https://dev.mysql.com/doc/internals/en/sending-more-than-16mbyte.html
+        if (!is_multi_packet && bytes_to_read < MYSQL_MAX_PACKET_LEN) {
+            *data = chunk;
+            *data_l = bytes_to_read;
+            break;
+        }
+
+        if (!is_multi_packet) {
+            is_multi_packet = 1;
+            if (!py_state->py_large_packet) {
+                py_state->py_large_packet = PyByteArray_FromStringAndSize(NULL, 0);
+                if (!py_state->py_large_packet) goto error;
+            }
+        }
+
+        CHECKRC(PyByteArray_Resize(py_state->py_large_packet, buff_l + bytes_to_read));
+        memcpy(PyByteArray_AsString(py_state->py_large_packet) + buff_l, chunk, bytes_to_read);
+        buff_l += bytes_to_read;
+
+        if (bytes_to_read < MYSQL_MAX_PACKET_LEN) {
+            *data = PyByteArray_AsString(py_state->py_large_packet);
+            *data_l = buff_l;
+            break;
+        }
+    }
+
+    if (*data_l && is_error_packet(*data)) {
+        py_err_packet = PyBytes_FromStringAndSize(*data, *data_l);
+        State_release_buffer(py_state);
+        if (!py_err_packet) goto error;
+        PyObject *py_result = PyObject_GetAttr(py_state->py_conn, PyStr._result);
+        if (py_result && py_result != Py_None) {
+            PyObject *py_unbuffered_active = PyObject_GetAttr(py_result, PyStr.unbuffered_active);
+            if (py_unbuffered_active == Py_True) {
+                PyObject_SetAttr(py_result, PyStr.unbuffered_active, Py_False);
+            }
+            Py_XDECREF(py_unbuffered_active);
+        }
+        Py_XDECREF(py_result);
+        Py_XDECREF(PyObject_CallMethod(py_state->py_conn, "_raise_mysql_exception",
+                                       "O", py_err_packet, NULL));
+        goto error;
+    }
+
+    return 0;
+
+error:
+    Py_XDECREF(py_err_packet);
+    *data = NULL;
+    *data_l = 0;
+    return -1;
+}
+
+static int is_eof_packet(char *data, unsigned long long data_l) {
+    return data && data_l > 0 && (uint8_t)*(uint8_t*)data == 0xFE && data_l < 9;
+}
+
+static int check_packet_is_eof(
+    char **data,
+    unsigned long long *data_l,
+    unsigned long long *warning_count,
+    int *has_next
+) {
+    uint16_t server_status = 0;
+    if (!data || !data_l) {
+        if (has_next) *has_next = 0;
+        if (warning_count) *warning_count = 0;
+        return 0;
+    }
+    if (!is_eof_packet(*data, *data_l)) {
+        return 0;
+    }
+    *data += 1; *data_l -= 1;
+    if (warning_count) *warning_count = **(uint16_t**)data;
+    *data += 2; *data_l -= 2;
+    server_status = **(uint16_t**)data;
+    *data += 2; *data_l -= 2;
+    if (has_next) *has_next = server_status & MYSQL_SERVER_MORE_RESULTS_EXISTS;
+    return 1;
+}
+
+static unsigned long long read_length_encoded_integer(
+    char **data,
+    unsigned long long *data_l,
+    int *is_null
+) {
+    if (is_null) *is_null = 0;
+
+    if (!data || !data_l || *data_l == 0) {
+        if (is_null) *is_null = 1;
+        return 0;
+    }
+
+    uint8_t c = **(uint8_t**)data;
+    *data += 1; *data_l -= 1;
+
+    if (c == MYSQL_COLUMN_NULL) {
+        if (is_null) *is_null = 1;
+        return 0;
+    }
+
+    if (c < MYSQL_COLUMN_UNSIGNED_CHAR) {
+        return c;
+    }
+
+    if (c == MYSQL_COLUMN_UNSIGNED_SHORT) {
+        if (*data_l < 2) {
+            if (is_null) *is_null = 1;
+            return 0;
+        }
+        uint16_t out = **(uint16_t**)data;
+        *data += 2; *data_l -= 2;
+        return out;
+    }
+
+    if (c == MYSQL_COLUMN_UNSIGNED_INT24) {
+        if (*data_l < 3) {
+            if (is_null) *is_null = 1;
+            return 0;
+        }
+        uint16_t low = **(uint8_t**)data;
+        *data += 1; *data_l -= 1;
+        uint16_t high = **(uint16_t**)data;
+        *data += 2; *data_l -= 2;
+        return low + (high << 16);
+    }
+
+    if (c == MYSQL_COLUMN_UNSIGNED_INT64) {
+        if (*data_l < 8) {
+            if (is_null) *is_null = 1;
+            return 0;
+        }
+        uint64_t out = **(uint64_t**)data;
+        *data += 8; *data_l -= 8;
+        return out;
+    }
+
+    if (is_null) *is_null = 1;
+    return 0;
+}
+
+static void read_length_coded_string(
+    char **data,
+    unsigned long long *data_l,
+    char **out,
+    unsigned long long *out_l,
+    int *is_null
+) {
+    if (is_null) *is_null = 0;
+
+    if (!data || !data_l || !out || !out_l) {
+        if (is_null) *is_null = 1;
+        return;
+    }
+
+    unsigned long long length = read_length_encoded_integer(data, data_l, is_null);
+
+    if (is_null && *is_null) {
+        // Leave a valid (empty) cell so callers can peek past it.
+        *out = *data;
+        *out_l = 0;
+        return;
+    }
+
+    length = (length > *data_l) ? *data_l : length;
+
+    *out = *data;
+    *out_l = length;
+
+    *data += length;
+    *data_l -= length;
+
+    return;
+}
+
+#ifdef Py_LIMITED_API
+
+static PyObject *PyDate_FromDate(
+    StateObject *py_state,
+    int year,
+    int month,
+    int day
+) {
+    PyObject *out = NULL;
+    PyObject *py_year = PyLong_FromCachedLong(year);
+    PyObject *py_month = PyLong_FromCachedLong(month);
+    PyObject *py_day = PyLong_FromCachedLong(day);
+
+    if (py_year && py_month && py_day) {
+        out = PyObject_CallFunctionObjArgs(
+            PyFunc.datetime_date, py_year, py_month, py_day, NULL
+        );
+    }
+
+    Py_XDECREF(py_year);
+    Py_XDECREF(py_month);
+    Py_XDECREF(py_day);
+
+    return out;
+}
+
+static PyObject *PyDelta_FromDSU(
+    StateObject *py_state,
+    int days,
+    int seconds,
+    int microseconds
+) {
+    PyObject *out = NULL;
+    PyObject *py_days = PyLong_FromCachedLong(days);
+    PyObject *py_seconds = PyLong_FromCachedLong(seconds);
+    PyObject *py_microseconds = PyLong_FromCachedLong(microseconds);
+
+    if (py_days && py_seconds && py_microseconds) {
+        out = PyObject_CallFunctionObjArgs(
+            PyFunc.datetime_timedelta, py_days, py_seconds, py_microseconds, NULL
+        );
+    }
+
+    Py_XDECREF(py_days);
+    Py_XDECREF(py_seconds);
+    Py_XDECREF(py_microseconds);
+
+    return out;
+}
+
+static PyObject *PyDateTime_FromDateAndTime(
+    StateObject *py_state,
+    int year,
+    int month,
+    int day,
+    int hour,
+    int minute,
+    int second,
+    int microsecond
+) {
+    PyObject *out = NULL;
+    PyObject *py_args[7] = {
+        PyLong_FromCachedLong(year),
+        PyLong_FromCachedLong(month),
+        PyLong_FromCachedLong(day),
+        PyLong_FromCachedLong(hour),
+        PyLong_FromCachedLong(minute),
+        PyLong_FromCachedLong(second),
+        PyLong_FromCachedLong(microsecond),
+    };
+
+    for (int i = 0; i < 7; i++) {
+        if (!py_args[i]) goto exit;
+    }
+
+    out = PyObject_CallFunctionObjArgs(
+        PyFunc.datetime_datetime, py_args[0], py_args[1], py_args[2],
+        py_args[3], py_args[4], py_args[5], py_args[6], NULL
+    );
+
+exit:
+    for (int i = 0; i < 7; i++) {
+        Py_XDECREF(py_args[i]);
+    }
+
+    return out;
+}
+
+#endif
+
+//
+// Return a date object, reusing objects created for recent rows.
+//
+static PyObject *get_date(StateObject *py_state, int year, int month, int day) {
+    int32_t key = (year * 16 + month) * 32 + day;
+    DateMemo *memo = &py_state->date_memo[(key ^ (key >> 9)) & (ACCEL_DATE_MEMO_SIZE - 1)];
+    PyObject *out = NULL;
+
+    if (memo->py_value && memo->key == key) {
+        Py_INCREF(memo->py_value);
+        return memo->py_value;
+    }
+
+    out = PyDate_FromDate(
+#ifdef Py_LIMITED_API
+              py_state,
+#endif
+              year, month, day);
+    if (!out) return NULL;
+
+    Py_INCREF(out);
+    Py_XDECREF(memo->py_value);
+    memo->py_value = out;
+    memo->key = key;
+
+    return out;
+}
+
+//
+// Return a new reference to the memoized object if a temporal cell repeats
+// the previous one in its column.
+//
+static inline PyObject *TemporalMemo_get(TemporalMemo *memo, char *s, unsigned long long s_l) {
+    if (!memo->py_value || memo->text_l != s_l || memcmp(memo->text, s, s_l) != 0) {
+        return NULL;
+    }
+    Py_INCREF(memo->py_value);
+    return memo->py_value;
+}
+
+static inline void TemporalMemo_set(
+    TemporalMemo *memo,
+    char *s,
+    unsigned long long s_l,
+    PyObject *py_value
+) {
+    if (s_l > sizeof(memo->text)) return;
+    Py_INCREF(py_value);
+    Py_XDECREF(memo->py_value);
+    memo->py_value = py_value;
+    memcpy(memo->text, s, s_l);
+    memo->text_l = (unsigned char)s_l;
+}
+
+//
+// Days since 1970-01-01 for a proleptic Gregorian date.
+//
+static int64_t days_from_civil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t yoe = year - era * 400;
+    int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+//
+// Proleptic Gregorian date of a number of days since 1970-01-01.
+//
+static void civil_from_days(int64_t days, int *year, int *month, int *day) {
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t doe = days - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    *day = (int)(doy - (153 * mp + 2) / 5 + 1);
+    *month = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = (int)(yoe + era * 400 + (*month <= 2));
+}
+
+static int is_valid_date(int year, int month, int day) {
+    static const int month_days[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (year < 1 || month < 1 || month > 12 || day < 1) return 0;
+    if (day > month_days[month - 1]) return 0;
+    if (month == 2 && day == 29) {
+        return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    }
+    return 1;
+}
+
+#if defined(_WIN32) || (defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define ACCEL_LITTLE_ENDIAN 1
+#endif
+
+//
+// Numeric text parsers.
+//
+// These work on (ptr, len) cells without writing a terminator into the
+// receive buffer. Anything unusual (whitespace, '+', overflow, hex floats,
+// more digits than fit the fast path) is handed to strtoll / strtoull /
+// strtod on a terminated copy, so results always match the C library.
+//
+
+// Copy a cell into a terminated buffer (the stack buffer if it fits).
+static char *terminated_copy(
+    const char *s,
+    unsigned long long s_l,
+    char *stack,
+    size_t stack_l
+) {
+    char *buf = (s_l < stack_l) ? stack : malloc(s_l + 1);
+    if (!buf) return NULL;
+    memcpy(buf, s, s_l);
+    buf[s_l] = '\0';
+    return buf;
+}
+
+static long long strtoll_copy(const char *s, unsigned long long s_l) {
+    char stack[64];
+    char *buf = terminated_copy(s, s_l, stack, sizeof(stack));
+    if (!buf) return 0;
+    long long out = strtoll(buf, NULL, 10);
+    if (buf != stack) free(buf);
+    return out;
+}
+
+static unsigned long long strtoull_copy(const char *s, unsigned long long s_l) {
+    char stack[64];
+    char *buf = terminated_copy(s, s_l, stack, sizeof(stack));
+    if (!buf) return 0;
+    unsigned long long out = strtoull(buf, NULL, 10);
+    if (buf != stack) free(buf);
+    return out;
+}
+
+static double strtod_copy(const char *s, unsigned long long s_l) {
+    char stack[64];
+    char *buf = terminated_copy(s, s_l, stack, sizeof(stack));
+    if (!buf) return 0.0;
+    double out = strtod(buf, NULL);
+    if (buf != stack) free(buf);
+    return out;
+}
+
+//
+// Accumulate up to 20 decimal digits into *acc. Returns the number of digits
+// read; stops early at a non-digit. Eight digits at a time are converted
+// with SWAR arithmetic on little-endian machines.
+//
+static inline unsigned long long read_digits(
+    const char *s,
+    unsigned long long s_l,
+    uint64_t *acc
+) {
+    unsigned long long i = 0;
+    uint64_t v = *acc;
+#ifdef ACCEL_LITTLE_ENDIAN
+    while (s_l - i >= 8) {
+        uint64_t chunk;
+        memcpy(&chunk, s + i, 8);
+        // All eight bytes are '0'..'9'
+        if ((((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+              (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4))
+             != 0x3333333333333333ULL)) break;
+        // Only 20 digits fit a uint64; leave the rest to the caller.
+        if (i + 8 > 20) break;
+        chunk -= 0x3030303030303030ULL;
+        chunk = (chunk * 10) + (chunk >> 8);
+        chunk = (((chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+                 (((chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+        v = v * 100000000ULL + chunk;
+        i += 8;
+    }
+#endif
+    for (; i < s_l && i < 20; i++) {
+        unsigned int d = (unsigned char)s[i] - '0';
+        if (d > 9) break;
+        v = v * 10 + d;
+    }
+    *acc = v;
+    return i;
+}
+
+// Parse a base-10 integer cell. Out-of-range values saturate like strtoll.
+static int64_t parse_int64(const char *s, unsigned long long s_l) {
+    uint64_t v = 0;
+    unsigned long long i = 0;
+    int negative = 0;
+    if (s_l && s[0] == '-') { negative = 1; i = 1; }
+    unsigned long long n = read_digits(s + i, s_l - i, &v);
+    if (n == 0 || n > 19 || i + n != s_l) return strtoll_copy(s, s_l);
+    if (negative) {
+        if (v > (uint64_t)INT64_MAX + 1) return INT64_MIN;
+        return (int64_t)(0 - v);
+    }
+    if (v > (uint64_t)INT64_MAX) return INT64_MAX;
+    return (int64_t)v;
+}
+
+// Parse an unsigned base-10 integer cell.
+static uint64_t parse_uint64(const char *s, unsigned long long s_l) {
+    uint64_t v = 0;
+    unsigned long long n = read_digits(s, s_l, &v);
+    // 20 digits may have wrapped around
+    if (n == 0 || n > 19 || n != s_l) return strtoull_copy(s, s_l);
+    return v;
+}
+
+//
+// Eisel-Lemire conversion of w * 10^q to a double (Lemire, "Number Parsing
+// at a Gigabyte per Second", 2021). POWERS_OF_FIVE_128 holds 5^q for
+// q = -342..308 as (high, low) pairs: the value normalized so that bit 127
+// is set and truncated to 128 bits, with negative powers rounded up from
+// 2^b / 5^-q. This is the same table fast_float and Go's strconv use.
+//
+
+#define ACCEL_POW10_MIN -342
+#define ACCEL_POW10_MAX 308
+
+static const uint64_t POWERS_OF_FIVE_128[] = {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL,
+    0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL,
+    0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL,
+    0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL,
+    0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL,
+    0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL,
+    0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL,
+    0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL,
+    0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL,
+    0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL,
+    0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL,
+    0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL,
+    0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL,
+    0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL,
+    0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL,
+    0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL,
+    0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL,
+    0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL,
+    0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL,
+    0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL,
+    0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL,
+    0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL,
+    0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL,
+    0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL,
+    0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL,
+    0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL,
+    0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL,
+    0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL,
+    0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL,
+    0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL,
+    0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL,
+    0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL,
+    0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL,
+    0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL,
+    0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL,
+    0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL,
+    0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL,
+    0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL,
+    0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL,
+    0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL,
+    0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL,
+    0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL,
+    0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL,
+    0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL,
+    0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL,
+    0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL,
+    0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL,
+    0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL,
+    0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL,
+    0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL,
+    0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL,
+    0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL,
+    0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL,
+    0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL,
+    0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL,
+    0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL,
+    0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL,
+    0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL,
+    0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL,
+    0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL,
+    0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL,
+    0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL,
+    0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL,
+    0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL,
+    0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL,
+    0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL,
+    0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL,
+    0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL,
+    0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL,
+    0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL,
+    0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL,
+    0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL,
+    0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL,
+    0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL,
+    0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL,
+    0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL,
+    0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL,
+    0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL,
+    0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL,
+    0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL,
+    0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL,
+    0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL,
+    0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL,
+    0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL,
+    0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL,
+    0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL,
+    0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL,
+    0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL,
+    0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL,
+    0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL,
+    0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL,
+    0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL,
+    0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL,
+    0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL,
+    0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL,
+    0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL,
+    0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL,
+    0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL,
+    0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL,
+    0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL,
+    0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL,
+    0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL,
+    0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL,
+    0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL,
+    0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL,
+    0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL,
+    0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL,
+    0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL,
+    0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL,
+    0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL,
+    0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL,
+    0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL,
+    0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL,
+    0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL,
+    0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL,
+    0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL,
+    0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL,
+    0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL,
+    0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL,
+    0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL,
+    0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL,
+    0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL,
+    0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL,
+    0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL,
+    0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL,
+    0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL,
+    0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL,
+    0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL,
+    0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL,
+    0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL,
+    0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL,
+    0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL,
+    0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL,
+    0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL,
+    0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL,
+    0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL,
+    0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL,
+    0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL,
+    0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL,
+    0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL,
+    0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL,
+    0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL,
+    0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL,
+    0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL,
+    0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL,
+    0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL,
+    0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL,
+    0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL,
+    0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL,
+    0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL,
+    0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL,
+    0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL,
+    0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL,
+    0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL,
+    0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL,
+    0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL,
+    0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL,
+    0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL,
+    0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+    0xc612062576589ddaULL, 0x95364afe032a819eULL,
+    0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL,
+    0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL,
+    0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL,
+    0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL,
+    0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL,
+    0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL,
+    0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL,
+    0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL,
+    0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL,
+    0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL,
+    0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL,
+    0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL,
+    0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL,
+    0xa000000000000000ULL, 0x0000000000000000ULL,
+    0xc800000000000000ULL, 0x0000000000000000ULL,
+    0xfa00000000000000ULL, 0x0000000000000000ULL,
+    0x9c40000000000000ULL, 0x0000000000000000ULL,
+    0xc350000000000000ULL, 0x0000000000000000ULL,
+    0xf424000000000000ULL, 0x0000000000000000ULL,
+    0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xbebc200000000000ULL, 0x0000000000000000ULL,
+    0xee6b280000000000ULL, 0x0000000000000000ULL,
+    0x9502f90000000000ULL, 0x0000000000000000ULL,
+    0xba43b74000000000ULL, 0x0000000000000000ULL,
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL,
+    0x9184e72a00000000ULL, 0x0000000000000000ULL,
+    0xb5e620f480000000ULL, 0x0000000000000000ULL,
+    0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL,
+    0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL,
+    0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL,
+    0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+    0x878678326eac9000ULL, 0x0000000000000000ULL,
+    0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL,
+    0x84595161401484a0ULL, 0x0000000000000000ULL,
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL,
+    0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+    0x813f3978f8940984ULL, 0x4000000000000000ULL,
+    0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL,
+    0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL,
+    0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL,
+    0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL,
+    0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL,
+    0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL,
+    0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL,
+    0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL,
+    0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL,
+    0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL,
+    0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL,
+    0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL,
+    0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL,
+    0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL,
+    0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL,
+    0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL,
+    0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL,
+    0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL,
+    0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL,
+    0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL,
+    0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL,
+    0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL,
+    0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL,
+    0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL,
+    0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL,
+    0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL,
+    0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL,
+    0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL,
+    0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL,
+    0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL,
+    0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL,
+    0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL,
+    0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL,
+    0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL,
+    0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL,
+    0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL,
+    0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL,
+    0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL,
+    0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL,
+    0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL,
+    0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL,
+    0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL,
+    0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL,
+    0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL,
+    0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL,
+    0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL,
+    0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL,
+    0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL,
+    0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL,
+    0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL,
+    0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL,
+    0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL,
+    0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL,
+    0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL,
+    0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL,
+    0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL,
+    0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL,
+    0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL,
+    0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL,
+    0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL,
+    0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL,
+    0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL,
+    0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL,
+    0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL,
+    0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL,
+    0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL,
+    0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL,
+    0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL,
+    0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL,
+    0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL,
+    0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL,
+    0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL,
+    0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL,
+    0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL,
+    0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL,
+    0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL,
+    0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL,
+    0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL,
+    0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL,
+    0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL,
+    0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL,
+    0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL,
+    0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL,
+    0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL,
+    0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL,
+    0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL,
+    0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL,
+    0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL,
+    0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL,
+    0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL,
+    0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL,
+    0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL,
+    0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL,
+    0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL,
+    0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL,
+    0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL,
+    0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL,
+    0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL,
+    0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL,
+    0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL,
+    0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL,
+    0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL,
+    0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL,
+    0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL,
+    0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL,
+    0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL,
+    0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL,
+    0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL,
+    0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL,
+    0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL,
+    0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL,
+    0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL,
+    0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL,
+    0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL,
+    0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL,
+    0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL,
+    0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL,
+    0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL,
+    0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL,
+    0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL,
+    0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL,
+    0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL,
+    0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL,
+    0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL,
+    0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL,
+    0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL,
+    0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL,
+    0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL,
+    0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL,
+    0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL,
+    0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL,
+    0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL,
+    0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL,
+    0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL,
+    0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL,
+    0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL,
+    0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL,
+    0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL,
+    0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL,
+    0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL
+};
+
+// Full 64 x 64 -> 128-bit product.
+static inline void mul_64x64(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128)a * b;
+    *hi = (uint64_t)(r >> 64);
+    *lo = (uint64_t)r;
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+    uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+    *lo = (mid << 32) | (uint32_t)p0;
+    *hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+#endif
+}
+
+static inline int leading_zeros_64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & 0x8000000000000000ULL)) { x <<= 1; n++; }
+    return n;
+#endif
+}
+
+//
+// Convert a non-zero mantissa w and decimal exponent q to a double.
+// Returns -1 in the rare cases where the truncated power of five can not
+// decide the rounding, so the caller has to use a slower method.
+//
+static int eisel_lemire(uint64_t w, int64_t q, int negative, double *out) {
+    uint64_t hi = 0, lo = 0, hi2 = 0, lo2 = 0;
+    uint64_t bits = 0;
+
+    if (q < ACCEL_POW10_MIN) {
+        bits = 0;
+        goto done;
+    }
+    if (q > ACCEL_POW10_MAX) {
+        bits = 0x7FFULL << 52;
+        goto done;
+    }
+
+    int lz = leading_zeros_64(w);
+    w <<= lz;
+
+    const uint64_t *pow5 = &POWERS_OF_FIVE_128[2 * (q - ACCEL_POW10_MIN)];
+    mul_64x64(w, pow5[0], &hi, &lo);
+
+    // The low bits of the product are all ones, so they may be off by the
+    // carry from the second half of the power of five.
+    if ((hi & 0x1FF) == 0x1FF) {
+        mul_64x64(w, pow5[1], &hi2, &lo2);
+        lo += hi2;
+        if (hi2 > lo) hi++;
+        if (lo == 0xFFFFFFFFFFFFFFFFULL && (q < -27 || q > 55)) return -1;
+    }
+
+    int upperbit = (int)(hi >> 63);
+    uint64_t mantissa = hi >> (upperbit + 9);
+    int64_t power2 = (((152170 + 65536) * q) >> 16) + 63 + upperbit - lz + 1023;
+
+    if (power2 <= 0) {
+        // Subnormal
+        if (-power2 + 1 >= 64) {
+            bits = 0;
+            goto done;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += (mantissa & 1);
+        mantissa >>= 1;
+        power2 = (mantissa < (1ULL << 52)) ? 0 : 1;
+        bits = (mantissa & ((1ULL << 52) - 1)) | ((uint64_t)power2 << 52);
+        goto done;
+    }
+
+    // Exactly halfway between two doubles: round to even.
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 &&
+            (mantissa << (upperbit + 9)) == hi) {
+        mantissa &= ~1ULL;
+    }
+
+    mantissa += (mantissa & 1);
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << 52)) {
+        mantissa = 1ULL << 52;
+        power2++;
+    }
+    mantissa &= ~(1ULL << 52);
+
+    if (power2 >= 0x7FF) {
+        bits = 0x7FFULL << 52;
+        goto done;
+    }
+    bits = mantissa | ((uint64_t)power2 << 52);
+
+done:
+    if (negative) bits |= 1ULL << 63;
+    memcpy(out, &bits, 8);
+    return 0;
+}
+
+//
+// Parse a floating point cell. Decimal mantissas of up to 2^53 with a power
+// of ten up to 10^22 are exact in a double, so a single multiply or divide
+// gives the correctly rounded result (Clinger's fast path). Other values
+// with up to 19 significant digits, such as the 17 digits needed to round
+// trip a DOUBLE, use the Eisel-Lemire algorithm. Longer mantissas and the
+// rare cases Eisel-Lemire can not decide are parsed by strtod.
+//
+static double parse_double(const char *s, unsigned long long s_l) {
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+    uint64_t mantissa = 0;
+    int64_t exponent = 0;
+    unsigned long long i = 0;
+    unsigned long long n = 0;
+    unsigned long long n_digits = 0;
+    int negative = 0;
+    double out = 0.0;
+
+    if (s_l && s[0] == '-') { negative = 1; i = 1; }
+
+    n = read_digits(s + i, s_l - i, &mantissa);
+    n_digits = n;
+    i += n;
+
+    if (i < s_l && s[i] == '.') {
+        i++;
+        n = read_digits(s + i, s_l - i, &mantissa);
+        n_digits += n;
+        exponent -= (int64_t)n;
+        i += n;
+    }
+
+    if (n_digits == 0 || n_digits > 19) goto slow;
+
+    if (i < s_l && (s[i] == 'e' || s[i] == 'E')) {
+        int exp_negative = 0;
+        int64_t exp_value = 0;
+        i++;
+        if (i < s_l && (s[i] == '-' || s[i] == '+')) { exp_negative = (s[i] == '-'); i++; }
+        if (i == s_l || s_l - i > 4) goto slow;
+        for (; i < s_l; i++) {
+            unsigned int d = (unsigned char)s[i] - '0';
+            if (d > 9) goto slow;
+            exp_value = exp_value * 10 + d;
+        }
+        exponent += exp_negative ? -exp_value : exp_value;
+    }
+
+    if (i != s_l) goto slow;
+
+    if (mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        out = (double)mantissa;
+        out = (exponent < 0) ? out / powers[-exponent] : out * powers[exponent];
+        return negative ? -out : out;
+    }
+
+    if (mantissa == 0) return negative ? -0.0 : 0.0;
+    if (eisel_lemire(mantissa, exponent, negative, &out) == 0) return out;
+
+slow:
+#endif
+    (void)powers;
+    return strtod_copy(s, s_l);
+}
+
+//
+// Parse DECIMAL text into the magnitude of its unscaled value with `scale`
+// fraction digits, e.g. "-12.5" with a scale of 2 is 1250 (negative).
+// The magnitude is returned as two 64-bit halves. Returns -1 if the text
+// is not a plain decimal number or needs more than 38 digits.
+//
+static int parse_decimal_unscaled(
+    const char *s,
+    unsigned long long s_l,
+    int scale,
+    uint64_t *hi,
+    uint64_t *lo,
+    int *negative
+) {
+    unsigned long long i = 0;
+    int n_digits = 0;
+    int n_fraction = -1;
+
+    *hi = 0;
+    *lo = 0;
+    *negative = 0;
+
+    if (s_l && (s[0] == '-' || s[0] == '+')) { *negative = (s[0] == '-'); i = 1; }
+    if (i == s_l) return -1;
+
+    while (1) {
+        unsigned int d = 0;
+        if (i >= s_l) {
+            // Pad the fraction out to the column scale.
+            if (n_fraction < 0) n_fraction = 0;
+            if (n_fraction >= scale) break;
+            n_fraction++;
+        } else if (s[i] == '.') {
+            if (n_fraction >= 0) return -1;
+            n_fraction = 0;
+            i++;
+            continue;
+        } else {
+            d = (unsigned char)s[i++] - '0';
+            if (d > 9) return -1;
+            if (n_fraction >= 0 && ++n_fraction > scale) return -1;
+        }
+        if (*hi == 0 && *lo == 0 && d == 0) continue;
+        if (++n_digits > 38) return -1;
+        // (hi, lo) = (hi, lo) * 10 + d
+        uint64_t low = (*lo & 0xFFFFFFFFULL) * 10 + d;
+        uint64_t high = (*lo >> 32) * 10 + (low >> 32);
+        *lo = (high << 32) | (low & 0xFFFFFFFFULL);
+        *hi = *hi * 10 + (high >> 32);
+    }
+
+    return 0;
+}
+
+//
+// Parse an optional ".f" to ".ffffff" fraction into microseconds.
+// Returns -1 if the text is not a fraction.
+//
+static int64_t parse_fraction_micros(char *s, unsigned long long s_l) {
+    int64_t out = 0;
+    unsigned long long i = 1;
+    if (s_l == 0) return 0;
+    if (s[0] != '.' || s_l < 2 || s_l > 7) return -1;
+    for (; i < s_l; i++) {
+        if (s[i] < '0' || s[i] > '9') return -1;
+        out = out * 10 + (s[i] - '0');
+    }
+    for (; i < 7; i++) out *= 10;
+    return out;
+}
+
+// Parse "YYYY-MM-DD" into days since the epoch. Returns 0 on success.
+static int parse_date_days(char *s, unsigned long long s_l, int64_t *out) {
+    if (s_l != 10 || !CHECK_DATE_STR(s, 10)) return -1;
+    int year = CHR2INT4(s), month = CHR2INT2(s + 5), day = CHR2INT2(s + 8);
+    if (!is_valid_date(year, month, day)) return -1;
+    *out = days_from_civil(year, month, day);
+    return 0;
+}
+
+// Parse "YYYY-MM-DD hh:mm:ss[.ffffff]" into microseconds since the epoch.
+static int parse_datetime_micros(char *s, unsigned long long s_l, int64_t *out) {
+    int64_t days = 0;
+    int64_t micros = 0;
+    if (s_l < 19 || parse_date_days(s, 10, &days) < 0) return -1;
+    if ((s[10] != ' ' && s[10] != 'T') || !CHECK_TIME_STR(s + 11, 8)) return -1;
+    micros = parse_fraction_micros(s + 19, s_l - 19);
+    if (micros < 0) return -1;
+    *out = ((days * 24 + CHR2INT2(s + 11)) * 60 + CHR2INT2(s + 14)) * 60 + CHR2INT2(s + 17);
+    *out = *out * 1000000 + micros;
+    return 0;
+}
+
+// Parse "[-]h[hh]:mm:ss[.ffffff]" into microseconds.
+static int parse_time_micros(char *s, unsigned long long s_l, int64_t *out) {
+    int64_t sign = 1;
+    int64_t hours = 0;
+    int64_t micros = 0;
+    unsigned long long i = 0;
+    if (s_l && s[0] == '-') { sign = -1; i++; }
+    unsigned long long start = i;
+    while (i < s_l && i - start < 3 && s[i] >= '0' && s[i] <= '9') {
+        hours = hours * 10 + (s[i++] - '0');
+    }
+    if (i == start || i + 6 > s_l || s[i] != ':' || s[i + 3] != ':') return -1;
+    for (unsigned long long j = i + 1; j < i + 6; j++) {
+        if (j != i + 3 && (s[j] < '0' || s[j] > '9')) return -1;
+    }
+    micros = parse_fraction_micros(s + i + 6, s_l - i - 6);
+    if (micros < 0) return -1;
+    *out = (hours * 60 + CHR2INT2(s + i + 1)) * 60 + CHR2INT2(s + i + 4);
+    *out = sign * (*out * 1000000 + micros);
+    return 0;
+}
+
+//
+// Return non-zero if the string is valid UTF-8.
+//
+static int is_valid_utf8(const char *s, unsigned long long s_l) {
+    const unsigned char *p = (const unsigned char*)s;
+    const unsigned char *end = p + s_l;
+
+    while (p < end) {
+        unsigned char c = *p;
+        int n = 0;
+        uint32_t cp = 0;
+
+        if (c < 0x80) { p++; continue; }
+
+        if (c >= 0xC2 && c <= 0xDF) { n = 1; cp = c & 0x1F; }
+        else if (c >= 0xE0 && c <= 0xEF) { n = 2; cp = c & 0x0F; }
+        else if (c >= 0xF0 && c <= 0xF4) { n = 3; cp = c & 0x07; }
+        else return 0;
+
+        if (end - p <= n) return 0;
+        for (int k = 1; k <= n; k++) {
+            if ((p[k] & 0xC0) != 0x80) return 0;
+            cp = (cp << 6) | (p[k] & 0x3F);
+        }
+
+        // Reject overlong forms, surrogates, and values past U+10FFFF.
+        if ((n == 2 && cp < 0x800) || (n == 3 && cp < 0x10000) ||
+            (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) return 0;
+
+        p += n + 1;
+    }
+
+    return 1;
+}
+
+//
+// JSON parsing
+//
+// JSON cells are parsed straight from the packet bytes into Python objects,
+// without building the intermediate str for json.loads. Object keys are
+// interned in the string table of the column, so rows with the same keys
+// share the key objects. Text the parser does not handle (syntax errors,
+// lone surrogate escapes, very deep nesting) is passed to json.loads so
+// results and error messages match the Python parser.
+//
+#define ACCEL_JSON_MAX_DEPTH 256
+
+typedef struct {
+    const char *s; // Next unread byte
+    const char *end; // End of the cell
+    int codec; // Text codec of the column
+    const char *encoding; // Encoding of the column
+    const char *encoding_errors; // Decoding error handler
+    StringTable *keys; // Interned object keys (NULL to skip interning)
+    int fallback; // Set when the cell must be parsed by json.loads
+    char *buf; // Scratch space for strings with escapes
+    unsigned long long buf_capacity; // Allocated size of buf
+} JSONParser;
+
+static PyObject *json_parse_value(JSONParser *p, int depth);
+
+static inline void json_skip_whitespace(JSONParser *p) {
+    while (p->s < p->end &&
+           (*p->s == ' ' || *p->s == '\n' || *p->s == '\r' || *p->s == '\t')) p->s++;
+}
+
+// Flag the cell for json.loads; returns NULL for use in return statements.
+static inline PyObject *json_fallback(JSONParser *p) {
+    p->fallback = 1;
+    return NULL;
+}
+
+static inline int json_hex4(const char *s, uint32_t *out) {
+    uint32_t v = 0;
+    for (int k = 0; k < 4; k++) {
+        unsigned char c = (unsigned char)s[k];
+        if (c >= '0' && c <= '9') v = (v << 4) | (c - '0');
+        else if (c >= 'a' && c <= 'f') v = (v << 4) | (c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') v = (v << 4) | (c - 'A' + 10);
+        else return -1;
+    }
+    *out = v;
+    return 0;
+}
+
+//
+// Parse a string whose opening quote has been consumed. The raw bytes
+// between the quotes are returned in *raw / *raw_l.
+//
+static PyObject *json_parse_string(
+    JSONParser *p,
+    const char **raw,
+    unsigned long long *raw_l
+) {
+    const char *start = p->s;
+    const char *q = p->s;
+    unsigned long long n = 0;
+
+    // Fast path: no escapes
+    while (q < p->end && *q != '"' && *q != '\\' && (unsigned char)*q >= 0x20) q++;
+    if (q == p->end || (unsigned char)*q < 0x20) return json_fallback(p);
+    if (*q == '"') {
+        p->s = q + 1;
+        *raw = start;
+        *raw_l = q - start;
+        return decode_text(start, q - start, p->codec, p->encoding, p->encoding_errors);
+    }
+
+    // Unescape into the scratch buffer as UTF-8
+    for (q = start; q < p->end && *q != '"'; q++) {
+        if (n + 4 > p->buf_capacity) {
+            unsigned long long capacity = MAX(p->buf_capacity * 2, 256);
+            char *buf = realloc(p->buf, capacity);
+            if (!buf) { PyErr_NoMemory(); return NULL; }
+            p->buf = buf;
+            p->buf_capacity = capacity;
+        }
+
+        if ((unsigned char)*q < 0x20) return json_fallback(p);
+        if (*q != '\\') { p->buf[n++] = *q; continue; }
+
+        if (++q == p->end) return json_fallback(p);
+        switch (*q) {
+        case '"': p->buf[n++] = '"'; break;
+        case '\\': p->buf[n++] = '\\'; break;
+        case '/': p->buf[n++] = '/'; break;
+        case 'b': p->buf[n++] = '\b'; break;
+        case 'f': p->buf[n++] = '\f'; break;
+        case 'n': p->buf[n++] = '\n'; break;
+        case 'r': p->buf[n++] = '\r'; break;
+        case 't': p->buf[n++] = '\t'; break;
+        case 'u': {
+            uint32_t cp = 0;
+            uint32_t lo = 0;
+            if (p->end - q < 5 || json_hex4(q + 1, &cp)) return json_fallback(p);
+            q += 4;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                // Lone surrogates can't be written as UTF-8
+                if (p->end - q < 7 || q[1] != '\\' || q[2] != 'u' ||
+                    json_hex4(q + 3, &lo) || lo < 0xDC00 || lo > 0xDFFF) return json_fallback(p);
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+                q += 6;
+            } else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                return json_fallback(p);
+            }
+            if (cp < 0x80) {
+                p->buf[n++] = (char)cp;
+            } else if (cp < 0x800) {
+                p->buf[n++] = (char)(0xC0 | (cp >> 6));
+                p->buf[n++] = (char)(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                p->buf[n++] = (char)(0xE0 | (cp >> 12));
+                p->buf[n++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                p->buf[n++] = (char)(0x80 | (cp & 0x3F));
+            } else {
+                p->buf[n++] = (char)(0xF0 | (cp >> 18));
+                p->buf[n++] = (char)(0x80 | ((cp >> 12) & 0x3F));
+                p->buf[n++] = (char)(0x80 | ((cp >> 6) & 0x3F));
+                p->buf[n++] = (char)(0x80 | (cp & 0x3F));
+            }
+            break;
+        }
+        default:
+            return json_fallback(p);
+        }
+    }
+    if (q == p->end) return json_fallback(p);
+
+    p->s = q + 1;
+    *raw = start;
+    *raw_l = q - start;
+    return decode_text(p->buf, n, p->codec, p->encoding, p->encoding_errors);
+}
+
+//
+// Parse an object key, returning the interned object for repeated keys.
+//
+static PyObject *json_parse_key(JSONParser *p) {
+    const char *raw = NULL;
+    unsigned long long raw_l = 0;
+    const char *q = p->s;
+    PyObject *py_key = NULL;
+    uint64_t h = 0;
+    int64_t idx = -1;
+
+    // Look the key up by its raw bytes before decoding it
+    while (q < p->end && *q != '"' && *q != '\\') q++;
+    if (p->keys && q < p->end && *q == '"' && q - p->s <= ACCEL_INTERN_MAX_LENGTH) {
+        h = hash_bytes(p->s, q - p->s);
+        idx = StringTable_find(p->keys, p->s, q - p->s, h);
+        if (idx >= 0) {
+            p->s = q + 1;
+            py_key = PyList_GetItem(p->keys->py_values, idx);
+            Py_XINCREF(py_key);
+            return py_key;
+        }
+    }
+
+    py_key = json_parse_string(p, &raw, &raw_l);
+    if (!py_key) return NULL;
+
+    if (p->keys && raw_l <= ACCEL_INTERN_MAX_LENGTH &&
+            p->keys->n_entries < ACCEL_INTERN_MAX_ENTRIES) {
+        h = hash_bytes(raw, raw_l);
+        if (StringTable_find(p->keys, raw, raw_l, h) < 0 &&
+                StringTable_add(p->keys, raw, raw_l, h, py_key) < 0) {
+            Py_DECREF(py_key);
+            return NULL;
+        }
+    }
+
+    return py_key;
+}
+
+static PyObject *json_parse_number(JSONParser *p) {
+    const char *start = p->s;
+    const char *q = p->s;
+    int is_float = 0;
+
+    if (q < p->end && *q == '-') q++;
+    if (q == p->end) return json_fallback(p);
+
+    if (*q == '0') {
+        q++;
+    } else if (*q >= '1' && *q <= '9') {
+        while (q < p->end && *q >= '0' && *q <= '9') q++;
+    } else if (p->end - q >= 8 && memcmp(q, "Infinity", 8) == 0) {
+        p->s = q + 8;
+        return PyFloat_FromDouble((*start == '-') ? -INFINITY : INFINITY);
+    } else {
+        return json_fallback(p);
+    }
+
+    if (q < p->end && *q == '.') {
+        q++;
+        if (q == p->end || *q < '0' || *q > '9') return json_fallback(p);
+        while (q < p->end && *q >= '0' && *q <= '9') q++;
+        is_float = 1;
+    }
+
+    if (q < p->end && (*q == 'e' || *q == 'E')) {
+        q++;
+        if (q < p->end && (*q == '-' || *q == '+')) q++;
+        if (q == p->end || *q < '0' || *q > '9') return json_fallback(p);
+        while (q < p->end && *q >= '0' && *q <= '9') q++;
+        is_float = 1;
+    }
+
+    p->s = q;
+
+    if (is_float) return PyFloat_FromDouble(parse_double(start, q - start));
+    if (q - start <= 18) return PyLong_FromLongLong(parse_int64(start, q - start));
+
+    // Too long for int64; let Python build the big integer
+    char stack[64];
+    char *buf = terminated_copy(start, q - start, stack, sizeof(stack));
+    if (!buf) { PyErr_NoMemory(); return NULL; }
+    PyObject *py_out = PyLong_FromString(buf, NULL, 10);
+    if (buf != stack) free(buf);
+    return py_out;
+}
+
+static PyObject *json_parse_array(JSONParser *p, int depth) {
+    PyObject *py_out = PyList_New(0);
+    PyObject *py_item = NULL;
+    if (!py_out) return NULL;
+
+    json_skip_whitespace(p);
+    if (p->s < p->end && *p->s == ']') { p->s++; return py_out; }
+
+    while (1) {
+        py_item = json_parse_value(p, depth + 1);
+        if (!py_item) goto error;
+        if (PyList_Append(py_out, py_item) < 0) goto error;
+        Py_CLEAR(py_item);
+
+        json_skip_whitespace(p);
+        if (p->s == p->end) { json_fallback(p); goto error; }
+        if (*p->s == ',') { p->s++; continue; }
+        if (*p->s == ']') { p->s++; break; }
+        json_fallback(p);
+        goto error;
+    }
+
+    return py_out;
+
+error:
+    Py_XDECREF(py_item);
+    Py_DECREF(py_out);
+    return NULL;
+}
+
+static PyObject *json_parse_object(JSONParser *p, int depth) {
+    PyObject *py_out = PyDict_New();
+    PyObject *py_key = NULL;
+    PyObject *py_value = NULL;
+    if (!py_out) return NULL;
+
+    json_skip_whitespace(p);
+    if (p->s < p->end && *p->s == '}') { p->s++; return py_out; }
+
+    while (1) {
+        json_skip_whitespace(p);
+        if (p->s == p->end || *p->s != '"') { json_fallback(p); goto error; }
+        p->s++;
+        py_key = json_parse_key(p);
+        if (!py_key) goto error;
+
+        json_skip_whitespace(p);
+        if (p->s == p->end || *p->s != ':') { json_fallback(p); goto error; }
+        p->s++;
+
+        py_value = json_parse_value(p, depth + 1);
+        if (!py_value) goto error;
+        if (PyDict_SetItem(py_out, py_key, py_value) < 0) goto error;
+        Py_CLEAR(py_key);
+        Py_CLEAR(py_value);
+
+        json_skip_whitespace(p);
+        if (p->s == p->end) { json_fallback(p); goto error; }
+        if (*p->s == ',') { p->s++; continue; }
+        if (*p->s == '}') { p->s++; break; }
+        json_fallback(p);
+        goto error;
+    }
+
+    return py_out;
+
+error:
+    Py_XDECREF(py_key);
+    Py_XDECREF(py_value);
+    Py_DECREF(py_out);
+    return NULL;
+}
+
+static PyObject *json_parse_value(JSONParser *p, int depth) {
+    const char *raw = NULL;
+    unsigned long long raw_l = 0;
+
+    if (depth > ACCEL_JSON_MAX_DEPTH) return json_fallback(p);
+
+    json_skip_whitespace(p);
+    if (p->s == p->end) return json_fallback(p);
+
+    switch (*p->s) {
+    case '{':
+        p->s++;
+        return json_parse_object(p, depth);
+    case '[':
+        p->s++;
+        return json_parse_array(p, depth);
+    case '"':
+        p->s++;
+        return json_parse_string(p, &raw, &raw_l);
+    case 't':
+        if (p->end - p->s < 4 || memcmp(p->s, "true", 4)) break;
+        p->s += 4;
+        Py_INCREF(Py_True);
+        return Py_True;
+    case 'f':
+        if (p->end - p->s < 5 || memcmp(p->s, "false", 5)) break;
+        p->s += 5;
+        Py_INCREF(Py_False);
+        return Py_False;
+    case 'n':
+        if (p->end - p->s < 4 || memcmp(p->s, "null", 4)) break;
+        p->s += 4;
+        Py_INCREF(Py_None);
+        return Py_None;
+    case 'N':
+        if (p->end - p->s < 3 || memcmp(p->s, "NaN", 3)) break;
+        p->s += 3;
+        return PyFloat_FromDouble(NAN);
+    default:
+        return json_parse_number(p);
+    }
+
+    return json_fallback(p);
+}
+
+//
+// Parse a JSON cell. Only UTF-8 and ASCII text is parsed natively; other
+// charsets and anything the parser flags are decoded and passed to json.loads.
+//
+static PyObject *parse_json_cell(
+    const char *s,
+    unsigned long long s_l,
+    int codec,
+    const char *encoding,
+    const char *encoding_errors,
+    StringTable *keys
+) {
+    PyObject *py_out = NULL;
+    PyObject *py_str = NULL;
+    JSONParser p = {s, s + s_l, codec, encoding, encoding_errors, keys, 0, NULL, 0};
+
+    if (codec == ACCEL_CODEC_UTF8 || (codec == ACCEL_CODEC_ASCII && is_ascii(s, s_l))) {
+        py_out = json_parse_value(&p, 0);
+        if (py_out) {
+            json_skip_whitespace(&p);
+            if (p.s != p.end) {
+                Py_CLEAR(py_out);
+                p.fallback = 1;
+            }
+        }
+        free(p.buf);
+        if (py_out || !p.fallback) return py_out;
+    }
+
+    py_str = decode_text(s, s_l, codec, encoding, encoding_errors);
+    if (!py_str) return NULL;
+    py_out = call_one(PyFunc.json_loads, py_str);
+    Py_DECREF(py_str);
+    return py_out;
+}
+
+//
+// Parse a JSON vector such as "[0.5,-1,2e3]" into packed elements of a
+// VECTOR type (type_idx 1 to 6 for float32, float64, int8, int16, int32,
+// and int64), writing at most max_n of them to buf.
+//
+// Returns the number of elements, or -1 without an exception if the text
+// is not a flat array of numbers that fit the element type, or holds more
+// than max_n of them.
+//
+static long long parse_vector_json(
+    const char *s,
+    unsigned long long s_l,
+    int type_idx,
+    char *buf,
+    unsigned long long max_n
+) {
+    static const int64_t int_min[] = {0, 0, 0, INT8_MIN, INT16_MIN, INT32_MIN, INT64_MIN};
+    static const int64_t int_max[] = {0, 0, 0, INT8_MAX, INT16_MAX, INT32_MAX, INT64_MAX};
+    JSONParser p = {s, s + s_l, ACCEL_CODEC_ASCII, NULL, NULL, NULL, 0, NULL, 0};
+    unsigned long long n = 0;
+
+    json_skip_whitespace(&p);
+    if (p.s == p.end || *p.s != '[') return -1;
+    p.s++;
+    json_skip_whitespace(&p);
+
+    if (p.s < p.end && *p.s == ']') {
+        p.s++;
+    } else {
+        while (1) {
+            const char *start = p.s;
+            const char *q = p.s;
+            int is_float = 0;
+            float f32 = 0;
+            double f64 = 0;
+            int64_t i64 = 0;
+
+            if (n == max_n) return -1;
+
+            if (q < p.end && *q == '-') q++;
+            if (q == p.end) return -1;
+            if (*q == '0') {
+                q++;
+            } else if (*q >= '1' && *q <= '9') {
+                while (q < p.end && *q >= '0' && *q <= '9') q++;
+            } else {
+                return -1;
+            }
+            if (q < p.end && *q == '.') {
+                q++;
+                if (q == p.end || *q < '0' || *q > '9') return -1;
+                while (q < p.end && *q >= '0' && *q <= '9') q++;
+                is_float = 1;
+            }
+            if (q < p.end && (*q == 'e' || *q == 'E')) {
+                q++;
+                if (q < p.end && (*q == '-' || *q == '+')) q++;
+                if (q == p.end || *q < '0' || *q > '9') return -1;
+                while (q < p.end && *q >= '0' && *q <= '9') q++;
+                is_float = 1;
+            }
+            p.s = q;
+
+            switch (type_idx) {
+            case 1:
+                f32 = (float)parse_double(start, q - start);
+                memcpy(buf + n * 4, &f32, 4);
+                break;
+            case 2:
+                f64 = parse_double(start, q - start);
+                memcpy(buf + n * 8, &f64, 8);
+                break;
+            default:
+                // Integer vectors only hold integer literals that fit the type
+                if (is_float || q - start > 18) return -1;
+                i64 = parse_int64(start, q - start);
+                if (i64 < int_min[type_idx] || i64 > int_max[type_idx]) return -1;
+                switch (type_idx) {
+                case 3: { int8_t v = (int8_t)i64; memcpy(buf + n, &v, 1); break; }
+                case 4: { int16_t v = (int16_t)i64; memcpy(buf + n * 2, &v, 2); break; }
+                case 5: { int32_t v = (int32_t)i64; memcpy(buf + n * 4, &v, 4); break; }
+                default: memcpy(buf + n * 8, &i64, 8);
+                }
+            }
+            n++;
+
+            json_skip_whitespace(&p);
+            if (p.s == p.end) return -1;
+            if (*p.s == ']') { p.s++; break; }
+            if (*p.s != ',') return -1;
+            p.s++;
+            json_skip_whitespace(&p);
+        }
+    }
+
+    json_skip_whitespace(&p);
+    return (p.s == p.end) ? (long long)n : -1;
+}
+
+//
+// Convert a JSON vector to a numpy array without building a list first.
+//
+// Returns NULL without an exception if the value needs the generic path.
+//
+static PyObject *vector_json_to_numpy(const char *s, unsigned long long s_l, int type_idx) {
+    static const int itemsizes[] = {0, 4, 8, 1, 2, 4, 8};
+    // Every element takes at least a digit and a separator
+    unsigned long long max_n = s_l / 2 + 1;
+    long long n = 0;
+    PyObject *py_buf = PyByteArray_FromStringAndSize(NULL, max_n * itemsizes[type_idx]);
+    if (!py_buf) return NULL;
+
+    n = parse_vector_json(s, s_l, type_idx, PyByteArray_AsString(py_buf), max_n);
+    if (n < 0 || PyByteArray_Resize(py_buf, n * itemsizes[type_idx]) < 0) {
+        Py_DECREF(py_buf);
+        return NULL;
+    }
+
+    if (PyTuple_SetItem(PyObj.create_numpy_array_args, 0, py_buf) < 0) return NULL;
+    return PyObject_Call(PyFunc.numpy_frombuffer, PyObj.create_numpy_array_args,
+                         PyObj.create_numpy_array_kwargs_vector[type_idx]);
+}
+
+//
+// BSON decoding
+//
+// Documents made of the common element types are decoded here, either into
+// dicts or into read-only BSONDocument mappings that decode their fields on
+// access. Cells holding other element types (ObjectId, Decimal128, regular
+// expressions, ...) are handed to bson.decode when pymongo is installed and
+// are returned as bytes otherwise.
+//
+
+#define ACCEL_BSON_MAX_DEPTH 100
+
+#define BSON_DOUBLE 0x01
+#define BSON_STRING 0x02
+#define BSON_DOCUMENT 0x03
+#define BSON_ARRAY 0x04
+#define BSON_BINARY 0x05
+#define BSON_BOOLEAN 0x08
+#define BSON_DATETIME 0x09
+#define BSON_NULL 0x0A
+#define BSON_INT32 0x10
+#define BSON_INT64 0x12
+
+// Milliseconds since the epoch of 0001-01-01 and 9999-12-31 23:59:59.999
+#define ACCEL_BSON_MIN_DATETIME -62135596800000LL
+#define ACCEL_BSON_MAX_DATETIME 253402300799999LL
+
+static PyTypeObject *BSONDocumentType = NULL;
+
+//
+// Read-only mapping over a BSON document held in a bytes object.
+//
+typedef struct {
+    PyObject_HEAD
+    PyObject *py_data; // bytes holding the document
+    const char *doc; // Start of the document within py_data
+    Py_ssize_t length; // Number of fields, or -1 until counted
+} BSONDocumentObject;
+
+static inline int32_t bson_int32(const char *s) {
+    int32_t v;
+    memcpy(&v, s, 4);
+    return v;
+}
+
+static inline int64_t bson_int64(const char *s) {
+    int64_t v;
+    memcpy(&v, s, 8);
+    return v;
+}
+
+static long long bson_check_document(const char *s, unsigned long long s_l, int depth);
+
+//
+// Return the size of a valid value of the given element type, or -1 if it
+// is malformed or not decoded natively.
+//
+static long long bson_check_value(char type, const char *v, unsigned long long v_l, int depth) {
+    int64_t ms = 0;
+    int32_t n = 0;
+
+    switch (type) {
+    case BSON_DOUBLE:
+    case BSON_INT64:
+        return (v_l >= 8) ? 8 : -1;
+    case BSON_DATETIME:
+        if (v_l < 8) return -1;
+        ms = bson_int64(v);
+        return (ms >= ACCEL_BSON_MIN_DATETIME && ms <= ACCEL_BSON_MAX_DATETIME) ? 8 : -1;
+    case BSON_INT32:
+        return (v_l >= 4) ? 4 : -1;
+    case BSON_BOOLEAN:
+        return (v_l >= 1 && (v[0] == 0 || v[0] == 1)) ? 1 : -1;
+    case BSON_NULL:
+        return 0;
+    case BSON_STRING:
+        if (v_l < 5) return -1;
+        n = bson_int32(v);
+        if (n < 1 || (unsigned long long)n > v_l - 4 || v[4 + n - 1] != 0) return -1;
+        return is_valid_utf8(v + 4, n - 1) ? 4 + n : -1;
+    case BSON_DOCUMENT:
+    case BSON_ARRAY:
+        return bson_check_document(v, v_l, depth + 1);
+    case BSON_BINARY:
+        // Only generic binary data (subtype 0) maps to bytes
+        if (v_l < 5) return -1;
+        n = bson_int32(v);
+        if (n < 0 || (unsigned long long)n > v_l - 5 || v[4] != 0) return -1;
+        return 5 + n;
+    }
+
+    return -1;
+}
+
+//
+// Return the size of a valid document at the start of s, or -1 if it is
+// malformed or holds element types that are not decoded natively.
+//
+static long long bson_check_document(const char *s, unsigned long long s_l, int depth) {
+    const char *p = NULL;
+    const char *end = NULL;
+    const char *key_end = NULL;
+    long long doc_l = 0;
+    long long value_l = 0;
+    char type = 0;
+
+    if (depth > ACCEL_BSON_MAX_DEPTH || s_l < 5) return -1;
+    doc_l = bson_int32(s);
+    if (doc_l < 5 || (unsigned long long)doc_l > s_l || s[doc_l - 1] != 0) return -1;
+
+    p = s + 4;
+    end = s + doc_l - 1;
+    while (p < end) {
+        type = *p++;
+        key_end = memchr(p, 0, end - p);
+        if (!key_end || !is_valid_utf8(p, key_end - p)) return -1;
+        p = key_end + 1;
+        value_l = bson_check_value(type, p, end - p, depth);
+        if (value_l < 0) return -1;
+        p += value_l;
+    }
+
+    return (p == end) ? doc_l : -1;
+}
+
+// Size of a value that has been checked by bson_check_value.
+static long long bson_value_size(char type, const char *v) {
+    switch (type) {
+    case BSON_DOUBLE:
+    case BSON_INT64:
+    case BSON_DATETIME:
+        return 8;
+    case BSON_INT32:
+        return 4;
+    case BSON_BOOLEAN:
+        return 1;
+    case BSON_STRING:
+        return 4 + (long long)bson_int32(v);
+    case BSON_DOCUMENT:
+    case BSON_ARRAY:
+        return bson_int32(v);
+    case BSON_BINARY:
+        return 5 + (long long)bson_int32(v);
+    }
+    return 0;
+}
+
+//
+// Return a decoded key, reusing the str objects of keys seen before.
+//
+static PyObject *bson_key(StringTable *keys, const char *s, unsigned long long s_l) {
+    PyObject *py_key = NULL;
+    uint64_t h = 0;
+    int64_t idx = -1;
+
+    if (!keys || s_l > ACCEL_INTERN_MAX_LENGTH) return PyUnicode_DecodeUTF8(s, s_l, "strict");
+
+    h = hash_bytes(s, s_l);
+    idx = StringTable_find(keys, s, s_l, h);
+    if (idx >= 0) {
+        py_key = PyList_GetItem(keys->py_values, idx);
+        Py_XINCREF(py_key);
+        return py_key;
+    }
+
+    py_key = PyUnicode_DecodeUTF8(s, s_l, "strict");
+    if (py_key && keys->n_entries < ACCEL_INTERN_MAX_ENTRIES &&
+            StringTable_add(keys, s, s_l, h, py_key) < 0) {
+        Py_CLEAR(py_key);
+    }
+
+    return py_key;
+}
+
+//
+// Naive UTC datetime of a BSON datetime, as returned by bson.decode.
+//
+static PyObject *bson_datetime(int64_t ms) {
+    int64_t days = ms / 86400000;
+    int64_t rem = ms % 86400000;
+    int year = 0, month = 0, day = 0;
+
+    if (rem < 0) { rem += 86400000; days--; }
+    civil_from_days(days, &year, &month, &day);
+
+    return PyDateTime_FromDateAndTime(
+#ifdef Py_LIMITED_API
+               NULL,
+#endif
+               year, month, day, (int)(rem / 3600000), (int)(rem / 60000 % 60),
+               (int)(rem / 1000 % 60), (int)(rem % 1000) * 1000);
+}
+
+static PyObject *bson_decode_document(const char *s, int is_array, StringTable *keys, PyObject *py_owner);
+static PyObject *BSONDocument_new(PyObject *py_data, const char *doc);
+
+//
+// Decode a checked value. Documents are BSONDocuments over py_owner if it
+// is given, or dicts otherwise.
+//
+static PyObject *bson_decode_value(char type, const char *v, StringTable *keys, PyObject *py_owner) {
+    double f64 = 0;
+
+    switch (type) {
+    case BSON_DOUBLE:
+        memcpy(&f64, v, 8);
+        return PyFloat_FromDouble(f64);
+    case BSON_STRING:
+        return PyUnicode_DecodeUTF8(v + 4, bson_int32(v) - 1, "strict");
+    case BSON_DOCUMENT:
+        if (py_owner) return BSONDocument_new(py_owner, v);
+        return bson_decode_document(v, 0, keys, NULL);
+    case BSON_ARRAY:
+        return bson_decode_document(v, 1, keys, py_owner);
+    case BSON_BINARY:
+        return PyBytes_FromStringAndSize(v + 5, bson_int32(v));
+    case BSON_BOOLEAN:
+        return PyBool_FromLong(v[0]);
+    case BSON_DATETIME:
+        return bson_datetime(bson_int64(v));
+    case BSON_NULL:
+        Py_INCREF(Py_None);
+        return Py_None;
+    case BSON_INT32:
+        return PyLong_FromLong(bson_int32(v));
+    case BSON_INT64:
+        return PyLong_FromLongLong(bson_int64(v));
+    }
+
+    PyErr_Format(PyExc_ValueError, "unsupported BSON element type: 0x%02x", (unsigned char)type);
+    return NULL;
+}
+
+//
+// Decode a checked document into a dict, or a list if it is an array.
+//
+static PyObject *bson_decode_document(const char *s, int is_array, StringTable *keys, PyObject *py_owner) {
+    const char *p = s + 4;
+    const char *end = s + bson_int32(s) - 1;
+    PyObject *py_out = (is_array) ? PyList_New(0) : PyDict_New();
+    PyObject *py_key = NULL;
+    PyObject *py_value = NULL;
+    const char *key = NULL;
+    size_t key_l = 0;
+    char type = 0;
+
+    if (!py_out) return NULL;
+
+    while (p < end) {
+        type = *p++;
+        key = p;
+        key_l = strlen(p);
+        p += key_l + 1;
+
+        py_value = bson_decode_value(type, p, keys, py_owner);
+        if (!py_value) goto error;
+        if (is_array) {
+            if (PyList_Append(py_out, py_value) < 0) goto error;
+        } else {
+            py_key = bson_key(keys, key, key_l);
+            if (!py_key || PyDict_SetItem(py_out, py_key, py_value) < 0) goto error;
+            Py_CLEAR(py_key);
+        }
+        Py_CLEAR(py_value);
+
+        p += bson_value_size(type, p);
+    }
+
+    return py_out;
+
+error:
+    Py_XDECREF(py_key);
+    Py_XDECREF(py_value);
+    Py_DECREF(py_out);
+    return NULL;
+}
+
+//
+// Decode a BSON cell into a dict, or a BSONDocument if lazy is set.
+//
+// Returns NULL without an exception if the cell needs the generic path.
+//
+static PyObject *decode_bson_cell(const char *s, unsigned long long s_l, StringTable *keys, int lazy) {
+    PyObject *py_data = NULL;
+    PyObject *py_out = NULL;
+
+    if (bson_check_document(s, s_l, 0) != (long long)s_l) return NULL;
+    if (!lazy) return bson_decode_document(s, 0, keys, NULL);
+
+    py_data = PyBytes_FromStringAndSize(s, s_l);
+    if (!py_data) return NULL;
+    py_out = BSONDocument_new(py_data, PyBytes_AsString(py_data));
+    Py_DECREF(py_data);
+    return py_out;
+}
+
+static PyObject *BSONDocument_new(PyObject *py_data, const char *doc) {
+    BSONDocumentObject *py_out = (BSONDocumentObject*)PyType_GenericAlloc(BSONDocumentType, 0);
+    if (!py_out) return NULL;
+    Py_INCREF(py_data);
+    py_out->py_data = py_data;
+    py_out->doc = doc;
+    py_out->length = -1;
+    return (PyObject*)py_out;
+}
+
+//
+// Find the value of a field; the last one wins if the key repeats, as it
+// does in bson.decode. Returns NULL if there is no such field.
+//
+static const char *BSONDocument_find(BSONDocumentObject *self, PyObject *py_key, char *type) {
+    const char *p = self->doc + 4;
+    const char *end = self->doc + bson_int32(self->doc) - 1;
+    const char *out = NULL;
+    const char *key = NULL;
+    Py_ssize_t key_l = 0;
+    size_t field_l = 0;
+    char field_type = 0;
+    PyObject *py_bytes = NULL;
+
+    if (!PyUnicode_Check(py_key)) return NULL;
+    py_bytes = PyUnicode_AsUTF8String(py_key);
+    if (!py_bytes) { PyErr_Clear(); return NULL; }
+    key = PyBytes_AsString(py_bytes);
+    key_l = PyBytes_Size(py_bytes);
+
+    while (p < end) {
+        field_type = *p++;
+        field_l = strlen(p);
+        if ((Py_ssize_t)field_l == key_l && memcmp(p, key, key_l) == 0) {
+            out = p + field_l + 1;
+            *type = field_type;
+        }
+        p += field_l + 1;
+        p += bson_value_size(field_type, p);
+    }
+
+    Py_DECREF(py_bytes);
+    return out;
+}
+
+//
+// Return a list of the keys (0), values (1), or (key, value) items (2).
+//
+static PyObject *BSONDocument_fields(BSONDocumentObject *self, int what) {
+    const char *p = self->doc + 4;
+    const char *end = self->doc + bson_int32(self->doc) - 1;
+    PyObject *py_out = PyList_New(0);
+    PyObject *py_key = NULL;
+    PyObject *py_value = NULL;
+    PyObject *py_item = NULL;
+    size_t key_l = 0;
+    char type = 0;
+
+    if (!py_out) return NULL;
+
+    while (p < end) {
+        type = *p++;
+        key_l = strlen(p);
+        if (what != 1) {
+            py_key = PyUnicode_DecodeUTF8(p, key_l, "strict");
+            if (!py_key) goto error;
+        }
+        p += key_l + 1;
+        if (what != 0) {
+            py_value = bson_decode_value(type, p, NULL, self->py_data);
+            if (!py_value) goto error;
+        }
+        p += bson_value_size(type, p);
+
+        switch (what) {
+        case 0: py_item = py_key; py_key = NULL; break;
+        case 1: py_item = py_value; py_value = NULL; break;
+        default:
+            py_item = PyTuple_Pack(2, py_key, py_value);
+            if (!py_item) goto error;
+            Py_CLEAR(py_key);
+            Py_CLEAR(py_value);
+        }
+        if (PyList_Append(py_out, py_item) < 0) goto error;
+        Py_CLEAR(py_item);
+    }
+
+    return py_out;
+
+error:
+    Py_XDECREF(py_key);
+    Py_XDECREF(py_value);
+    Py_XDECREF(py_item);
+    Py_DECREF(py_out);
+    return NULL;
+}
+
+static Py_ssize_t BSONDocument_length(BSONDocumentObject *self) {
+    const char *p = self->doc + 4;
+    const char *end = self->doc + bson_int32(self->doc) - 1;
+    char type = 0;
+
+    if (self->length >= 0) return self->length;
+
+    self->length = 0;
+    while (p < end) {
+        type = *p++;
+        p += strlen(p) + 1;
+        p += bson_value_size(type, p);
+        self->length++;
+    }
+
+    return self->length;
+}
+
+static PyObject *BSONDocument_subscript(BSONDocumentObject *self, PyObject *py_key) {
+    char type = 0;
+    const char *v = BSONDocument_find(self, py_key, &type);
+    if (!v) {
+        PyErr_SetObject(PyExc_KeyError, py_key);
+        return NULL;
+    }
+    return bson_decode_value(type, v, NULL, self->py_data);
+}
+
+static int BSONDocument_contains(BSONDocumentObject *self, PyObject *py_key) {
+    char type = 0;
+    return BSONDocument_find(self, py_key, &type) != NULL;
+}
+
+static PyObject *BSONDocument_get(BSONDocumentObject *self, PyObject *args) {
+    PyObject *py_key = NULL;
+    PyObject *py_default = Py_None;
+    const char *v = NULL;
+    char type = 0;
+
+    if (!PyArg_ParseTuple(args, "O|O", &py_key, &py_default)) return NULL;
+
+    v = BSONDocument_find(self, py_key, &type);
+    if (!v) {
+        Py_INCREF(py_default);
+        return py_default;
+    }
+    return bson_decode_value(type, v, NULL, self->py_data);
+}
+
+static PyObject *BSONDocument_keys(BSONDocumentObject *self, PyObject *args) {
+    return BSONDocument_fields(self, 0);
+}
+
+static PyObject *BSONDocument_values(BSONDocumentObject *self, PyObject *args) {
+    return BSONDocument_fields(self, 1);
+}
+
+static PyObject *BSONDocument_items(BSONDocumentObject *self, PyObject *args) {
+    return BSONDocument_fields(self, 2);
+}
+
+static PyObject *BSONDocument_to_dict(BSONDocumentObject *self, PyObject *args) {
+    return bson_decode_document(self->doc, 0, NULL, NULL);
+}
+
+static PyObject *BSONDocument_iter(BSONDocumentObject *self) {
+    PyObject *py_keys = BSONDocument_fields(self, 0);
+    PyObject *py_out = NULL;
+    if (!py_keys) return NULL;
+    py_out = PyObject_GetIter(py_keys);
+    Py_DECREF(py_keys);
+    return py_out;
+}
+
+static PyObject *BSONDocument_richcompare(BSONDocumentObject *self, PyObject *py_other, int op) {
+    PyObject *py_dict = NULL;
+    PyObject *py_other_dict = NULL;
+    PyObject *py_out = NULL;
+
+    if (op != Py_EQ && op != Py_NE) Py_RETURN_NOTIMPLEMENTED;
+
+    py_dict = BSONDocument_to_dict(self, NULL);
+    if (!py_dict) return NULL;
+
+    if (Py_TYPE(py_other) == BSONDocumentType) {
+        py_other_dict = BSONDocument_to_dict((BSONDocumentObject*)py_other, NULL);
+    } else {
+        py_other_dict = py_other;
+        Py_INCREF(py_other_dict);
+    }
+
+    if (py_other_dict) py_out = PyObject_RichCompare(py_dict, py_other_dict, op);
+
+    Py_DECREF(py_dict);
+    Py_XDECREF(py_other_dict);
+    return py_out;
+}
+
+static PyObject *BSONDocument_repr(BSONDocumentObject *self) {
+    PyObject *py_dict = BSONDocument_to_dict(self, NULL);
+    PyObject *py_out = NULL;
+    if (!py_dict) return NULL;
+    py_out = PyUnicode_FromFormat("BSONDocument(%R)", py_dict);
+    Py_DECREF(py_dict);
+    return py_out;
+}
+
+static void BSONDocument_dealloc(BSONDocumentObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    Py_CLEAR(self->py_data);
+    PyObject_Del(self);
+    Py_DECREF(tp);
+}
+
+static PyMethodDef BSONDocumentType_methods[] = {
+    {"get", (PyCFunction)BSONDocument_get, METH_VARARGS,
+     "Return the value of a field, or the default if there is no such field"},
+    {"keys", (PyCFunction)BSONDocument_keys, METH_NOARGS, "List of field names"},
+    {"values", (PyCFunction)BSONDocument_values, METH_NOARGS, "List of field values"},
+    {"items", (PyCFunction)BSONDocument_items, METH_NOARGS, "List of (name, value) pairs"},
+    {"to_dict", (PyCFunction)BSONDocument_to_dict, METH_NOARGS,
+     "Decode the whole document into a dict"},
+    {NULL, NULL, 0, NULL}
+};
+
+static PyType_Slot BSONDocumentType_slots[] = {
+    {Py_tp_dealloc, (destructor)BSONDocument_dealloc},
+    {Py_tp_methods, BSONDocumentType_methods},
+    {Py_tp_iter, (getiterfunc)BSONDocument_iter},
+    {Py_tp_richcompare, (richcmpfunc)BSONDocument_richcompare},
+    {Py_tp_repr, (reprfunc)BSONDocument_repr},
+    {Py_mp_length, (lenfunc)BSONDocument_length},
+    {Py_mp_subscript, (binaryfunc)BSONDocument_subscript},
+    {Py_sq_contains, (objobjproc)BSONDocument_contains},
+    {Py_tp_doc, "Read-only mapping that decodes the fields of a BSON document on access"},
+    {0, NULL},
+};
+
+static PyType_Spec BSONDocumentType_spec = {
+    .name = ACCEL_STR(ACCEL_MODULE_NAME) ".BSONDocument",
+    .basicsize = sizeof(BSONDocumentObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = BSONDocumentType_slots,
+};
+
+//
+// Append a text cell to an Arrow string column as UTF-8.
+//
+static int append_column_text(
+    ColumnBuffer *col,
+    char *out,
+    unsigned long long out_l,
+    int codec,
+    const char *encoding,
+    const char *encoding_errors
+) {
+    int rc = 0;
+    PyObject *py_str = NULL;
+    PyObject *py_bytes = NULL;
+
+    if (is_ascii(out, out_l) ||
+            (codec == ACCEL_CODEC_UTF8 && is_valid_utf8(out, out_l))) {
+        return ColumnBuffer_append_bytes(col, out, out_l, 0);
+    }
+
+    // Let the codec raise or apply the error handler, as in the row path.
+    py_str = decode_text(out, out_l, codec, encoding, encoding_errors);
+    if (!py_str) goto error;
+
+    py_bytes = PyUnicode_AsUTF8String(py_str);
+    if (!py_bytes) goto error;
+
+    rc = ColumnBuffer_append_bytes(col, PyBytes_AsString(py_bytes), PyBytes_Size(py_bytes), 0);
+
+exit:
+    Py_XDECREF(py_str);
+    Py_XDECREF(py_bytes);
+    return rc;
+
+error:
+    rc = -1;
+    goto exit;
+}
+
+//
+// Decode a cell into the packed buffer of its column.
+//
+//
+// Append the dictionary code of a text cell, adding new values to the dictionary.
+//
+static int append_column_category(
+    ColumnBuffer *col,
+    char *out,
+    unsigned long long out_l,
+    int is_null,
+    int codec,
+    const char *encoding,
+    const char *encoding_errors
+) {
+    int32_t code = -1;
+    char *slot = NULL;
+
+    if (!is_null) {
+        uint64_t h = hash_bytes(out, out_l);
+        int64_t idx = StringTable_find(col->dictionary, out, out_l, h);
+        if (idx < 0) {
+            PyObject *py_value = decode_text(out, out_l, codec, encoding, encoding_errors);
+            if (!py_value) return -1;
+            idx = StringTable_add(col->dictionary, out, out_l, h, py_value);
+            Py_DECREF(py_value);
+            if (idx < 0) return -1;
+            if (idx > INT32_MAX) {
+                PyErr_SetString(PyExc_OverflowError, "too many distinct values");
+                return -1;
+            }
+        }
+        code = (int32_t)idx;
+    }
+
+    slot = ColumnBuffer_append(col, is_null);
+    if (!slot) return -1;
+    memcpy(slot, &code, sizeof(code));
+
+    return 0;
+}
+
+//
+// Copy a VECTOR cell into its row of the column block (zeros for NULL).
+//
+static int append_column_vector(
+    ColumnBuffer *col,
+    char *out,
+    unsigned long long out_l,
+    int is_null
+) {
+    char *slot = NULL;
+    long long n = 0;
+
+    if (!is_null && col->vector_type < MYSQL_TYPE_FLOAT32_VECTOR) {
+        slot = ColumnBuffer_append(col, 0);
+        if (!slot) return -1;
+        n = parse_vector_json(out, out_l, col->vector_type % 1000, slot, col->dim);
+        if (n == col->dim) return 0;
+        col->length--;
+        if (n < 0) {
+            PyErr_Format(PyExc_ValueError,
+                         "invalid VECTOR value for a column of dimension %d", col->dim);
+        } else {
+            PyErr_Format(PyExc_ValueError,
+                         "VECTOR value of %lld elements does not match the column dimension of %d",
+                         n, col->dim);
+        }
+        return -1;
+    }
+
+    if (!is_null && out_l != (unsigned long long)col->itemsize) {
+        PyErr_Format(PyExc_ValueError,
+                     "VECTOR value of %llu bytes does not match the column dimension of %d",
+                     out_l, col->dim);
+        return -1;
+    }
+
+    slot = ColumnBuffer_append(col, is_null);
+    if (!slot) return -1;
+
+    if (is_null) memset(slot, 0, col->itemsize);
+    else memcpy(slot, out, out_l);
+
+    return 0;
+}
+
+//
+// Store a text cell in the packed buffer of its column.
+//
+// Returns 1 without storing anything if the packed type can not represent
+// the value (an invalid date or time), in which case the caller switches
+// the column to objects with demote_column.
+//
+static int append_column_value(
+    ColumnBuffer *col,
+    char *out,
+    unsigned long long out_l,
+    int is_null,
+    int codec,
+    const char *encoding,
+    const char *encoding_errors
+) {
+    char *slot = NULL;
+    int64_t i64 = 0;
+    uint64_t u64 = 0;
+    double f64 = 0.0;
+    int negative = 0;
+
+    switch (col->kind) {
+    case ACCEL_COL_BINARY:
+        if (is_null) out_l = 0;
+        return ColumnBuffer_append_bytes(col, out, out_l, is_null);
+    case ACCEL_COL_UTF8:
+        if (is_null) return ColumnBuffer_append_bytes(col, out, 0, 1);
+        return append_column_text(col, out, out_l, codec, encoding, encoding_errors);
+    case ACCEL_COL_DICT:
+        return append_column_category(col, out, out_l, is_null, codec, encoding,
+                                      encoding_errors);
+    case ACCEL_COL_VECTOR:
+        return append_column_vector(col, out, out_l, is_null);
+    }
+
+    if (!is_null) {
+        switch (col->kind) {
+        case ACCEL_COL_INT:
+            if (out_l == 0) { is_null = 1; break; }
+            i64 = parse_int64(out, out_l);
+            break;
+        case ACCEL_COL_UINT:
+            if (out_l == 0) { is_null = 1; break; }
+            u64 = parse_uint64(out, out_l);
+            break;
+        case ACCEL_COL_FLOAT:
+        case ACCEL_COL_DOUBLE:
+            f64 = parse_double(out, out_l);
+            break;
+        // Zero dates are NULL, as in the row path; other values that do
+        // not parse are left to the column's invalid value handling.
+        case ACCEL_COL_DATE:
+        case ACCEL_COL_DATE64:
+            if (CHECK_ZERO_DATE_STR(out, out_l)) { is_null = 1; break; }
+            if (parse_date_days(out, out_l, &i64) < 0) return 1;
+            if (col->kind == ACCEL_COL_DATE64) i64 *= 86400000;
+            break;
+        case ACCEL_COL_DATETIME:
+            if (CHECK_ANY_ZERO_DATETIME_STR(out, out_l)) { is_null = 1; break; }
+            if (parse_datetime_micros(out, out_l, &i64) < 0) return 1;
+            break;
+        case ACCEL_COL_TIME:
+            if (parse_time_micros(out, out_l, &i64) < 0) return 1;
+            break;
+        case ACCEL_COL_DECIMAL128:
+            // i64 / u64 hold the high / low halves of the magnitude
+            if (parse_decimal_unscaled(out, out_l, col->scale,
+                                       (uint64_t*)&i64, &u64, &negative) < 0) return 1;
+            break;
+        }
+    }
+
+    slot = ColumnBuffer_append(col, is_null);
+    if (!slot) return -1;
+
+    if (is_null) {
+        memset(slot, 0, col->itemsize);
         return 0;
     }
-    if (!is_eof_packet(*data, *data_l)) {
+
+    switch (col->kind) {
+    case ACCEL_COL_UINT:
+        i64 = (int64_t)u64;
+        // Fall through
+    case ACCEL_COL_INT:
+        switch (col->itemsize) {
+        case 1: *(int8_t*)slot = (int8_t)i64; break;
+        case 2: *(int16_t*)slot = (int16_t)i64; break;
+        case 4: *(int32_t*)slot = (int32_t)i64; break;
+        default: memcpy(slot, &i64, 8);
+        }
+        break;
+    case ACCEL_COL_FLOAT:
+        *(float*)slot = (float)f64;
+        break;
+    case ACCEL_COL_DOUBLE:
+        memcpy(slot, &f64, 8);
+        break;
+    case ACCEL_COL_DECIMAL128: {
+        // Two's complement, native byte order
+        uint64_t hi = (uint64_t)i64;
+        uint64_t lo = u64;
+        if (negative) {
+            lo = ~lo + 1;
+            hi = ~hi + (lo == 0);
+        }
+#ifdef ACCEL_LITTLE_ENDIAN
+        memcpy(slot, &lo, 8);
+        memcpy(slot + 8, &hi, 8);
+#else
+        memcpy(slot, &hi, 8);
+        memcpy(slot + 8, &lo, 8);
+#endif
+        break;
+        }
+    default:
+        memcpy(slot, &i64, 8);
+    }
+
+    return 0;
+}
+
+//
+// Convert a 128-bit magnitude and sign to an int.
+//
+static PyObject *int128_to_pylong(uint64_t hi, uint64_t lo, int negative) {
+    PyObject *py_hi = NULL;
+    PyObject *py_lo = NULL;
+    PyObject *py_shift = NULL;
+    PyObject *py_tmp = NULL;
+    PyObject *py_out = NULL;
+
+    if (hi == 0 && lo <= (uint64_t)INT64_MAX) {
+        return PyLong_FromLongLong((negative) ? -(int64_t)lo : (int64_t)lo);
+    }
+
+    // (hi << 64) | lo
+    py_hi = PyLong_FromUnsignedLongLong(hi);
+    if (!py_hi) goto error;
+    py_lo = PyLong_FromUnsignedLongLong(lo);
+    if (!py_lo) goto error;
+    py_shift = PyLong_FromLong(64);
+    if (!py_shift) goto error;
+    py_tmp = PyNumber_Lshift(py_hi, py_shift);
+    if (!py_tmp) goto error;
+    py_out = PyNumber_Or(py_tmp, py_lo);
+    if (!py_out) goto error;
+    if (negative) {
+        Py_DECREF(py_tmp);
+        py_tmp = py_out;
+        py_out = PyNumber_Negative(py_tmp);
+    }
+
+exit:
+    Py_XDECREF(py_hi);
+    Py_XDECREF(py_lo);
+    Py_XDECREF(py_shift);
+    Py_XDECREF(py_tmp);
+    return py_out;
+
+error:
+    Py_CLEAR(py_out);
+    goto exit;
+}
+
+//
+// Convert DECIMAL text to an int scaled by 10**scale.
+//
+// Values of up to 38 digits are converted natively; wider ones (DECIMAL
+// allows 65) are handed to PyLong_FromString with the point removed.
+//
+static PyObject *decimal_to_scaled_int(const char *s, unsigned long long s_l, int scale) {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+    int negative = 0;
+    const char *point = NULL;
+    unsigned long long n_fraction = 0;
+    unsigned long long n = 0;
+    char *digits = NULL;
+    char text[65];
+    PyObject *py_out = NULL;
+
+    if (parse_decimal_unscaled(s, s_l, scale, &hi, &lo, &negative) == 0) {
+        return int128_to_pylong(hi, lo, negative);
+    }
+
+    point = memchr(s, '.', s_l);
+    if (point) n_fraction = s_l - (unsigned long long)(point - s) - 1;
+    if (s_l == 0 || n_fraction > (unsigned long long)scale) goto invalid;
+
+    digits = malloc(s_l + scale + 1);
+    if (!digits) return PyErr_NoMemory();
+    for (unsigned long long i = 0; i < s_l; i++) {
+        if (s + i == point) continue;
+        // PyLong_FromString would also accept spaces and underscores.
+        if (s[i] != '-' && s[i] != '+' && (s[i] < '0' || s[i] > '9')) {
+            free(digits);
+            goto invalid;
+        }
+        digits[n++] = s[i];
+    }
+    memset(digits + n, '0', scale - n_fraction);
+    digits[n + scale - n_fraction] = '\0';
+
+    py_out = PyLong_FromString(digits, NULL, 10);
+    free(digits);
+    if (py_out) return py_out;
+    PyErr_Clear();
+
+invalid:
+    // PyUnicode_FromFormat only supports a '*' precision from Python 3.12.
+    n = (s_l < 64) ? s_l : 64;
+    memcpy(text, s, n);
+    text[n] = '\0';
+    PyErr_Format(PyExc_ValueError, "invalid DECIMAL value: %.64s", text);
+    return NULL;
+}
+
+//
+// Binary protocol values
+//
+// Rows of prepared statement results start with a 0x00 header and a NULL
+// bitmap (offset by 2 bits). Numbers are fixed-width little-endian values,
+// dates and times are a length byte followed by their fields, and
+// everything else is a length-coded string as in the text protocol.
+//
+
+typedef struct {
+    int64_t i64; // Integer value
+    uint64_t u64; // Unsigned integer value
+    double f64; // Floating point value
+    int is_negative; // TIME sign
+    int year;
+    int month;
+    int day;
+    int hour; // Includes days for TIME values
+    int minute;
+    int second;
+    int microsecond;
+} BinaryValue;
+
+//
+// Read a fixed-width binary value.
+//
+// Returns 1 if the value was read, 0 if the column type is sent as a
+// length-coded string, or -1 if the packet is truncated.
+//
+static int read_binary_value(
+    int type_code,
+    int is_unsigned,
+    char **data,
+    unsigned long long *data_l,
+    BinaryValue *v
+) {
+    unsigned char *p = (unsigned char*)*data;
+    unsigned long long n = 0;
+    int8_t i8 = 0;
+    int16_t i16 = 0;
+    int32_t i32 = 0;
+    float f32 = 0;
+
+    memset(v, 0, sizeof(BinaryValue));
+
+    switch (type_code) {
+    case MYSQL_TYPE_TINY:
+        n = 1;
+        if (*data_l < n) return -1;
+        i8 = (int8_t)p[0];
+        v->i64 = (is_unsigned) ? (int64_t)p[0] : i8;
+        break;
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_YEAR:
+        n = 2;
+        if (*data_l < n) return -1;
+        memcpy(&i16, p, 2);
+        v->i64 = (is_unsigned || type_code == MYSQL_TYPE_YEAR) ? (int64_t)(uint16_t)i16 : i16;
+        break;
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+        n = 4;
+        if (*data_l < n) return -1;
+        memcpy(&i32, p, 4);
+        v->i64 = (is_unsigned) ? (int64_t)(uint32_t)i32 : i32;
+        break;
+    case MYSQL_TYPE_LONGLONG:
+        n = 8;
+        if (*data_l < n) return -1;
+        memcpy(&v->u64, p, 8);
+        v->i64 = (int64_t)v->u64;
+        break;
+    case MYSQL_TYPE_FLOAT:
+        n = 4;
+        if (*data_l < n) return -1;
+        memcpy(&f32, p, 4);
+        v->f64 = f32;
+        break;
+    case MYSQL_TYPE_DOUBLE:
+        n = 8;
+        if (*data_l < n) return -1;
+        memcpy(&v->f64, p, 8);
+        break;
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_NEWDATE:
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_TIMESTAMP:
+        if (*data_l < 1) return -1;
+        n = 1 + p[0];
+        if (*data_l < n || (p[0] != 0 && p[0] != 4 && p[0] != 7 && p[0] != 11)) return -1;
+        if (p[0] >= 4) {
+            v->year = p[1] | (p[2] << 8);
+            v->month = p[3];
+            v->day = p[4];
+        }
+        if (p[0] >= 7) {
+            v->hour = p[5];
+            v->minute = p[6];
+            v->second = p[7];
+        }
+        if (p[0] == 11) {
+            memcpy(&i32, p + 8, 4);
+            v->microsecond = i32;
+        }
+        break;
+    case MYSQL_TYPE_TIME:
+        if (*data_l < 1) return -1;
+        n = 1 + p[0];
+        if (*data_l < n || (p[0] != 0 && p[0] != 8 && p[0] != 12)) return -1;
+        if (p[0] >= 8) {
+            v->is_negative = p[1];
+            memcpy(&i32, p + 2, 4);
+            v->hour = i32 * 24 + p[6];
+            v->minute = p[7];
+            v->second = p[8];
+        }
+        if (p[0] == 12) {
+            memcpy(&i32, p + 9, 4);
+            v->microsecond = i32;
+        }
+        break;
+    default:
         return 0;
     }
-    *data += 1; *data_l -= 1;
-    if (warning_count) *warning_count = **(uint16_t**)data;
-    *data += 2; *data_l -= 2;
-    server_status = **(uint16_t**)data;
-    *data += 2; *data_l -= 2;
-    if (has_next) *has_next = server_status & MYSQL_SERVER_MORE_RESULTS_EXISTS;
+
+    *data += n;
+    *data_l -= n;
+
     return 1;
 }
 
-static unsigned long long read_length_encoded_integer(
-    char **data,
-    unsigned long long *data_l,
-    int *is_null
-) {
-    if (is_null) *is_null = 0;
+//
+// Format a float with the fewest digits that read back as the same value,
+// which is how the server prints FLOAT columns in the text protocol.
+//
+static int format_float32(float f, char *buf, size_t buf_l) {
+    int n = 0;
+    for (int prec = 6; prec <= 9; prec++) {
+        n = snprintf(buf, buf_l, "%.*g", prec, (double)f);
+        if ((float)parse_double(buf, n) == f) break;
+    }
+    return n;
+}
+
+//
+// Format a binary value as the server would in the text protocol.
+//
+static unsigned long long binary_value_to_text(
+    int type_code,
+    int is_unsigned,
+    BinaryValue *v,
+    char *buf,
+    size_t buf_l
+) {
+    int n = 0;
+
+    switch (type_code) {
+    case MYSQL_TYPE_LONGLONG:
+        if (is_unsigned) {
+            n = snprintf(buf, buf_l, "%llu", (unsigned long long)v->u64);
+            break;
+        }
+        // Fall through
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_YEAR:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+        n = snprintf(buf, buf_l, "%lld", (long long)v->i64);
+        break;
+    case MYSQL_TYPE_FLOAT:
+        n = format_float32((float)v->f64, buf, buf_l);
+        break;
+    case MYSQL_TYPE_DOUBLE:
+        n = snprintf(buf, buf_l, "%.17g", v->f64);
+        break;
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_NEWDATE:
+        n = snprintf(buf, buf_l, "%04d-%02d-%02d", v->year, v->month, v->day);
+        break;
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_TIMESTAMP:
+        n = snprintf(buf, buf_l, "%04d-%02d-%02d %02d:%02d:%02d",
+                     v->year, v->month, v->day, v->hour, v->minute, v->second);
+        if (v->microsecond) n += snprintf(buf + n, buf_l - n, ".%06d", v->microsecond);
+        break;
+    case MYSQL_TYPE_TIME:
+        n = snprintf(buf, buf_l, "%s%02d:%02d:%02d", (v->is_negative) ? "-" : "",
+                     v->hour, v->minute, v->second);
+        if (v->microsecond) n += snprintf(buf + n, buf_l - n, ".%06d", v->microsecond);
+        break;
+    }
+
+    return (n < 0) ? 0 : (unsigned long long)n;
+}
+
+//
+// Store a binary value in the packed buffer of its column.
+//
+// Returns 1 without storing anything for invalid dates, as
+// append_column_value does.
+//
+static int append_binary_column_value(ColumnBuffer *col, BinaryValue *v) {
+    int64_t i64 = v->i64;
+    double f64 = v->f64;
+    int is_null = 0;
+    char *slot = NULL;
+
+    switch (col->kind) {
+    case ACCEL_COL_DATE:
+    case ACCEL_COL_DATE64:
+    case ACCEL_COL_DATETIME:
+        // Zero dates are NULL, as in the text protocol.
+        if (v->year == 0 && v->month == 0 && v->day == 0) {
+            is_null = 1;
+            break;
+        }
+        if (!is_valid_date(v->year, v->month, v->day)) return 1;
+        i64 = days_from_civil(v->year, v->month, v->day);
+        if (col->kind == ACCEL_COL_DATE64) {
+            i64 *= 86400000;
+        } else if (col->kind == ACCEL_COL_DATETIME) {
+            i64 = ((i64 * 24 + v->hour) * 60 + v->minute) * 60 + v->second;
+            i64 = i64 * 1000000 + v->microsecond;
+        }
+        break;
+    case ACCEL_COL_TIME:
+        i64 = ((int64_t)v->hour * 60 + v->minute) * 60 + v->second;
+        i64 = i64 * 1000000 + v->microsecond;
+        if (v->is_negative) i64 = -i64;
+        break;
+    }
+
+    slot = ColumnBuffer_append(col, is_null);
+    if (!slot) return -1;
+
+    if (is_null) {
+        memset(slot, 0, col->itemsize);
+        return 0;
+    }
+
+    switch (col->kind) {
+    case ACCEL_COL_INT:
+    case ACCEL_COL_UINT:
+        switch (col->itemsize) {
+        case 1: *(int8_t*)slot = (int8_t)i64; break;
+        case 2: *(int16_t*)slot = (int16_t)i64; break;
+        case 4: *(int32_t*)slot = (int32_t)i64; break;
+        default: memcpy(slot, &i64, 8);
+        }
+        break;
+    case ACCEL_COL_FLOAT:
+        *(float*)slot = (float)f64;
+        break;
+    case ACCEL_COL_DOUBLE:
+        memcpy(slot, &f64, 8);
+        break;
+    default:
+        memcpy(slot, &i64, 8);
+    }
+
+    return 0;
+}
+
+//
+// Convert a binary value to its default Python object.
+//
+// Returns NULL without an exception set if the value needs the handling
+// of the text path (zero or invalid dates).
+//
+static PyObject *binary_value_to_object(
+    StateObject *py_state,
+    unsigned long i,
+    BinaryValue *v
+) {
+    char buf[32];
+
+    switch (py_state->type_codes[i]) {
+    case MYSQL_TYPE_LONGLONG:
+        if (py_state->flags[i] & MYSQL_FLAG_UNSIGNED) {
+            return PyLong_FromUnsignedLongLong(v->u64);
+        }
+        return PyLong_FromLongLong(v->i64);
+    case MYSQL_TYPE_TINY:
+    case MYSQL_TYPE_SHORT:
+    case MYSQL_TYPE_YEAR:
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+        return PyLong_FromLongLong(v->i64);
+    case MYSQL_TYPE_FLOAT:
+        // Match the value parsed from the text protocol.
+        return PyFloat_FromDouble(parse_double(buf, format_float32((float)v->f64, buf, sizeof(buf))));
+    case MYSQL_TYPE_DOUBLE:
+        return PyFloat_FromDouble(v->f64);
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_NEWDATE:
+        if (!is_valid_date(v->year, v->month, v->day)) return NULL;
+        return get_date(py_state, v->year, v->month, v->day);
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_TIMESTAMP:
+        if (!is_valid_date(v->year, v->month, v->day)) return NULL;
+        return PyDateTime_FromDateAndTime(
+#ifdef Py_LIMITED_API
+                    py_state,
+#endif
+                    v->year, v->month, v->day, v->hour, v->minute, v->second,
+                    v->microsecond);
+    case MYSQL_TYPE_TIME: {
+        int sign = (v->is_negative) ? -1 : 1;
+        return PyDelta_FromDSU(
+#ifdef Py_LIMITED_API
+                    py_state,
+#endif
+                    0, sign * ((v->hour * 60 + v->minute) * 60 + v->second),
+                    sign * v->microsecond);
+        }
+    }
+
+    return NULL;
+}
+
+//
+// Convert a non-NULL text cell to its Python object, using the converter
+// of the column if it has one.
+//
+static PyObject *decode_cell(
+    StateObject *py_state,
+    unsigned long i,
+    char *out,
+    unsigned long long out_l
+) {
+    char *orig_out = out;
+    unsigned long long orig_out_l = out_l;
+    PyObject *py_item = NULL;
+    PyObject *py_str = NULL;
+    PyObject *py_memview = NULL;
+    char *cast_type_codes[] = {"", "f", "d", "b", "h", "i", "q"};
+    int item_type_lengths[] = {0, 4, 8, 1, 2, 4, 8};
+
+    int sign = 1;
+    int year = 0;
+    int month = 0;
+    int day = 0;
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+    int microsecond = 0;
+
+    // If a converter was passed in, use it.
+    if (py_state->py_converters[i]) {
+        py_str = NULL;
+        if (py_state->encodings[i] == NULL) {
+            py_str = PyBytes_FromStringAndSize(out, out_l);
+            if (!py_str) goto error;
+        } else {
+            py_str = decode_interned(State_string_table(py_state, i), out, out_l,
+                                     py_state->codecs[i], py_state->encodings[i],
+                                     py_state->encoding_errors);
+            if (!py_str) goto error;
+        }
+        if (py_state->py_converters[i] == Py_None) {
+            py_item = py_str;
+        } else {
+            py_item = call_one(py_state->py_converters[i], py_str);
+            Py_CLEAR(py_str);
+        }
+        if (!py_item) goto error;
+    }
+
+    // If no converter was passed in, do the default processing.
+    else {
+        switch (py_state->type_codes[i]) {
+        case MYSQL_TYPE_NEWDECIMAL:
+        case MYSQL_TYPE_DECIMAL:
+            // Opt-in plain number types for row results
+            if (!py_state->columns &&
+                    py_state->options.decimal_type == ACCEL_DECIMAL_FLOAT) {
+                py_item = PyFloat_FromDouble(parse_double(out, out_l));
+                if (!py_item) goto error;
+                break;
+            }
+            if (!py_state->columns &&
+                    py_state->options.decimal_type == ACCEL_DECIMAL_SCALED_INT) {
+                py_item = decimal_to_scaled_int(out, out_l, (int)py_state->scales[i]);
+                if (!py_item) goto error;
+                break;
+            }
+            py_str = decode_text(out, out_l, py_state->codecs[i], py_state->encodings[i],
+                                 py_state->encoding_errors);
+            if (!py_str) goto error;
+
+            py_item = call_one(PyFunc.decimal_Decimal, py_str);
+            Py_CLEAR(py_str);
+            if (!py_item) goto error;
+            break;
+
+        case MYSQL_TYPE_TINY:
+        case MYSQL_TYPE_SHORT:
+        case MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_LONGLONG:
+        case MYSQL_TYPE_INT24:
+            if (py_state->flags[i] & MYSQL_FLAG_UNSIGNED) {
+                py_item = PyLong_FromUnsignedLongLong(parse_uint64(out, out_l));
+            } else {
+                py_item = PyLong_FromLongLong(parse_int64(out, out_l));
+            }
+            if (!py_item) goto error;
+            break;
+
+        case MYSQL_TYPE_FLOAT:
+        case MYSQL_TYPE_DOUBLE:
+            py_item = PyFloat_FromDouble(parse_double(out, out_l));
+            if (!py_item) goto error;
+            break;
+
+        case MYSQL_TYPE_NULL:
+            py_item = Py_None;
+            Py_INCREF(Py_None);
+            break;
+
+        case MYSQL_TYPE_DATETIME:
+        case MYSQL_TYPE_TIMESTAMP:
+            py_item = TemporalMemo_get(&py_state->temporal_memo[i], out, out_l);
+            if (py_item) break;
+            if (CHECK_ANY_ZERO_DATETIME_STR(out, out_l)) {
+                py_item = Py_None;
+                Py_INCREF(Py_None);
+                break;
+            }
+            else if (!CHECK_ANY_DATETIME_STR(out, out_l)) {
+                if (py_state->py_invalid_values[i]) {
+                    py_item = py_state->py_invalid_values[i];
+                    Py_INCREF(py_item);
+                } else {
+                    py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
+                    if (!py_item) goto error;
+                }
+                break;
+            }
+            year = CHR2INT4(out); out += 5;
+            month = CHR2INT2(out); out += 3;
+            day = CHR2INT2(out); out += 3;
+            hour = CHR2INT2(out); out += 3;
+            minute = CHR2INT2(out); out += 3;
+            second = CHR2INT2(out); out += 3;
+            microsecond = (IS_DATETIME_MICRO(out, out_l)) ? CHR2INT6(out) :
+                          (IS_DATETIME_MILLI(out, out_l)) ? CHR2INT3(out) * 1e3 : 0;
+            py_item = PyDateTime_FromDateAndTime(
+#ifdef Py_LIMITED_API
+                            py_state,
+#endif
+                            year, month, day, hour, minute, second, microsecond);
+            if (py_item) {
+                TemporalMemo_set(&py_state->temporal_memo[i], orig_out, orig_out_l, py_item);
+            } else {
+                PyErr_Clear();
+                py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
+            }
+            if (!py_item) goto error;
+            break;
+
+        case MYSQL_TYPE_NEWDATE:
+        case MYSQL_TYPE_DATE:
+            if (CHECK_ZERO_DATE_STR(out, out_l)) {
+                py_item = Py_None;
+                Py_INCREF(Py_None);
+                break;
+            }
+            else if (!CHECK_DATE_STR(out, out_l)) {
+                if (py_state->py_invalid_values[i]) {
+                    py_item = py_state->py_invalid_values[i];
+                    Py_INCREF(py_item);
+                } else {
+                    py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
+                    if (!py_item) goto error;
+                }
+                break;
+            }
+            year = CHR2INT4(out); out += 5;
+            month = CHR2INT2(out); out += 3;
+            day = CHR2INT2(out); out += 3;
+            py_item = get_date(py_state, year, month, day);
+            if (!py_item) {
+                PyErr_Clear();
+                py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
+            }
+            if (!py_item) goto error;
+            break;
+
+        case MYSQL_TYPE_TIME:
+            py_item = TemporalMemo_get(&py_state->temporal_memo[i], out, out_l);
+            if (py_item) break;
+            sign = CHECK_ANY_TIMEDELTA_STR(out, out_l);
+            if (!sign) {
+                if (py_state->py_invalid_values[i]) {
+                    py_item = py_state->py_invalid_values[i];
+                    Py_INCREF(py_item);
+                } else {
+                    py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
+                    if (!py_item) goto error;
+                }
+                break;
+            } else if (sign < 0) {
+                out += 1; out_l -= 1;
+            }
+            if (IS_TIMEDELTA1(out, out_l)) {
+                hour = CHR2INT1(out); out += 2;
+                minute = CHR2INT2(out); out += 3;
+                second = CHR2INT2(out); out += 3;
+                microsecond = (IS_TIMEDELTA_MICRO(out, out_l)) ? CHR2INT6(out) :
+                              (IS_TIMEDELTA_MILLI(out, out_l)) ? CHR2INT3(out) * 1e3 : 0;
+            }
+            else if (IS_TIMEDELTA2(out, out_l)) {
+                hour = CHR2INT2(out); out += 3;
+                minute = CHR2INT2(out); out += 3;
+                second = CHR2INT2(out); out += 3;
+                microsecond = (IS_TIMEDELTA_MICRO(out, out_l)) ? CHR2INT6(out) :
+                              (IS_TIMEDELTA_MILLI(out, out_l)) ? CHR2INT3(out) * 1e3 : 0;
+            }
+            else if (IS_TIMEDELTA3(out, out_l)) {
+                hour = CHR2INT3(out); out += 4;
+                minute = CHR2INT2(out); out += 3;
+                second = CHR2INT2(out); out += 3;
+                microsecond = (IS_TIMEDELTA_MICRO(out, out_l)) ? CHR2INT6(out) :
+                              (IS_TIMEDELTA_MILLI(out, out_l)) ? CHR2INT3(out) * 1e3 : 0;
+            }
+            py_item = PyDelta_FromDSU(
+#ifdef Py_LIMITED_API
+                            py_state,
+#endif
+                            0, sign * hour * 60 * 60 +
+                               sign * minute * 60 +
+                               sign * second,
+                               sign * microsecond);
+            if (py_item) {
+                TemporalMemo_set(&py_state->temporal_memo[i], orig_out, orig_out_l, py_item);
+            } else {
+                PyErr_Clear();
+                py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
+            }
+            if (!py_item) goto error;
+            break;
+
+        case MYSQL_TYPE_YEAR:
+            if (out_l == 0) {
+                goto error;
+                break;
+            }
+            year = (int)parse_uint64(out, out_l);
+            py_item = PyLong_FromCachedLong(year);
+            if (!py_item) goto error;
+            break;
+
+        case MYSQL_TYPE_BIT:
+        case MYSQL_TYPE_JSON:
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+        case MYSQL_TYPE_GEOMETRY:
+        case MYSQL_TYPE_ENUM:
+        case MYSQL_TYPE_SET:
+        case MYSQL_TYPE_VARCHAR:
+        case MYSQL_TYPE_VAR_STRING:
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_FLOAT32_VECTOR_JSON:
+        case MYSQL_TYPE_FLOAT64_VECTOR_JSON:
+        case MYSQL_TYPE_INT8_VECTOR_JSON:
+        case MYSQL_TYPE_INT16_VECTOR_JSON:
+        case MYSQL_TYPE_INT32_VECTOR_JSON:
+        case MYSQL_TYPE_INT64_VECTOR_JSON:
+            if (!py_state->encodings[i]) {
+                py_item = PyBytes_FromStringAndSize(out, out_l);
+                if (!py_item) goto error;
+                break;
+            }
+
+            // JSON vectors are parsed straight into numpy arrays.
+            if (py_state->type_codes[i] >= MYSQL_TYPE_FLOAT32_VECTOR_JSON
+                    && py_state->type_codes[i] <= MYSQL_TYPE_INT64_VECTOR_JSON
+                    && py_state->codecs[i] != ACCEL_CODEC_OTHER
+                    && ensure_numpy() == 0) {
+                py_item = vector_json_to_numpy(out, out_l, py_state->type_codes[i] % 1000);
+                if (py_item) break;
+                if (PyErr_Occurred()) goto error;
+            }
 
-    if (!data || !data_l || *data_l == 0) {
-        if (is_null) *is_null = 1;
-        return 0;
-    }
+            // Parse JSON string.
+            if ((py_state->type_codes[i] == MYSQL_TYPE_JSON && py_state->options.parse_json)
+                || (py_state->type_codes[i] >= MYSQL_TYPE_FLOAT32_VECTOR_JSON
+                    && py_state->type_codes[i] <= MYSQL_TYPE_INT64_VECTOR_JSON)) {
+                py_item = parse_json_cell(out, out_l, py_state->codecs[i],
+                                          py_state->encodings[i],
+                                          py_state->encoding_errors,
+                                          State_string_table(py_state, i));
+                if (!py_item) goto error;
+            } else {
+                py_item = decode_interned(State_string_table(py_state, i), out, out_l,
+                                          py_state->codecs[i], py_state->encodings[i],
+                                          py_state->encoding_errors);
+                if (!py_item) goto error;
+            }
 
-    uint8_t c = **(uint8_t**)data;
-    *data += 1; *data_l -= 1;
+            if (ensure_numpy() == 0) {
+                switch (py_state->type_codes[i]) {
+                case MYSQL_TYPE_FLOAT32_VECTOR_JSON:
+                case MYSQL_TYPE_FLOAT64_VECTOR_JSON:
+                case MYSQL_TYPE_INT8_VECTOR_JSON:
+                case MYSQL_TYPE_INT16_VECTOR_JSON:
+                case MYSQL_TYPE_INT32_VECTOR_JSON:
+                case MYSQL_TYPE_INT64_VECTOR_JSON:
+                    CHECKRC(PyTuple_SetItem(PyObj.create_numpy_array_args, 0, py_item));
+                    py_item = PyObject_Call(
+                        PyFunc.numpy_array,
+                        PyObj.create_numpy_array_args,
+                        PyObj.create_numpy_array_kwargs_vector[py_state->type_codes[i] % 1000]
+                    );
+                    if (!py_item) goto error;
+                }
+            }
 
-    if (c == MYSQL_COLUMN_NULL) {
-        if (is_null) *is_null = 1;
-        return 0;
+            break;
+
+        case MYSQL_TYPE_FLOAT32_VECTOR:
+        case MYSQL_TYPE_FLOAT64_VECTOR:
+        case MYSQL_TYPE_INT8_VECTOR:
+        case MYSQL_TYPE_INT16_VECTOR:
+        case MYSQL_TYPE_INT32_VECTOR:
+        case MYSQL_TYPE_INT64_VECTOR:
+        {
+            int type_idx = py_state->type_codes[i] % 1000;
+
+            if (ensure_numpy() == 0) {
+                py_memview = PyBytes_FromStringAndSize(out, out_l);
+                if (!py_memview) goto error;
+
+                CHECKRC(PyTuple_SetItem(PyObj.create_numpy_array_args, 0, py_memview));
+
+                py_item = PyObject_Call(
+                    PyFunc.numpy_frombuffer,
+                    PyObj.create_numpy_array_args,
+                    PyObj.create_numpy_array_kwargs_vector[type_idx]
+                );
+                if (!py_item) goto error;
+
+            } else {
+                py_memview = PyBytes_FromStringAndSize(out, out_l);
+                if (!py_memview) goto error;
+
+                CHECKRC(PyTuple_SetItem(PyObj.struct_unpack_args, 0,
+                                        PyUnicode_FromFormat("<%ld%s", out_l / item_type_lengths[type_idx], cast_type_codes[type_idx])));
+                CHECKRC(PyTuple_SetItem(PyObj.struct_unpack_args, 1, py_memview));
+
+                py_item = PyObject_Call(
+                    PyFunc.struct_unpack,
+                    PyObj.struct_unpack_args,
+                    NULL
+                );
+                if (!py_item) goto error;
+            }
+
+            break;
+        }
+
+        case MYSQL_TYPE_BSON:
+            py_item = decode_bson_cell(out, out_l, State_string_table(py_state, i),
+                                       py_state->options.lazy_bson);
+            if (py_item) break;
+            if (PyErr_Occurred()) goto error;
+
+            py_item = PyBytes_FromStringAndSize(out, out_l);
+            if (!py_item) goto error;
+
+            if (ensure_bson() == 0) {
+                CHECKRC(PyTuple_SetItem(PyObj.bson_decode_args, 0, py_item));
+                py_item = PyObject_Call(
+                    PyFunc.bson_decode,
+                    PyObj.bson_decode_args,
+                    NULL
+                );
+                if (!py_item) goto error;
+            }
+
+            break;
+
+        default:
+            PyErr_Format(PyExc_TypeError, "unknown type code: %ld",
+                         py_state->type_codes[i], NULL);
+            goto error;
+        }
     }
 
-    if (c < MYSQL_COLUMN_UNSIGNED_CHAR) {
-        return c;
+exit:
+    return py_item;
+
+error:
+    Py_CLEAR(py_item);
+    goto exit;
+}
+
+//
+// Convert a packed decimal128 value back to a Decimal.
+//
+static PyObject *decimal128_to_object(const char *slot, int scale) {
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+    uint32_t limbs[4];
+    char digits[40];
+    char text[80];
+    int n_digits = 0;
+    int n = 0;
+    PyObject *py_str = NULL;
+    PyObject *py_out = NULL;
+
+#ifdef ACCEL_LITTLE_ENDIAN
+    memcpy(&lo, slot, 8);
+    memcpy(&hi, slot + 8, 8);
+#else
+    memcpy(&hi, slot, 8);
+    memcpy(&lo, slot + 8, 8);
+#endif
+    if (hi >> 63) {
+        text[n++] = '-';
+        lo = ~lo + 1;
+        hi = ~hi + (lo == 0);
     }
 
-    if (c == MYSQL_COLUMN_UNSIGNED_SHORT) {
-        if (*data_l < 2) {
-            if (is_null) *is_null = 1;
-            return 0;
+    // Digits of the magnitude, least significant first
+    limbs[0] = (uint32_t)(hi >> 32);
+    limbs[1] = (uint32_t)hi;
+    limbs[2] = (uint32_t)(lo >> 32);
+    limbs[3] = (uint32_t)lo;
+    do {
+        uint64_t rem = 0;
+        for (int j = 0; j < 4; j++) {
+            uint64_t cur = (rem << 32) | limbs[j];
+            limbs[j] = (uint32_t)(cur / 10);
+            rem = cur % 10;
         }
-        uint16_t out = **(uint16_t**)data;
-        *data += 2; *data_l -= 2;
-        return out;
+        digits[n_digits++] = (char)('0' + rem);
+    } while (limbs[0] || limbs[1] || limbs[2] || limbs[3]);
+
+    if (scale < 0 || scale > 38) scale = 0;
+    if (n_digits <= scale) {
+        text[n++] = '0';
+        text[n++] = '.';
+        for (int j = n_digits; j < scale; j++) text[n++] = '0';
+    }
+    for (int j = n_digits - 1; j >= 0; j--) {
+        if (j == scale - 1 && n_digits > scale) text[n++] = '.';
+        text[n++] = digits[j];
     }
 
-    if (c == MYSQL_COLUMN_UNSIGNED_INT24) {
-        if (*data_l < 3) {
-            if (is_null) *is_null = 1;
-            return 0;
+    py_str = PyUnicode_FromStringAndSize(text, n);
+    if (!py_str) return NULL;
+    py_out = call_one(PyFunc.decimal_Decimal, py_str);
+    Py_DECREF(py_str);
+    return py_out;
+}
+
+//
+// Switch a packed date, time or decimal column to a list of objects, for
+// a cell that its packed type can not represent. Values packed so far are
+// converted to the objects the row path would have returned.
+//
+static int demote_column(StateObject *py_state, ColumnBuffer *col) {
+    PyObject *py_values = NULL;
+    PyObject *py_item = NULL;
+    unsigned long long length = col->length;
+    int year = 0, month = 0, day = 0;
+
+    py_values = PyList_New((Py_ssize_t)length);
+    if (!py_values) goto error;
+
+    for (unsigned long long k = 0; k < length; k++) {
+        int64_t i64 = 0;
+        int64_t days = 0;
+        int64_t micros = 0;
+
+        if (col->mask[k]) {
+            Py_INCREF(Py_None);
+            CHECKRC(PyList_SetItem(py_values, (Py_ssize_t)k, Py_None));
+            continue;
         }
-        uint16_t low = **(uint8_t**)data;
-        *data += 1; *data_l -= 1;
-        uint16_t high = **(uint16_t**)data;
-        *data += 2; *data_l -= 2;
-        return low + (high << 16);
-    }
 
-    if (c == MYSQL_COLUMN_UNSIGNED_INT64) {
-        if (*data_l < 8) {
-            if (is_null) *is_null = 1;
-            return 0;
+        if (col->kind == ACCEL_COL_DECIMAL128) {
+            py_item = decimal128_to_object(col->values + k * 16, col->scale);
+            if (!py_item) goto error;
+            CHECKRC(PyList_SetItem(py_values, (Py_ssize_t)k, py_item));
+            continue;
         }
-        uint64_t out = **(uint64_t**)data;
-        *data += 8; *data_l -= 8;
-        return out;
+
+        memcpy(&i64, col->values + k * 8, 8);
+
+        switch (col->kind) {
+        case ACCEL_COL_DATE:
+        case ACCEL_COL_DATE64:
+            days = (col->kind == ACCEL_COL_DATE64) ? i64 / 86400000 : i64;
+            civil_from_days(days, &year, &month, &day);
+            py_item = get_date(py_state, year, month, day);
+            break;
+        case ACCEL_COL_DATETIME:
+            days = i64 / 86400000000LL;
+            micros = i64 % 86400000000LL;
+            if (micros < 0) { micros += 86400000000LL; days--; }
+            civil_from_days(days, &year, &month, &day);
+            py_item = PyDateTime_FromDateAndTime(
+#ifdef Py_LIMITED_API
+                            py_state,
+#endif
+                            year, month, day, (int)(micros / 3600000000LL),
+                            (int)(micros / 60000000 % 60), (int)(micros / 1000000 % 60),
+                            (int)(micros % 1000000));
+            break;
+        case ACCEL_COL_TIME:
+            py_item = PyDelta_FromDSU(
+#ifdef Py_LIMITED_API
+                            py_state,
+#endif
+                            0, (int)(i64 / 1000000), (int)(i64 % 1000000));
+            break;
+        default:
+            PyErr_SetString(PyExc_TypeError, "column can not be converted to objects");
+            goto error;
+        }
+        if (!py_item) goto error;
+        CHECKRC(PyList_SetItem(py_values, (Py_ssize_t)k, py_item));
     }
 
-    if (is_null) *is_null = 1;
+    ColumnBuffer_reset(col);
+    set_column_kind(col, ACCEL_COL_OBJECT, 0, NULL);
+    col->format = NULL;
+    col->py_values = py_values;
+    col->length = length;
     return 0;
+
+error:
+    Py_XDECREF(py_values);
+    return -1;
 }
 
-static void read_length_coded_string(
-    char **data,
-    unsigned long long *data_l,
-    char **out,
-    unsigned long long *out_l,
-    int *is_null
-) {
-    if (is_null) *is_null = 0;
+//
+// Convert a fixed-width binary cell to its Python object. Cells with a
+// converter, and zero or invalid dates, take the text path.
+//
+static PyObject *decode_binary_cell(StateObject *py_state, unsigned long i, BinaryValue *v) {
+    PyObject *py_item = NULL;
+    char text[64];
 
-    if (!data || !data_l || !out || !out_l) {
-        if (is_null) *is_null = 1;
-        return;
+    if (!py_state->py_converters[i]) {
+        py_item = binary_value_to_object(py_state, i, v);
+        if (py_item || PyErr_Occurred()) return py_item;
     }
 
-    unsigned long long length = read_length_encoded_integer(data, data_l, is_null);
+    return decode_cell(py_state, i, text,
+                       binary_value_to_text(py_state->type_codes[i],
+                                            py_state->flags[i] & MYSQL_FLAG_UNSIGNED,
+                                            v, text, sizeof(text)));
+}
 
-    if (is_null && *is_null) {
-        return;
+//
+// Lazy rows
+//
+// Rows of the lazyrows results type keep the packet of the row and the
+// position of each cell, found in a single pass over the row, and decode a
+// cell the first time it is accessed by index, name, or attribute. Packets
+// are copied into blocks shared by consecutive rows, and all rows of a
+// result decode with one detached state (see State_new_layout).
+//
+
+// Size of the blocks that row packets are copied into
+#define ACCEL_LAZY_BLOCK_SIZE 65536
+
+// Cell length of NULL values
+#define ACCEL_LAZY_NULL UINT32_MAX
+
+static PyTypeObject *LazyRowType = NULL;
+
+typedef struct {
+    PyObject *py_value; // Decoded value, or NULL until first accessed
+    uint32_t offset; // Offset of the cell in the row packet
+    uint32_t length; // Length of the cell (ACCEL_LAZY_NULL for NULL)
+} LazyCell;
+
+typedef struct {
+    PyObject_VAR_HEAD
+    StateObject *py_layout; // Decoding state shared by the rows of a result
+    PyObject *py_block; // Bytearray holding the row packet
+    char *data; // Start of the row packet in py_block
+    LazyCell cells[1]; // One per column
+} LazyRowObject;
+
+//
+// Create a lazy row from a row packet.
+//
+static PyObject *LazyRow_from_packet(StateObject *py_state, char *data, unsigned long long data_l) {
+    LazyRowObject *py_row = NULL;
+    PyObject *py_block = py_state->py_row_block;
+    unsigned char *null_bitmap = NULL;
+    unsigned long long null_bitmap_l = 0;
+    char *row = NULL;
+    char *out = NULL;
+    unsigned long long out_l = 0;
+    int is_null = 0;
+    BinaryValue binary_value;
+
+    if (data_l >= ACCEL_LAZY_NULL) {
+        PyErr_SetString(PyExc_ValueError, "row is too large for the lazyrows results type");
+        return NULL;
     }
 
-    length = (length > *data_l) ? *data_l : length;
+    // Copy the packet into the current block, with a spare byte that lets
+    // decoders peek past the last cell.
+    if (!py_block ||
+            py_state->row_block_pos + data_l + 1 > (unsigned long long)PyByteArray_Size(py_block)) {
+        py_block = PyByteArray_FromStringAndSize(NULL, MAX(ACCEL_LAZY_BLOCK_SIZE, data_l + 1));
+        if (!py_block) return NULL;
+        Py_XDECREF(py_state->py_row_block);
+        py_state->py_row_block = py_block;
+        py_state->row_block_pos = 0;
+    }
+    row = PyByteArray_AsString(py_block) + py_state->row_block_pos;
+    memcpy(row, data, data_l);
+    row[data_l] = '\0';
+    py_state->row_block_pos += data_l + 1;
+
+    py_row = (LazyRowObject*)PyType_GenericAlloc(LazyRowType, py_state->n_cols);
+    if (!py_row) return NULL;
+    py_row->py_layout = (StateObject*)py_state->py_layout;
+    Py_INCREF(py_row->py_layout);
+    py_row->py_block = py_block;
+    Py_INCREF(py_block);
+    py_row->data = row;
+
+    data = row;
+
+    // Binary protocol rows: 0x00 header and NULL bitmap.
+    if (py_state->options.binary_protocol) {
+        null_bitmap_l = (py_state->n_cols + 9) / 8;
+        if (data_l < 1 + null_bitmap_l) goto truncated;
+        null_bitmap = (unsigned char*)data + 1;
+        data += 1 + null_bitmap_l;
+        data_l -= 1 + null_bitmap_l;
+    }
 
-    *out = *data;
-    *out_l = length;
+    for (unsigned long i = 0; i < py_state->n_cols; i++) {
+        LazyCell *cell = &py_row->cells[i];
 
-    *data += length;
-    *data_l -= length;
+        if (null_bitmap) {
+            if ((null_bitmap[(i + 2) >> 3] >> ((i + 2) & 7)) & 1) {
+                cell->length = ACCEL_LAZY_NULL;
+                continue;
+            }
+            // Fixed-width values are read again when decoded.
+            out = data;
+            int rc = read_binary_value(py_state->type_codes[i],
+                                       py_state->flags[i] & MYSQL_FLAG_UNSIGNED,
+                                       &data, &data_l, &binary_value);
+            if (rc < 0) goto truncated;
+            if (rc > 0) {
+                cell->offset = (uint32_t)(out - row);
+                cell->length = (uint32_t)(data - out);
+                continue;
+            }
+        }
 
-    return;
-}
+        read_length_coded_string(&data, &data_l, &out, &out_l, &is_null);
+        cell->offset = (uint32_t)(out - row);
+        cell->length = (is_null) ? ACCEL_LAZY_NULL : (uint32_t)out_l;
+    }
 
-#ifdef Py_LIMITED_API
+    return (PyObject*)py_row;
 
-static PyObject *PyDate_FromDate(
-    StateObject *py_state,
-    int year,
-    int month,
-    int day
-) {
-    PyObject *out = NULL;
-    PyObject *py_year = NULL;
-    int free_year = 0;
+truncated:
+    PyErr_SetString(PyExc_ValueError, "truncated binary protocol row");
+    Py_DECREF(py_row);
+    return NULL;
+}
 
-    if (year >= 0 && year <= 60) {
-       py_year = PyInts[year];
-    } else {
-       free_year = 1;
-       py_year = PyLong_FromLong(year);
+//
+// Return the value of a cell, decoding it on first access.
+//
+static PyObject *LazyRow_cell(LazyRowObject *self, Py_ssize_t i) {
+    StateObject *py_layout = self->py_layout;
+    LazyCell *cell = &self->cells[i];
+    char *out = self->data + cell->offset;
+    unsigned long long out_l = cell->length;
+    BinaryValue binary_value;
+
+    if (!cell->py_value) {
+        if (cell->length == ACCEL_LAZY_NULL) {
+            cell->py_value = Py_None;
+            Py_INCREF(Py_None);
+        } else if (py_layout->options.binary_protocol &&
+                   read_binary_value(py_layout->type_codes[i],
+                                     py_layout->flags[i] & MYSQL_FLAG_UNSIGNED,
+                                     &out, &out_l, &binary_value) > 0) {
+            cell->py_value = decode_binary_cell(py_layout, i, &binary_value);
+        } else {
+            cell->py_value = decode_cell(py_layout, i, out, out_l);
+        }
+        if (!cell->py_value) {
+            if (!PyErr_Occurred()) {
+                PyErr_Format(PyExc_ValueError, "invalid value in column %zd", i);
+            }
+            return NULL;
+        }
     }
 
-    out = PyObject_CallFunctionObjArgs(
-        PyFunc.datetime_date, py_year, PyInts[month], PyInts[day], NULL
-    );
+    Py_INCREF(cell->py_value);
+    return cell->py_value;
+}
 
-    if (free_year) Py_XDECREF(py_year);
+//
+// Decode all cells into a tuple.
+//
+static PyObject *LazyRow_to_tuple(LazyRowObject *self) {
+    PyObject *py_out = PyTuple_New(Py_SIZE(self));
+    if (!py_out) return NULL;
+    for (Py_ssize_t i = 0; i < Py_SIZE(self); i++) {
+        PyObject *py_item = LazyRow_cell(self, i);
+        if (!py_item) { Py_DECREF(py_out); return NULL; }
+        PyTuple_SetItem(py_out, i, py_item);
+    }
+    return py_out;
+}
 
-    return out;
+static Py_ssize_t LazyRow_length(LazyRowObject *self) {
+    return Py_SIZE(self);
 }
 
-static PyObject *PyDelta_FromDSU(
-    StateObject *py_state,
-    int days,
-    int seconds,
-    int microseconds
-) {
-    PyObject *out = NULL;
-    PyObject *py_days = NULL;
-    PyObject *py_seconds = NULL;
-    PyObject *py_microseconds = NULL;
-    int free_days = 0;
-    int free_seconds = 0;
-    int free_microseconds = 0;
-
-    if (days >= 0 && days <= 60) {
-        py_days = PyInts[days];
-    } else {
-        free_days = 1;
-        py_days = PyLong_FromLong(days);
+static PyObject *LazyRow_item(LazyRowObject *self, Py_ssize_t i) {
+    if (i < 0 || i >= Py_SIZE(self)) {
+        PyErr_SetString(PyExc_IndexError, "row index out of range");
+        return NULL;
     }
+    return LazyRow_cell(self, i);
+}
 
-    if (seconds >= 0 && seconds <= 60) {
-        py_seconds = PyInts[seconds];
-    } else {
-        free_seconds = 1;
-        py_seconds = PyLong_FromLong(seconds);
+static PyObject *LazyRow_subscript(LazyRowObject *self, PyObject *py_key) {
+    if (PyUnicode_Check(py_key)) {
+        PyObject *py_index = PyDict_GetItem(self->py_layout->py_name_index, py_key);
+        if (!py_index) {
+            PyErr_SetObject(PyExc_KeyError, py_key);
+            return NULL;
+        }
+        return LazyRow_cell(self, PyLong_AsSsize_t(py_index));
+    }
+
+    if (PySlice_Check(py_key)) {
+        Py_ssize_t start = 0, stop = 0, step = 0, n = 0;
+        PyObject *py_out = NULL;
+        if (PySlice_Unpack(py_key, &start, &stop, &step) < 0) return NULL;
+        n = PySlice_AdjustIndices(Py_SIZE(self), &start, &stop, step);
+        py_out = PyTuple_New(n);
+        if (!py_out) return NULL;
+        for (Py_ssize_t j = 0; j < n; j++, start += step) {
+            PyObject *py_item = LazyRow_cell(self, start);
+            if (!py_item) { Py_DECREF(py_out); return NULL; }
+            PyTuple_SetItem(py_out, j, py_item);
+        }
+        return py_out;
     }
 
-    if (microseconds >= 0 && microseconds <= 60) {
-        py_microseconds = PyInts[microseconds];
+    Py_ssize_t i = PyNumber_AsSsize_t(py_key, PyExc_IndexError);
+    if (i == -1 && PyErr_Occurred()) return NULL;
+    if (i < 0) i += Py_SIZE(self);
+    return LazyRow_item(self, i);
+}
+
+static PyObject *LazyRow_getattro(LazyRowObject *self, PyObject *py_name) {
+    PyObject *py_index = PyDict_GetItem(self->py_layout->py_name_index, py_name);
+    if (py_index) return LazyRow_cell(self, PyLong_AsSsize_t(py_index));
+    return PyObject_GenericGetAttr((PyObject*)self, py_name);
+}
+
+static PyObject *LazyRow_richcompare(LazyRowObject *self, PyObject *py_other, int op) {
+    PyObject *py_self = NULL;
+    PyObject *py_out = NULL;
+
+    if (Py_TYPE(py_other) == LazyRowType) {
+        py_other = LazyRow_to_tuple((LazyRowObject*)py_other);
+    } else if (PyTuple_Check(py_other)) {
+        Py_INCREF(py_other);
     } else {
-        free_microseconds = 1;
-        py_microseconds = PyLong_FromLong(microseconds);
+        Py_RETURN_NOTIMPLEMENTED;
     }
+    if (!py_other) return NULL;
 
-    out = PyObject_CallFunctionObjArgs(
-        PyFunc.datetime_timedelta, py_days, py_seconds, py_microseconds, NULL
-    );
+    py_self = LazyRow_to_tuple(self);
+    if (py_self) py_out = PyObject_RichCompare(py_self, py_other, op);
 
-    if (free_days) Py_XDECREF(py_days);
-    if (free_seconds) Py_XDECREF(py_seconds);
-    if (free_microseconds) Py_XDECREF(py_microseconds);
+    Py_XDECREF(py_self);
+    Py_DECREF(py_other);
+    return py_out;
+}
 
+static Py_hash_t LazyRow_hash(LazyRowObject *self) {
+    Py_hash_t out = -1;
+    PyObject *py_tuple = LazyRow_to_tuple(self);
+    if (!py_tuple) return -1;
+    out = PyObject_Hash(py_tuple);
+    Py_DECREF(py_tuple);
     return out;
 }
 
-static PyObject *PyDateTime_FromDateAndTime(
-    StateObject *py_state,
-    int year,
-    int month,
-    int day,
-    int hour,
-    int minute,
-    int second,
-    int microsecond
-) {
-    PyObject *out = NULL;
-    PyObject *py_year = NULL;
-    PyObject *py_microsecond = NULL;
-    int free_year = 0;
-    int free_microsecond = 0;
+static PyObject *LazyRow_repr(LazyRowObject *self) {
+    PyObject *py_items = NULL;
+    PyObject *py_sep = NULL;
+    PyObject *py_body = NULL;
+    PyObject *py_out = NULL;
 
-    if (year >= 0 && year <= 60) {
-       py_year = PyInts[year];
-    } else {
-       free_year = 1;
-       py_year = PyLong_FromLong(year);
-    }
+    py_items = PyList_New(Py_SIZE(self));
+    if (!py_items) goto exit;
 
-    if (microsecond >= 0 && microsecond <= 60) {
-       py_microsecond = PyInts[microsecond];
-    } else {
-       free_microsecond = 1;
-       py_microsecond = PyLong_FromLong(microsecond);
+    for (Py_ssize_t i = 0; i < Py_SIZE(self); i++) {
+        PyObject *py_item = LazyRow_cell(self, i);
+        if (!py_item) goto exit;
+        PyObject *py_str = PyUnicode_FromFormat("%U=%R", self->py_layout->py_names[i], py_item);
+        Py_DECREF(py_item);
+        if (!py_str) goto exit;
+        PyList_SetItem(py_items, i, py_str);
     }
 
-    out = PyObject_CallFunctionObjArgs(
-        PyFunc.datetime_datetime, py_year, PyInts[month], PyInts[day],
-        PyInts[hour], PyInts[minute], PyInts[second], py_microsecond, NULL
-    );
+    py_sep = PyUnicode_FromString(", ");
+    if (!py_sep) goto exit;
+    py_body = PyUnicode_Join(py_sep, py_items);
+    if (!py_body) goto exit;
+    py_out = PyUnicode_FromFormat("LazyRow(%U)", py_body);
 
-    if (free_microsecond) Py_XDECREF(py_microsecond);
-    if (free_year) Py_XDECREF(py_year);
+exit:
+    Py_XDECREF(py_body);
+    Py_XDECREF(py_sep);
+    Py_XDECREF(py_items);
+    return py_out;
+}
 
-    return out;
+static void LazyRow_dealloc(LazyRowObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    for (Py_ssize_t i = 0; i < Py_SIZE(self); i++) {
+        Py_CLEAR(self->cells[i].py_value);
+    }
+    Py_CLEAR(self->py_layout);
+    Py_CLEAR(self->py_block);
+    PyObject_Del(self);
+    Py_DECREF(tp);
 }
 
-#endif
+static PyType_Slot LazyRowType_slots[] = {
+    {Py_tp_dealloc, (destructor)LazyRow_dealloc},
+    {Py_tp_getattro, (getattrofunc)LazyRow_getattro},
+    {Py_tp_richcompare, (richcmpfunc)LazyRow_richcompare},
+    {Py_tp_hash, (hashfunc)LazyRow_hash},
+    {Py_tp_repr, (reprfunc)LazyRow_repr},
+    {Py_sq_length, (lenfunc)LazyRow_length},
+    {Py_sq_item, (ssizeargfunc)LazyRow_item},
+    {Py_mp_length, (lenfunc)LazyRow_length},
+    {Py_mp_subscript, (binaryfunc)LazyRow_subscript},
+    {Py_tp_doc, "Row of a result that decodes its cells on first access"},
+    {0, NULL},
+};
+
+static PyType_Spec LazyRowType_spec = {
+    .name = ACCEL_STR(ACCEL_MODULE_NAME) ".LazyRow",
+    .basicsize = offsetof(LazyRowObject, cells),
+    .itemsize = sizeof(LazyCell),
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = LazyRowType_slots,
+};
 
 static PyObject *read_row_from_packet(
     StateObject *py_state,
@@ -1472,379 +7993,108 @@ static PyObject *read_row_from_packet(
     unsigned long long data_l
 ) {
     char *out = NULL;
-    char *orig_out = NULL;
     unsigned long long out_l = 0;
-    unsigned long long orig_out_l = 0;
     int is_null = 0;
     PyObject *py_result = NULL;
     PyObject *py_item = NULL;
-    PyObject *py_str = NULL;
-    PyObject *py_memview = NULL;
-    char end = '\0';
-    char *cast_type_codes[] = {"", "f", "d", "b", "h", "i", "q"};
-    int item_type_lengths[] = {0, 4, 8, 1, 2, 4, 8};
+    unsigned char *null_bitmap = NULL;
+    unsigned long long null_bitmap_l = 0;
+    BinaryValue binary_value;
 
-    int sign = 1;
-    int year = 0;
-    int month = 0;
-    int day = 0;
-    int hour = 0;
-    int minute = 0;
-    int second = 0;
-    int microsecond = 0;
+    if (py_state->options.results_type == ACCEL_OUT_LAZYROWS) {
+        return LazyRow_from_packet(py_state, data, data_l);
+    }
 
-    switch (py_state->options.results_type) {
+    switch ((py_state->columns) ? -1 : py_state->options.results_type) {
+    case -1:
+        // Cells go to the column buffers; there is no row object.
+        py_result = Py_None;
+        Py_INCREF(Py_None);
+        break;
     case ACCEL_OUT_DICTS:
     case ACCEL_OUT_ARROW:
         py_result = PyDict_New();
         break;
-    case ACCEL_OUT_STRUCTSEQUENCES: {
-        if (!py_state->structsequence) goto error;
-        py_result = PyStructSequence_New(py_state->structsequence);
-        break;
-        }
+    case ACCEL_OUT_STRUCTSEQUENCES:
     case ACCEL_OUT_NAMEDTUPLES:
-        if (!py_state->py_namedtuple) goto error;
-        if (!py_state->py_namedtuple_args) goto error;
-        py_result = py_state->py_namedtuple_args;
+        // Rows are tuples; the layout subtype only adds the column names.
+        if (!py_state->py_row_type) goto error;
+        py_result = PyType_GenericAlloc((PyTypeObject*)py_state->py_row_type,
+                                        py_state->n_cols);
         break;
     default:
         py_result = PyTuple_New(py_state->n_cols);
     }
 
-    for (unsigned long i = 0; i < py_state->n_cols; i++) {
-
-        read_length_coded_string(&data, &data_l, &out, &out_l, &is_null);
-        end = out[out_l];
-
-        orig_out = out;
-        orig_out_l = out_l;
+    if (!py_result) goto error;
 
-        py_item = Py_None;
+    // Binary protocol rows: 0x00 header and NULL bitmap.
+    if (py_state->options.binary_protocol) {
+        null_bitmap_l = (py_state->n_cols + 9) / 8;
+        if (data_l < 1 + null_bitmap_l) goto truncated;
+        null_bitmap = (unsigned char*)data + 1;
+        data += 1 + null_bitmap_l;
+        data_l -= 1 + null_bitmap_l;
+    }
 
-        // Don't convert if it's a NULL.
-        if (!is_null) {
+    for (unsigned long i = 0; i < py_state->n_cols; i++) {
 
-            // If a converter was passed in, use it.
-            if (py_state->py_converters[i]) {
-                py_str = NULL;
-                if (py_state->encodings[i] == NULL) {
-                    py_str = PyBytes_FromStringAndSize(out, out_l);
-                    if (!py_str) goto error;
-                } else {
-                    py_str = PyUnicode_Decode(out, out_l, py_state->encodings[i], py_state->encoding_errors);
-                    if (!py_str) goto error;
-                }
-                if (py_state->py_converters[i] == Py_None) {
-                    py_item = py_str;
-                } else {
-                    py_item = PyObject_CallFunctionObjArgs(py_state->py_converters[i], py_str, NULL);
-                    Py_CLEAR(py_str);
+        if (null_bitmap) {
+            int rc = 0;
+            is_null = (null_bitmap[(i + 2) >> 3] >> ((i + 2) & 7)) & 1;
+            if (is_null) {
+                out = data;
+                out_l = 0;
+            } else {
+                rc = read_binary_value(py_state->type_codes[i],
+                                       py_state->flags[i] & MYSQL_FLAG_UNSIGNED,
+                                       &data, &data_l, &binary_value);
+                if (rc < 0) goto truncated;
+            }
+            if (rc == 0) {
+                if (!is_null) read_length_coded_string(&data, &data_l, &out, &out_l, &is_null);
+            } else if (py_state->columns && py_state->columns[i].kind != ACCEL_COL_OBJECT &&
+                       (rc = append_binary_column_value(&py_state->columns[i], &binary_value)) <= 0) {
+                CHECKRC(rc);
+                continue;
+            } else {
+                if (py_state->columns && py_state->columns[i].kind != ACCEL_COL_OBJECT) {
+                    CHECKRC(demote_column(py_state, &py_state->columns[i]));
                 }
+                py_item = decode_binary_cell(py_state, i, &binary_value);
                 if (!py_item) goto error;
+                goto store_item;
             }
+        } else {
+            read_length_coded_string(&data, &data_l, &out, &out_l, &is_null);
+        }
 
-            // If no converter was passed in, do the default processing.
-            else {
-                switch (py_state->type_codes[i]) {
-                case MYSQL_TYPE_NEWDECIMAL:
-                case MYSQL_TYPE_DECIMAL:
-                    py_str = PyUnicode_Decode(out, out_l, py_state->encodings[i], py_state->encoding_errors);
-                    if (!py_str) goto error;
-
-                    py_item = PyObject_CallFunctionObjArgs(PyFunc.decimal_Decimal, py_str, NULL);
-                    Py_CLEAR(py_str);
-                    if (!py_item) goto error;
-                    break;
-
-                case MYSQL_TYPE_TINY:
-                case MYSQL_TYPE_SHORT:
-                case MYSQL_TYPE_LONG:
-                case MYSQL_TYPE_LONGLONG:
-                case MYSQL_TYPE_INT24:
-                    if (data_l) out[out_l] = '\0';
-                    if (py_state->flags[i] & MYSQL_FLAG_UNSIGNED) {
-                        py_item = PyLong_FromUnsignedLongLong(strtoull(out, NULL, 10));
-                    } else {
-                        py_item = PyLong_FromLongLong(strtoll(out, NULL, 10));
-                    }
-                    if (data_l) out[out_l] = end;
-                    if (!py_item) goto error;
-                    break;
-
-                case MYSQL_TYPE_FLOAT:
-                case MYSQL_TYPE_DOUBLE:
-                    if (data_l) out[out_l] = '\0';
-                    py_item = PyFloat_FromDouble(strtod(out, NULL));
-                    if (data_l) out[out_l] = end;
-                    if (!py_item) goto error;
-                    break;
-
-                case MYSQL_TYPE_NULL:
-                    py_item = Py_None;
-                    break;
-
-                case MYSQL_TYPE_DATETIME:
-                case MYSQL_TYPE_TIMESTAMP:
-                    if (CHECK_ANY_ZERO_DATETIME_STR(out, out_l)) {
-                        py_item = Py_None;
-                        Py_INCREF(Py_None);
-                        break;
-                    }
-                    else if (!CHECK_ANY_DATETIME_STR(out, out_l)) {
-                        if (py_state->py_invalid_values[i]) {
-                            py_item = py_state->py_invalid_values[i];
-                            Py_INCREF(py_item);
-                        } else {
-                            py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
-                            if (!py_item) goto error;
-                        }
-                        break;
-                    }
-                    year = CHR2INT4(out); out += 5;
-                    month = CHR2INT2(out); out += 3;
-                    day = CHR2INT2(out); out += 3;
-                    hour = CHR2INT2(out); out += 3;
-                    minute = CHR2INT2(out); out += 3;
-                    second = CHR2INT2(out); out += 3;
-                    microsecond = (IS_DATETIME_MICRO(out, out_l)) ? CHR2INT6(out) :
-                                  (IS_DATETIME_MILLI(out, out_l)) ? CHR2INT3(out) * 1e3 : 0;
-                    py_item = PyDateTime_FromDateAndTime(
-#ifdef Py_LIMITED_API
-                                    py_state,
-#endif
-                                    year, month, day, hour, minute, second, microsecond);
-                    if (!py_item) {
-                        PyErr_Clear();
-                        py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
-                    }
-                    if (!py_item) goto error;
-                    break;
-
-                case MYSQL_TYPE_NEWDATE:
-                case MYSQL_TYPE_DATE:
-                    if (CHECK_ZERO_DATE_STR(out, out_l)) {
-                        py_item = Py_None;
-                        Py_INCREF(Py_None);
-                        break;
-                    }
-                    else if (!CHECK_DATE_STR(out, out_l)) {
-                        if (py_state->py_invalid_values[i]) {
-                            py_item = py_state->py_invalid_values[i];
-                            Py_INCREF(py_item);
-                        } else {
-                            py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
-                            if (!py_item) goto error;
-                        }
-                        break;
-                    }
-                    year = CHR2INT4(out); out += 5;
-                    month = CHR2INT2(out); out += 3;
-                    day = CHR2INT2(out); out += 3;
-                    py_item = PyDate_FromDate(
-#ifdef Py_LIMITED_API
-                                    py_state,
-#endif
-                                    year, month, day);
-                    if (!py_item) {
-                        PyErr_Clear();
-                        py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
-                    }
-                    if (!py_item) goto error;
-                    break;
-
-                case MYSQL_TYPE_TIME:
-                    sign = CHECK_ANY_TIMEDELTA_STR(out, out_l);
-                    if (!sign) {
-                        if (py_state->py_invalid_values[i]) {
-                            py_item = py_state->py_invalid_values[i];
-                            Py_INCREF(py_item);
-                        } else {
-                            py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
-                            if (!py_item) goto error;
-                        }
-                        break;
-                    } else if (sign < 0) {
-                        out += 1; out_l -= 1;
-                    }
-                    if (IS_TIMEDELTA1(out, out_l)) {
-                        hour = CHR2INT1(out); out += 2;
-                        minute = CHR2INT2(out); out += 3;
-                        second = CHR2INT2(out); out += 3;
-                        microsecond = (IS_TIMEDELTA_MICRO(out, out_l)) ? CHR2INT6(out) :
-                                      (IS_TIMEDELTA_MILLI(out, out_l)) ? CHR2INT3(out) * 1e3 : 0;
-                    }
-                    else if (IS_TIMEDELTA2(out, out_l)) {
-                        hour = CHR2INT2(out); out += 3;
-                        minute = CHR2INT2(out); out += 3;
-                        second = CHR2INT2(out); out += 3;
-                        microsecond = (IS_TIMEDELTA_MICRO(out, out_l)) ? CHR2INT6(out) :
-                                      (IS_TIMEDELTA_MILLI(out, out_l)) ? CHR2INT3(out) * 1e3 : 0;
-                    }
-                    else if (IS_TIMEDELTA3(out, out_l)) {
-                        hour = CHR2INT3(out); out += 4;
-                        minute = CHR2INT2(out); out += 3;
-                        second = CHR2INT2(out); out += 3;
-                        microsecond = (IS_TIMEDELTA_MICRO(out, out_l)) ? CHR2INT6(out) :
-                                      (IS_TIMEDELTA_MILLI(out, out_l)) ? CHR2INT3(out) * 1e3 : 0;
-                    }
-                    py_item = PyDelta_FromDSU(
-#ifdef Py_LIMITED_API
-                                    py_state,
-#endif
-                                    0, sign * hour * 60 * 60 +
-                                       sign * minute * 60 +
-                                       sign * second,
-                                       sign * microsecond);
-                    if (!py_item) {
-                        PyErr_Clear();
-                        py_item = PyUnicode_Decode(orig_out, orig_out_l, "ascii", py_state->encoding_errors);
-                    }
-                    if (!py_item) goto error;
-                    break;
-
-                case MYSQL_TYPE_YEAR:
-                    if (out_l == 0) {
-                        goto error;
-                        break;
-                    }
-                    if (data_l) out[out_l] = '\0';
-                    year = strtoul(out, NULL, 10);
-                    py_item = PyLong_FromLong(year);
-                    if (data_l) out[out_l] = end;
-                    if (!py_item) goto error;
-                    break;
-
-                case MYSQL_TYPE_BIT:
-                case MYSQL_TYPE_JSON:
-                case MYSQL_TYPE_TINY_BLOB:
-                case MYSQL_TYPE_MEDIUM_BLOB:
-                case MYSQL_TYPE_LONG_BLOB:
-                case MYSQL_TYPE_BLOB:
-                case MYSQL_TYPE_GEOMETRY:
-                case MYSQL_TYPE_ENUM:
-                case MYSQL_TYPE_SET:
-                case MYSQL_TYPE_VARCHAR:
-                case MYSQL_TYPE_VAR_STRING:
-                case MYSQL_TYPE_STRING:
-                case MYSQL_TYPE_FLOAT32_VECTOR_JSON:
-                case MYSQL_TYPE_FLOAT64_VECTOR_JSON:
-                case MYSQL_TYPE_INT8_VECTOR_JSON:
-                case MYSQL_TYPE_INT16_VECTOR_JSON:
-                case MYSQL_TYPE_INT32_VECTOR_JSON:
-                case MYSQL_TYPE_INT64_VECTOR_JSON:
-                    if (!py_state->encodings[i]) {
-                        py_item = PyBytes_FromStringAndSize(out, out_l);
-                        if (!py_item) goto error;
-                        break;
-                    }
-
-                    py_item = PyUnicode_Decode(out, out_l, py_state->encodings[i], py_state->encoding_errors);
-                    if (!py_item) goto error;
-
-                    // Parse JSON string.
-                    if ((py_state->type_codes[i] == MYSQL_TYPE_JSON && py_state->options.parse_json)
-                        || (py_state->type_codes[i] >= MYSQL_TYPE_FLOAT32_VECTOR_JSON
-                            && py_state->type_codes[i] <= MYSQL_TYPE_INT64_VECTOR_JSON)) {
-                        py_str = py_item;
-                        py_item = PyObject_CallFunctionObjArgs(PyFunc.json_loads, py_str, NULL);
-                        Py_CLEAR(py_str);
-                        if (!py_item) goto error;
-                    }
-
-                    if (ensure_numpy() == 0) {
-                        switch (py_state->type_codes[i]) {
-                        case MYSQL_TYPE_FLOAT32_VECTOR_JSON:
-                        case MYSQL_TYPE_FLOAT64_VECTOR_JSON:
-                        case MYSQL_TYPE_INT8_VECTOR_JSON:
-                        case MYSQL_TYPE_INT16_VECTOR_JSON:
-                        case MYSQL_TYPE_INT32_VECTOR_JSON:
-                        case MYSQL_TYPE_INT64_VECTOR_JSON:
-                            CHECKRC(PyTuple_SetItem(PyObj.create_numpy_array_args, 0, py_item));
-                            py_item = PyObject_Call(
-                                PyFunc.numpy_array,
-                                PyObj.create_numpy_array_args,
-                                PyObj.create_numpy_array_kwargs_vector[py_state->type_codes[i] % 1000]
-                            );
-                            if (!py_item) goto error;
-                        }
-                    }
-
-                    break;
-
-                case MYSQL_TYPE_FLOAT32_VECTOR:
-                case MYSQL_TYPE_FLOAT64_VECTOR:
-                case MYSQL_TYPE_INT8_VECTOR:
-                case MYSQL_TYPE_INT16_VECTOR:
-                case MYSQL_TYPE_INT32_VECTOR:
-                case MYSQL_TYPE_INT64_VECTOR:
-                {
-                    int type_idx = py_state->type_codes[i] % 1000;
-
-                    if (ensure_numpy() == 0) {
-                        py_memview = PyBytes_FromStringAndSize(out, out_l);
-                        if (!py_memview) goto error;
-
-                        CHECKRC(PyTuple_SetItem(PyObj.create_numpy_array_args, 0, py_memview));
-
-                        py_item = PyObject_Call(
-                            PyFunc.numpy_frombuffer,
-                            PyObj.create_numpy_array_args,
-                            PyObj.create_numpy_array_kwargs_vector[type_idx]
-                        );
-                        if (!py_item) goto error;
-
-                    } else {
-                        py_memview = PyBytes_FromStringAndSize(out, out_l);
-                        if (!py_memview) goto error;
-
-                        CHECKRC(PyTuple_SetItem(PyObj.struct_unpack_args, 0,
-                                                PyUnicode_FromFormat("<%ld%s", out_l / item_type_lengths[type_idx], cast_type_codes[type_idx])));
-                        CHECKRC(PyTuple_SetItem(PyObj.struct_unpack_args, 1, py_memview));
-
-                        py_item = PyObject_Call(
-                            PyFunc.struct_unpack,
-                            PyObj.struct_unpack_args,
-                            NULL
-                        );
-                        if (!py_item) goto error;
-                    }
-
-                    break;
-                }
-
-                case MYSQL_TYPE_BSON:
-                    py_item = PyBytes_FromStringAndSize(out, out_l);
-                    if (!py_item) goto error;
-
-                    if (ensure_bson() == 0) {
-                        CHECKRC(PyTuple_SetItem(PyObj.bson_decode_args, 0, py_item));
-                        py_item = PyObject_Call(
-                            PyFunc.bson_decode,
-                            PyObj.bson_decode_args,
-                            NULL
-                        );
-                        if (!py_item) goto error;
-                    }
-
-                    break;
-
-                default:
-                    PyErr_Format(PyExc_TypeError, "unknown type code: %ld",
-                                 py_state->type_codes[i], NULL);
-                    goto error;
-                }
-            }
+        if (py_state->columns && py_state->columns[i].kind != ACCEL_COL_OBJECT) {
+            int rc = append_column_value(&py_state->columns[i], out, out_l, is_null,
+                                         py_state->codecs[i], py_state->encodings[i],
+                                         py_state->encoding_errors);
+            CHECKRC(rc);
+            if (rc == 0) continue;
+            CHECKRC(demote_column(py_state, &py_state->columns[i]));
         }
 
-        if (py_item == Py_None) {
+        if (is_null) {
+            py_item = Py_None;
             Py_INCREF(Py_None);
+        } else {
+            py_item = decode_cell(py_state, i, out, out_l);
+            if (!py_item) goto error;
+        }
+
+store_item:
+        if (py_state->columns) {
+            int rc = ColumnBuffer_append_object(&py_state->columns[i], py_item);
+            Py_DECREF(py_item);
+            CHECKRC(rc);
+            continue;
         }
 
         switch (py_state->options.results_type) {
-        case ACCEL_OUT_STRUCTSEQUENCES:
-            PyStructSequence_SetItem(py_result, i, py_item);
-            break;
         case ACCEL_OUT_DICTS:
         case ACCEL_OUT_ARROW:
             PyDict_SetItem(py_result, py_state->py_names[i], py_item);
@@ -1856,22 +8106,43 @@ static PyObject *read_row_from_packet(
         }
     }
 
-    if (py_state->options.results_type == ACCEL_OUT_NAMEDTUPLES) {
-        // We just use py_result above as storage for the parameters to
-        // the namedtuple constructor. It gets deleted at the end of the
-        // fetch operation.
-        py_result = PyObject_CallObject(py_state->py_namedtuple, py_result);
-        if (!py_result) goto error;
-    }
-
 exit:
     return py_result;
 
+truncated:
+    PyErr_SetString(PyExc_ValueError, "truncated binary protocol row");
+
 error:
     Py_CLEAR(py_result);
     goto exit;
 }
 
+//
+// Return the rowdata state of a result, creating it on first use.
+//
+static StateObject *State_for_result(
+    PyObject *py_res,
+    unsigned long long requested_n_rows,
+    int *is_new
+) {
+    StateObject *py_state = (StateObject*)PyObject_GetAttr(py_res, PyStr._state);
+
+    *is_new = 0;
+    if (py_state) return py_state;
+    PyErr_Clear();
+
+    py_state = (StateObject*)PyObject_CallFunction((PyObject*)StateType, "OK",
+                                                   py_res, requested_n_rows);
+    if (!py_state) return NULL;
+    *is_new = 1;
+
+    if (PyObject_SetAttr(py_res, PyStr._state, (PyObject*)py_state)) {
+        Py_CLEAR(py_state);
+    }
+
+    return py_state;
+}
+
 static PyObject *read_rowdata_packet(PyObject *self, PyObject *args, PyObject *kwargs) {
     int rc = 0;
     StateObject *py_state = NULL;
@@ -1884,11 +8155,15 @@ static PyObject *read_rowdata_packet(PyObject *self, PyObject *args, PyObject *k
     PyObject *py_err_value = NULL;
     PyObject *py_err_tb = NULL;
     unsigned long long requested_n_rows = 0;
+    unsigned long long max_bytes = 0;
+    unsigned long long batch_bytes = 0;
     unsigned long long row_idx = 0;
-    char *keywords[] = {"result", "unbuffered", "size", NULL};
+    int is_new_state = 0;
+    char *keywords[] = {"result", "unbuffered", "size", "max_bytes", NULL};
 
     // Parse function args.
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|K", keywords, &py_res, &py_unbuffered, &requested_n_rows)) {
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|KK", keywords, &py_res, &py_unbuffered,
+                                     &requested_n_rows, &max_bytes)) {
         goto error;
     }
 
@@ -1904,27 +8179,9 @@ static PyObject *read_rowdata_packet(PyObject *self, PyObject *args, PyObject *k
     }
 
     // Get the rowdata state.
-    py_state = (StateObject*)PyObject_GetAttr(py_res, PyStr._state);
-    if (!py_state) {
-        PyErr_Clear();
-
-        PyObject *py_requested_n_rows = PyLong_FromUnsignedLongLong(requested_n_rows);
-        if (!py_requested_n_rows) goto error;
-
-        PyObject *py_args = PyTuple_New(2);
-        if (!py_args) goto error;
-        PyTuple_SetItem(py_args, 0, py_res);
-        PyTuple_SetItem(py_args, 1, py_requested_n_rows);
-        Py_INCREF(py_res);
-        Py_INCREF(py_requested_n_rows);
-
-        py_state = (StateObject*)PyObject_CallObject((PyObject*)StateType, py_args);
-        if (!py_state) { Py_DECREF(py_args); goto error; }
-        Py_DECREF(py_args);
-
-        PyObject_SetAttr(py_res, PyStr._state, (PyObject*)py_state);
-    }
-    else if (requested_n_rows > 0) {
+    py_state = State_for_result(py_res, requested_n_rows, &is_new_state);
+    if (!py_state) goto error;
+    if (!is_new_state && requested_n_rows > 0) {
         State_reset_batch(py_state, py_res, requested_n_rows);
     }
 
@@ -1937,20 +8194,20 @@ static PyObject *read_rowdata_packet(PyObject *self, PyObject *args, PyObject *k
     }
 
     while (row_idx < requested_n_rows) {
-        PyObject *py_buff = read_packet(py_state);
-        if (!py_buff) goto error;
-
         PyObject *py_row = NULL;
-        char *data = PyByteArray_AsString(py_buff);
-        unsigned long long data_l = PyByteArray_Size(py_buff);
+        char *data = NULL;
+        unsigned long long data_l = 0;
         unsigned long long warning_count = 0;
         int has_next = 0;
 
-        if (check_packet_is_eof(&data, &data_l, &warning_count, &has_next)) {
-            Py_CLEAR(py_buff);
+        if (read_packet(py_state, &data, &data_l)) goto error;
 
+        if (check_packet_is_eof(&data, &data_l, &warning_count, &has_next)) {
             py_state->is_eof = 1;
 
+            // Anything after the EOF packet belongs to the next result.
+            if (State_release_buffer(py_state)) goto error;
+
             PyObject *py_long = NULL;
 
             py_long = PyLong_FromUnsignedLongLong(warning_count);
@@ -1971,19 +8228,25 @@ static PyObject *read_rowdata_packet(PyObject *self, PyObject *args, PyObject *k
         py_state->n_rows_in_batch++;
 
         py_row = read_row_from_packet(py_state, data, data_l);
-        if (!py_row) { Py_CLEAR(py_buff); goto error; }
+        if (!py_row) goto error;
 
-        //if (requested_n_rows == 1) {
-        //    rc = PyList_SetItem(py_state->py_rows, 0, py_row);
-        //} else {
-            rc = PyList_Append(py_state->py_rows, py_row);
+        if (py_state->columns) {
             Py_DECREF(py_row);
-        //}
-        if (rc != 0) { Py_CLEAR(py_buff); goto error; }
+        } else {
+            //if (requested_n_rows == 1) {
+            //    rc = PyList_SetItem(py_state->py_rows, 0, py_row);
+            //} else {
+                rc = PyList_Append(py_state->py_rows, py_row);
+                Py_DECREF(py_row);
+            //}
+            if (rc != 0) goto error;
+        }
 
         row_idx++;
 
-        Py_CLEAR(py_buff);
+        // End the batch once it holds max_bytes of row data.
+        batch_bytes += data_l;
+        if (max_bytes && batch_bytes >= max_bytes) break;
     }
 
 exit:
@@ -1994,6 +8257,12 @@ exit:
     PyObject_SetAttr(py_state->py_conn, PyStr._next_seq_id, py_next_seq_id);
     Py_DECREF(py_next_seq_id);
 
+    if (py_state->columns && !py_err_type) {
+        if (State_finish_columns(py_state, py_res)) {
+            PyErr_Fetch(&py_err_type, &py_err_value, &py_err_tb);
+        }
+    }
+
     py_out = NULL;
 
     if (py_state->unbuffered) {
@@ -2008,9 +8277,13 @@ exit:
             Py_CLEAR(py_state);
         }
         else {
-            py_out = (requested_n_rows == 1) ?
-                     PyList_GetItem(py_state->py_rows, 0) : py_state->py_rows;
-            Py_XINCREF(py_out);
+            if (requested_n_rows == 1 && py_state->columns) {
+                py_out = PySequence_GetItem(py_state->py_rows, 0);
+            } else {
+                py_out = (requested_n_rows == 1) ?
+                         PyList_GetItem(py_state->py_rows, 0) : py_state->py_rows;
+                Py_XINCREF(py_out);
+            }
         }
     }
     else {
@@ -2025,6 +8298,8 @@ exit:
         }
     }
 
+    // Rows still being read keep the state alive through the result.
+    Py_XDECREF(py_state);
     Py_XDECREF(py_zero);
 
     if (PyErr_Occurred()) {
@@ -2037,534 +8312,994 @@ exit:
 
     return py_out;
 
-error:
-    if (PyErr_Occurred()) {
-        PyErr_Fetch(&py_err_type, &py_err_value, &py_err_tb);
+error:
+    if (PyErr_Occurred()) {
+        PyErr_Fetch(&py_err_type, &py_err_value, &py_err_tb);
+    }
+    goto exit;
+}
+
+
+//
+// Row iterator
+//
+// Iterating an unbuffered cursor one fetchone() at a time looks up the
+// state, resets the batch list, and writes the sequence number back to
+// the connection for every row. The iterator holds on to the state and
+// yields rows straight from the receive buffer instead; the result and
+// cursor are updated once the result is exhausted, or when the iterator
+// is dropped. State_release_buffer syncs the sequence number if the rest
+// of the result is read by someone else.
+//
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *py_res; // Result being read; NULL once exhausted
+    PyObject *py_cursor; // Cursor whose row number is updated, or None
+    StateObject *py_state; // Rowdata state of the result
+    unsigned long long n_rows; // Rows yielded since the cursor was updated
+} RowIteratorObject;
+
+static PyTypeObject *RowIteratorType = NULL;
+
+//
+// Add the rows yielded so far to the row number of the cursor.
+//
+static int RowIterator_update_cursor(RowIteratorObject *self) {
+    int rc = 0;
+    PyObject *py_rownumber = NULL;
+    PyObject *py_n_rows = NULL;
+    PyObject *py_total = NULL;
+
+    if (!self->n_rows || !self->py_cursor || self->py_cursor == Py_None) goto exit;
+
+    py_rownumber = PyObject_GetAttr(self->py_cursor, PyStr._rownumber);
+    if (!py_rownumber) goto error;
+    py_n_rows = PyLong_FromUnsignedLongLong(self->n_rows);
+    if (!py_n_rows) goto error;
+    py_total = PyNumber_Add(py_rownumber, py_n_rows);
+    if (!py_total) goto error;
+    CHECKRC(PyObject_SetAttr(self->py_cursor, PyStr._rownumber, py_total));
+    self->n_rows = 0;
+
+exit:
+    Py_XDECREF(py_total);
+    Py_XDECREF(py_n_rows);
+    Py_XDECREF(py_rownumber);
+    return rc;
+
+error:
+    rc = -1;
+    goto exit;
+}
+
+//
+// Mark the result as complete after its EOF packet.
+//
+static int RowIterator_finish(
+    RowIteratorObject *self,
+    unsigned long long warning_count,
+    int has_next
+) {
+    int rc = 0;
+    PyObject *py_res = self->py_res;
+    StateObject *py_state = self->py_state;
+    PyObject *py_long = NULL;
+
+    self->py_res = NULL;
+    self->py_state = NULL;
+    py_state->is_eof = 1;
+
+    // Anything after the EOF packet belongs to the next result.
+    CHECKRC(State_release_buffer(py_state));
+
+    py_long = PyLong_FromUnsignedLongLong(warning_count);
+    if (!py_long) goto error;
+    CHECKRC(PyObject_SetAttr(py_res, PyStr.warning_count, py_long));
+    if (self->py_cursor && self->py_cursor != Py_None) {
+        CHECKRC(PyObject_SetAttr(self->py_cursor, PyStr.warning_count, py_long));
+    }
+    Py_CLEAR(py_long);
+
+    py_long = PyLong_FromLong(has_next);
+    if (!py_long) goto error;
+    CHECKRC(PyObject_SetAttr(py_res, PyStr.has_next, py_long));
+    Py_CLEAR(py_long);
+
+    py_long = PyLong_FromUnsignedLongLong(py_state->n_rows);
+    if (!py_long) goto error;
+    CHECKRC(PyObject_SetAttr(py_res, PyStr.affected_rows, py_long));
+    Py_CLEAR(py_long);
+
+    CHECKRC(PyObject_SetAttr(py_res, PyStr.connection, Py_None));
+    CHECKRC(PyObject_SetAttr(py_res, PyStr.unbuffered_active, Py_False));
+    CHECKRC(PyObject_SetAttr(py_res, PyStr.rows, Py_None));
+    CHECKRC(PyObject_DelAttr(py_res, PyStr._state));
+
+    CHECKRC(RowIterator_update_cursor(self));
+
+exit:
+    Py_XDECREF(py_long);
+    Py_XDECREF(py_state);
+    Py_XDECREF(py_res);
+    return rc;
+
+error:
+    rc = -1;
+    goto exit;
+}
+
+static PyObject *RowIterator_next(RowIteratorObject *self) {
+    StateObject *py_state = self->py_state;
+    PyObject *py_row = NULL;
+    char *data = NULL;
+    unsigned long long data_l = 0;
+    unsigned long long warning_count = 0;
+    int has_next = 0;
+
+    if (!py_state) return NULL;
+
+    // Column buffers are only turned into rows a batch at a time.
+    if (py_state->columns) {
+        PyObject *py_args = Py_BuildValue("(OOi)", self->py_res, Py_True, 1);
+        if (!py_args) return NULL;
+        py_row = read_rowdata_packet(NULL, py_args, NULL);
+        Py_DECREF(py_args);
+        if (py_row == Py_None) {
+            Py_CLEAR(py_row);
+            Py_CLEAR(self->py_state);
+            Py_CLEAR(self->py_res);
+            if (RowIterator_update_cursor(self)) return NULL;
+        }
+        if (py_row) self->n_rows++;
+        return py_row;
+    }
+
+    if (read_packet(py_state, &data, &data_l)) return NULL;
+
+    if (check_packet_is_eof(&data, &data_l, &warning_count, &has_next)) {
+        RowIterator_finish(self, warning_count, has_next);
+        return NULL;
+    }
+
+    py_state->n_rows++;
+
+    py_row = read_row_from_packet(py_state, data, data_l);
+    if (py_row) self->n_rows++;
+
+    return py_row;
+}
+
+static PyObject *RowIterator_iter(PyObject *self) {
+    Py_INCREF(self);
+    return self;
+}
+
+static void RowIterator_dealloc(RowIteratorObject *self) {
+    PyTypeObject *tp = Py_TYPE(self);
+    PyObject *py_err_type = NULL;
+    PyObject *py_err_value = NULL;
+    PyObject *py_err_tb = NULL;
+
+    // A loop that stopped early still counts the rows it saw.
+    PyErr_Fetch(&py_err_type, &py_err_value, &py_err_tb);
+    if (RowIterator_update_cursor(self)) PyErr_Clear();
+    PyErr_Restore(py_err_type, py_err_value, py_err_tb);
+
+    Py_CLEAR(self->py_res);
+    Py_CLEAR(self->py_cursor);
+    Py_CLEAR(self->py_state);
+
+    freefunc tp_free = (freefunc)PyType_GetSlot(tp, Py_tp_free);
+    tp_free(self);
+    Py_DECREF(tp);
+}
+
+static PyType_Slot RowIteratorType_slots[] = {
+    {Py_tp_iter, (getiterfunc)RowIterator_iter},
+    {Py_tp_iternext, (iternextfunc)RowIterator_next},
+    {Py_tp_dealloc, (destructor)RowIterator_dealloc},
+    {Py_tp_doc, "Iterator over the rows of an unbuffered result"},
+    {0, NULL},
+};
+
+static PyType_Spec RowIteratorType_spec = {
+    .name = ACCEL_STR(ACCEL_MODULE_NAME) ".RowIterator",
+    .basicsize = sizeof(RowIteratorObject),
+    .itemsize = 0,
+    .flags = Py_TPFLAGS_DEFAULT,
+    .slots = RowIteratorType_slots,
+};
+
+static PyObject *iter_rowdata_packets(PyObject *self, PyObject *args, PyObject *kwargs) {
+    RowIteratorObject *py_iter = NULL;
+    PyObject *py_res = NULL;
+    PyObject *py_cursor = Py_None;
+    PyObject *py_unbuffered_active = NULL;
+    int is_active = 0;
+    int is_new_state = 0;
+    char *keywords[] = {"result", "cursor", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", keywords, &py_res, &py_cursor)) {
+        return NULL;
+    }
+
+    py_iter = (RowIteratorObject*)PyType_GenericAlloc(RowIteratorType, 0);
+    if (!py_iter) return NULL;
+
+    py_iter->py_cursor = py_cursor;
+    Py_INCREF(py_cursor);
+
+    // A finished result gives an empty iterator.
+    py_unbuffered_active = PyObject_GetAttr(py_res, PyStr.unbuffered_active);
+    is_active = py_unbuffered_active && PyObject_IsTrue(py_unbuffered_active) == 1;
+    Py_XDECREF(py_unbuffered_active);
+    PyErr_Clear();
+    if (!is_active) return (PyObject*)py_iter;
+
+    py_iter->py_state = State_for_result(py_res, 1, &is_new_state);
+    if (!py_iter->py_state) goto error;
+    if (py_iter->py_state->is_eof) {
+        Py_CLEAR(py_iter->py_state);
+        return (PyObject*)py_iter;
+    }
+
+    py_iter->py_res = py_res;
+    Py_INCREF(py_res);
+
+    return (PyObject*)py_iter;
+
+error:
+    Py_DECREF(py_iter);
+    return NULL;
+}
+
+//
+// Memory of a bytes-like rowdat_1 input or output
+//
+// bytes and bytearray objects are used as is. Other buffer-protocol objects
+// (mmap, memoryview, ...) are accessed in place when the buffer protocol is
+// available, which the limited API only has from Python 3.11 on. Otherwise
+// inputs are copied into a bytes object and outputs are written by slice
+// assignment.
+//
+#if !defined(Py_LIMITED_API) || Py_LIMITED_API + 0 >= 0x030B0000
+#define ACCEL_HAS_BUFFER 1
+#endif
+
+typedef struct {
+    char *buf;
+    Py_ssize_t len;
+    PyObject *py_copy;
+#ifdef ACCEL_HAS_BUFFER
+    Py_buffer view;
+    int has_view;
+#endif
+} accel_buffer;
+
+static int get_input_buffer(PyObject *py_obj, accel_buffer *b) {
+    memset(b, 0, sizeof(accel_buffer));
+
+    if (PyBytes_Check(py_obj)) {
+        return PyBytes_AsStringAndSize(py_obj, &b->buf, &b->len);
     }
-    goto exit;
-}
 
+    if (PyByteArray_Check(py_obj)) {
+        b->buf = PyByteArray_AsString(py_obj);
+        b->len = PyByteArray_Size(py_obj);
+        return 0;
+    }
 
-static PyObject *create_numpy_array(PyObject *py_memview, char *data_format, int data_type, PyObject *py_objs) {
-    PyObject *py_memviewc = NULL;
-    PyObject *py_in = NULL;
-    PyObject *py_out = NULL;
-    PyObject *py_vec_func = NULL;
+#ifdef ACCEL_HAS_BUFFER
+    if (PyObject_GetBuffer(py_obj, &b->view, PyBUF_SIMPLE) < 0) return -1;
+    b->has_view = 1;
+    b->buf = (char*)b->view.buf;
+    b->len = b->view.len;
+    return 0;
+#else
+    b->py_copy = PyBytes_FromObject(py_obj);
+    if (!b->py_copy) return -1;
+    return PyBytes_AsStringAndSize(b->py_copy, &b->buf, &b->len);
+#endif
+}
 
-    py_memviewc = PyObject_CallMethod(py_memview, "cast", "s", data_format);
-    if (!py_memviewc) goto error;
+//
+// Get writable memory of at least `size` bytes. Sets `b->buf` to NULL if the
+// object must be written with `write_output_buffer` instead.
+//
+static int get_output_buffer(PyObject *py_obj, accel_buffer *b) {
+    memset(b, 0, sizeof(accel_buffer));
 
-    CHECKRC(PyTuple_SetItem(PyObj.create_numpy_array_args, 0, py_memviewc));
-    Py_INCREF(py_memviewc);
+    if (PyByteArray_Check(py_obj)) {
+        b->buf = PyByteArray_AsString(py_obj);
+        b->len = PyByteArray_Size(py_obj);
+        return 0;
+    }
 
-    py_out = PyObject_Call(PyFunc.numpy_array, PyObj.create_numpy_array_args, PyObj.create_numpy_array_kwargs);
-    if (!py_out) goto error;
+#ifdef ACCEL_HAS_BUFFER
+    if (PyObject_GetBuffer(py_obj, &b->view, PyBUF_WRITABLE) < 0) return -1;
+    b->has_view = 1;
+    b->buf = (char*)b->view.buf;
+    b->len = b->view.len;
+    return 0;
+#else
+    b->len = PyObject_Length(py_obj);
+    return (b->len < 0) ? -1 : 0;
+#endif
+}
 
-    // Add series to the output, remapping string values as needed
-    if (py_objs) {
-        switch(data_type) {
-        case MYSQL_TYPE_VARCHAR:
-        case MYSQL_TYPE_JSON:
-        case MYSQL_TYPE_SET:
-        case MYSQL_TYPE_ENUM:
-        case MYSQL_TYPE_VAR_STRING:
-        case MYSQL_TYPE_STRING:
-        case MYSQL_TYPE_GEOMETRY:
-        case MYSQL_TYPE_TINY_BLOB:
-        case MYSQL_TYPE_MEDIUM_BLOB:
-        case MYSQL_TYPE_LONG_BLOB:
-        case MYSQL_TYPE_BLOB:
-        case -MYSQL_TYPE_VARCHAR:
-        case -MYSQL_TYPE_JSON:
-        case -MYSQL_TYPE_SET:
-        case -MYSQL_TYPE_ENUM:
-        case -MYSQL_TYPE_VAR_STRING:
-        case -MYSQL_TYPE_STRING:
-        case -MYSQL_TYPE_GEOMETRY:
-        case -MYSQL_TYPE_TINY_BLOB:
-        case -MYSQL_TYPE_MEDIUM_BLOB:
-        case -MYSQL_TYPE_LONG_BLOB:
-        case -MYSQL_TYPE_BLOB:
-            py_vec_func = PyObject_CallFunction(PyFunc.numpy_vectorize, "Os", PyObject_GetAttrString(py_objs, "get"), "O");
-            py_in = py_out;
-            py_out = PyObject_CallFunction(py_vec_func, "O", py_in);
-            if (!py_out) goto error;
-            break;
-        }
+//
+// Get writable memory for `size` bytes of output. `py_into` is either the
+// output object or a callable which is given `size` and returns one; the
+// object to write to is returned as a new reference in `py_target`.
+//
+static int allocate_output_buffer(
+    PyObject *py_into, unsigned long long size, PyObject **py_target, accel_buffer *b
+) {
+    if (PyCallable_Check(py_into)) {
+        *py_target = PyObject_CallFunction(py_into, "K", size);
+        if (!*py_target) return -1;
+    } else {
+        Py_INCREF(py_into);
+        *py_target = py_into;
     }
+    return get_output_buffer(*py_target, b);
+}
 
-exit:
-    Py_XDECREF(py_in);
-    Py_XDECREF(py_vec_func);
-    Py_XDECREF(py_memviewc);
+// Copy data into the start of an output object by slice assignment.
+static int write_output_buffer(PyObject *py_obj, const char *data, Py_ssize_t data_l) {
+    int rc = -1;
+    PyObject *py_data = NULL;
+    PyObject *py_start = NULL;
+    PyObject *py_end = NULL;
+    PyObject *py_slice = NULL;
 
-    return py_out;
+    py_data = PyBytes_FromStringAndSize(data, data_l);
+    if (!py_data) goto exit;
+    py_start = PyLong_FromLong(0);
+    if (!py_start) goto exit;
+    py_end = PyLong_FromSsize_t(data_l);
+    if (!py_end) goto exit;
+    py_slice = PySlice_New(py_start, py_end, NULL);
+    if (!py_slice) goto exit;
 
-error:
-    Py_XDECREF(py_out);
-    py_out = NULL;
+    rc = PyObject_SetItem(py_obj, py_slice, py_data);
 
-    goto exit;
+exit:
+    Py_XDECREF(py_data);
+    Py_XDECREF(py_start);
+    Py_XDECREF(py_end);
+    Py_XDECREF(py_slice);
+
+    return rc;
 }
 
+static void release_accel_buffer(accel_buffer *b) {
+#ifdef ACCEL_HAS_BUFFER
+    if (b->has_view) PyBuffer_Release(&b->view);
+    b->has_view = 0;
+#endif
+    Py_XDECREF(b->py_copy);
+    b->py_copy = NULL;
+    b->buf = NULL;
+}
 
-static PyObject *load_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *kwargs) {
-    PyObject *py_data = NULL;
-    PyObject *py_out = NULL;
-    PyObject *py_colspec = NULL;
-    PyObject *py_str = NULL;
-    PyObject *py_blob = NULL;
-    PyObject *py_memview = NULL;
-    PyObject *py_arr = NULL;
-    PyObject *py_out_pairs = NULL;
-    PyObject *py_index = NULL;
-    PyObject *py_objs = NULL;
-    PyObject *py_mask = NULL;
-    PyObject *py_pair = NULL;
-    Py_ssize_t length = 0;
-    uint8_t is_null = 0;
-    int8_t i8 = 0;
-    int16_t i16 = 0;
-    int32_t i32 = 0;
+//
+// Parse a DECIMAL, DATE, TIME, DATETIME or TIMESTAMP value, which rowdat_1
+// sends as text, into its numpy representation: float64 for DECIMAL, days
+// for DATE and microseconds otherwise. Returns -1 if numpy can not represent
+// the value (such as a zero date).
+//
+static int rowdat_1_text_to_numpy(int ctype, char *s, unsigned long long s_l, char *out) {
     int64_t i64 = 0;
-    uint8_t u8 = 0;
-    uint16_t u16 = 0;
-    uint32_t u32 = 0;
-    uint64_t u64 = 0;
-    float flt = 0;
     double dbl = 0;
-    int *ctypes = NULL;
-    char *data = NULL;
-    char *orig_data = NULL;
-    char *end = NULL;
-    unsigned long long n_cols = 0;
-    unsigned long long i = 0;
-    unsigned long long j = 0;
-    char *keywords[] = {"colspec", "data", NULL};
-    uint64_t n_rows = 0;
-    int *item_sizes = NULL;
-    char **data_formats = NULL;
-    char **out_cols = NULL;
-    char **mask_cols = NULL;
-    int64_t *out_row_ids = NULL;
 
-    if (ensure_numpy() < 0) goto error;
+    switch (ctype) {
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+        dbl = parse_double(s, s_l);
+        memcpy(out, &dbl, 8);
+        return 0;
 
-    // Parse function args.
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", keywords, &py_colspec, &py_data)) {
-        goto error;
-    }
+    case MYSQL_TYPE_DATE:
+    case MYSQL_TYPE_NEWDATE:
+        if (parse_date_days(s, s_l, &i64) < 0) return -1;
+        break;
 
-    CHECKRC(PyBytes_AsStringAndSize(py_data, &data, &length));
-    end = data + (unsigned long long)length;
-    orig_data = data;
+    case MYSQL_TYPE_TIME:
+        if (parse_time_micros(s, s_l, &i64) < 0) return -1;
+        break;
 
-    // Get number of columns
-    n_cols = PyObject_Length(py_colspec);
-    if (n_cols == 0) {
-        goto error;
+    default:
+        if (parse_datetime_micros(s, s_l, &i64) < 0) return -1;
+        break;
     }
 
-    // Determine column types
-    ctypes = calloc(sizeof(int), n_cols);
-    if (!ctypes) goto error;
-    for (i = 0; i < n_cols; i++) {
-        PyObject *py_cspec = PySequence_GetItem(py_colspec, i);
-        if (!py_cspec) goto error;
-        PyObject *py_ctype = PySequence_GetItem(py_cspec, 1);
-        if (!py_ctype) { Py_DECREF(py_cspec); goto error; }
-        ctypes[i] = (int)PyLong_AsLong(py_ctype);
-        Py_DECREF(py_ctype);
-        Py_DECREF(py_cspec);
-        if (PyErr_Occurred()) { goto error; }
-    }
+    memcpy(out, &i64, 8);
+    return 0;
+}
 
-#define CHECKSIZE(x) \
-    if ((data + x) > end) { \
-        PyErr_SetString(PyExc_ValueError, "data length does not align with specified column values"); \
-        goto error; \
+//
+// Size of the numpy value a fixed-width rowdat_1 type is decoded into, or 0
+// for types that are not fixed-width numbers.
+//
+static int rowdat_1_numeric_size(int ctype) {
+    switch (ctype) {
+    case MYSQL_TYPE_TINY:
+    case -MYSQL_TYPE_TINY:
+        return 1;
+    case MYSQL_TYPE_SHORT:
+    case -MYSQL_TYPE_SHORT:
+        return 2;
+    case MYSQL_TYPE_LONG:
+    case -MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+    case -MYSQL_TYPE_INT24:
+    case MYSQL_TYPE_FLOAT:
+        return 4;
+    case MYSQL_TYPE_LONGLONG:
+    case -MYSQL_TYPE_LONGLONG:
+    case MYSQL_TYPE_DOUBLE:
+        return 8;
     }
+    return 0;
+}
 
-    // Determine number of rows
-    item_sizes = malloc(sizeof(int) * n_cols);
-    if (!item_sizes) goto error;
-    data_formats = malloc(sizeof(char*) * n_cols);
-    if (!data_formats) goto error;
-    while (end > data) {
-        // Row ID
-        CHECKSIZE(8);
-        data += 8;
+//
+// Store a wide rowdat_1 number (8-byte integer or double) into the narrower
+// numpy type declared for the column. Returns -1 if the value does not fit.
+//
+static int rowdat_1_narrow_to_numpy(int out_type, char *data, char *out) {
+    int64_t i64 = 0;
+    uint64_t u64 = 0;
+    double dbl = 0;
+    float flt = 0;
 
-        for (i = 0; i < n_cols; i++) {
-            // Null slot
-            CHECKSIZE(1);
-            data += 1;
+    switch (out_type) {
+    case MYSQL_TYPE_FLOAT:
+        memcpy(&dbl, data, 8);
+        if (isfinite(dbl) && (dbl > FLT_MAX || dbl < -FLT_MAX)) return -1;
+        flt = (float)dbl;
+        memcpy(out, &flt, 4);
+        return 0;
 
-            // Data row
-            switch (ctypes[i]) {
-            case MYSQL_TYPE_NULL:
-                PyErr_SetString(PyExc_TypeError, "unsupported data type: NULL");
-                goto error;
-                break;
+    case MYSQL_TYPE_TINY:
+        memcpy(&i64, data, 8);
+        if (i64 < INT8_MIN || i64 > INT8_MAX) return -1;
+        *(int8_t*)out = (int8_t)i64;
+        return 0;
 
-            case MYSQL_TYPE_BIT:
-                PyErr_SetString(PyExc_TypeError, "unsupported data type: BIT");
-                goto error;
-                break;
+    case MYSQL_TYPE_SHORT:
+        memcpy(&i64, data, 8);
+        if (i64 < INT16_MIN || i64 > INT16_MAX) return -1;
+        { int16_t v = (int16_t)i64; memcpy(out, &v, 2); }
+        return 0;
 
-            case MYSQL_TYPE_TINY:
-            case -MYSQL_TYPE_TINY:
-                CHECKSIZE(1);
-                item_sizes[i] = 1;
-                data_formats[i] = (ctypes[i] < 0) ? "B" : "b";
-                data += 1;
-                break;
+    case MYSQL_TYPE_LONG:
+    case MYSQL_TYPE_INT24:
+        memcpy(&i64, data, 8);
+        if (i64 < INT32_MIN || i64 > INT32_MAX) return -1;
+        { int32_t v = (int32_t)i64; memcpy(out, &v, 4); }
+        return 0;
 
-            case MYSQL_TYPE_SHORT:
-            case -MYSQL_TYPE_SHORT:
-                CHECKSIZE(2);
-                item_sizes[i] = 2;
-                data_formats[i] = (ctypes[i] < 0) ? "H" : "h";
-                data += 2;
-                break;
+    case -MYSQL_TYPE_TINY:
+        memcpy(&u64, data, 8);
+        if (u64 > UINT8_MAX) return -1;
+        *(uint8_t*)out = (uint8_t)u64;
+        return 0;
 
-            case MYSQL_TYPE_LONG:
-            case -MYSQL_TYPE_LONG:
-            case MYSQL_TYPE_INT24:
-            case -MYSQL_TYPE_INT24:
-                CHECKSIZE(4);
-                item_sizes[i] = 4;
-                data_formats[i] = (ctypes[i] < 0) ? "I" : "i";
-                data += 4;
-                break;
+    case -MYSQL_TYPE_SHORT:
+        memcpy(&u64, data, 8);
+        if (u64 > UINT16_MAX) return -1;
+        { uint16_t v = (uint16_t)u64; memcpy(out, &v, 2); }
+        return 0;
 
-            case MYSQL_TYPE_LONGLONG:
-            case -MYSQL_TYPE_LONGLONG:
-                CHECKSIZE(8);
-                item_sizes[i] = 8;
-                data_formats[i] = (ctypes[i] < 0) ? "Q" : "q";
-                data += 8;
-                break;
+    case -MYSQL_TYPE_LONG:
+    case -MYSQL_TYPE_INT24:
+        memcpy(&u64, data, 8);
+        if (u64 > UINT32_MAX) return -1;
+        { uint32_t v = (uint32_t)u64; memcpy(out, &v, 4); }
+        return 0;
+    }
 
-            case MYSQL_TYPE_FLOAT:
-                CHECKSIZE(4);
-                item_sizes[i] = 4;
-                data_formats[i] = "f";
-                data += 4;
-                break;
+    return -1;
+}
 
-            case MYSQL_TYPE_DOUBLE:
-                CHECKSIZE(8);
-                item_sizes[i] = 8;
-                data_formats[i] = "d";
-                data += 8;
-                break;
+//
+// Scale a datetime64 / timedelta64 value to microseconds, rounding down.
+// Returns -1 on overflow.
+//
+static int scale_to_micros(int64_t value, int64_t unit_mul, int64_t unit_div, int64_t *out) {
+    if (unit_div > 1) {
+        *out = value / unit_div;
+        if (value % unit_div < 0) *out -= 1;
+        return 0;
+    }
+    if (value > INT64_MAX / unit_mul || value < INT64_MIN / unit_mul) return -1;
+    *out = value * unit_mul;
+    return 0;
+}
 
-            case MYSQL_TYPE_DECIMAL:
-            case MYSQL_TYPE_NEWDECIMAL:
-                PyErr_SetString(PyExc_TypeError, "unsupported data type: DECIMAL");
-                goto error;
-                break;
+//
+// Format a numpy value as rowdat_1 text for a DECIMAL, DATE, TIME, DATETIME
+// or TIMESTAMP output. Datetime and timedelta values are scaled to
+// microseconds by `unit_mul / unit_div`. Returns the text length, 0 for NaN
+// and NaT (sent as NULL), or -1 with an exception set.
+//
+static int numpy_to_rowdat_1_text(
+    int ctype,
+    int col_type,
+    char *value,
+    int64_t unit_mul,
+    int64_t unit_div,
+    char *buf,
+    size_t buf_l
+) {
+    BinaryValue v = {0};
+    int64_t i64 = 0;
+    int64_t days = 0;
+    double dbl = 0;
+    int n = 0;
+
+    switch (ctype) {
+    case MYSQL_TYPE_DECIMAL:
+    case MYSQL_TYPE_NEWDECIMAL:
+        switch (col_type) {
+        case NUMPY_BOOL:
+        case NUMPY_INT8: return snprintf(buf, buf_l, "%d", (int)*(int8_t*)value);
+        case NUMPY_INT16: return snprintf(buf, buf_l, "%d", (int)*(int16_t*)value);
+        case NUMPY_INT32: return snprintf(buf, buf_l, "%d", (int)*(int32_t*)value);
+        case NUMPY_INT64: return snprintf(buf, buf_l, "%lld", (long long)*(int64_t*)value);
+        case NUMPY_UINT8: return snprintf(buf, buf_l, "%u", (unsigned)*(uint8_t*)value);
+        case NUMPY_UINT16: return snprintf(buf, buf_l, "%u", (unsigned)*(uint16_t*)value);
+        case NUMPY_UINT32: return snprintf(buf, buf_l, "%u", (unsigned)*(uint32_t*)value);
+        case NUMPY_UINT64: return snprintf(buf, buf_l, "%llu", (unsigned long long)*(uint64_t*)value);
+        case NUMPY_FLOAT32:
+        case NUMPY_FLOAT64:
+            dbl = (col_type == NUMPY_FLOAT32) ? (double)*(float*)value : *(double*)value;
+            if (isnan(dbl)) return 0;
+            if (isinf(dbl)) {
+                PyErr_SetString(PyExc_ValueError, "value is outside the valid range for DECIMAL");
+                return -1;
+            }
+            return (col_type == NUMPY_FLOAT32) ? format_float32((float)dbl, buf, buf_l)
+                                               : snprintf(buf, buf_l, "%.17g", dbl);
+        default:
+            PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type DECIMAL");
+            return -1;
+        }
 
-            case MYSQL_TYPE_DATE:
-            case MYSQL_TYPE_NEWDATE:
-                PyErr_SetString(PyExc_TypeError, "unsupported data type: DATE");
-                goto error;
-                break;
+    case MYSQL_TYPE_TIME:
+        if (col_type != NUMPY_TIMEDELTA) {
+            PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type TIME");
+            return -1;
+        }
+        memcpy(&i64, value, 8);
+        if (i64 == INT64_MIN) return 0;
+        if (scale_to_micros(i64, unit_mul, unit_div, &i64) < 0) goto time_range;
+        v.is_negative = i64 < 0;
+        if (v.is_negative) i64 = -i64;
+        if (i64 / 1000000 > 838 * 3600 + 59 * 60 + 59) goto time_range;
+        v.microsecond = (int)(i64 % 1000000);
+        v.second = (int)(i64 / 1000000 % 60);
+        v.minute = (int)(i64 / 60000000 % 60);
+        v.hour = (int)(i64 / 3600000000LL);
+        break;
 
-            case MYSQL_TYPE_TIME:
-                PyErr_SetString(PyExc_TypeError, "unsupported data type: TIME");
-                goto error;
-                break;
+    default:
+        if (col_type != NUMPY_DATETIME) {
+            PyErr_Format(PyExc_ValueError, "unsupported numpy data type for output type %s",
+                         (ctype == MYSQL_TYPE_DATE || ctype == MYSQL_TYPE_NEWDATE) ? "DATE" : "DATETIME");
+            return -1;
+        }
+        memcpy(&i64, value, 8);
+        if (i64 == INT64_MIN) return 0;
+        if (scale_to_micros(i64, unit_mul, unit_div, &i64) < 0) goto datetime_range;
+        // Microseconds of 0001-01-01 00:00:00 and 9999-12-31 23:59:59.999999
+        if (i64 < -62135596800000000LL || i64 > 253402300799999999LL) goto datetime_range;
+        days = i64 / 86400000000LL;
+        if (i64 % 86400000000LL < 0) days -= 1;
+        i64 -= days * 86400000000LL;
+        civil_from_days(days, &v.year, &v.month, &v.day);
+        v.microsecond = (int)(i64 % 1000000);
+        v.second = (int)(i64 / 1000000 % 60);
+        v.minute = (int)(i64 / 60000000 % 60);
+        v.hour = (int)(i64 / 3600000000LL);
+        break;
+    }
 
-            case MYSQL_TYPE_DATETIME:
-                PyErr_SetString(PyExc_TypeError, "unsupported data type: DATETIME");
-                goto error;
-                break;
+    n = (int)binary_value_to_text(ctype, 0, &v, buf, buf_l);
+    return n;
 
-            case MYSQL_TYPE_TIMESTAMP:
-                PyErr_SetString(PyExc_TypeError, "unsupported data type: TIMESTAMP");
-                goto error;
-                break;
+time_range:
+    PyErr_SetString(PyExc_ValueError, "value is outside the valid range for TIME");
+    return -1;
 
-            case MYSQL_TYPE_YEAR:
-                CHECKSIZE(2);
-                data += 2;
-                break;
+datetime_range:
+    PyErr_SetString(PyExc_ValueError, "value is outside the valid range for DATETIME");
+    return -1;
+}
 
-            case MYSQL_TYPE_VARCHAR:
-            case MYSQL_TYPE_JSON:
-            case MYSQL_TYPE_SET:
-            case MYSQL_TYPE_ENUM:
-            case MYSQL_TYPE_VAR_STRING:
-            case MYSQL_TYPE_STRING:
-            case MYSQL_TYPE_GEOMETRY:
-            case MYSQL_TYPE_TINY_BLOB:
-            case MYSQL_TYPE_MEDIUM_BLOB:
-            case MYSQL_TYPE_LONG_BLOB:
-            case MYSQL_TYPE_BLOB:
-                CHECKSIZE(8);
-                item_sizes[i] = 8;
-                data_formats[i] = "Q";
-                i64 = *(int64_t*)data;
-                data += 8;
-                CHECKSIZE(i64);
-                data += i64;
-                break;
+//
+// Decode rowdat_1 data into numpy arrays in a single pass.
+//
+// Every row takes at least a fixed number of bytes, so the input length bounds
+// the number of rows. Fixed-width values are copied into bytearrays of that size
+// which are trimmed and wrapped with numpy.frombuffer at the end. Strings and
+// blobs are kept as object pointers and moved straight into object arrays.
+// DECIMAL and temporal values arrive as text and are parsed into float64,
+// datetime64[D] (DATE), timedelta64[us] (TIME) or datetime64[us].
+//
+// A colspec entry may carry a third element with the declared type of the
+// column, e.g. ('x', LONGLONG, TINY). Integers and doubles are always sent
+// wide; such columns are range checked and stored in the narrow type.
+//
+static PyObject *load_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *py_data = NULL;
+    PyObject *py_out = NULL;
+    PyObject *py_colspec = NULL;
+    PyObject *py_arr = NULL;
+    PyObject *py_out_pairs = NULL;
+    PyObject *py_index = NULL;
+    PyObject *py_mask = NULL;
+    PyObject *py_pair = NULL;
+    PyObject *py_row_ids = NULL; // Bytearray of row IDs
+    PyObject **py_cols = NULL; // Bytearray of values (or object pointers) per column
+    PyObject **py_masks = NULL; // Bytearray of null flags per column
+    PyObject **objs = NULL;
+    PyObject **arr_objs = NULL;
+    PyObject *py_old = NULL;
+    Py_ssize_t length = 0;
+    accel_buffer input = {0};
+    uint8_t is_null = 0;
+    int64_t i64 = 0;
+    float flt = NAN;
+    double dbl = NAN;
+    int64_t nat = INT64_MIN;
+    int *ctypes = NULL;
+    int *out_types = NULL; // Declared type of the column, may be narrower than ctypes
+    int *item_sizes = NULL;
+    int *wire_sizes = NULL; // Zero for length-prefixed values
+    char **data_formats = NULL; // NULL for object columns
+    char *data = NULL;
+    char *end = NULL;
+    char *out = NULL;
+    unsigned long long n_cols = 0;
+    unsigned long long i = 0;
+    unsigned long long j = 0;
+    char *keywords[] = {"colspec", "data", NULL};
+    unsigned long long n_rows = 0;
+    unsigned long long max_rows = 0;
+    unsigned long long min_row_size = 8;
 
-            // Use negative to indicate binary
-            case -MYSQL_TYPE_VARCHAR:
-            case -MYSQL_TYPE_JSON:
-            case -MYSQL_TYPE_SET:
-            case -MYSQL_TYPE_ENUM:
-            case -MYSQL_TYPE_VAR_STRING:
-            case -MYSQL_TYPE_STRING:
-            case -MYSQL_TYPE_GEOMETRY:
-            case -MYSQL_TYPE_TINY_BLOB:
-            case -MYSQL_TYPE_MEDIUM_BLOB:
-            case -MYSQL_TYPE_LONG_BLOB:
-                CHECKSIZE(8);
-                item_sizes[i] = 8;
-                data_formats[i] = "Q";
-                i64 = *(int64_t*)data;
-                data += 8;
-                CHECKSIZE(i64);
-                data += i64;
-                break;
-            }
-        }
+    if (ensure_numpy() < 0) goto error;
 
-        n_rows += 1;
+    // Parse function args.
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", keywords, &py_colspec, &py_data)) {
+        goto error;
     }
 
-    // Reset data pointer
-    data = orig_data;
+    CHECKRC(get_input_buffer(py_data, &input));
+    data = input.buf;
+    length = input.len;
+    end = data + (unsigned long long)length;
+
+    // Get number of columns
+    n_cols = PyObject_Length(py_colspec);
+    if (n_cols == 0) {
+        PyErr_SetString(PyExc_ValueError, "no columns specified");
+        goto error;
+    }
 
-    // Allocate data columns
-    out_cols = malloc(n_cols * sizeof(char*));
-    if (!out_cols) goto error;
-    mask_cols = malloc(n_cols * sizeof(char*));
-    if (!mask_cols) goto error;
+    // Determine column types
+    ctypes = calloc(sizeof(int), n_cols);
+    if (!ctypes) goto error;
+    out_types = calloc(sizeof(int), n_cols);
+    if (!out_types) goto error;
     for (i = 0; i < n_cols; i++) {
-        out_cols[i] = malloc(item_sizes[i] * n_rows);
-        if (!out_cols[i]) goto error;
-        mask_cols[i] = malloc(1 * n_rows);
-        if (!mask_cols[i]) goto error;
+        PyObject *py_cspec = PySequence_GetItem(py_colspec, i);
+        if (!py_cspec) goto error;
+        PyObject *py_ctype = PySequence_GetItem(py_cspec, 1);
+        if (!py_ctype) { Py_DECREF(py_cspec); goto error; }
+        ctypes[i] = out_types[i] = (int)PyLong_AsLong(py_ctype);
+        Py_DECREF(py_ctype);
+        // An optional third element is the type the column was declared as
+        if (!PyErr_Occurred() && PySequence_Length(py_cspec) > 2) {
+            py_ctype = PySequence_GetItem(py_cspec, 2);
+            if (!py_ctype) { Py_DECREF(py_cspec); goto error; }
+            out_types[i] = (int)PyLong_AsLong(py_ctype);
+            Py_DECREF(py_ctype);
+        }
+        Py_DECREF(py_cspec);
+        if (PyErr_Occurred()) { goto error; }
     }
 
-    // Allocate row ID array
-    out_row_ids = malloc(sizeof(int64_t) * n_rows);
-    if (!out_row_ids) goto error;
+    // Determine the output layout of each column
+    item_sizes = calloc(sizeof(int), n_cols);
+    if (!item_sizes) goto error;
+    wire_sizes = calloc(sizeof(int), n_cols);
+    if (!wire_sizes) goto error;
+    data_formats = calloc(sizeof(char*), n_cols);
+    if (!data_formats) goto error;
+    for (i = 0; i < n_cols; i++) {
+        switch (ctypes[i]) {
+        case MYSQL_TYPE_NULL:
+            PyErr_SetString(PyExc_TypeError, "unsupported data type: NULL");
+            goto error;
 
-    // Create dict for strings/blobs
-    py_objs = PyDict_New();
-    if (!py_objs) goto error;
-    CHECKRC(PyDict_SetItem(py_objs, PyLong_FromUnsignedLongLong(0), Py_None));
+        case MYSQL_TYPE_BIT:
+            PyErr_SetString(PyExc_TypeError, "unsupported data type: BIT");
+            goto error;
 
-    // Build output arrays
-    j = 0;
-    while (end > data) {
-        if (j >= n_rows) goto error;
+        case MYSQL_TYPE_TINY:
+        case -MYSQL_TYPE_TINY:
+            item_sizes[i] = wire_sizes[i] = 1;
+            data_formats[i] = (ctypes[i] < 0) ? "B" : "b";
+            break;
 
-        out_row_ids[j] = *(int64_t*)data; data += 8;
+        case MYSQL_TYPE_SHORT:
+        case -MYSQL_TYPE_SHORT:
+            item_sizes[i] = wire_sizes[i] = 2;
+            data_formats[i] = (ctypes[i] < 0) ? "H" : "h";
+            break;
 
-        for (i = 0; i < n_cols; i++) {
-            is_null = (data[0] == '\x01');
-            data += 1;
+        case MYSQL_TYPE_LONG:
+        case -MYSQL_TYPE_LONG:
+        case MYSQL_TYPE_INT24:
+        case -MYSQL_TYPE_INT24:
+            item_sizes[i] = wire_sizes[i] = 4;
+            data_formats[i] = (ctypes[i] < 0) ? "I" : "i";
+            break;
 
-            ((char*)mask_cols[i])[j] = (is_null) ? '\x01' : '\x00';
+        case MYSQL_TYPE_LONGLONG:
+        case -MYSQL_TYPE_LONGLONG:
+            item_sizes[i] = wire_sizes[i] = 8;
+            data_formats[i] = (ctypes[i] < 0) ? "Q" : "q";
+            break;
 
-            switch (ctypes[i]) {
-            case MYSQL_TYPE_NULL:
-                i8 = 0; data += 1;
-                memcpy(out_cols[i] + j * 1, &i8, 1);
-                break;
+        case MYSQL_TYPE_FLOAT:
+            item_sizes[i] = wire_sizes[i] = 4;
+            data_formats[i] = "f";
+            break;
 
-            case MYSQL_TYPE_BIT:
-                // TODO
-                break;
+        case MYSQL_TYPE_DOUBLE:
+            item_sizes[i] = wire_sizes[i] = 8;
+            data_formats[i] = "d";
+            break;
 
-            case MYSQL_TYPE_TINY:
-                i8 = (is_null) ? 0 : *(int8_t*)data; data += 1;
-                memcpy(out_cols[i] + j * 1, &i8, 1);
-                break;
+        // Sent as text, parsed into fixed-width values
+        case MYSQL_TYPE_DECIMAL:
+        case MYSQL_TYPE_NEWDECIMAL:
+            item_sizes[i] = 8;
+            data_formats[i] = "d";
+            break;
 
-            // Use negative to indicate unsigned
-            case -MYSQL_TYPE_TINY:
-                u8 = (is_null) ? 0 : *(uint8_t*)data; data += 1;
-                memcpy(out_cols[i] + j * 1, &u8, 1);
-                break;
+        case MYSQL_TYPE_DATE:
+        case MYSQL_TYPE_NEWDATE:
+            item_sizes[i] = 8;
+            data_formats[i] = "datetime64[D]";
+            break;
 
-            case MYSQL_TYPE_SHORT:
-                i16 = (is_null) ? 0 : *(int16_t*)data; data += 2;
-                memcpy(out_cols[i] + j * 2, &i16, 2);
-                break;
+        case MYSQL_TYPE_TIME:
+            item_sizes[i] = 8;
+            data_formats[i] = "timedelta64[us]";
+            break;
 
-            // Use negative to indicate unsigned
-            case -MYSQL_TYPE_SHORT:
-                u16 = (is_null) ? 0 : *(uint16_t*)data; data += 2;
-                memcpy(out_cols[i] + j * 2, &u16, 2);
-                break;
+        case MYSQL_TYPE_DATETIME:
+        case MYSQL_TYPE_TIMESTAMP:
+            item_sizes[i] = 8;
+            data_formats[i] = "datetime64[us]";
+            break;
 
-            case MYSQL_TYPE_LONG:
-            case MYSQL_TYPE_INT24:
-                i32 = (is_null) ? 0 : *(int32_t*)data; data += 4;
-                memcpy(out_cols[i] + j * 4, &i32, 4);
-                break;
+        case MYSQL_TYPE_YEAR:
+            item_sizes[i] = wire_sizes[i] = 2;
+            data_formats[i] = "H";
+            break;
 
-            // Use negative to indicate unsigned
-            case -MYSQL_TYPE_LONG:
-            case -MYSQL_TYPE_INT24:
-                u32 = (is_null) ? 0 : *(uint32_t*)data; data += 4;
-                memcpy(out_cols[i] + j * 4, &u32, 4);
-                break;
+        case MYSQL_TYPE_VARCHAR:
+        case MYSQL_TYPE_JSON:
+        case MYSQL_TYPE_SET:
+        case MYSQL_TYPE_ENUM:
+        case MYSQL_TYPE_VAR_STRING:
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_GEOMETRY:
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+        // Use negative to indicate binary
+        case -MYSQL_TYPE_VARCHAR:
+        case -MYSQL_TYPE_JSON:
+        case -MYSQL_TYPE_SET:
+        case -MYSQL_TYPE_ENUM:
+        case -MYSQL_TYPE_VAR_STRING:
+        case -MYSQL_TYPE_STRING:
+        case -MYSQL_TYPE_GEOMETRY:
+        case -MYSQL_TYPE_TINY_BLOB:
+        case -MYSQL_TYPE_MEDIUM_BLOB:
+        case -MYSQL_TYPE_LONG_BLOB:
+        case -MYSQL_TYPE_BLOB:
+            item_sizes[i] = sizeof(PyObject*);
+            break;
 
-            case MYSQL_TYPE_LONGLONG:
-                i64 = (is_null) ? 0 : *(int64_t*)data; data += 8;
-                memcpy(out_cols[i] + j * 8, &i64, 8);
-                break;
+        default:
+            PyErr_Format(PyExc_TypeError, "unsupported data type: %d", ctypes[i]);
+            goto error;
+        }
 
-            // Use negative to indicate unsigned
-            case -MYSQL_TYPE_LONGLONG:
-                u64 = (is_null) ? 0 : *(uint64_t*)data; data += 8;
-                memcpy(out_cols[i] + j * 8, &u64, 8);
-                break;
+        // Integers and floats may be declared narrower than they are sent,
+        // in which case they are range checked and stored in the narrow type
+        if (out_types[i] != ctypes[i]) {
+            int is_int = rowdat_1_numeric_size(out_types[i]) &&
+                         out_types[i] != MYSQL_TYPE_FLOAT && out_types[i] != MYSQL_TYPE_DOUBLE;
+            if (!((ctypes[i] == MYSQL_TYPE_LONGLONG && out_types[i] > 0 && is_int) ||
+                  (ctypes[i] == -MYSQL_TYPE_LONGLONG && out_types[i] < 0 && is_int) ||
+                  (ctypes[i] == MYSQL_TYPE_DOUBLE && out_types[i] == MYSQL_TYPE_FLOAT))) {
+                PyErr_Format(PyExc_TypeError, "can not load data type %d as %d", ctypes[i], out_types[i]);
+                goto error;
+            }
+            item_sizes[i] = rowdat_1_numeric_size(out_types[i]);
+            switch (out_types[i]) {
+            case MYSQL_TYPE_TINY: data_formats[i] = "b"; break;
+            case -MYSQL_TYPE_TINY: data_formats[i] = "B"; break;
+            case MYSQL_TYPE_SHORT: data_formats[i] = "h"; break;
+            case -MYSQL_TYPE_SHORT: data_formats[i] = "H"; break;
+            case MYSQL_TYPE_FLOAT: data_formats[i] = "f"; break;
+            default: data_formats[i] = (out_types[i] < 0) ? "I" : "i"; break;
+            }
+        }
 
-            case MYSQL_TYPE_FLOAT:
-                flt = (is_null) ? NAN : *(float*)data; data += 4;
-                memcpy(out_cols[i] + j * 4, &flt, 4);
-                break;
+        // Numbers are sent as is, everything else with a length prefix
+        min_row_size += 1 + ((wire_sizes[i]) ? wire_sizes[i] : 8);
+    }
 
-            case MYSQL_TYPE_DOUBLE:
-                dbl = (is_null) ? NAN : *(double*)data; data += 8;
-                memcpy(out_cols[i] + j * 8, &dbl, 8);
-                break;
+    // Allocate output buffers for the largest possible number of rows
+    max_rows = (unsigned long long)length / min_row_size;
 
-            case MYSQL_TYPE_DECIMAL:
-            case MYSQL_TYPE_NEWDECIMAL:
-                // TODO
-                break;
+    py_row_ids = PyByteArray_FromStringAndSize(NULL, max_rows * 8);
+    if (!py_row_ids) goto error;
 
-            case MYSQL_TYPE_DATE:
-            case MYSQL_TYPE_NEWDATE:
-                // TODO
-                break;
+    py_cols = calloc(sizeof(PyObject*), n_cols);
+    if (!py_cols) goto error;
+    py_masks = calloc(sizeof(PyObject*), n_cols);
+    if (!py_masks) goto error;
+    for (i = 0; i < n_cols; i++) {
+        py_cols[i] = PyByteArray_FromStringAndSize(NULL, max_rows * item_sizes[i]);
+        if (!py_cols[i]) goto error;
+        py_masks[i] = PyByteArray_FromStringAndSize(NULL, max_rows);
+        if (!py_masks[i]) goto error;
+        if (!data_formats[i]) {
+            memset(PyByteArray_AsString(py_cols[i]), 0, max_rows * item_sizes[i]);
+        }
+    }
 
-            case MYSQL_TYPE_TIME:
-                // TODO
-                break;
+#define CHECKSIZE(x) \
+    if ((data + x) > end) { \
+        PyErr_SetString(PyExc_ValueError, "data length does not align with specified column values"); \
+        goto error; \
+    }
 
-            case MYSQL_TYPE_DATETIME:
-                // TODO
-                break;
+    // Build output columns
+    while (end > data) {
+        CHECKSIZE(min_row_size);
 
-            case MYSQL_TYPE_TIMESTAMP:
-                // TODO
-                break;
+        memcpy(PyByteArray_AsString(py_row_ids) + n_rows * 8, data, 8);
+        data += 8;
 
-            case MYSQL_TYPE_YEAR:
-                u16 = (is_null) ? 0 : *(uint16_t*)data; data += 2;
-                memcpy(out_cols[i] + j * 2, &u16, 2);
-                break;
+        for (i = 0; i < n_cols; i++) {
+            CHECKSIZE(1);
+            is_null = (data[0] == '\x01');
+            data += 1;
 
-            case MYSQL_TYPE_VARCHAR:
-            case MYSQL_TYPE_JSON:
-            case MYSQL_TYPE_SET:
-            case MYSQL_TYPE_ENUM:
-            case MYSQL_TYPE_VAR_STRING:
-            case MYSQL_TYPE_STRING:
-            case MYSQL_TYPE_GEOMETRY:
-            case MYSQL_TYPE_TINY_BLOB:
-            case MYSQL_TYPE_MEDIUM_BLOB:
-            case MYSQL_TYPE_LONG_BLOB:
-            case MYSQL_TYPE_BLOB:
-                i64 = *(int64_t*)data; data += 8;
-                if (is_null) {
-                    u64 = 0;
-                    memcpy(out_cols[i] + j * 8, &u64, 8);
-                } else {
-                    py_str = PyUnicode_FromStringAndSize(data, (Py_ssize_t)i64);
-                    data += i64;
-                    if (!py_str) goto error;
-                    u64 = (uint64_t)py_str;
-                    memcpy(out_cols[i] + j * 8, &u64, 8);
-                    CHECKRC(PyDict_SetItem(py_objs, PyLong_FromUnsignedLongLong(u64), py_str));
-                    Py_CLEAR(py_str);
-                }
-                break;
+            PyByteArray_AsString(py_masks[i])[n_rows] = (is_null) ? '\x01' : '\x00';
 
-            // Use negative to indicate binary
-            case -MYSQL_TYPE_VARCHAR:
-            case -MYSQL_TYPE_JSON:
-            case -MYSQL_TYPE_SET:
-            case -MYSQL_TYPE_ENUM:
-            case -MYSQL_TYPE_VAR_STRING:
-            case -MYSQL_TYPE_STRING:
-            case -MYSQL_TYPE_GEOMETRY:
-            case -MYSQL_TYPE_TINY_BLOB:
-            case -MYSQL_TYPE_MEDIUM_BLOB:
-            case -MYSQL_TYPE_LONG_BLOB:
-            case -MYSQL_TYPE_BLOB:
-                i64 = *(int64_t*)data; data += 8;
+            out = PyByteArray_AsString(py_cols[i]) + n_rows * item_sizes[i];
+
+            // Fixed-width values are copied as is, nulls are zero (NaN for floats)
+            if (wire_sizes[i]) {
+                CHECKSIZE(wire_sizes[i]);
                 if (is_null) {
-                    u64 = 0;
-                    memcpy(out_cols[i] + j * 8, &u64, 8);
-                } else {
-                    py_blob = PyBytes_FromStringAndSize(data, (Py_ssize_t)i64);
-                    data += i64;
-                    if (!py_blob) goto error;
-                    u64 = (uint64_t)py_blob;
-                    memcpy(out_cols[i] + j * 8, &u64, 8);
-                    CHECKRC(PyDict_SetItem(py_objs, PyLong_FromUnsignedLongLong(u64), py_blob));
-                    Py_CLEAR(py_blob);
+                    if (out_types[i] == MYSQL_TYPE_FLOAT) {
+                        memcpy(out, &flt, 4);
+                    } else if (out_types[i] == MYSQL_TYPE_DOUBLE) {
+                        memcpy(out, &dbl, 8);
+                    } else {
+                        memset(out, 0, item_sizes[i]);
+                    }
+                } else if (item_sizes[i] == wire_sizes[i]) {
+                    memcpy(out, data, item_sizes[i]);
+                } else if (rowdat_1_narrow_to_numpy(out_types[i], data, out) < 0) {
+                    PyErr_Format(PyExc_ValueError, "value in column %llu is out of range for data type %d", i, out_types[i]);
+                    goto error;
                 }
-                break;
+                data += wire_sizes[i];
+                continue;
+            }
 
-            default:
+            CHECKSIZE(8);
+            memcpy(&i64, data, 8);
+            data += 8;
+            if (i64 < 0) {
+                PyErr_SetString(PyExc_ValueError, "data length does not align with specified column values");
                 goto error;
             }
+            CHECKSIZE(i64);
+
+            if (data_formats[i]) {
+                // NULL and values numpy can not hold (such as zero dates) are NaN / NaT
+                if (is_null || rowdat_1_text_to_numpy(ctypes[i], data, i64, out) < 0) {
+                    if (ctypes[i] == MYSQL_TYPE_DECIMAL || ctypes[i] == MYSQL_TYPE_NEWDECIMAL) {
+                        memcpy(out, &dbl, 8);
+                    } else {
+                        memcpy(out, &nat, 8);
+                    }
+                    PyByteArray_AsString(py_masks[i])[n_rows] = '\x01';
+                }
+            } else if (is_null) {
+                Py_INCREF(Py_None);
+                ((PyObject**)out)[0] = Py_None;
+            } else if (ctypes[i] < 0) {
+                ((PyObject**)out)[0] = PyBytes_FromStringAndSize(data, (Py_ssize_t)i64);
+                if (!((PyObject**)out)[0]) goto error;
+            } else {
+                ((PyObject**)out)[0] = PyUnicode_FromStringAndSize(data, (Py_ssize_t)i64);
+                if (!((PyObject**)out)[0]) goto error;
+            }
+            data += i64;
         }
 
-        j += 1;
+        n_rows += 1;
     }
 
+#undef CHECKSIZE
+
     py_out = PyTuple_New(2);
     if (!py_out) goto error;
 
     py_out_pairs = PyList_New(n_cols);
     if (!py_out_pairs) goto error;
 
-    // Create Series of row IDs
-    py_memview = PyMemoryView_FromMemory((char*)out_row_ids, n_rows * 8, PyBUF_WRITE);
-    if (!py_memview) goto error;
-
-    py_index = create_numpy_array(py_memview, "Q", 0, NULL);
-    Py_CLEAR(py_memview);
+    // Create array of row IDs
+    CHECKRC(PyByteArray_Resize(py_row_ids, n_rows * 8));
+    py_index = PyObject_CallFunction(PyFunc.numpy_frombuffer, "Os", py_row_ids, "Q");
     if (!py_index) goto error;
 
     CHECKRC(PyTuple_SetItem(py_out, 0, py_index));
     CHECKRC(PyTuple_SetItem(py_out, 1, py_out_pairs));
 
-    // Convert C buffers to numpy arrays and masks
+    // Convert column buffers to numpy arrays and masks
     for (i = 0; i < n_cols; i++) {
         py_pair = PyTuple_New(2);
         if (!py_pair) goto error;
 
-        py_memview = PyMemoryView_FromMemory(out_cols[i], n_rows * item_sizes[i], PyBUF_WRITE);
-        if (!py_memview) goto error;
-
-        py_arr = create_numpy_array(py_memview, data_formats[i], ctypes[i], py_objs);
-        Py_CLEAR(py_memview);
-        if (!py_arr) goto error;
+        if (data_formats[i]) {
+            CHECKRC(PyByteArray_Resize(py_cols[i], n_rows * item_sizes[i]));
+            py_arr = PyObject_CallFunction(PyFunc.numpy_frombuffer, "Os", py_cols[i], data_formats[i]);
+            if (!py_arr) goto error;
+        } else {
+            py_arr = PyObject_CallFunction(PyFunc.numpy_empty, "KO", n_rows, (PyObject*)&PyBaseObject_Type);
+            if (!py_arr) goto error;
 
-        py_memview = PyMemoryView_FromMemory(mask_cols[i], n_rows * 1, PyBUF_WRITE);
-        if (!py_memview) goto error;
+            arr_objs = (PyObject**)get_array_base_address(py_arr);
+            if (!arr_objs && n_rows) {
+                if (!PyErr_Occurred()) {
+                    PyErr_SetString(PyExc_ValueError, "could not get address of object array");
+                }
+                goto error;
+            }
 
-        py_mask = create_numpy_array(py_memview, "?", 0, NULL);
-        Py_CLEAR(py_memview);
-        if (!py_mask) goto error;
+            // Move the references into the array, replacing its placeholders
+            objs = (PyObject**)PyByteArray_AsString(py_cols[i]);
+            for (j = 0; j < n_rows; j++) {
+                py_old = arr_objs[j];
+                arr_objs[j] = objs[j];
+                objs[j] = NULL;
+                Py_XDECREF(py_old);
+            }
+        }
 
-        if (!py_arr) goto error;
+        CHECKRC(PyByteArray_Resize(py_masks[i], n_rows));
+        py_mask = PyObject_CallFunction(PyFunc.numpy_frombuffer, "Os", py_masks[i], "?");
         if (!py_mask) goto error;
 
         CHECKRC(PyTuple_SetItem(py_pair, 0, py_arr));
@@ -2578,19 +9313,37 @@ static PyObject *load_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *k
     }
 
 exit:
+    if (py_cols) {
+        for (i = 0; i < n_cols; i++) {
+            if (!py_cols[i]) continue;
+            // Release objects not handed over to an array (the row in progress included)
+            if (!data_formats[i]) {
+                objs = (PyObject**)PyByteArray_AsString(py_cols[i]);
+                for (j = 0; j < n_rows + 1 && j < max_rows; j++) {
+                    Py_XDECREF(objs[j]);
+                }
+            }
+            Py_DECREF(py_cols[i]);
+        }
+        free(py_cols);
+    }
+    if (py_masks) {
+        for (i = 0; i < n_cols; i++) {
+            Py_XDECREF(py_masks[i]);
+        }
+        free(py_masks);
+    }
     if (ctypes) free(ctypes);
-    if (out_cols) free(out_cols);
-    if (mask_cols) free(mask_cols);
+    if (out_types) free(out_types);
     if (data_formats) free(data_formats);
     if (item_sizes) free(item_sizes);
+    if (wire_sizes) free(wire_sizes);
+    release_accel_buffer(&input);
 
-    Py_XDECREF(py_str);
+    Py_XDECREF(py_row_ids);
     Py_XDECREF(py_arr);
     Py_XDECREF(py_mask);
     Py_XDECREF(py_pair);
-    Py_XDECREF(py_blob);
-    Py_XDECREF(py_objs);
-    Py_XDECREF(py_memview);
 
     return py_out;
 
@@ -2715,11 +9468,225 @@ exit:
     return out;
 
 error:
-    out = 0;
+    out = 0;
+    goto exit;
+}
+
+
+//
+// Get the unit of a datetime64 / timedelta64 array in microseconds, as the
+// fraction `unit_mul / unit_div`. Returns -1 for units that are not a fixed
+// length (years, months) or finer than nanoseconds.
+//
+static int get_numpy_time_unit(PyObject *py_array, int64_t *unit_mul, int64_t *unit_div) {
+    static const struct { const char *name; int64_t mul; int64_t div; } units[] = {
+        {"[W]", 7 * 86400000000LL, 1}, {"[D]", 86400000000LL, 1},
+        {"[h]", 3600000000LL, 1}, {"[m]", 60000000LL, 1}, {"[s]", 1000000LL, 1},
+        {"[ms]", 1000LL, 1}, {"[us]", 1LL, 1}, {"[ns]", 1LL, 1000},
+    };
+    int out = -1;
+    char *str = NULL;
+    PyObject *py_array_interface = NULL;
+    PyObject *py_typestr = NULL;
+
+    py_array_interface = PyObject_GetAttrString(py_array, "__array_interface__");
+    if (!py_array_interface) goto error;
+
+    py_typestr = PyDict_GetItemString(py_array_interface, "typestr");
+    if (!py_typestr) goto error;
+
+    str = _PyUnicode_AsUTF8(py_typestr);
+    if (!str || strlen(str) < 3) goto error;
+
+    for (size_t i = 0; i < sizeof(units) / sizeof(units[0]); i++) {
+        if (strcmp(str + 3, units[i].name) == 0) {
+            *unit_mul = units[i].mul;
+            *unit_div = units[i].div;
+            out = 0;
+            break;
+        }
+    }
+
+exit:
+    Py_XDECREF(py_array_interface);
+
+    if (str) free(str);
+
+    return out;
+
+error:
+    PyErr_Clear();
+    out = -1;
     goto exit;
 }
 
 
+//
+// Column kernels for dump_rowdat_1_numpy
+//
+// Numeric columns are written by one kernel per (output type, numpy type)
+// pair. Rows are interleaved through `pos`, the current write offset of each
+// row, so every kernel is a plain loop over a single column.
+//
+
+typedef void (*rowdat_1_dump_kernel)(
+    const char *src, const char *mask, unsigned long long n_rows,
+    char *out, unsigned long long *pos
+);
+
+#define DEFINE_DUMP_KERNEL(dst_name, dst_t, src_name, src_t) \
+static void dump_##dst_name##_from_##src_name( \
+    const char *src, const char *mask, unsigned long long n_rows, \
+    char *out, unsigned long long *pos \
+) { \
+    src_t value; \
+    dst_t cell; \
+    for (unsigned long long j = 0; j < n_rows; j++) { \
+        char *p = out + pos[j]; \
+        uint8_t is_null = (mask && mask[j]) ? 1 : 0; \
+        memcpy(&value, src + j * sizeof(src_t), sizeof(src_t)); \
+        cell = (is_null) ? 0 : (dst_t)value; \
+        p[0] = (char)is_null; \
+        memcpy(p + 1, &cell, sizeof(dst_t)); \
+        pos[j] += 1 + sizeof(dst_t); \
+    } \
+}
+
+#define DEFINE_DUMP_KERNELS(dst_name, dst_t) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, int8, int8_t) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, int16, int16_t) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, int32, int32_t) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, int64, int64_t) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, uint8, uint8_t) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, uint16, uint16_t) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, uint32, uint32_t) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, uint64, uint64_t) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, float32, float) \
+    DEFINE_DUMP_KERNEL(dst_name, dst_t, float64, double)
+
+DEFINE_DUMP_KERNELS(int8, int8_t)
+DEFINE_DUMP_KERNELS(uint8, uint8_t)
+DEFINE_DUMP_KERNELS(int16, int16_t)
+DEFINE_DUMP_KERNELS(uint16, uint16_t)
+DEFINE_DUMP_KERNELS(int32, int32_t)
+DEFINE_DUMP_KERNELS(uint32, uint32_t)
+DEFINE_DUMP_KERNELS(int64, int64_t)
+DEFINE_DUMP_KERNELS(uint64, uint64_t)
+DEFINE_DUMP_KERNELS(float32, float)
+DEFINE_DUMP_KERNELS(float64, double)
+
+// Indexed by NUMPY_* type; booleans are read as int8
+#define DUMP_KERNEL_ROW(dst_name) { \
+    NULL, \
+    dump_##dst_name##_from_int8, dump_##dst_name##_from_int8, \
+    dump_##dst_name##_from_int16, dump_##dst_name##_from_int32, \
+    dump_##dst_name##_from_int64, dump_##dst_name##_from_uint8, \
+    dump_##dst_name##_from_uint16, dump_##dst_name##_from_uint32, \
+    dump_##dst_name##_from_uint64, dump_##dst_name##_from_float32, \
+    dump_##dst_name##_from_float64, \
+}
+
+#define DUMP_INT8 0
+#define DUMP_UINT8 1
+#define DUMP_INT16 2
+#define DUMP_UINT16 3
+#define DUMP_INT32 4
+#define DUMP_UINT32 5
+#define DUMP_INT64 6
+#define DUMP_UINT64 7
+#define DUMP_FLOAT32 8
+#define DUMP_FLOAT64 9
+
+static const rowdat_1_dump_kernel dump_kernels[][NUMPY_FLOAT64 + 1] = {
+    DUMP_KERNEL_ROW(int8), DUMP_KERNEL_ROW(uint8),
+    DUMP_KERNEL_ROW(int16), DUMP_KERNEL_ROW(uint16),
+    DUMP_KERNEL_ROW(int32), DUMP_KERNEL_ROW(uint32),
+    DUMP_KERNEL_ROW(int64), DUMP_KERNEL_ROW(uint64),
+    DUMP_KERNEL_ROW(float32), DUMP_KERNEL_ROW(float64),
+};
+
+static const int dump_kernel_sizes[] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8};
+
+//
+// Range checks over a whole column, in the domain of the numpy type:
+// int64 for signed, uint64 for unsigned and double for floats. Returns -1
+// if any value is out of range. YEAR checks compare through a signed
+// `year_t` so that narrow and unsigned types don't hit -Wtype-limits.
+//
+#define DEFINE_RANGE_CHECKS(src_name, src_t, val_t, year_t) \
+static int check_##src_name##_range(const char *src, unsigned long long n_rows, val_t lo, val_t hi) { \
+    src_t value; \
+    for (unsigned long long j = 0; j < n_rows; j++) { \
+        memcpy(&value, src + j * sizeof(src_t), sizeof(src_t)); \
+        if (value < lo || value > hi) return -1; \
+    } \
+    return 0; \
+} \
+static int check_##src_name##_year(const char *src, unsigned long long n_rows) { \
+    src_t value; \
+    year_t year; \
+    for (unsigned long long j = 0; j < n_rows; j++) { \
+        memcpy(&value, src + j * sizeof(src_t), sizeof(src_t)); \
+        year = (year_t)value; \
+        if (!((year >= 0 && year <= 99) || (year >= 1901 && year <= 2155))) return -1; \
+    } \
+    return 0; \
+}
+
+DEFINE_RANGE_CHECKS(int8, int8_t, int64_t, int64_t)
+DEFINE_RANGE_CHECKS(int16, int16_t, int64_t, int64_t)
+DEFINE_RANGE_CHECKS(int32, int32_t, int64_t, int64_t)
+DEFINE_RANGE_CHECKS(int64, int64_t, int64_t, int64_t)
+DEFINE_RANGE_CHECKS(uint8, uint8_t, uint64_t, int64_t)
+DEFINE_RANGE_CHECKS(uint16, uint16_t, uint64_t, int64_t)
+DEFINE_RANGE_CHECKS(uint32, uint32_t, uint64_t, int64_t)
+DEFINE_RANGE_CHECKS(uint64, uint64_t, uint64_t, int64_t)
+DEFINE_RANGE_CHECKS(float32, float, double, double)
+DEFINE_RANGE_CHECKS(float64, double, double, double)
+
+//
+// Check that all values of a numeric column fit within [lo, hi], or are
+// valid YEAR values if `is_year` is set.
+//
+static int check_numpy_range(
+    int col_type, const char *src, unsigned long long n_rows,
+    int64_t lo, uint64_t hi, int is_year
+) {
+    int64_t s_hi = (hi > INT64_MAX) ? INT64_MAX : (int64_t)hi;
+    uint64_t u_lo = (lo < 0) ? 0 : (uint64_t)lo;
+
+    switch (col_type) {
+    case NUMPY_BOOL:
+    case NUMPY_INT8:
+        return (is_year) ? check_int8_year(src, n_rows) : check_int8_range(src, n_rows, lo, s_hi);
+    case NUMPY_INT16:
+        return (is_year) ? check_int16_year(src, n_rows) : check_int16_range(src, n_rows, lo, s_hi);
+    case NUMPY_INT32:
+        return (is_year) ? check_int32_year(src, n_rows) : check_int32_range(src, n_rows, lo, s_hi);
+    case NUMPY_INT64:
+        return (is_year) ? check_int64_year(src, n_rows) : check_int64_range(src, n_rows, lo, s_hi);
+    case NUMPY_UINT8:
+        return (is_year) ? check_uint8_year(src, n_rows) : check_uint8_range(src, n_rows, u_lo, hi);
+    case NUMPY_UINT16:
+        return (is_year) ? check_uint16_year(src, n_rows) : check_uint16_range(src, n_rows, u_lo, hi);
+    case NUMPY_UINT32:
+        return (is_year) ? check_uint32_year(src, n_rows) : check_uint32_range(src, n_rows, u_lo, hi);
+    case NUMPY_UINT64:
+        return (is_year) ? check_uint64_year(src, n_rows) : check_uint64_range(src, n_rows, u_lo, hi);
+    case NUMPY_FLOAT32:
+        return (is_year) ? check_float32_year(src, n_rows) : check_float32_range(src, n_rows, (double)lo, (double)hi);
+    case NUMPY_FLOAT64:
+        return (is_year) ? check_float64_year(src, n_rows) : check_float64_range(src, n_rows, (double)lo, (double)hi);
+    }
+    return -1;
+}
+
+#undef DEFINE_DUMP_KERNEL
+#undef DEFINE_DUMP_KERNELS
+#undef DUMP_KERNEL_ROW
+#undef DEFINE_RANGE_CHECKS
+
+
 //
 // Convert Python objects to rowdat_1 format
 //
@@ -2732,40 +9699,44 @@ error:
 // parameter must equal the number of elements in each of the array-1 and mask-1
 // parameters. The mask parameters may be Py_None.
 //
-static PyObject *dump_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *kwargs) {
-    PyObject *py_returns = NULL;
-    PyObject *py_row_ids = NULL;
-    PyObject *py_cols = NULL;
+// The output is built column by column. A first pass checks value ranges,
+// encodes strings and adds up the size of every row; the output is then
+// allocated once and each column is written into it by its kernel.
+//
+static PyObject *dump_rowdat_1_numpy_to(
+    PyObject *py_returns, PyObject *py_row_ids, PyObject *py_cols, PyObject *py_into
+) {
     PyObject *py_out = NULL;
+    PyObject *py_target = NULL;
+    PyObject *py_bytes = NULL;
+    PyObject *py_obj = NULL;
+    PyObject ***objs = NULL; // Encoded values of character columns
+    rowdat_1_dump_kernel *kernels = NULL; // NULL for text / character columns
     unsigned long long n_cols = 0;
     unsigned long long n_rows = 0;
+    unsigned long long fixed_row_size = 8;
+    unsigned long long *pos = NULL; // Size, then write offset, of each row
+    unsigned long long out_l = 0;
     uint8_t is_null = 0;
-    int8_t i8 = 0;
-    int16_t i16 = 0;
-    int32_t i32 = 0;
     int64_t i64 = 0;
-    uint8_t u8 = 0;
-    uint16_t u16 = 0;
-    uint32_t u32 = 0;
-    uint64_t u64 = 0;
-    float flt = 0;
-    double dbl = 0;
+    int64_t lo = 0;
+    uint64_t hi = 0;
+    int kernel = 0;
+    const char *type_name = NULL;
     char *out = NULL;
-    unsigned long long out_l = 0;
-    unsigned long long out_idx = 0;
+    char *p = NULL;
     int *returns = NULL;
-    char *keywords[] = {"returns", "row_ids", "cols", NULL};
     unsigned long long i = 0;
     unsigned long long j = 0;
     char **cols = NULL;
     char **masks = NULL;
     int *col_types = NULL;
+    int64_t *time_units = NULL; // Microseconds per unit as (mul, div) pairs
     int64_t *row_ids = NULL;
-
-    // Parse function args.
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO", keywords, &py_returns, &py_row_ids, &py_cols)) {
-        goto error;
-    }
+    char text[64];
+    int text_l = 0;
+    accel_buffer output = {0};
+    static const int numpy_item_sizes[] = {0, 1, 1, 2, 4, 8, 1, 2, 4, 8, 4, 8, 8, 8, 8};
 
     if (PyObject_Length(py_returns) != PyObject_Length(py_cols)) {
         PyErr_SetString(PyExc_ValueError, "number of return values does not match number of returned columns");
@@ -2774,14 +9745,14 @@ static PyObject *dump_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *k
 
     n_rows = (unsigned long long)PyObject_Length(py_row_ids);
     if (n_rows == 0) {
-        py_out = PyBytes_FromStringAndSize("", 0);
+        py_out = (py_into) ? PyLong_FromLong(0) : PyBytes_FromStringAndSize("", 0);
         goto exit;
     }
 
     // Verify all data lengths agree
     n_cols = (unsigned long long)PyObject_Length(py_returns);
     if (n_cols == 0) {
-        py_out = PyBytes_FromStringAndSize("", 0);
+        py_out = (py_into) ? PyLong_FromLong(0) : PyBytes_FromStringAndSize("", 0);
         goto exit;
     }
     for (i = 0; i < n_cols; i++) {
@@ -2811,12 +9782,6 @@ static PyObject *dump_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *k
         goto error;
     }
 
-    // Starting size, it will be resized later
-    out_l = 256 * n_cols;
-    out_idx = 0;
-    out = malloc(out_l);
-    if (!out) goto error;
-
     // Get return types
     returns = malloc(sizeof(int) * n_cols);
     if (!returns) goto error;
@@ -2836,6 +9801,8 @@ static PyObject *dump_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *k
     if (!col_types) goto error;
     masks = calloc(sizeof(char*), n_cols);
     if (!masks) goto error;
+    time_units = calloc(sizeof(int64_t) * 2, n_cols);
+    if (!time_units) goto error;
     for (i = 0; i < n_cols; i++) {
         PyObject *py_item = PyList_GetItem(py_cols, i);
         if (!py_item) goto error;
@@ -2855,6 +9822,13 @@ static PyObject *dump_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *k
             goto error;
         }
 
+        if (col_types[i] == NUMPY_DATETIME || col_types[i] == NUMPY_TIMEDELTA) {
+            if (get_numpy_time_unit(py_data, &time_units[i * 2], &time_units[i * 2 + 1]) < 0) {
+                PyErr_SetString(PyExc_ValueError, "unsupported unit of datetime64 / timedelta64 column");
+                goto error;
+            }
+        }
+
         PyObject *py_mask = PyTuple_GetItem(py_item, 1);
         if (!py_mask) goto error;
 
@@ -2865,1057 +9839,254 @@ static PyObject *dump_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *k
         }
     }
 
-#define CHECKMEM(x) \
-    if ((out_idx + x) > out_l) { \
-        out_l = out_l * 2 + x; \
-        out = realloc(out, out_l); \
-        if (!out) goto error; \
-    }
-
-    for (j = 0; j < n_rows; j++) {
-
-        CHECKMEM(8);
-        memcpy(out+out_idx, &row_ids[j], 8);
-        out_idx += 8;
-
-        for (i = 0; i < n_cols; i++) {
-
-            if (masks[i]) {
-                is_null = *(masks[i] + j) != '\x00';
-            } else {
-                is_null = 0;
-            }
-
-            CHECKMEM(1);
-            memcpy(out+out_idx, &is_null, 1);
-            out_idx += 1;
-
-#define CHECK_TINYINT(x, unsigned_input) if ((x) < ((unsigned_input) ? 0 : -128) || (x) > 127) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for TINYINT"); \
-        goto error; \
-    }
-#define CHECK_UNSIGNED_TINYINT(x, unsigned_input) if ((x) < 0 || (x) > 255) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for UNSIGNED TINYINT"); \
-        goto error; \
-    }
-#define CHECK_SMALLINT(x, unsigned_input) if ((x) < ((unsigned_input) ? 0 : -32768) || (x) > 32767) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for SMALLINT"); \
-        goto error; \
-    }
-#define CHECK_UNSIGNED_SMALLINT(x, unsigned_input) if ((x) < 0 || (x) > 65535) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for UNSIGNED SMALLINT"); \
-        goto error; \
-    }
-#define CHECK_MEDIUMINT(x, unsigned_input) if ((x) < ((unsigned_input) ? 0 : -8388608) || (x) > 8388607) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for MEDIUMINT"); \
-        goto error; \
-    }
-#define CHECK_UNSIGNED_MEDIUMINT(x, unsigned_input) if ((x) < 0 || (x) > 16777215) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for UNSIGNED MEDIUMINT"); \
-        goto error; \
-    }
-#define CHECK_INT(x, unsigned_input) if ((x) < ((unsigned_input) ? 0 : -2147483648) || (x) > 2147483647) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for INT"); \
-        goto error; \
-    }
-#define CHECK_UNSIGNED_INT(x, unsigned_input) if ((x) < 0 || (x) > 4294967295) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for UNSIGNED INT"); \
-        goto error; \
-    }
-#define CHECK_BIGINT(x, unsigned_input) if ((x) < ((unsigned_input) ? 0 : -9223372036854775808) || (x) > 9223372036854775807) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for BIGINT"); \
-        goto error; \
-    }
-#define CHECK_UNSIGNED_BIGINT(x, unsigned_input) if ((x) < 0 || (x) > 18446744073709551615) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for UNSIGNED BIGINT"); \
-        goto error; \
-    }
-#define CHECK_YEAR(x) if (!(((x) >= 0 && (x) <= 99) || ((x) >= 1901 && (x) <= 2155))) { \
-        PyErr_SetString(PyExc_ValueError, "value is outside the valid range for YEAR"); \
-        goto error; \
-    }
-
-            switch (returns[i]) {
-            case MYSQL_TYPE_BIT:
-                PyErr_SetString(PyExc_ValueError, "unsupported data type: BIT");
-                goto error;
-                break;
-
-            case MYSQL_TYPE_TINY:
-                CHECKMEM(1);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_TINYINT(i8, 0);
-                    i8 = (int8_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_TINYINT(i8, 0);
-                    i8 = (int8_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_TINYINT(i16, 0);
-                    i8 = (int8_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_TINYINT(i32, 0);
-                    i8 = (int8_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_TINYINT(i64, 0);
-                    i8 = (int8_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_TINYINT(u8, 1);
-                    i8 = (int8_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_TINYINT(u16, 1);
-                    i8 = (int8_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_TINYINT(u32, 1);
-                    i8 = (int8_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_TINYINT(u64, 1);
-                    i8 = (int8_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_TINYINT(flt, 0);
-                    i8 = (int8_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_TINYINT(dbl, 0);
-                    i8 = (int8_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type TINYINT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &i8, 1);
-                out_idx += 1;
-                break;
-
-            // Use negative to indicate unsigned
-            case -MYSQL_TYPE_TINY:
-                CHECKMEM(1);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_TINYINT(i8, 0);
-                    u8 = (uint8_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_TINYINT(i8, 0);
-                    u8 = (uint8_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_TINYINT(i16, 0);
-                    u8 = (uint8_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_TINYINT(i32, 0);
-                    u8 = (uint8_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_TINYINT(i64, 0);
-                    u8 = (uint8_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_TINYINT(u8, 1);
-                    u8 = (uint8_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_TINYINT(u16, 1);
-                    u8 = (uint8_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_TINYINT(u32, 1);
-                    u8 = (uint8_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_TINYINT(u64, 1);
-                    u8 = (uint8_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_TINYINT(flt, 0);
-                    u8 = (uint8_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_TINYINT(dbl, 0);
-                    u8 = (uint8_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type UNSIGNED TINYINT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &u8, 1);
-                out_idx += 1;
-                break;
-
-            case MYSQL_TYPE_SHORT:
-                CHECKMEM(2);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_SMALLINT(i8, 0);
-                    i16 = (int16_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_SMALLINT(i8, 0);
-                    i16 = (int16_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_SMALLINT(i16, 0);
-                    i16 = (int16_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_SMALLINT(i32, 0);
-                    i16 = (int16_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_SMALLINT(i64, 0);
-                    i16 = (int16_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_SMALLINT(u8, 1);
-                    i16 = (int16_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_SMALLINT(u16, 1);
-                    i16 = (int16_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_SMALLINT(u32, 1);
-                    i16 = (int16_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_SMALLINT(u64, 1);
-                    i16 = (int16_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_SMALLINT(flt, 0);
-                    i16 = (int16_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_SMALLINT(dbl, 0);
-                    i16 = (int16_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type SMALLINT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &i16, 2);
-                out_idx += 2;
-                break;
-
-            // Use negative to indicate unsigned
-            case -MYSQL_TYPE_SHORT:
-                CHECKMEM(2);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_SMALLINT(i8, 0);
-                    u16 = (uint16_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_SMALLINT(i8, 0);
-                    u16 = (uint16_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_SMALLINT(i16, 0);
-                    u16 = (uint16_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_SMALLINT(i32, 0);
-                    u16 = (uint16_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_SMALLINT(i64, 0);
-                    u16 = (uint16_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_SMALLINT(u8, 1);
-                    u16 = (uint16_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_SMALLINT(u16, 1);
-                    u16 = (uint16_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_SMALLINT(u32, 1);
-                    u16 = (uint16_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_SMALLINT(u64, 1);
-                    u16 = (uint16_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_SMALLINT(flt, 0);
-                    u16 = (uint16_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_SMALLINT(dbl, 0);
-                    u16 = (uint16_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type UNSIGNED MEDIUMINT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &u16, 2);
-                out_idx += 2;
-                break;
-
-            case MYSQL_TYPE_INT24:
-                CHECKMEM(4);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_MEDIUMINT(i8, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_MEDIUMINT(i8, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_MEDIUMINT(i16, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_MEDIUMINT(i32, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_MEDIUMINT(i64, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_MEDIUMINT(u8, 1);
-                    i32 = (int32_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_MEDIUMINT(u16, 1);
-                    i32 = (int32_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_MEDIUMINT(u32, 1);
-                    i32 = (int32_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_MEDIUMINT(u64, 1);
-                    i32 = (int32_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_MEDIUMINT(flt, 0);
-                    i32 = (int32_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_MEDIUMINT(dbl, 0);
-                    i32 = (int32_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type MEDIUMINT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &i32, 4);
-                out_idx += 4;
-                break;
-
-            case MYSQL_TYPE_LONG:
-                CHECKMEM(4);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_INT(i8, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_INT(i8, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_INT(i16, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_INT(i32, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_INT(i64, 0);
-                    i32 = (int32_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_INT(u8, 1);
-                    i32 = (int32_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_INT(u16, 1);
-                    i32 = (int32_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_INT(u32, 1);
-                    i32 = (int32_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_INT(u64, 1);
-                    i32 = (int32_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_INT(flt, 0);
-                    i32 = (int32_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_INT(dbl, 0);
-                    i32 = (int32_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type INT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &i32, 4);
-                out_idx += 4;
-                break;
-
-            // Use negative to indicate unsigned
-            case -MYSQL_TYPE_INT24:
-                CHECKMEM(4);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_MEDIUMINT(i8, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_MEDIUMINT(i8, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_MEDIUMINT(i16, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_MEDIUMINT(i32, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_MEDIUMINT(i64, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_MEDIUMINT(u8, 1);
-                    u32 = (uint32_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_MEDIUMINT(u16, 1);
-                    u32 = (uint32_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_MEDIUMINT(u32, 1);
-                    u32 = (uint32_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_MEDIUMINT(u64, 1);
-                    u32 = (uint32_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_MEDIUMINT(flt, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_MEDIUMINT(dbl, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type UNSIGNED MEDIUMINT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &u32, 4);
-                out_idx += 4;
-                break;
-
-            // Use negative to indicate unsigned
-            case -MYSQL_TYPE_LONG:
-                CHECKMEM(4);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_INT(i8, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_INT(i8, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_INT(i16, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_INT(i32, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_INT(i64, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_INT(u8, 1);
-                    u32 = (uint32_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_INT(u16, 1);
-                    u32 = (uint32_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_INT(u32, 1);
-                    u32 = (uint32_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_INT(u64, 1);
-                    u32 = (uint32_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_INT(flt, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_INT(dbl, 0);
-                    u32 = (uint32_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type UNSIGNED INT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &u32, 4);
-                out_idx += 4;
-                break;
-
-            case MYSQL_TYPE_LONGLONG:
-                CHECKMEM(8);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_BIGINT(i8, 0);
-                    i64 = (int64_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_BIGINT(i8, 0);
-                    i64 = (int64_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_BIGINT(i16, 0);
-                    i64 = (int64_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_BIGINT(i32, 0);
-                    i64 = (int64_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_BIGINT(i64, 0);
-                    i64 = (int64_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_BIGINT(u8, 1);
-                    i64 = (int64_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_BIGINT(u16, 1);
-                    i64 = (int64_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_BIGINT(u32, 1);
-                    i64 = (int64_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_BIGINT(u64, 1);
-                    i64 = (int64_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_BIGINT(flt, 0);
-                    i64 = (int64_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_BIGINT(dbl, 0);
-                    i64 = (int64_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type BIGINT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &i64, 8);
-                out_idx += 8;
-                break;
-
-            // Use negative to indicate unsigned
-            case -MYSQL_TYPE_LONGLONG:
-                CHECKMEM(8);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_BIGINT(i8, 0);
-                    u64 = (uint64_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_BIGINT(i8, 0);
-                    u64 = (uint64_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_BIGINT(i16, 0);
-                    u64 = (uint64_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_BIGINT(i32, 0);
-                    u64 = (uint64_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_BIGINT(i64, 0);
-                    u64 = (uint64_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_UNSIGNED_BIGINT(u8, 1);
-                    u64 = (uint64_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_UNSIGNED_BIGINT(u16, 1);
-                    u64 = (uint64_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_BIGINT(u32, 1);
-                    u64 = (uint64_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_BIGINT(u64, 1);
-                    u64 = (uint64_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_UNSIGNED_BIGINT(flt, 0);
-                    u64 = (uint64_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_UNSIGNED_BIGINT(dbl, 0);
-                    u64 = (uint64_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type UNSIGNED BIGINT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &u64, 8);
-                out_idx += 8;
-                break;
-
-            case MYSQL_TYPE_FLOAT:
-                CHECKMEM(4);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    flt = (float)((is_null) ? 0 : *(int8_t*)(cols[i] + j * 1));
-                    break;
-                case NUMPY_INT8:
-                    flt = (float)((is_null) ? 0 : *(int8_t*)(cols[i] + j * 1));
-                    break;
-                case NUMPY_INT16:
-                    flt = (float)((is_null) ? 0 : *(int16_t*)(cols[i] + j * 2));
-                    break;
-                case NUMPY_INT32:
-                    flt = (float)((is_null) ? 0 : *(int32_t*)(cols[i] + j * 4));
-                    break;
-                case NUMPY_INT64:
-                    flt = (float)((is_null) ? 0 : *(int64_t*)(cols[i] + j * 8));
-                    break;
-                case NUMPY_UINT8:
-                    flt = (float)((is_null) ? 0 : *(uint8_t*)(cols[i] + j * 1));
-                    break;
-                case NUMPY_UINT16:
-                    flt = (float)((is_null) ? 0 : *(uint16_t*)(cols[i] + j * 2));
-                    break;
-                case NUMPY_UINT32:
-                    flt = (float)((is_null) ? 0 : *(uint32_t*)(cols[i] + j * 4));
-                    break;
-                case NUMPY_UINT64:
-                    flt = (float)((is_null) ? 0 : *(uint64_t*)(cols[i] + j * 8));
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = (float)((is_null) ? 0 : *(float*)(cols[i] + j * 4));
-                    break;
-                case NUMPY_FLOAT64:
-                    flt = (float)((is_null) ? 0 : *(double*)(cols[i] + j * 8));
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type FLOAT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &flt, 4);
-                out_idx += 4;
-                break;
-
-            case MYSQL_TYPE_DOUBLE:
-                CHECKMEM(8);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    dbl = (double)((is_null) ? 0 : *(int8_t*)(cols[i] + j * 1));
-                    break;
-                case NUMPY_INT8:
-                    dbl = (double)((is_null) ? 0 : *(int8_t*)(cols[i] + j * 1));
-                    break;
-                case NUMPY_INT16:
-                    dbl = (double)((is_null) ? 0 : *(int16_t*)(cols[i] + j * 2));
-                    break;
-                case NUMPY_INT32:
-                    dbl = (double)((is_null) ? 0 : *(int32_t*)(cols[i] + j * 4));
-                    break;
-                case NUMPY_INT64:
-                    dbl = (double)((is_null) ? 0 : *(int64_t*)(cols[i] + j * 8));
-                    break;
-                case NUMPY_UINT8:
-                    dbl = (double)((is_null) ? 0 : *(uint8_t*)(cols[i] + j * 1));
-                    break;
-                case NUMPY_UINT16:
-                    dbl = (double)((is_null) ? 0 : *(uint16_t*)(cols[i] + j * 2));
-                    break;
-                case NUMPY_UINT32:
-                    dbl = (double)((is_null) ? 0 : *(uint32_t*)(cols[i] + j * 4));
-                    break;
-                case NUMPY_UINT64:
-                    dbl = (double)((is_null) ? 0 : *(uint64_t*)(cols[i] + j * 8));
-                    break;
-                case NUMPY_FLOAT32:
-                    dbl = (double)((is_null) ? 0 : *(float*)(cols[i] + j * 4));
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = (double)((is_null) ? 0 : *(double*)(cols[i] + j * 8));
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type FLOAT");
-                    goto error;
-                }
-                memcpy(out+out_idx, &dbl, 8);
-                out_idx += 8;
-                break;
-
-            case MYSQL_TYPE_DECIMAL:
-                // TODO
-                PyErr_SetString(PyExc_ValueError, "unsupported data type: DECIMAL");
-                goto error;
-                break;
-
-            case MYSQL_TYPE_DATE:
-            case MYSQL_TYPE_NEWDATE:
-                // TODO
-                PyErr_SetString(PyExc_ValueError, "unsupported data type: DATE");
-                goto error;
-                break;
-
-            case MYSQL_TYPE_TIME:
-                // TODO
-                PyErr_SetString(PyExc_ValueError, "unsupported data type: TIME");
-                goto error;
-                break;
-
-            case MYSQL_TYPE_DATETIME:
-                // TODO
-                PyErr_SetString(PyExc_ValueError, "unsupported data type: DATETIME");
-                goto error;
-                break;
-
-            case MYSQL_TYPE_TIMESTAMP:
-                // TODO
-                PyErr_SetString(PyExc_ValueError, "unsupported data type: TIMESTAMP");
-                goto error;
-                break;
-
-            case MYSQL_TYPE_YEAR:
-                CHECKMEM(2);
-                switch (col_types[i]) {
-                case NUMPY_BOOL:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_YEAR(i8);
-                    i16 = (int16_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT8:
-                    i8 = *(int8_t*)(cols[i] + j * 1);
-                    CHECK_YEAR(i8);
-                    i16 = (int16_t)((is_null) ? 0 : i8);
-                    break;
-                case NUMPY_INT16:
-                    i16 = *(int16_t*)(cols[i] + j * 2);
-                    CHECK_YEAR(i16);
-                    i16 = (int16_t)((is_null) ? 0 : i16);
-                    break;
-                case NUMPY_INT32:
-                    i32 = *(int32_t*)(cols[i] + j * 4);
-                    CHECK_YEAR(i32);
-                    i16 = (int16_t)((is_null) ? 0 : i32);
-                    break;
-                case NUMPY_INT64:
-                    i64 = *(int64_t*)(cols[i] + j * 8);
-                    CHECK_YEAR(i64);
-                    i16 = (int16_t)((is_null) ? 0 : i64);
-                    break;
-                case NUMPY_UINT8:
-                    u8 = *(uint8_t*)(cols[i] + j * 1);
-                    CHECK_YEAR(u8);
-                    i16 = (int16_t)((is_null) ? 0 : u8);
-                    break;
-                case NUMPY_UINT16:
-                    u16 = *(uint16_t*)(cols[i] + j * 2);
-                    CHECK_YEAR(u16);
-                    i16 = (int16_t)((is_null) ? 0 : u16);
-                    break;
-                case NUMPY_UINT32:
-                    u32 = *(uint32_t*)(cols[i] + j * 4);
-                    CHECK_YEAR(u32);
-                    i16 = (int16_t)((is_null) ? 0 : u32);
-                    break;
-                case NUMPY_UINT64:
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
-                    CHECK_YEAR(u64);
-                    i16 = (int16_t)((is_null) ? 0 : u64);
-                    break;
-                case NUMPY_FLOAT32:
-                    flt = *(float*)(cols[i] + j * 4);
-                    CHECK_YEAR(flt);
-                    i16 = (int16_t)((is_null) ? 0 : flt);
-                    break;
-                case NUMPY_FLOAT64:
-                    dbl = *(double*)(cols[i] + j * 8);
-                    CHECK_YEAR(dbl);
-                    i16 = (int16_t)((is_null) ? 0 : dbl);
-                    break;
-                default:
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for output type YEAR");
-                    goto error;
-                }
-                memcpy(out+out_idx, &i16, 2);
-                out_idx += 2;
-                break;
-
-            case MYSQL_TYPE_VARCHAR:
-            case MYSQL_TYPE_JSON:
-            case MYSQL_TYPE_SET:
-            case MYSQL_TYPE_ENUM:
-            case MYSQL_TYPE_VAR_STRING:
-            case MYSQL_TYPE_STRING:
-            case MYSQL_TYPE_GEOMETRY:
-            case MYSQL_TYPE_TINY_BLOB:
-            case MYSQL_TYPE_MEDIUM_BLOB:
-            case MYSQL_TYPE_LONG_BLOB:
-            case MYSQL_TYPE_BLOB:
-                if  (col_types[i] != NUMPY_OBJECT) {
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for character output types");
-                    goto error;
-                }
 
-                if (is_null) {
-                    CHECKMEM(8);
-                    i64 = 0;
-                    memcpy(out+out_idx, &i64, 8);
-                    out_idx += 8;
+    pos = calloc(sizeof(unsigned long long), n_rows);
+    if (!pos) goto error;
+    kernels = calloc(sizeof(rowdat_1_dump_kernel), n_cols);
+    if (!kernels) goto error;
+    objs = calloc(sizeof(PyObject**), n_cols);
+    if (!objs) goto error;
 
-                } else {
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
+    // Check values, pick a kernel per column and compute the size of each row
+    for (i = 0; i < n_cols; i++) {
+        switch (returns[i]) {
+        case MYSQL_TYPE_BIT:
+            PyErr_SetString(PyExc_ValueError, "unsupported data type: BIT");
+            goto error;
 
-                    PyObject *py_str = (PyObject*)u64;
-                    if (!py_str) goto error;
+        case MYSQL_TYPE_TINY:
+            kernel = DUMP_INT8; type_name = "TINYINT"; lo = INT8_MIN; hi = INT8_MAX;
+            goto numeric;
+        // Use negative to indicate unsigned
+        case -MYSQL_TYPE_TINY:
+            kernel = DUMP_UINT8; type_name = "UNSIGNED TINYINT"; lo = 0; hi = UINT8_MAX;
+            goto numeric;
+        case MYSQL_TYPE_SHORT:
+            kernel = DUMP_INT16; type_name = "SMALLINT"; lo = INT16_MIN; hi = INT16_MAX;
+            goto numeric;
+        case -MYSQL_TYPE_SHORT:
+            kernel = DUMP_UINT16; type_name = "UNSIGNED SMALLINT"; lo = 0; hi = UINT16_MAX;
+            goto numeric;
+        case MYSQL_TYPE_INT24:
+            kernel = DUMP_INT32; type_name = "MEDIUMINT"; lo = -8388608; hi = 8388607;
+            goto numeric;
+        case -MYSQL_TYPE_INT24:
+            kernel = DUMP_UINT32; type_name = "UNSIGNED MEDIUMINT"; lo = 0; hi = 16777215;
+            goto numeric;
+        case MYSQL_TYPE_LONG:
+            kernel = DUMP_INT32; type_name = "INT"; lo = INT32_MIN; hi = INT32_MAX;
+            goto numeric;
+        case -MYSQL_TYPE_LONG:
+            kernel = DUMP_UINT32; type_name = "UNSIGNED INT"; lo = 0; hi = UINT32_MAX;
+            goto numeric;
+        case MYSQL_TYPE_LONGLONG:
+            kernel = DUMP_INT64; type_name = "BIGINT"; lo = INT64_MIN; hi = INT64_MAX;
+            goto numeric;
+        case -MYSQL_TYPE_LONGLONG:
+            kernel = DUMP_UINT64; type_name = "UNSIGNED BIGINT"; lo = 0; hi = UINT64_MAX;
+            goto numeric;
+        case MYSQL_TYPE_YEAR:
+            kernel = DUMP_INT16; type_name = "YEAR";
+            goto numeric;
+        case MYSQL_TYPE_FLOAT:
+            kernel = DUMP_FLOAT32; type_name = "FLOAT";
+            goto numeric;
+        case MYSQL_TYPE_DOUBLE:
+            kernel = DUMP_FLOAT64; type_name = "DOUBLE";
+            goto numeric;
+
+        numeric:
+            if (col_types[i] < NUMPY_BOOL || col_types[i] > NUMPY_FLOAT64) {
+                PyErr_Format(PyExc_ValueError, "unsupported numpy data type for output type %s", type_name);
+                goto error;
+            }
+            if (kernel != DUMP_FLOAT32 && kernel != DUMP_FLOAT64 &&
+                    check_numpy_range(col_types[i], cols[i], n_rows, lo, hi,
+                                      returns[i] == MYSQL_TYPE_YEAR) < 0) {
+                PyErr_Format(PyExc_ValueError, "value is outside the valid range for %s", type_name);
+                goto error;
+            }
+            kernels[i] = dump_kernels[kernel][col_types[i]];
+            fixed_row_size += 1 + dump_kernel_sizes[kernel];
+            break;
 
-                    if (py_str == Py_None) {
-                        CHECKMEM(8);
-                        i64 = 0;
-                        memcpy(out+out_idx, &i64, 8);
-                        out_idx += 8;
-                    } else {
-                        PyObject *py_bytes = PyUnicode_AsEncodedString(py_str, "utf-8", "strict");
-                        if (!py_bytes) goto error;
-
-                        char *str = NULL;
-                        Py_ssize_t str_l = 0;
-                        if (PyBytes_AsStringAndSize(py_bytes, &str, &str_l) < 0) {
-                            Py_DECREF(py_bytes);
-                            goto error;
-                        }
-
-                        CHECKMEM(8+str_l);
-                        i64 = str_l;
-                        memcpy(out+out_idx, &i64, 8);
-                        out_idx += 8;
-                        memcpy(out+out_idx, str, str_l);
-                        out_idx += str_l;
-                        Py_DECREF(py_bytes);
+        // Sent as text, NaN and NaT values are sent as NULL
+        case MYSQL_TYPE_DECIMAL:
+        case MYSQL_TYPE_NEWDECIMAL:
+        case MYSQL_TYPE_DATE:
+        case MYSQL_TYPE_NEWDATE:
+        case MYSQL_TYPE_TIME:
+        case MYSQL_TYPE_DATETIME:
+        case MYSQL_TYPE_TIMESTAMP:
+            fixed_row_size += 1 + 8;
+            for (j = 0; j < n_rows; j++) {
+                if (masks[i] && masks[i][j]) continue;
+                text_l = numpy_to_rowdat_1_text(
+                    returns[i], col_types[i], cols[i] + j * numpy_item_sizes[col_types[i]],
+                    time_units[i * 2], time_units[i * 2 + 1], text, sizeof(text)
+                );
+                if (text_l < 0) goto error;
+                pos[j] += text_l;
+            }
+            break;
+
+        case MYSQL_TYPE_VARCHAR:
+        case MYSQL_TYPE_JSON:
+        case MYSQL_TYPE_SET:
+        case MYSQL_TYPE_ENUM:
+        case MYSQL_TYPE_VAR_STRING:
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_GEOMETRY:
+        case MYSQL_TYPE_TINY_BLOB:
+        case MYSQL_TYPE_MEDIUM_BLOB:
+        case MYSQL_TYPE_LONG_BLOB:
+        case MYSQL_TYPE_BLOB:
+        // Use negative to indicate binary
+        case -MYSQL_TYPE_VARCHAR:
+        case -MYSQL_TYPE_JSON:
+        case -MYSQL_TYPE_SET:
+        case -MYSQL_TYPE_ENUM:
+        case -MYSQL_TYPE_VAR_STRING:
+        case -MYSQL_TYPE_STRING:
+        case -MYSQL_TYPE_GEOMETRY:
+        case -MYSQL_TYPE_TINY_BLOB:
+        case -MYSQL_TYPE_MEDIUM_BLOB:
+        case -MYSQL_TYPE_LONG_BLOB:
+        case -MYSQL_TYPE_BLOB:
+            if (col_types[i] != NUMPY_OBJECT) {
+                PyErr_SetString(PyExc_ValueError, (returns[i] < 0) ?
+                                "unsupported numpy data type for binary output types" :
+                                "unsupported numpy data type for character output types");
+                goto error;
+            }
+
+            fixed_row_size += 1 + 8;
+
+            // Strings are encoded once here and copied in the second pass;
+            // None values are sent as empty strings
+            objs[i] = calloc(sizeof(PyObject*), n_rows);
+            if (!objs[i]) goto error;
+            for (j = 0; j < n_rows; j++) {
+                if (masks[i] && masks[i][j]) continue;
+                py_obj = ((PyObject**)cols[i])[j];
+                if (!py_obj || py_obj == Py_None) continue;
+                if (returns[i] < 0) {
+                    if (!PyBytes_Check(py_obj)) {
+                        PyErr_SetString(PyExc_TypeError, "expected bytes object for binary output types");
+                        goto error;
                     }
+                    Py_INCREF(py_obj);
+                    objs[i][j] = py_obj;
+                } else {
+                    objs[i][j] = PyUnicode_AsEncodedString(py_obj, "utf-8", "strict");
+                    if (!objs[i][j]) goto error;
                 }
-                break;
+                pos[j] += PyBytes_Size(objs[i][j]);
+            }
+            break;
 
-            // Use negative to indicate binary
-            case -MYSQL_TYPE_VARCHAR:
-            case -MYSQL_TYPE_JSON:
-            case -MYSQL_TYPE_SET:
-            case -MYSQL_TYPE_ENUM:
-            case -MYSQL_TYPE_VAR_STRING:
-            case -MYSQL_TYPE_STRING:
-            case -MYSQL_TYPE_GEOMETRY:
-            case -MYSQL_TYPE_TINY_BLOB:
-            case -MYSQL_TYPE_MEDIUM_BLOB:
-            case -MYSQL_TYPE_LONG_BLOB:
-            case -MYSQL_TYPE_BLOB:
-                if  (col_types[i] != NUMPY_OBJECT) {
-                    PyErr_SetString(PyExc_ValueError, "unsupported numpy data type for binary output types");
-                    goto error;
-                }
+        default:
+            PyErr_Format(PyExc_ValueError, "unrecognized database data type: %d", returns[i]);
+            goto error;
+        }
+    }
 
-                if (is_null) {
-                    CHECKMEM(8);
-                    i64 = 0;
-                    memcpy(out+out_idx, &i64, 8);
-                    out_idx += 8;
+    // Turn row sizes into row offsets and allocate the output once
+    for (j = 0; j < n_rows; j++) {
+        i64 = fixed_row_size + pos[j];
+        pos[j] = out_l;
+        out_l += i64;
+    }
 
-                } else {
-                    u64 = *(uint64_t*)(cols[i] + j * 8);
+    if (py_into) {
+        // Nothing is written if the output is too small; the caller can
+        // retry with at least the returned number of bytes
+        CHECKRC(allocate_output_buffer(py_into, out_l, &py_target, &output));
+        if ((unsigned long long)output.len < out_l) {
+            py_out = PyLong_FromUnsignedLongLong(out_l);
+            goto exit;
+        }
+        out = output.buf;
+    }
 
-                    PyObject *py_bytes = (PyObject*)u64;
+    if (!out) {
+        py_bytes = PyBytes_FromStringAndSize(NULL, out_l);
+        if (!py_bytes) goto error;
+        out = PyBytes_AsString(py_bytes);
+        if (!out) goto error;
+    }
 
-                    if (py_bytes == Py_None) {
-                        CHECKMEM(8);
-                        i64 = 0;
-                        memcpy(out+out_idx, &i64, 8);
-                        out_idx += 8;
-                    } else {
-                        char *str = NULL;
-                        Py_ssize_t str_l = 0;
-                        if (PyBytes_AsStringAndSize(py_bytes, &str, &str_l) < 0) {
-                            goto error;
-                        }
-
-                        CHECKMEM(8+str_l);
-                        i64 = str_l;
-                        memcpy(out+out_idx, &i64, 8);
-                        out_idx += 8;
-                        memcpy(out+out_idx, str, str_l);
-                        out_idx += str_l;
-                    }
-                }
-                break;
+    for (j = 0; j < n_rows; j++) {
+        memcpy(out + pos[j], &row_ids[j], 8);
+        pos[j] += 8;
+    }
 
-            default:
-                PyErr_Format(PyExc_ValueError, "unrecognized database data type: %d", returns[i]);
-                goto error;
+    for (i = 0; i < n_cols; i++) {
+        if (kernels[i]) {
+            kernels[i](cols[i], masks[i], n_rows, out, pos);
+
+        } else if (objs[i]) {
+            for (j = 0; j < n_rows; j++) {
+                p = out + pos[j];
+                p[0] = (masks[i] && masks[i][j]) ? '\x01' : '\x00';
+                i64 = (objs[i][j]) ? PyBytes_Size(objs[i][j]) : 0;
+                memcpy(p + 1, &i64, 8);
+                if (i64) memcpy(p + 9, PyBytes_AsString(objs[i][j]), i64);
+                pos[j] += 9 + i64;
+            }
+
+        } else {
+            for (j = 0; j < n_rows; j++) {
+                p = out + pos[j];
+                is_null = (masks[i] && masks[i][j]) ? 1 : 0;
+                text_l = (is_null) ? 0 : numpy_to_rowdat_1_text(
+                    returns[i], col_types[i], cols[i] + j * numpy_item_sizes[col_types[i]],
+                    time_units[i * 2], time_units[i * 2 + 1], text, sizeof(text)
+                );
+                if (text_l < 0) goto error;
+                p[0] = (text_l == 0) ? '\x01' : '\x00';
+                i64 = text_l;
+                memcpy(p + 1, &i64, 8);
+                memcpy(p + 9, text, text_l);
+                pos[j] += 9 + text_l;
             }
         }
     }
 
-    py_out = PyMemoryView_FromMemory(out, out_idx, PyBUF_WRITE);
+    if (py_into) {
+        if (!output.buf) CHECKRC(write_output_buffer(py_target, out, out_l));
+        py_out = PyLong_FromUnsignedLongLong(out_l);
+    } else {
+        py_out = PyMemoryView_FromObject(py_bytes);
+    }
     if (!py_out) goto error;
 
 exit:
+    if (objs) {
+        for (i = 0; i < n_cols; i++) {
+            if (!objs[i]) continue;
+            for (j = 0; j < n_rows; j++) {
+                Py_XDECREF(objs[i][j]);
+            }
+            free(objs[i]);
+        }
+        free(objs);
+    }
+    if (kernels) free(kernels);
+    if (pos) free(pos);
     if (returns) free(returns);
     if (masks) free(masks);
     if (cols) free(cols);
     if (col_types) free(col_types);
+    if (time_units) free(time_units);
+
+    release_accel_buffer(&output);
+    Py_XDECREF(py_target);
+    Py_XDECREF(py_bytes);
 
     return py_out;
 
 error:
-    if (!py_out && out) free(out);
     Py_XDECREF(py_out);
     py_out = NULL;
 
@@ -3923,6 +10094,43 @@ error:
 }
 
 
+static PyObject *dump_rowdat_1_numpy(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *py_returns = NULL;
+    PyObject *py_row_ids = NULL;
+    PyObject *py_cols = NULL;
+    char *keywords[] = {"returns", "row_ids", "cols", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO", keywords, &py_returns, &py_row_ids, &py_cols)) {
+        return NULL;
+    }
+
+    return dump_rowdat_1_numpy_to(py_returns, py_row_ids, py_cols, NULL);
+}
+
+
+//
+// Same as dump_rowdat_1_numpy, but write the output into the start of a
+// writable buffer (such as a shared memory mmap). `out` may also be a
+// callable which is given the size of the output once it is known and
+// returns the buffer, so the output is only encoded once. Returns the size
+// of the output in bytes; if that is larger than the buffer, nothing is
+// written.
+//
+static PyObject *dump_rowdat_1_numpy_into(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *py_returns = NULL;
+    PyObject *py_row_ids = NULL;
+    PyObject *py_cols = NULL;
+    PyObject *py_into = NULL;
+    char *keywords[] = {"returns", "row_ids", "cols", "out", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOO", keywords, &py_returns, &py_row_ids, &py_cols, &py_into)) {
+        return NULL;
+    }
+
+    return dump_rowdat_1_numpy_to(py_returns, py_row_ids, py_cols, py_into);
+}
+
+
 static PyObject *load_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs) {
     PyObject *py_data = NULL;
     PyObject *py_out = NULL;
@@ -3933,6 +10141,7 @@ static PyObject *load_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs)
     PyObject *py_str = NULL;
     PyObject *py_blob = NULL;
     Py_ssize_t length = 0;
+    accel_buffer input = {0};
     uint64_t row_id = 0;
     uint8_t is_null = 0;
     int8_t i8 = 0;
@@ -3957,7 +10166,9 @@ static PyObject *load_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs)
         goto error;
     }
 
-    CHECKRC(PyBytes_AsStringAndSize(py_data, &data, &length));
+    CHECKRC(get_input_buffer(py_data, &input));
+    data = input.buf;
+    length = input.len;
     end = data + (unsigned long long)length;
 
     colspec_l = PyObject_Length(py_colspec);
@@ -4126,27 +10337,28 @@ static PyObject *load_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs)
                 }
                 break;
 
+            // Only the numpy codecs decode these so far
             case MYSQL_TYPE_DECIMAL:
             case MYSQL_TYPE_NEWDECIMAL:
-                // TODO
-                break;
+                PyErr_SetString(PyExc_TypeError, "unsupported data type: DECIMAL");
+                goto error;
 
             case MYSQL_TYPE_DATE:
             case MYSQL_TYPE_NEWDATE:
-                // TODO
-                break;
+                PyErr_SetString(PyExc_TypeError, "unsupported data type: DATE");
+                goto error;
 
             case MYSQL_TYPE_TIME:
-                // TODO
-                break;
+                PyErr_SetString(PyExc_TypeError, "unsupported data type: TIME");
+                goto error;
 
             case MYSQL_TYPE_DATETIME:
-                // TODO
-                break;
+                PyErr_SetString(PyExc_TypeError, "unsupported data type: DATETIME");
+                goto error;
 
             case MYSQL_TYPE_TIMESTAMP:
-                // TODO
-                break;
+                PyErr_SetString(PyExc_TypeError, "unsupported data type: TIMESTAMP");
+                goto error;
 
             case MYSQL_TYPE_YEAR:
                 u16 = *(uint16_t*)data; data += 2;
@@ -4217,6 +10429,7 @@ static PyObject *load_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs)
 
 exit:
     if (ctypes) free(ctypes);
+    release_accel_buffer(&input);
 
     Py_XDECREF(py_row);
 
@@ -4230,14 +10443,14 @@ error:
 }
 
 
-static PyObject *dump_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs) {
-    PyObject *py_returns = NULL;
-    PyObject *py_rows = NULL;
+static PyObject *dump_rowdat_1_to(
+    PyObject *py_returns, PyObject *py_row_ids, PyObject *py_rows, PyObject *py_into
+) {
     PyObject *py_out = NULL;
+    PyObject *py_target = NULL;
     PyObject *py_rows_iter = NULL;
     PyObject *py_row = NULL;
     PyObject *py_row_iter = NULL;
-    PyObject *py_row_ids = NULL;
     PyObject *py_row_ids_iter = NULL;
     PyObject *py_item = NULL;
     uint64_t row_id = 0;
@@ -4256,19 +10469,14 @@ static PyObject *dump_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs)
     unsigned long long out_l = 0;
     unsigned long long out_idx = 0;
     int *returns = NULL;
-    char *keywords[] = {"returns", "row_ids", "data", NULL};
+    accel_buffer output = {0};
     unsigned long long i = 0;
     unsigned long long n_cols = 0;
     unsigned long long n_rows = 0;
 
-    // Parse function args.
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO", keywords, &py_returns, &py_row_ids, &py_rows)) {
-        goto error;
-    }
-
     n_rows = (unsigned long long)PyObject_Length(py_rows);
     if (n_rows == 0) {
-        py_out = PyBytes_FromStringAndSize("", 0);
+        py_out = (py_into) ? PyLong_FromLong(0) : PyBytes_FromStringAndSize("", 0);
         goto exit;
     }
 
@@ -4410,26 +10618,28 @@ static PyObject *dump_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs)
                 out_idx += 8;
                 break;
 
+            // Only the numpy codecs encode these so far
             case MYSQL_TYPE_DECIMAL:
-                // TODO
-                break;
+            case MYSQL_TYPE_NEWDECIMAL:
+                PyErr_SetString(PyExc_ValueError, "unsupported data type: DECIMAL");
+                goto error;
 
             case MYSQL_TYPE_DATE:
             case MYSQL_TYPE_NEWDATE:
-                // TODO
-                break;
+                PyErr_SetString(PyExc_ValueError, "unsupported data type: DATE");
+                goto error;
 
             case MYSQL_TYPE_TIME:
-                // TODO
-                break;
+                PyErr_SetString(PyExc_ValueError, "unsupported data type: TIME");
+                goto error;
 
             case MYSQL_TYPE_DATETIME:
-                // TODO
-                break;
+                PyErr_SetString(PyExc_ValueError, "unsupported data type: DATETIME");
+                goto error;
 
             case MYSQL_TYPE_TIMESTAMP:
-                // TODO
-                break;
+                PyErr_SetString(PyExc_ValueError, "unsupported data type: TIMESTAMP");
+                goto error;
 
             case MYSQL_TYPE_YEAR:
                 CHECKMEM(2);
@@ -4522,11 +10732,30 @@ static PyObject *dump_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs)
         py_row = NULL;
     }
 
-    py_out = PyMemoryView_FromMemory(out, out_idx, PyBUF_WRITE);
-    if (!py_out) goto error;
+    if (py_into) {
+        // Rows are encoded first since their size is not known up front;
+        // nothing is written if the output is too small
+        CHECKRC(allocate_output_buffer(py_into, out_idx, &py_target, &output));
+        if ((unsigned long long)output.len >= out_idx) {
+            if (output.buf) {
+                memcpy(output.buf, out, out_idx);
+            } else {
+                CHECKRC(write_output_buffer(py_target, out, out_idx));
+            }
+        }
+        py_out = PyLong_FromUnsignedLongLong(out_idx);
+        if (!py_out) goto error;
+        free(out);
+        out = NULL;
+    } else {
+        py_out = PyMemoryView_FromMemory(out, out_idx, PyBUF_WRITE);
+        if (!py_out) goto error;
+    }
 
 exit:
     if (returns) free(returns);
+    release_accel_buffer(&output);
+    Py_XDECREF(py_target);
 
     Py_XDECREF(py_item);
     Py_XDECREF(py_row_iter);
@@ -4545,24 +10774,90 @@ error:
 }
 
 
+static PyObject *dump_rowdat_1(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *py_returns = NULL;
+    PyObject *py_row_ids = NULL;
+    PyObject *py_rows = NULL;
+    char *keywords[] = {"returns", "row_ids", "data", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOO", keywords, &py_returns, &py_row_ids, &py_rows)) {
+        return NULL;
+    }
+
+    return dump_rowdat_1_to(py_returns, py_row_ids, py_rows, NULL);
+}
+
+
+//
+// Same as dump_rowdat_1, but write the output into the start of a writable
+// buffer, or into the buffer returned by calling `out` with the size of the
+// output. Returns the size of the output in bytes; if that is larger than
+// the buffer, nothing is written.
+//
+static PyObject *dump_rowdat_1_into(PyObject *self, PyObject *args, PyObject *kwargs) {
+    PyObject *py_returns = NULL;
+    PyObject *py_row_ids = NULL;
+    PyObject *py_rows = NULL;
+    PyObject *py_into = NULL;
+    char *keywords[] = {"returns", "row_ids", "data", "out", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OOOO", keywords, &py_returns, &py_row_ids, &py_rows, &py_into)) {
+        return NULL;
+    }
+
+    return dump_rowdat_1_to(py_returns, py_row_ids, py_rows, py_into);
+}
+
+
+//
+// Expose the text cell parsers so their edge cases can be tested directly.
+//
+static PyObject *accel_parse_double(PyObject *self, PyObject *py_bytes) {
+    char *s = NULL;
+    Py_ssize_t s_l = 0;
+    if (PyBytes_AsStringAndSize(py_bytes, &s, &s_l) < 0) return NULL;
+    return PyFloat_FromDouble(parse_double(s, (unsigned long long)s_l));
+}
+
+static PyObject *accel_parse_int64(PyObject *self, PyObject *py_bytes) {
+    char *s = NULL;
+    Py_ssize_t s_l = 0;
+    if (PyBytes_AsStringAndSize(py_bytes, &s, &s_l) < 0) return NULL;
+    return PyLong_FromLongLong(parse_int64(s, (unsigned long long)s_l));
+}
+
+static PyObject *accel_parse_uint64(PyObject *self, PyObject *py_bytes) {
+    char *s = NULL;
+    Py_ssize_t s_l = 0;
+    if (PyBytes_AsStringAndSize(py_bytes, &s, &s_l) < 0) return NULL;
+    return PyLong_FromUnsignedLongLong(parse_uint64(s, (unsigned long long)s_l));
+}
+
 static PyMethodDef PyMySQLAccelMethods[] = {
     {"read_rowdata_packet", (PyCFunction)read_rowdata_packet, METH_VARARGS | METH_KEYWORDS, "PyMySQL row data packet reader"},
+    {"iter_rowdata_packets", (PyCFunction)iter_rowdata_packets, METH_VARARGS | METH_KEYWORDS, "Iterator over the rows of an unbuffered result"},
     {"dump_rowdat_1", (PyCFunction)dump_rowdat_1, METH_VARARGS | METH_KEYWORDS, "ROWDAT_1 formatter for external functions"},
+    {"dump_rowdat_1_into", (PyCFunction)dump_rowdat_1_into, METH_VARARGS | METH_KEYWORDS, "ROWDAT_1 formatter for external functions which writes into a buffer"},
     {"load_rowdat_1", (PyCFunction)load_rowdat_1, METH_VARARGS | METH_KEYWORDS, "ROWDAT_1 parser for external functions"},
     {"dump_rowdat_1_numpy", (PyCFunction)dump_rowdat_1_numpy, METH_VARARGS | METH_KEYWORDS, "ROWDAT_1 formatter for external functions which takes numpy.arrays"},
+    {"dump_rowdat_1_numpy_into", (PyCFunction)dump_rowdat_1_numpy_into, METH_VARARGS | METH_KEYWORDS, "ROWDAT_1 formatter for external functions which takes numpy.arrays and writes into a buffer"},
     {"load_rowdat_1_numpy", (PyCFunction)load_rowdat_1_numpy, METH_VARARGS | METH_KEYWORDS, "ROWDAT_1 parser for external functions which creates numpy.arrays"},
+    {"_make_row", (PyCFunction)make_row, METH_VARARGS, "Rebuild a pickled row"},
+    {"_parse_double", (PyCFunction)accel_parse_double, METH_O, "Parse a DOUBLE text cell (for testing)"},
+    {"_parse_int64", (PyCFunction)accel_parse_int64, METH_O, "Parse a BIGINT text cell (for testing)"},
+    {"_parse_uint64", (PyCFunction)accel_parse_uint64, METH_O, "Parse a BIGINT UNSIGNED text cell (for testing)"},
     {NULL, NULL, 0, NULL}
 };
 
 static struct PyModuleDef _singlestoredb_accelmodule = {
     PyModuleDef_HEAD_INIT,
-    "_singlestoredb_accel",
+    ACCEL_STR(ACCEL_MODULE_NAME),
     "PyMySQL row data packet reader accelerator",
     -1,
     PyMySQLAccelMethods
 };
 
-PyMODINIT_FUNC PyInit__singlestoredb_accel(void) {
+PyMODINIT_FUNC ACCEL_CONCAT(PyInit_, ACCEL_MODULE_NAME)(void) {
 #ifndef Py_LIMITED_API
     PyDateTime_IMPORT;
 #endif
@@ -4572,9 +10867,24 @@ PyMODINIT_FUNC PyInit__singlestoredb_accel(void) {
         return NULL;
     }
 
-    // Populate ints
-    for (int i = 0; i < 62; i++) {
-        PyInts[i] = PyLong_FromLong(i);
+    ArrowColumnType = (PyTypeObject*)PyType_FromSpec(&ArrowColumnType_spec);
+    if (ArrowColumnType == NULL || PyType_Ready(ArrowColumnType) < 0) {
+        return NULL;
+    }
+
+    BSONDocumentType = (PyTypeObject*)PyType_FromSpec(&BSONDocumentType_spec);
+    if (BSONDocumentType == NULL || PyType_Ready(BSONDocumentType) < 0) {
+        return NULL;
+    }
+
+    LazyRowType = (PyTypeObject*)PyType_FromSpec(&LazyRowType_spec);
+    if (LazyRowType == NULL || PyType_Ready(LazyRowType) < 0) {
+        return NULL;
+    }
+
+    RowIteratorType = (PyTypeObject*)PyType_FromSpec(&RowIteratorType_spec);
+    if (RowIteratorType == NULL || PyType_Ready(RowIteratorType) < 0) {
+        return NULL;
     }
 
     PyStr.unbuffered_active = PyUnicode_FromString("unbuffered_active");
@@ -4595,6 +10905,7 @@ PyMODINIT_FUNC PyInit__singlestoredb_accel(void) {
     PyStr.fields = PyUnicode_FromString("fields");
     PyStr.flags = PyUnicode_FromString("flags");
     PyStr.scale = PyUnicode_FromString("scale");
+    PyStr.length = PyUnicode_FromString("length");
     PyStr.type_code = PyUnicode_FromString("type_code");
     PyStr.name = PyUnicode_FromString("name");
     PyStr.table_name = PyUnicode_FromString("table_name");
@@ -4602,16 +10913,23 @@ PyMODINIT_FUNC PyInit__singlestoredb_accel(void) {
     PyStr.settimeout = PyUnicode_FromString("settimeout");
     PyStr._read_timeout = PyUnicode_FromString("_read_timeout");
     PyStr._rfile = PyUnicode_FromString("_rfile");
+    PyStr._rbuf = PyUnicode_FromString("_rbuf");
+    PyStr._rbuf_pos = PyUnicode_FromString("_rbuf_pos");
     PyStr.read = PyUnicode_FromString("read");
+    PyStr.readinto1 = PyUnicode_FromString("readinto1");
+    PyStr.recv_into = PyUnicode_FromString("recv_into");
     PyStr.x_errno = PyUnicode_FromString("errno");
     PyStr._result = PyUnicode_FromString("_result");
     PyStr._next_seq_id = PyUnicode_FromString("_next_seq_id");
+    PyStr._rownumber = PyUnicode_FromString("_rownumber");
     PyStr.rows = PyUnicode_FromString("rows");
-    PyStr.namedtuple = PyUnicode_FromString("namedtuple");
-    PyStr.Row = PyUnicode_FromString("Row");
+    PyStr._fields = PyUnicode_FromString("_fields");
+    PyStr._index = PyUnicode_FromString("_index");
+    PyStr._labels = PyUnicode_FromString("_labels");
+    PyStr.isidentifier = PyUnicode_FromString("isidentifier");
     PyStr.Series = PyUnicode_FromString("Series");
     PyStr.array = PyUnicode_FromString("array");
-    PyStr.vectorize = PyUnicode_FromString("vectorize");
+    PyStr.empty = PyUnicode_FromString("empty");
     PyStr.DataFrame = PyUnicode_FromString("DataFrame");
     PyStr.Table = PyUnicode_FromString("Table");
     PyStr.from_pylist = PyUnicode_FromString("from_pylist");
@@ -4624,6 +10942,25 @@ PyMODINIT_FUNC PyInit__singlestoredb_accel(void) {
     PyStr.unpack = PyUnicode_FromString("unpack");
     PyStr.decode = PyUnicode_FromString("decode");
     PyStr.frombuffer = PyUnicode_FromString("frombuffer");
+    PyStr.ColumnarRows = PyUnicode_FromString("ColumnarRows");
+    PyStr._shape = PyUnicode_FromString("_shape");
+    PyStr.accel = PyUnicode_FromString("accel");
+
+    // Base of the per-layout Row types; Row itself has no columns
+    PyObject *py_row_bases = PyTuple_Pack(1, (PyObject*)&PyTuple_Type);
+    if (!py_row_bases) goto error;
+    RowType = (PyTypeObject*)PyType_FromSpecWithBases(&RowType_spec, py_row_bases);
+    Py_DECREF(py_row_bases);
+    if (!RowType) goto error;
+    PyObject *py_no_fields = PyTuple_New(0);
+    PyObject *py_no_index = PyDict_New();
+    int rc = (!py_no_fields || !py_no_index) ? -1
+           : (PyObject_SetAttr((PyObject*)RowType, PyStr._labels, py_no_fields) ||
+              PyObject_SetAttr((PyObject*)RowType, PyStr._fields, py_no_fields) ||
+              PyObject_SetAttr((PyObject*)RowType, PyStr._index, py_no_index));
+    Py_XDECREF(py_no_fields);
+    Py_XDECREF(py_no_index);
+    if (rc) goto error;
 
     PyObject *decimal_mod = PyImport_ImportModule("decimal");
     if (!decimal_mod) goto error;
@@ -4631,10 +10968,10 @@ PyMODINIT_FUNC PyInit__singlestoredb_accel(void) {
     if (!datetime_mod) goto error;
     PyObject *json_mod = PyImport_ImportModule("json");
     if (!json_mod) goto error;
-    PyObject *collections_mod = PyImport_ImportModule("collections");
-    if (!collections_mod) goto error;
     PyObject *struct_mod = PyImport_ImportModule("struct");
     if (!struct_mod) goto error;
+    PyObject *keyword_mod = PyImport_ImportModule("keyword");
+    if (!keyword_mod) goto error;
 
     PyFunc.decimal_Decimal = PyObject_GetAttr(decimal_mod, PyStr.Decimal);
     if (!PyFunc.decimal_Decimal) goto error;
@@ -4648,26 +10985,14 @@ PyMODINIT_FUNC PyInit__singlestoredb_accel(void) {
     if (!PyFunc.datetime_datetime) goto error;
     PyFunc.json_loads = PyObject_GetAttr(json_mod, PyStr.loads);
     if (!PyFunc.json_loads) goto error;
-    PyFunc.collections_namedtuple = PyObject_GetAttr(collections_mod, PyStr.namedtuple);
-    if (!PyFunc.collections_namedtuple) goto error;
     PyFunc.struct_unpack = PyObject_GetAttr(struct_mod, PyStr.unpack);
     if (!PyFunc.struct_unpack) goto error;
-
-    PyObj.namedtuple_kwargs = PyDict_New();
-    if (!PyObj.namedtuple_kwargs) goto error;
-    if (PyDict_SetItemString(PyObj.namedtuple_kwargs, "rename", Py_True)) {
-        goto error;
-    }
+    PyFunc.keyword_iskeyword = PyObject_GetAttrString(keyword_mod, "iskeyword");
+    if (!PyFunc.keyword_iskeyword) goto error;
 
     PyObj.create_numpy_array_args = PyTuple_New(1);
     if (!PyObj.create_numpy_array_args) goto error;
 
-    PyObj.create_numpy_array_kwargs = PyDict_New();
-    if (!PyObj.create_numpy_array_kwargs) goto error;
-    if (PyDict_SetItemString(PyObj.create_numpy_array_kwargs, "copy", Py_False)) {
-        goto error;
-    }
-
     PyObj.create_numpy_array_kwargs_vector[1] = PyDict_New();
     if (!PyObj.create_numpy_array_kwargs_vector[1]) goto error;
     if (PyDict_SetItemString(PyObj.create_numpy_array_kwargs_vector[1], "dtype", PyStr.float32)) {
@@ -4705,7 +11030,43 @@ PyMODINIT_FUNC PyInit__singlestoredb_accel(void) {
     PyObj.bson_decode_args = PyTuple_New(1);
     if (!PyObj.bson_decode_args) goto error;
 
-    return PyModule_Create(&_singlestoredb_accelmodule);
+    PyObj.empty_bytes = PyBytes_FromStringAndSize("", 0);
+    if (!PyObj.empty_bytes) goto error;
+    PyObj.zero = PyLong_FromLong(0);
+    if (!PyObj.zero) goto error;
+
+    PyObj.row_types = PyDict_New();
+    if (!PyObj.row_types) goto error;
+
+    PyObject *py_module = PyModule_Create(&_singlestoredb_accelmodule);
+    if (!py_module) goto error;
+
+    PyFunc.make_row = PyObject_GetAttrString(py_module, "_make_row");
+    if (!PyFunc.make_row) goto error;
+
+    // Exposed so the package can register them as a Mapping and a Sequence
+    Py_INCREF(BSONDocumentType);
+    if (PyModule_AddObject(py_module, "BSONDocument", (PyObject*)BSONDocumentType) < 0) {
+        Py_DECREF(BSONDocumentType);
+        Py_DECREF(py_module);
+        goto error;
+    }
+
+    Py_INCREF(LazyRowType);
+    if (PyModule_AddObject(py_module, "LazyRow", (PyObject*)LazyRowType) < 0) {
+        Py_DECREF(LazyRowType);
+        Py_DECREF(py_module);
+        goto error;
+    }
+
+    Py_INCREF(RowType);
+    if (PyModule_AddObject(py_module, "Row", (PyObject*)RowType) < 0) {
+        Py_DECREF(RowType);
+        Py_DECREF(py_module);
+        goto error;
+    }
+
+    return py_module;
 
 error:
     return NULL;
@@ -14,6 +14,13 @@ py_limited_api = '0x03080000'
 
 build_extension = bool(int(os.environ.get('SINGLESTOREDB_BUILD_EXTENSION', '1')))
 
+# Also build the accelerator against the full C API (faster date / time
+# construction). The module is specific to the Python version it is built
+# for, so wheels containing it are not abi3.
+build_full_api_extension = bool(
+    int(os.environ.get('SINGLESTOREDB_BUILD_FULL_API_EXTENSION', '0')),
+)
+
 universal2_flags = ['-arch', 'x86_64', '-arch', 'arm64'] \
     if (
         platform.platform().startswith('mac') and
@@ -37,20 +44,32 @@ class bdist_wheel_abi3(bdist_wheel):
 
 
 if build_extension:
-    setup(
-        ext_modules=[
+    ext_modules = [
+        Extension(
+            '_singlestoredb_accel',
+            sources=['accel.c'],
+            define_macros=[
+                ('Py_LIMITED_API', py_limited_api),
+            ] if py_limited_api else [],
+            py_limited_api=bool(py_limited_api),
+            extra_compile_args=universal2_flags,
+            extra_link_args=universal2_flags,
+        ),
+    ]
+    if build_full_api_extension:
+        ext_modules.append(
             Extension(
-                '_singlestoredb_accel',
+                '_singlestoredb_accel_full',
                 sources=['accel.c'],
-                define_macros=[
-                    ('Py_LIMITED_API', py_limited_api),
-                ] if py_limited_api else [],
-                py_limited_api=bool(py_limited_api),
+                define_macros=[('ACCEL_MODULE_NAME', '_singlestoredb_accel_full')],
                 extra_compile_args=universal2_flags,
                 extra_link_args=universal2_flags,
             ),
-        ],
-        cmdclass={'bdist_wheel': bdist_wheel_abi3 if py_limited_api else bdist_wheel},
+        )
+    abi3 = py_limited_api and not build_full_api_extension
+    setup(
+        ext_modules=ext_modules,
+        cmdclass={'bdist_wheel': bdist_wheel_abi3 if abi3 else bdist_wheel},
     )
 else:
     setup()
@@ -221,6 +221,39 @@ register_option(
     environ='SINGLESTOREDB_ENABLE_EXTENDED_DATA_TYPES',
 )
 
+register_option(
+    'decimal_type', 'string',
+    functools.partial(
+        check_str,
+        valid_values=['decimal', 'float', 'scaled_int'],
+    ),
+    'decimal',
+    'What type should DECIMAL values in row-based results take? '
+    'Either decimal.Decimal, float, or an int scaled by 10**scale.',
+    environ='SINGLESTOREDB_DECIMAL_TYPE',
+)
+
+register_option(
+    'contiguous_vectors', 'bool', check_bool, True,
+    'Should VECTOR columns in numpy, pandas, and Arrow results be returned '
+    'as one contiguous (n_rows, dimension) block rather than per-row objects?',
+    environ='SINGLESTOREDB_CONTIGUOUS_VECTORS',
+)
+
+register_option(
+    'lazy_bson', 'bool', check_bool, False,
+    'Should BSON values be returned as read-only mappings that decode '
+    'their fields on access rather than as dicts?',
+    environ='SINGLESTOREDB_LAZY_BSON',
+)
+
+register_option(
+    'prefetch_bytes', 'int', check_int, 0,
+    'Number of bytes of an unbuffered result to read ahead on a background '
+    'thread while rows are decoded. Zero disables read-ahead.',
+    environ='SINGLESTOREDB_PREFETCH_BYTES',
+)
+
 register_option(
     'fusion.enabled', 'bool', check_bool, False,
     'Should Fusion SQL queries be enabled?',
@@ -237,6 +270,7 @@ register_option(
         valid_values=[
             'tuple', 'tuples', 'namedtuple', 'namedtuples',
             'dict', 'dicts', 'structsequence', 'structsequences',
+            'lazyrow', 'lazyrows',
             'numpy', 'pandas', 'polars', 'arrow', 'pyarrow',
         ],
     ),
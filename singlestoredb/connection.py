@@ -1304,6 +1304,10 @@ def connect(
     encoding_errors: Optional[str] = None,
     track_env: Optional[bool] = None,
     enable_extended_data_types: Optional[bool] = None,
+    decimal_type: Optional[str] = None,
+    contiguous_vectors: Optional[bool] = None,
+    lazy_bson: Optional[bool] = None,
+    prefetch_bytes: Optional[int] = None,
 ) -> Connection:
     """
     Return a SingleStoreDB connection.
@@ -1358,7 +1362,11 @@ def connect(
         Enable autocommits
     results_type : str, optional
         The form of the query results: tuples, namedtuples, dicts,
-        numpy, polars, pandas, arrow
+        numpy, polars, pandas, arrow, lazyrows. Lazy rows are read-only
+        sequences that decode each value on first access by index, column
+        name, or attribute, which is cheaper when only a few columns of a
+        wide result are used. They require the C extension; otherwise
+        tuples are returned.
     buffered : bool, optional
         Should the entire query result be buffered in memory? This is the default
         behavior which allows full cursor control of the result, but does consume
@@ -1387,6 +1395,19 @@ def connect(
         Should the connection track the SINGLESTOREDB_URL environment variable?
     enable_extended_data_types : bool, optional
         Should extended data types (BSON, vector) be enabled?
+    decimal_type : str, optional
+        Type of DECIMAL values in row-based results: 'decimal' for
+        decimal.Decimal, 'float', or 'scaled_int' for an int equal to the
+        value times 10**scale
+    contiguous_vectors : bool, optional
+        Should VECTOR columns in numpy, pandas, and Arrow results be
+        returned as one contiguous (n_rows, dimension) block?
+    lazy_bson : bool, optional
+        Should BSON values be returned as read-only mappings that decode
+        their fields on access rather than as dicts?
+    prefetch_bytes : int, optional
+        Number of bytes of an unbuffered result to read ahead on a
+        background thread while rows are decoded. Zero disables read-ahead.
 
     Examples
     --------
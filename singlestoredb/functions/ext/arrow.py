@@ -128,7 +128,7 @@ def load_pandas(
                 data.to_pandas().reindex(index),
                 mask.to_pandas().reindex(index),
             )
-            for (data, mask), (name, dtype) in zip(cols, colspec)
+            for (data, mask), (name, *_, dtype) in zip(cols, colspec)
         ]
 
 
@@ -166,7 +166,7 @@ def load_polars(
                 pl.from_arrow(data),  # type: ignore
                 pl.from_arrow(mask),  # type: ignore
             )
-            for (data, mask), (name, dtype) in zip(cols, colspec)
+            for (data, mask), (name, *_, dtype) in zip(cols, colspec)
         ],
     )
 
@@ -204,7 +204,7 @@ def load_numpy(
                 data.to_numpy(),
                 mask.to_numpy(),
             )
-            for (data, mask), (name, dtype) in zip(cols, colspec)
+            for (data, mask), (name, *_, dtype) in zip(cols, colspec)
         ]
 
 
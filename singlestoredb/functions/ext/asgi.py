@@ -25,7 +25,6 @@ Example
 import argparse
 import asyncio
 import importlib.util
-import io
 import itertools
 import json
 import logging
@@ -99,6 +98,26 @@ rowdat_1_type_map = {
     'float64': ft.DOUBLE,
     'str': ft.STRING,
     'bytes': -ft.STRING,
+    'date': ft.DATE,
+    'time': ft.TIME,
+    'time6': ft.TIME,
+    'datetime': ft.DATETIME,
+    'datetime6': ft.DATETIME,
+}
+
+# Types above that only the C extension's vector format codecs can decode
+rowdat_1_accel_vector_types = set(['date', 'time', 'time6', 'datetime', 'datetime6'])
+
+# Declared types of the numbers above that are sent wider than they are
+rowdat_1_narrow_type_map = {
+    'bool': ft.TINY,
+    'int8': ft.TINY,
+    'int16': ft.SHORT,
+    'int32': ft.LONG,
+    'uint8': -ft.TINY,
+    'uint16': -ft.SHORT,
+    'uint32': -ft.LONG,
+    'float32': ft.FLOAT,
 }
 
 
@@ -196,19 +215,31 @@ def make_func(
     # Set data format
     info['data_format'] = data_format
 
+    def check_dtype(dtype: str) -> None:
+        if dtype not in rowdat_1_type_map:
+            raise TypeError(f'no data type mapping for {dtype}')
+        if dtype in rowdat_1_accel_vector_types and \
+                (data_format == 'python' or not rowdat_1.has_accel):
+            raise TypeError(
+                f'{dtype} values require a vector data format '
+                '(numpy, pandas, polars or arrow) and the C extension',
+            )
+
     # Setup argument types for rowdat_1 parser
     colspec = []
     for x in sig['args']:
         dtype = x['dtype'].replace('?', '')
-        if dtype not in rowdat_1_type_map:
-            raise TypeError(f'no data type mapping for {dtype}')
-        colspec.append((x['name'], rowdat_1_type_map[dtype]))
+        check_dtype(dtype)
+        # Wire type followed by the declared type, which may be narrower
+        colspec.append((
+            x['name'], rowdat_1_type_map[dtype],
+            rowdat_1_narrow_type_map.get(dtype, rowdat_1_type_map[dtype]),
+        ))
     info['colspec'] = colspec
 
     # Setup return type
     dtype = sig['returns']['dtype'].replace('?', '')
-    if dtype not in rowdat_1_type_map:
-        raise TypeError(f'no data type mapping for {dtype}')
+    check_dtype(dtype)
     info['returns'] = [rowdat_1_type_map[dtype]]
 
     return do_func, info
@@ -297,26 +328,31 @@ class Application(object):
         (b'application/octet-stream', b'1.0', 'python'): dict(
             load=rowdat_1.load,
             dump=rowdat_1.dump,
+            dump_into=rowdat_1.dump_into,
             response=rowdat_1_response_dict,
         ),
         (b'application/octet-stream', b'1.0', 'pandas'): dict(
             load=rowdat_1.load_pandas,
             dump=rowdat_1.dump_pandas,
+            dump_into=rowdat_1.dump_pandas_into,
             response=rowdat_1_response_dict,
         ),
         (b'application/octet-stream', b'1.0', 'numpy'): dict(
             load=rowdat_1.load_numpy,
             dump=rowdat_1.dump_numpy,
+            dump_into=rowdat_1.dump_numpy_into,
             response=rowdat_1_response_dict,
         ),
         (b'application/octet-stream', b'1.0', 'polars'): dict(
             load=rowdat_1.load_polars,
             dump=rowdat_1.dump_polars,
+            dump_into=rowdat_1.dump_polars_into,
             response=rowdat_1_response_dict,
         ),
         (b'application/octet-stream', b'1.0', 'arrow'): dict(
             load=rowdat_1.load_arrow,
             dump=rowdat_1.dump_arrow,
+            dump_into=rowdat_1.dump_arrow_into,
             response=rowdat_1_response_dict,
         ),
         (b'application/json', b'1.0', 'python'): dict(
@@ -551,10 +587,27 @@ class Application(object):
 
             out = await func(
                 *input_handler['load'](  # type: ignore
-                    func_info['colspec'], b''.join(data),
+                    func_info['colspec'], data[0] if len(data) == 1 else b''.join(data),
                 ),
             )
-            body = output_handler['dump'](func_info['returns'], *out)  # type: ignore
+
+            # Encode directly into a server-provided buffer when possible;
+            # the encoder allocates it once the size of the output is known
+            allocate = scope.get('extensions', {}).get('singlestoredb.allocate')
+            dump_into = output_handler.get('dump_into')
+            if allocate is not None and dump_into is not None:
+                bufs: List[Any] = []
+
+                def allocate_body(size: int) -> Any:
+                    bufs.append(allocate(size))
+                    return bufs[-1]
+
+                size = dump_into(
+                    func_info['returns'], *out, allocate_body,  # type: ignore
+                )
+                body = memoryview(bufs[-1])[:size] if bufs else b''
+            else:
+                body = output_handler['dump'](func_info['returns'], *out)  # type: ignore
 
             await send(output_handler['response'])
 
@@ -726,11 +779,11 @@ class Application(object):
     async def call(
         self,
         name: str,
-        data_in: io.BytesIO,
-        data_out: io.BytesIO,
+        data_in: Any,
+        data_out: Any,
         data_format: Optional[str] = None,
         data_version: Optional[str] = None,
-    ) -> None:
+    ) -> int:
         """
         Call a function in the application.
 
@@ -738,27 +791,53 @@ class Application(object):
         ----------
         name : str
             Name of the function to call
-        data_in : io.BytesIO
-            The input data rows
-        data_out : io.BytesIO
-            The output data rows
+        data_in : io.BytesIO or bytes-like
+            The input data rows; bytes-like objects such as an mmap are
+            passed to the loader without copying
+        data_out : io.BytesIO or Callable
+            The output data rows, or a function that takes a size and
+            returns a writable buffer of at least that size; rowdat_1
+            results are encoded directly into the returned buffer
         data_format : str, optional
             The format of the input and output data
         data_version : str, optional
             The version of the data format
 
+        Returns
+        -------
+        int
+            Number of bytes in the response
+
         """
         data_format = data_format or self.data_format
         data_version = data_version or self.data_version
+        response_size = 0
+        allocated: List[Any] = []
+
+        def allocate(size: int) -> Any:
+            allocated[:] = [data_out(size)]
+            return allocated[0]
 
         async def receive() -> Dict[str, Any]:
-            return dict(body=data_in.read())
+            if hasattr(data_in, 'read'):
+                return dict(body=data_in.read())
+            return dict(body=data_in)
 
         async def send(content: Dict[str, Any]) -> None:
+            nonlocal response_size
             status = content.get('status', 200)
             if status != 200:
                 raise KeyError(f'error occurred when calling `{name}`: {status}')
-            data_out.write(content.get('body', b''))
+            body = content.get('body', b'')
+            response_size += len(body)
+            if not callable(data_out):
+                data_out.write(body)
+            elif not (
+                isinstance(body, memoryview) and
+                allocated and body.obj is allocated[0]
+            ):
+                # Formats without an in-place encoder are copied in
+                allocate(len(body))[:len(body)] = body
 
         accepts = dict(
             json=b'application/json',
@@ -777,10 +856,15 @@ class Application(object):
                 b's2-ef-name': name.encode('utf-8'),
                 b's2-ef-version': data_version.encode('utf-8'),
             },
+            extensions={
+                'singlestoredb.allocate': allocate,
+            } if callable(data_out) else {},
         )
 
         await self(scope, receive, send)
 
+        return response_size
+
     def to_environment(
         self,
         name: str,
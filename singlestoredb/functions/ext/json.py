@@ -145,7 +145,7 @@ def load_pandas(
             (
                 pd.Series(
                     data, index=index, name=spec[0],
-                    dtype=PANDAS_TYPE_MAP[spec[1]],
+                    dtype=PANDAS_TYPE_MAP[spec[-1]],
                 ),
                 pd.Series(mask, index=index, dtype=np.longlong),
             )
@@ -179,7 +179,7 @@ def load_polars(
     return pl.Series(None, row_ids, dtype=pl.Int64), \
         [
             (
-                pl.Series(spec[0], data, dtype=POLARS_TYPE_MAP[spec[1]]),
+                pl.Series(spec[0], data, dtype=POLARS_TYPE_MAP[spec[-1]]),
                 pl.Series(None, mask, dtype=pl.Boolean),
             )
             for (data, mask), spec in zip(cols, colspec)
@@ -212,7 +212,7 @@ def load_numpy(
     return np.asarray(row_ids, dtype=np.longlong), \
         [
             (
-                np.asarray(data, dtype=NUMPY_TYPE_MAP[spec[1]]),  # type: ignore
+                np.asarray(data, dtype=NUMPY_TYPE_MAP[spec[-1]]),  # type: ignore
                 np.asarray(mask, dtype=np.bool_),  # type: ignore
             )
             for (data, mask), spec in zip(cols, colspec)
@@ -251,7 +251,7 @@ def load_arrow(
                 ),
                 pa.array(mask, type=pa.bool_()),
             )
-            for (data, mask), (name, dtype) in zip(cols, colspec)
+            for (data, mask), (name, *_, dtype) in zip(cols, colspec)
         ]
 
 
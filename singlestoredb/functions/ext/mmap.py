@@ -41,7 +41,6 @@ With the functions registered, you can now run the UDFs::
 import argparse
 import array
 import asyncio
-import io
 import logging
 import mmap
 import multiprocessing
@@ -133,30 +132,54 @@ def _handle_request(app: Any, connection: Any, client_address: Any) -> None:
             mmap.PROT_READ,
         )
 
-        # Read row data
-        response_size = 0
-        out = io.BytesIO()
+        # Output shared memory segment, mapped on demand by `allocate`
+        omem: List[mmap.mmap] = []
+        spill: List[bytearray] = []
+
+        def allocate(size: int) -> Any:
+            """Size the output file and return a writable mapping of it."""
+            size = max(128*1024, size)
+            if omem and len(omem[0]) >= size:
+                return omem[0]
+            while omem:
+                omem.pop().close()
+            ofile.truncate(size)
+            try:
+                omem.append(
+                    mmap.mmap(
+                        ofile.fileno(),
+                        size,
+                        mmap.MAP_SHARED,
+                        mmap.PROT_READ | mmap.PROT_WRITE,
+                    ),
+                )
+            except OSError:
+                # The output file can not be mapped for writing; encode
+                # into memory and write it out afterwards instead.
+                spill[:] = [bytearray(size)]
+                return spill[0]
+            return omem[0]
 
-        ifile.seek(0)
         try:
-            # Run the function
-            asyncio.run(
+            # Run the function; the input mapping is decoded in place and
+            # the results are encoded directly into the output mapping.
+            response_size = asyncio.run(
                 app.call(
                     name,
-                    io.BytesIO(ifile.read(length)),
-                    out,
+                    mem,
+                    allocate,
                     data_format='rowdat_1',
                     data_version='1.0',
                 ),
             )
 
-            # Write results
-            buf = out.getbuffer()
-            response_size = len(buf)
-            ofile.truncate(max(128*1024, response_size))
-            ofile.seek(0)
-            ofile.write(buf)
-            ofile.flush()
+            if spill:
+                ofile.seek(0)
+                ofile.write(memoryview(spill[0])[:response_size])
+                ofile.flush()
+            elif not omem:
+                # Nothing was encoded; still size the output file
+                allocate(response_size)
 
             # Complete the request by send back the status as two uint64s on the
             # socket:
@@ -178,8 +201,10 @@ def _handle_request(app: Any, connection: Any, client_address: Any) -> None:
             break
 
         finally:
-            # Close the shared memory object.
+            # Close the shared memory objects.
             mem.close()
+            while omem:
+                omem.pop().close()
 
     # Close shared memory files.
     ifile.close()
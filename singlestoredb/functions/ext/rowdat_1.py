@@ -45,7 +45,11 @@ from ...mysql.constants import FIELD_TYPE as ft
 has_accel = False
 try:
     if not get_option('pure_python'):
-        import _singlestoredb_accel
+        try:
+            # Prefer the full C API build of the accelerator if it was built
+            import _singlestoredb_accel_full as _singlestoredb_accel
+        except ImportError:
+            import _singlestoredb_accel
         has_accel = True
 except ImportError:
     warnings.warn(
@@ -118,7 +122,7 @@ def _load(
     while data_io.tell() < data_len:
         row_ids.append(struct.unpack('<q', data_io.read(8))[0])
         row = []
-        for _, ctype in colspec:
+        for _, ctype, *_ in colspec:
             is_null = data_io.read(1) == b'\x01'
             if ctype in numeric_formats:
                 val = struct.unpack(
@@ -165,7 +169,7 @@ def _load_vectors(
     val = None
     while data_io.tell() < data_len:
         row_ids.append(struct.unpack('<q', data_io.read(8))[0])
-        for i, (_, ctype) in enumerate(colspec):
+        for i, (_, ctype, *_) in enumerate(colspec):
             default = DEFAULT_VALUES[ctype]
             is_null = data_io.read(1) == b'\x01'
             if ctype in numeric_formats:
@@ -218,7 +222,7 @@ def _load_pandas(
             pd.Series(data, index=index, name=name, dtype=PANDAS_TYPE_MAP[dtype]),
             pd.Series(mask, index=index, dtype=np.bool_),
         )
-        for (data, mask), (name, dtype) in zip(cols, colspec)
+        for (data, mask), (name, *_, dtype) in zip(cols, colspec)
     ]
 
 
@@ -254,7 +258,7 @@ def _load_polars(
                 pl.Series(name=name, values=data, dtype=POLARS_TYPE_MAP[dtype]),
                 pl.Series(values=mask, dtype=pl.Boolean),
             )
-            for (data, mask), (name, dtype) in zip(cols, colspec)
+            for (data, mask), (name, *_, dtype) in zip(cols, colspec)
         ]
 
 
@@ -290,7 +294,7 @@ def _load_numpy(
                 np.asarray(data, dtype=NUMPY_TYPE_MAP[dtype]),  # type: ignore
                 np.asarray(mask, dtype=np.bool_),  # type: ignore
             )
-            for (data, mask), (name, dtype) in zip(cols, colspec)
+            for (data, mask), (name, *_, dtype) in zip(cols, colspec)
         ]
 
 
@@ -329,7 +333,7 @@ def _load_arrow(
                 ),
                 pa.array(mask, type=pa.bool_()),
             )
-            for (data, mask), (name, dtype) in zip(cols, colspec)
+            for (data, mask), (name, *_, dtype) in zip(cols, colspec)
         ]
 
 
@@ -562,12 +566,20 @@ def _dump_numpy_accel(
     returns: List[int],
     row_ids: 'np.typing.NDArray[np.int64]',
     cols: List[Tuple['np.typing.NDArray[Any]', 'np.typing.NDArray[np.bool_]']],
-) -> bytes:
+    out: Optional[Any] = None,
+) -> Any:
     if not has_numpy:
         raise RuntimeError('numpy must be installed for this operation')
     if not has_accel:
         raise RuntimeError('could not load SingleStoreDB extension')
 
+    # Write into the given buffer, or the one returned by calling `out`
+    # with the size of the output, and return the size of the output
+    if out is not None:
+        return _singlestoredb_accel.dump_rowdat_1_numpy_into(
+            returns, row_ids, cols, out,
+        )
+
     return _singlestoredb_accel.dump_rowdat_1_numpy(returns, row_ids, cols)
 
 
@@ -589,7 +601,7 @@ def _load_pandas_accel(
             pd.Series(data, name=name, dtype=PANDAS_TYPE_MAP[dtype]),
             pd.Series(mask, dtype=np.bool_),
         )
-        for (name, dtype), (data, mask) in zip(colspec, numpy_cols)
+        for (name, *_, dtype), (data, mask) in zip(colspec, numpy_cols)
     ]
     return pd.Series(numpy_ids, dtype=np.int64), cols
 
@@ -598,7 +610,8 @@ def _dump_pandas_accel(
     returns: List[int],
     row_ids: 'pd.Series[np.int64]',
     cols: List[Tuple['pd.Series[Any]', 'pd.Series[np.bool_]']],
-) -> bytes:
+    out: Optional[Any] = None,
+) -> Any:
     if not has_pandas or not has_numpy:
         raise RuntimeError('pandas must be installed for this operation')
     if not has_accel:
@@ -612,7 +625,7 @@ def _dump_pandas_accel(
         )
         for data, mask in cols
     ]
-    return _singlestoredb_accel.dump_rowdat_1_numpy(returns, numpy_ids, numpy_cols)
+    return _dump_numpy_accel(returns, numpy_ids, numpy_cols, out)
 
 
 def _load_polars_accel(
@@ -637,7 +650,7 @@ def _load_polars_accel(
             ),
             pl.Series(values=mask, dtype=pl.Boolean),
         )
-        for (name, dtype), (data, mask) in zip(colspec, numpy_cols)
+        for (name, *_, dtype), (data, mask) in zip(colspec, numpy_cols)
     ]
     return pl.Series(values=numpy_ids, dtype=pl.Int64), cols
 
@@ -646,7 +659,8 @@ def _dump_polars_accel(
     returns: List[int],
     row_ids: 'pl.Series[pl.Int64]',
     cols: List[Tuple['pl.Series[Any]', 'pl.Series[pl.Boolean]']],
-) -> bytes:
+    out: Optional[Any] = None,
+) -> Any:
     if not has_polars:
         raise RuntimeError('polars must be installed for this operation')
     if not has_accel:
@@ -660,7 +674,7 @@ def _dump_polars_accel(
         )
         for data, mask in cols
     ]
-    return _singlestoredb_accel.dump_rowdat_1_numpy(returns, numpy_ids, numpy_cols)
+    return _dump_numpy_accel(returns, numpy_ids, numpy_cols, out)
 
 
 def _load_arrow_accel(
@@ -681,7 +695,7 @@ def _load_arrow_accel(
             pa.array(data, type=PYARROW_TYPE_MAP[dtype], mask=mask),
             pa.array(mask, type=pa.bool_()),
         )
-        for (data, mask), (name, dtype) in zip(numpy_cols, colspec)
+        for (data, mask), (name, *_, dtype) in zip(numpy_cols, colspec)
     ]
     return pa.array(numpy_ids, type=pa.int64()), cols
 
@@ -699,7 +713,8 @@ def _dump_arrow_accel(
     returns: List[int],
     row_ids: 'pa.Array[pa.int64()]',
     cols: List[Tuple['pa.Array[Any]', 'pa.Array[pa.bool_()]']],
-) -> bytes:
+    out: Optional[Any] = None,
+) -> Any:
     if not has_pyarrow:
         raise RuntimeError('pyarrow must be installed for this operation')
     if not has_accel:
@@ -712,9 +727,36 @@ def _dump_arrow_accel(
         )
         for (data, mask), dtype in zip(cols, returns)
     ]
-    return _singlestoredb_accel.dump_rowdat_1_numpy(
-        returns, row_ids.to_numpy(), numpy_cols,
-    )
+    return _dump_numpy_accel(returns, row_ids.to_numpy(), numpy_cols, out)
+
+
+def _dump_into(dump: Any) -> Any:
+    '''
+    Wrap a dump function so that it writes into a caller-supplied buffer.
+
+    Parameters
+    ----------
+    dump : Callable
+        The dump function to wrap
+
+    Returns
+    -------
+    Callable
+        A function taking the arguments of `dump` followed by a writable
+        buffer, or by a callable which is given the size of the output and
+        returns the buffer. It returns the size of the output; nothing is
+        written if the buffer is smaller than that.
+
+    '''
+    def dump_into(*args: Any) -> int:
+        out = args[-1]
+        data = dump(*args[:-1])
+        if callable(out):
+            out = out(len(data))
+        if len(data) <= len(out):
+            out[:len(data)] = data
+        return len(data)
+    return dump_into
 
 
 if not has_accel:
@@ -728,6 +770,11 @@ if not has_accel:
     dump_arrow = _dump_arrow_accel = _dump_arrow  # noqa: F811
     load_polars = _load_polars_accel = _load_polars  # noqa: F811
     dump_polars = _dump_polars_accel = _dump_polars  # noqa: F811
+    dump_into = _dump_into(_dump)
+    dump_pandas_into = _dump_into(_dump_pandas)
+    dump_numpy_into = _dump_into(_dump_numpy)
+    dump_arrow_into = _dump_into(_dump_arrow)
+    dump_polars_into = _dump_into(_dump_polars)
 
 else:
     _load_accel = _singlestoredb_accel.load_rowdat_1
@@ -742,3 +789,8 @@ else:
     dump_arrow = _dump_arrow_accel
     load_polars = _load_polars_accel
     dump_polars = _dump_polars_accel
+    dump_into = _singlestoredb_accel.dump_rowdat_1_into
+    dump_pandas_into = _dump_pandas_accel
+    dump_numpy_into = _dump_numpy_accel
+    dump_arrow_into = _dump_arrow_accel
+    dump_polars_into = _dump_polars_accel
@@ -3,6 +3,9 @@
 # http://dev.mysql.com/doc/internals/en/client-server-protocol.html
 # Error codes:
 # https://dev.mysql.com/doc/refman/5.5/en/error-handling.html
+import collections.abc
+import datetime
+import decimal
 import errno
 import functools
 import io
@@ -16,17 +19,28 @@ import warnings
 from typing import Any
 from typing import Dict
 from typing import Iterable
+from typing import Tuple
 
 try:
-    import _singlestoredb_accel
+    # Prefer the full C API build of the accelerator if it was built
+    import _singlestoredb_accel_full as _singlestoredb_accel
 except (ImportError, ModuleNotFoundError):
-    _singlestoredb_accel = None
+    try:
+        import _singlestoredb_accel
+    except (ImportError, ModuleNotFoundError):
+        _singlestoredb_accel = None
+
+if _singlestoredb_accel is not None:
+    # Lazily decoded BSON documents are read-only mappings
+    collections.abc.Mapping.register(_singlestoredb_accel.BSONDocument)
+    # Lazily decoded rows are sequences like tuples
+    collections.abc.Sequence.register(_singlestoredb_accel.LazyRow)
 
 from . import _auth
 from ..utils import events
 
 from .charset import charset_by_name, charset_by_id
-from .constants import CLIENT, COMMAND, CR, ER, FIELD_TYPE, SERVER_STATUS
+from .constants import CLIENT, COMMAND, CR, ER, FIELD_TYPE, FLAG, SERVER_STATUS
 from . import converters
 from .cursors import (
     Cursor,
@@ -118,6 +132,11 @@ TEXT_TYPES = {
     FIELD_TYPE.INT64_VECTOR,
 }
 
+DECIMAL_TYPES = {FIELD_TYPE.DECIMAL, FIELD_TYPE.NEWDECIMAL}
+
+#: Results types that ``decimal_type`` applies to.
+ROW_RESULTS_TYPES = {'tuples', 'dicts', 'namedtuples', 'structsequences', 'lazyrows'}
+
 UNSET = 'unset'
 
 DEFAULT_CHARSET = 'utf8mb4'
@@ -129,6 +148,181 @@ def _pack_int24(n):
     return struct.pack('<I', n)[:3]
 
 
+#: struct formats of fixed-width binary protocol values (signed, unsigned).
+BINARY_NUMBER_FORMATS = {
+    FIELD_TYPE.TINY: ('<b', '<B'),
+    FIELD_TYPE.SHORT: ('<h', '<H'),
+    FIELD_TYPE.YEAR: ('<H', '<H'),
+    FIELD_TYPE.INT24: ('<i', '<I'),
+    FIELD_TYPE.LONG: ('<i', '<I'),
+    FIELD_TYPE.LONGLONG: ('<q', '<Q'),
+    FIELD_TYPE.FLOAT: ('<f', '<f'),
+    FIELD_TYPE.DOUBLE: ('<d', '<d'),
+}
+
+BINARY_TEMPORAL_TYPES = {
+    FIELD_TYPE.DATE,
+    FIELD_TYPE.NEWDATE,
+    FIELD_TYPE.DATETIME,
+    FIELD_TYPE.TIMESTAMP,
+    FIELD_TYPE.TIME,
+}
+
+
+def _float32_to_text(value):
+    """Format a float32 as the server does in the text protocol."""
+    for precision in range(6, 10):
+        out = '%.*g' % (precision, value)
+        if struct.unpack('<f', struct.pack('<f', float(out)))[0] == value:
+            break
+    return out
+
+
+def _decimal_to_scaled_int(value, scale=0):
+    """Convert DECIMAL text to an int equal to the value times 10**scale."""
+    if isinstance(value, (bytes, bytearray)):
+        value = value.decode('ascii')
+    whole, _, fraction = value.partition('.')
+    if len(fraction) > scale:
+        raise ValueError(f'invalid DECIMAL value: {value}')
+    return int(whole + fraction.ljust(scale, '0'))
+
+
+def _read_binary_temporal(packet, field_type):
+    """Read a binary protocol date / time value as text."""
+    length = packet.read_uint8()
+    data = packet.read(length)
+    if field_type == FIELD_TYPE.TIME:
+        negative, days, hour, minute, second, micro = struct.unpack(
+            '<BIBBBI', data + bytes(12 - length),
+        )
+        out = '%s%02d:%02d:%02d' % (
+            '-' if negative else '', days * 24 + hour, minute, second,
+        )
+    else:
+        year, month, day, hour, minute, second, micro = struct.unpack(
+            '<HBBBBBI', data + bytes(11 - length),
+        )
+        out = '%04d-%02d-%02d' % (year, month, day)
+        if field_type in (FIELD_TYPE.DATE, FIELD_TYPE.NEWDATE):
+            return out
+        out += ' %02d:%02d:%02d' % (hour, minute, second)
+    if micro:
+        out += '.%06d' % micro
+    return out
+
+
+def _encode_prepared_params(args, encoding):
+    """Encode the NULL bitmap, types, and values of COM_STMT_EXECUTE."""
+    null_bitmap = bytearray((len(args) + 7) // 8)
+    types = []
+    values = []
+    for i, arg in enumerate(args):
+        if arg is None:
+            null_bitmap[i >> 3] |= 1 << (i & 7)
+            types.append((FIELD_TYPE.NULL, 0))
+        elif isinstance(arg, int):
+            if arg > 0x7FFFFFFFFFFFFFFF:
+                types.append((FIELD_TYPE.LONGLONG, 0x80))
+                values.append(struct.pack('<Q', arg))
+            else:
+                types.append((FIELD_TYPE.LONGLONG, 0))
+                values.append(struct.pack('<q', arg))
+        elif isinstance(arg, float):
+            types.append((FIELD_TYPE.DOUBLE, 0))
+            values.append(struct.pack('<d', arg))
+        elif isinstance(arg, datetime.datetime):
+            types.append((FIELD_TYPE.DATETIME, 0))
+            values.append(
+                b'\x0b' + struct.pack(
+                    '<HBBBBBI', arg.year, arg.month, arg.day,
+                    arg.hour, arg.minute, arg.second, arg.microsecond,
+                ),
+            )
+        elif isinstance(arg, datetime.date):
+            types.append((FIELD_TYPE.DATE, 0))
+            values.append(b'\x04' + struct.pack('<HBB', arg.year, arg.month, arg.day))
+        elif isinstance(arg, (datetime.timedelta, datetime.time)):
+            if isinstance(arg, datetime.time):
+                arg = datetime.timedelta(
+                    hours=arg.hour, minutes=arg.minute,
+                    seconds=arg.second, microseconds=arg.microsecond,
+                )
+            micros = (arg.days * 86400 + arg.seconds) * 1000000 + arg.microseconds
+            days, micros = divmod(abs(micros), 86400000000)
+            seconds, micros = divmod(micros, 1000000)
+            types.append((FIELD_TYPE.TIME, 0))
+            values.append(
+                b'\x0c' + struct.pack(
+                    '<BIBBBI', arg < datetime.timedelta(0), days,
+                    seconds // 3600, seconds // 60 % 60, seconds % 60, micros,
+                ),
+            )
+        elif isinstance(arg, (bytes, bytearray, memoryview)):
+            arg = bytes(arg)
+            types.append((FIELD_TYPE.BLOB, 0))
+            values.append(_lenenc_int(len(arg)) + arg)
+        else:
+            if isinstance(arg, decimal.Decimal):
+                types.append((FIELD_TYPE.NEWDECIMAL, 0))
+            else:
+                types.append((FIELD_TYPE.VAR_STRING, 0))
+            arg = str(arg).encode(encoding, 'surrogateescape')
+            values.append(_lenenc_int(len(arg)) + arg)
+    return b''.join([
+        bytes(null_bitmap),
+        b'\x01',  # new params bound
+        b''.join(struct.pack('<BB', *x) for x in types),
+        *values,
+    ])
+
+
+class PreparedStatement:
+    """
+    Server-side prepared statement.
+
+    Parameters
+    ----------
+    statement_id : int
+        The statement ID assigned by the server
+    num_params : int
+        The number of parameters in the statement
+    num_columns : int
+        The number of columns in the result
+
+    """
+
+    def __init__(self, statement_id, num_params, num_columns):
+        self.statement_id = statement_id
+        self.num_params = num_params
+        self.num_columns = num_columns
+
+
+class ResultShape:
+    """
+    Column metadata shared by results with identical column definitions.
+
+    Parameters
+    ----------
+    fields : List[FieldDescriptorPacket]
+        The column definitions
+    converters : List[Tuple[Optional[str], Optional[Callable]]]
+        The (encoding, converter) pair of each column
+    description : Tuple[Tuple[Any, ...], ...]
+        The DB-API description of the columns
+
+    """
+
+    __slots__ = ['fields', 'converters', 'description', 'accel']
+
+    def __init__(self, fields, converters, description):
+        self.fields = fields
+        self.converters = converters
+        self.description = description
+        #: Column layout computed by the C extension on first use
+        self.accel = None
+
+
 # https://dev.mysql.com/doc/internals/en/integer.html#packet-Protocol::LengthEncodedInteger
 def _lenenc_int(i):
     if i < 0:
@@ -280,6 +474,21 @@ class Connection(BaseConnection):
         Should the connection track the SINGLESTOREDB_URL environment variable?
     enable_extended_data_types : bool, optional
         Should extended data types (BSON, vector) be enabled?
+    decimal_type : str, optional
+        Type of DECIMAL values in row-based results: 'decimal' for
+        decimal.Decimal (the default), 'float', or 'scaled_int' for an int
+        equal to the value times 10**scale. Columnar results are not affected.
+    contiguous_vectors : bool, optional
+        Should VECTOR columns in numpy, pandas, and Arrow results be collected
+        into one (n_rows, dimension) block instead of per-row arrays?
+        Requires the C extension.
+    lazy_bson : bool, optional
+        Should BSON values be returned as read-only mappings that decode their
+        fields on access rather than as dicts? Requires the C extension.
+    prefetch_bytes : int, optional
+        Number of bytes of an unbuffered result to read ahead on a background
+        thread while rows are decoded. Zero (the default) disables read-ahead.
+        Requires the C extension.
 
     See `Connection <https://www.python.org/dev/peps/pep-0249/#connection-objects>`_
     in the specification.
@@ -290,6 +499,16 @@ class Connection(BaseConnection):
     paramstyle = 'pyformat'
 
     _sock = None
+    _rbuf = b''
+    _rbuf_pos = 0
+    _prepared_statements: Dict[bytes, PreparedStatement]
+    _result_shapes: Dict[Tuple[Any, ...], ResultShape]
+
+    #: Number of server-side prepared statements kept open per connection.
+    prepared_statement_cache_size = 100
+
+    #: Number of distinct result column layouts kept per connection.
+    result_shape_cache_size = 256
     _auth_plugin_name = ''
     _closed = False
     _secure = False
@@ -350,6 +569,10 @@ class Connection(BaseConnection):
         encoding_errors='strict',
         track_env=False,
         enable_extended_data_types=True,
+        decimal_type='decimal',
+        contiguous_vectors=True,
+        lazy_bson=False,
+        prefetch_bytes=0,
     ):
         BaseConnection.__init__(**dict(locals()))
 
@@ -580,7 +803,17 @@ class Connection(BaseConnection):
         conv = conv.copy()
 
         self.parse_json = parse_json
+        self.decimal_type = decimal_type or 'decimal'
+        if self.decimal_type not in ('decimal', 'float', 'scaled_int'):
+            raise ValueError(
+                'decimal_type must be one of: decimal, float, scaled_int',
+            )
+        self.contiguous_vectors = contiguous_vectors
+        self.lazy_bson = lazy_bson
+        self.prefetch_bytes = prefetch_bytes or 0
         self.invalid_values = (invalid_values or {}).copy()
+        self._result_shapes = {}
+        self._prepared_statements = {}
 
         # Disable JSON parsing for Arrow
         if self.results_type in ['arrow']:
@@ -739,6 +972,9 @@ class Connection(BaseConnection):
                 pass
         self._sock = None
         self._rfile = None
+        self._rbuf = b''
+        self._rbuf_pos = 0
+        self._prepared_statements = {}
 
     __del__ = _force_close
 
@@ -896,6 +1132,84 @@ class Connection(BaseConnection):
             self._local_infile_stream = None
         return self._affected_rows
 
+    def prepare(self, sql):
+        """
+        Prepare a statement on the server.
+
+        Statements are cached per connection, so preparing the same SQL
+        again returns the existing statement.
+
+        Internal use only.
+
+        """
+        if isinstance(sql, str):
+            sql = sql.encode(self.encoding, 'surrogateescape')
+
+        stmt = self._prepared_statements.pop(sql, None)
+        if stmt is None:
+            self._execute_command(COMMAND.COM_STMT_PREPARE, sql)
+            packet = self._read_packet()
+            statement_id, num_columns, num_params = packet.read_struct('<xIHH')
+            # Parameter and column definitions are sent again with results
+            for n in (num_params, num_columns):
+                if n:
+                    for _ in range(n + 1):
+                        self._read_packet()
+            stmt = PreparedStatement(statement_id, num_params, num_columns)
+
+            # Close the least recently used statement
+            if len(self._prepared_statements) >= self.prepared_statement_cache_size:
+                old = next(iter(self._prepared_statements))
+                self.close_prepared(self._prepared_statements[old])
+
+        self._prepared_statements[sql] = stmt
+        return stmt
+
+    def close_prepared(self, stmt):
+        """
+        Deallocate a prepared statement on the server.
+
+        Internal use only.
+
+        """
+        for key, value in list(self._prepared_statements.items()):
+            if value is stmt:
+                del self._prepared_statements[key]
+        # The server does not respond to COM_STMT_CLOSE
+        self._execute_command(
+            COMMAND.COM_STMT_CLOSE, struct.pack('<I', stmt.statement_id),
+        )
+
+    def query_prepared(self, sql, args=(), unbuffered=False):
+        """
+        Run a query as a server-side prepared statement.
+
+        Parameters use ``?`` placeholders. Results are sent in the binary
+        protocol, so numbers and dates are not formatted as text.
+
+        Internal use only.
+
+        """
+        stmt = self.prepare(sql)
+        args = tuple(args or ())
+        if len(args) != stmt.num_params:
+            raise err.ProgrammingError(
+                f'statement has {stmt.num_params} parameters, '
+                f'but {len(args)} were given',
+            )
+
+        # statement id, flags (no cursor), iteration count
+        payload = struct.pack('<IBI', stmt.statement_id, 0, 1)
+        if args:
+            payload += _encode_prepared_params(args, self.encoding)
+
+        self._is_committable = True
+        self._execute_command(COMMAND.COM_STMT_EXECUTE, payload)
+        self._affected_rows = self._read_query_result(
+            unbuffered=unbuffered, binary=True,
+        )
+        return self._affected_rows
+
     def next_result(self, unbuffered=False):
         """
         Retrieve the next result set.
@@ -1084,6 +1398,9 @@ class Connection(BaseConnection):
 
             self._sock = sock
             self._rfile = sock.makefile('rb')
+            self._rbuf = b''
+            self._rbuf_pos = 0
+            self._prepared_statements = {}
             self._next_seq_id = 0
 
             self._get_server_information()
@@ -1218,6 +1535,20 @@ class Connection(BaseConnection):
         return packet
 
     def _read_bytes(self, num_bytes):
+        if self._rbuf:
+            # Bytes read ahead of a result set by the C extension. Only the
+            # read position moves; the buffer is dropped once it is used up.
+            start = self._rbuf_pos
+            end = start + num_bytes
+            data = self._rbuf[start:end]
+            if end >= len(self._rbuf):
+                self._rbuf = b''
+                self._rbuf_pos = 0
+            else:
+                self._rbuf_pos = end
+            if len(data) < num_bytes:
+                data += self._read_bytes(num_bytes - len(data))
+            return data
         if self._read_timeout is not None:
             self._sock.settimeout(self._read_timeout)
         while True:
@@ -1254,12 +1585,12 @@ class Connection(BaseConnection):
                 CR.CR_SERVER_GONE_ERROR, f'MySQL server has gone away ({e!r})',
             )
 
-    def _read_query_result(self, unbuffered=False):
+    def _read_query_result(self, unbuffered=False, binary=False):
         self._result = None
         if unbuffered:
-            result = self.resultclass(self, unbuffered=unbuffered)
+            result = self.resultclass(self, unbuffered=unbuffered, binary=binary)
         else:
-            result = self.resultclass(self)
+            result = self.resultclass(self, binary=binary)
             result.read()
         self._result = result
         if result.server_status is not None:
@@ -1636,11 +1967,19 @@ class MySQLResult:
         The connection the result came from.
     unbuffered : bool, optional
         Should the reads be unbuffered?
+    binary : bool, optional
+        Are rows sent in the binary protocol (prepared statements)?
 
     """
 
-    def __init__(self, connection, unbuffered=False):
+    #: Is `decimal_type` applied while decoding rows rather than by converters?
+    _native_decimal_type = False
+
+    def __init__(self, connection, unbuffered=False, binary=False):
         self.connection = connection
+        self.binary = binary
+        if binary:
+            self._read_row_from_packet = self._read_binary_row_from_packet
         self.affected_rows = None
         self.insert_id = None
         self.server_status = None
@@ -1651,6 +1990,7 @@ class MySQLResult:
         self.rows = None
         self.has_next = None
         self.unbuffered_active = False
+        self.rowdata_bytes_read = 0
         self.converters = []
         self.fields = []
         self.encoding_errors = self.connection.encoding_errors
@@ -1772,6 +2112,7 @@ class MySQLResult:
             self.rows = None
             return
 
+        self.rowdata_bytes_read += len(packet.get_all_data())
         row = self._read_row_from_packet(packet)
         self.affected_rows = 1
         self.rows = (row,)  # rows should tuple of row for MySQL-python compatibility.
@@ -1832,17 +2173,88 @@ class MySQLResult:
             row.append(data)
         return tuple(row)
 
+    def _read_binary_row_from_packet(self, packet):
+        n_cols = len(self.converters)
+        null_bitmap = packet.get_bytes(1, (n_cols + 9) // 8)
+        packet.advance(1 + len(null_bitmap))
+        row = []
+        for i, (field, (encoding, converter)) in enumerate(
+            zip(self.fields, self.converters),
+        ):
+            if null_bitmap[(i + 2) >> 3] & (1 << ((i + 2) & 7)):
+                row.append(None)
+                continue
+            field_type = field.type_code
+            if field_type in BINARY_NUMBER_FORMATS:
+                fmt = BINARY_NUMBER_FORMATS[field_type][bool(field.flags & FLAG.UNSIGNED)]
+                data = packet.read_struct(fmt)[0]
+                if field_type == FIELD_TYPE.FLOAT:
+                    data = float(_float32_to_text(data))
+                # Only custom converters need the text form
+                if converter is not None and \
+                        converter is not converters.decoders.get(field_type):
+                    data = converter(str(data))
+            elif field_type in BINARY_TEMPORAL_TYPES:
+                data = _read_binary_temporal(packet, field_type)
+                if converter is not None:
+                    data = converter(data)
+            else:
+                data = packet.read_length_coded_string()
+                if encoding is not None:
+                    data = data.decode(encoding, errors=self.encoding_errors)
+                if converter is not None:
+                    data = converter(data)
+            row.append(data)
+        return tuple(row)
+
+    def _get_decimal_converter(self, field, converter):
+        """Return the converter for a DECIMAL field honoring `decimal_type`."""
+        decimal_type = getattr(self.connection, 'decimal_type', 'decimal')
+        if decimal_type == 'decimal' or \
+                converter is not converters.decoders.get(field.type_code) or \
+                self.connection.results_type not in ROW_RESULTS_TYPES:
+            return converter
+        if decimal_type == 'float':
+            return float
+        return functools.partial(_decimal_to_scaled_int, scale=field.scale)
+
     def _get_descriptions(self):
         """Read a column descriptor packet for each column in the result."""
-        self.fields = []
-        self.converters = []
+        packets = tuple(
+            self.connection._read_packet().get_all_data()
+            for _ in range(self.field_count)
+        )
+
+        eof_packet = self.connection._read_packet()
+        assert eof_packet.is_eof_packet(), 'Protocol error, expecting EOF'
+
+        # Repeated queries send identical column definitions, so their
+        # metadata is parsed once and kept in a per-connection LRU cache.
+        key = (type(self), packets)
+        shapes = self.connection._result_shapes
+        shape = shapes.pop(key, None)
+        if shape is None:
+            shape = self._parse_descriptions(packets)
+            if len(shapes) >= self.connection.result_shape_cache_size:
+                del shapes[next(iter(shapes))]
+        shapes[key] = shape
+
+        self._shape = shape
+        self.fields = shape.fields
+        self.converters = shape.converters
+        self.description = shape.description
+
+    def _parse_descriptions(self, packets):
+        """Parse column descriptor packets into a ``ResultShape``."""
+        fields = []
+        field_converters = []
         use_unicode = self.connection.use_unicode
         conn_encoding = self.connection.encoding
         description = []
 
-        for i in range(self.field_count):
-            field = self.connection._read_packet(FieldDescriptorPacket)
-            self.fields.append(field)
+        for data in packets:
+            field = FieldDescriptorPacket(data, conn_encoding)
+            fields.append(field)
             description.append(field.description())
             field_type = field.type_code
             if use_unicode:
@@ -1867,19 +2279,22 @@ class MySQLResult:
             converter = self.connection.decoders.get(field_type)
             if converter is converters.through:
                 converter = None
+            if field_type in DECIMAL_TYPES and not self._native_decimal_type:
+                converter = self._get_decimal_converter(field, converter)
             if DEBUG:
                 print(f'DEBUG: field={field}, converter={converter}')
-            self.converters.append((encoding, converter))
+            field_converters.append((encoding, converter))
 
-        eof_packet = self.connection._read_packet()
-        assert eof_packet.is_eof_packet(), 'Protocol error, expecting EOF'
-        self.description = tuple(description)
+        return ResultShape(fields, field_converters, tuple(description))
 
 
 class MySQLResultSV(MySQLResult):
 
-    def __init__(self, connection, unbuffered=False):
-        MySQLResult.__init__(self, connection, unbuffered=unbuffered)
+    # The C extension applies `decimal_type` itself
+    _native_decimal_type = True
+
+    def __init__(self, connection, unbuffered=False, binary=False):
+        MySQLResult.__init__(self, connection, unbuffered=unbuffered, binary=binary)
         self.options = {
             k: v for k, v in dict(
                 default_converters=converters.decoders,
@@ -1888,6 +2303,11 @@ class MySQLResultSV(MySQLResult):
                 invalid_values=connection.invalid_values,
                 unbuffered=unbuffered,
                 encoding_errors=connection.encoding_errors,
+                binary_protocol=binary,
+                decimal_type=connection.decimal_type,
+                contiguous_vectors=connection.contiguous_vectors,
+                lazy_bson=connection.lazy_bson,
+                prefetch_bytes=connection.prefetch_bytes,
             ).items() if v is not UNSET
         }
         self._read_rowdata_packet = functools.partial(
@@ -1896,6 +2316,17 @@ class MySQLResultSV(MySQLResult):
         self._read_rowdata_packet_unbuffered = functools.partial(
             _singlestoredb_accel.read_rowdata_packet, self, True,
         )
+        self._iter_rowdata_packets = functools.partial(
+            _singlestoredb_accel.iter_rowdata_packets, self,
+        )
+
+    def _finish_unbuffered_query(self):
+        # The C extension reads the socket in large chunks, so any rows it
+        # has already received must be handed back before draining in Python.
+        state = getattr(self, '_state', None)
+        if state is not None:
+            state.release_buffer()
+        MySQLResult._finish_unbuffered_query(self)
 
 
 class LoadLocalFile:
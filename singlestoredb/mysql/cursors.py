@@ -19,6 +19,36 @@ RE_INSERT_VALUES = re.compile(
     re.IGNORECASE | re.DOTALL,
 )
 
+#: Regular expression for pyformat parameters in prepared statements.
+RE_PYFORMAT_PARAMS = re.compile(r'%(?:\((?P<name>[^)]+)\))?(?P<type>[s%])')
+
+
+def _to_prepared_query(query, args):
+    """Convert a pyformat query to ``?`` parameters and an argument tuple."""
+    # Like the text protocol, the query is used as-is without parameters
+    if args is None:
+        return query, ()
+
+    names = []
+
+    def replace(m):
+        if m.group('type') == '%':
+            return '%'
+        names.append(m.group('name'))
+        return '?'
+
+    query = RE_PYFORMAT_PARAMS.sub(replace, query)
+
+    if isinstance(args, dict):
+        if None in names:
+            raise err.ProgrammingError('%s placeholders require sequence parameters')
+        return query, tuple(args[x] for x in names)
+    if any(x is not None for x in names):
+        raise err.ProgrammingError('%(name)s placeholders require dict parameters')
+    if not isinstance(args, (tuple, list)):
+        args = (args,)
+    return query, tuple(args)
+
 
 class Cursor(BaseCursor):
     """
@@ -178,7 +208,7 @@ class Cursor(BaseCursor):
 
         return query
 
-    def execute(self, query, args=None, infile_stream=None):
+    def execute(self, query, args=None, infile_stream=None, prepared=False):
         """
         Execute a query.
 
@@ -194,6 +224,10 @@ class Cursor(BaseCursor):
             Parameters used with query. (optional)
         infile_stream : io.BytesIO or Iterator[bytes], optional
             Data stream for ``LOCAL INFILE`` statements
+        prepared : bool, optional
+            Execute the query as a server-side prepared statement. The
+            statement is cached on the connection and parameters are sent
+            separately from the query text.
 
         Returns
         -------
@@ -205,6 +239,12 @@ class Cursor(BaseCursor):
 
         log_query(query, args)
 
+        if prepared:
+            query, args = _to_prepared_query(query, args)
+            result = self._query_prepared(query, args)
+            self._executed = query
+            return result
+
         query = self.mogrify(query, args)
 
         result = self._query(query, infile_stream=infile_stream)
@@ -364,6 +404,55 @@ class Cursor(BaseCursor):
         self._rownumber = min(end, len(self._rows))
         return result
 
+    def _fetch_batch(self, rows_per_batch, bytes_per_batch):
+        """Fetch the next batch of buffered rows."""
+        if self._rows is None:
+            return []
+        end = self._rownumber + (rows_per_batch or len(self._rows))
+        result = self._rows[self._rownumber: end]
+        self._rownumber = min(end, len(self._rows))
+        return result
+
+    def fetch_batches(self, rows_per_batch=None, bytes_per_batch=None):
+        """
+        Fetch the remaining rows in batches, implemented as a generator.
+
+        With unbuffered cursors, only one batch is held in memory at a
+        time, so arbitrarily large results can be streamed in bounded
+        memory. Buffered cursors already hold all rows, so they only
+        apply ``rows_per_batch``.
+
+        Parameters
+        ----------
+        rows_per_batch : int, optional
+            Maximum number of rows in a batch
+        bytes_per_batch : int, optional
+            Amount of row data (as sent by the server) in a batch. A batch
+            ends with the row that reaches this size. If neither limit is
+            given, batches hold ``arraysize`` rows.
+
+        Returns
+        -------
+        Iterator
+            Batches in the output format of the cursor
+
+        """
+        self._check_executed()
+        if rows_per_batch is None and bytes_per_batch is None:
+            rows_per_batch = self.arraysize
+        if rows_per_batch is not None and rows_per_batch < 1:
+            raise err.ProgrammingError('rows_per_batch must be a positive integer')
+        if bytes_per_batch is not None and bytes_per_batch < 1:
+            raise err.ProgrammingError('bytes_per_batch must be a positive integer')
+
+        def fetch_batches_gen(_fetch_batch=self._fetch_batch):
+            while True:
+                rows = _fetch_batch(rows_per_batch, bytes_per_batch)
+                if not rows:
+                    break
+                yield rows
+        return fetch_batches_gen()
+
     def fetchall(self):
         """Fetch all the rows."""
         self._check_executed()
@@ -396,6 +485,13 @@ class Cursor(BaseCursor):
         self._do_get_result()
         return self.rowcount
 
+    def _query_prepared(self, q, args):
+        conn = self._get_db()
+        self._clear_result()
+        conn.query_prepared(q, args)
+        self._do_get_result()
+        return self.rowcount
+
     def _clear_result(self):
         self._rownumber = 0
         self._result = None
@@ -478,6 +574,21 @@ class ArrowCursorMixin:
             self.description, super().fetchmany(size), schema=self._schema,
         )
 
+    def fetch_batches(self, rows_per_batch=None, bytes_per_batch=None):
+        batches = super().fetch_batches(rows_per_batch, bytes_per_batch)
+
+        def fetch_batches_gen():
+            for rows in batches:
+                out = results.results_to_arrow(
+                    self.description, rows, schema=self._schema,
+                )
+                # Yield record batches when pyarrow is available
+                if results.has_pyarrow:
+                    yield from out.to_batches()
+                else:
+                    yield out
+        return fetch_batches_gen()
+
 
 class ArrowCursor(ArrowCursorMixin, Cursor):
     """A cursor which returns results as an Arrow Table."""
@@ -510,6 +621,13 @@ class NumpyCursorMixin:
             self.description, super().fetchmany(size), schema=self._schema,
         )
 
+    def fetch_batches(self, rows_per_batch=None, bytes_per_batch=None):
+        batches = super().fetch_batches(rows_per_batch, bytes_per_batch)
+        return (
+            results.results_to_numpy(self.description, x, schema=self._schema)
+            for x in batches
+        )
+
 
 class NumpyCursor(NumpyCursorMixin, Cursor):
     """A cursor which returns results as a numpy array."""
@@ -542,6 +660,13 @@ class PandasCursorMixin:
             self.description, super().fetchmany(size), schema=self._schema,
         )
 
+    def fetch_batches(self, rows_per_batch=None, bytes_per_batch=None):
+        batches = super().fetch_batches(rows_per_batch, bytes_per_batch)
+        return (
+            results.results_to_pandas(self.description, x, schema=self._schema)
+            for x in batches
+        )
+
 
 class PandasCursor(PandasCursorMixin, Cursor):
     """A cursor which returns results as a pandas DataFrame."""
@@ -574,6 +699,13 @@ class PolarsCursorMixin:
             self.description, super().fetchmany(size), schema=self._schema,
         )
 
+    def fetch_batches(self, rows_per_batch=None, bytes_per_batch=None):
+        batches = super().fetch_batches(rows_per_batch, bytes_per_batch)
+        return (
+            results.results_to_polars(self.description, x, schema=self._schema)
+            for x in batches
+        )
+
 
 class PolarsCursor(PolarsCursorMixin, Cursor):
     """A cursor which returns results as a polars DataFrame."""
@@ -689,6 +821,13 @@ class SSCursor(Cursor):
         self._do_get_result()
         return self.rowcount
 
+    def _query_prepared(self, q, args):
+        conn = self._get_db()
+        self._clear_result()
+        conn.query_prepared(q, args, unbuffered=True)
+        self._do_get_result()
+        return self.rowcount
+
     def nextset(self):
         return self._nextset(unbuffered=True)
 
@@ -760,6 +899,22 @@ class SSCursor(Cursor):
             self._rownumber += 1
         return rows
 
+    def _fetch_batch(self, rows_per_batch, bytes_per_batch):
+        """Fetch rows until either batch limit is reached."""
+        start = self._result.rowdata_bytes_read
+        rows = []
+        while rows_per_batch is None or len(rows) < rows_per_batch:
+            row = self.read_next()
+            if row is None:
+                self.warning_count = self._result.warning_count
+                break
+            rows.append(row)
+            self._rownumber += 1
+            if bytes_per_batch and \
+                    self._result.rowdata_bytes_read - start >= bytes_per_batch:
+                break
+        return rows
+
     def scroll(self, value, mode='relative'):
         self._check_executed()
 
@@ -816,6 +971,33 @@ class SSCursorSV(SSCursor):
         self._rownumber += len(out)
         return out
 
+    def fetchall_unbuffered(self):
+        """
+        Fetch all, implemented as an iterator in the C extension.
+
+        Rows are decoded straight from the receive buffer. The row number
+        and warning count are updated when the result is exhausted or the
+        iterator is discarded.
+
+        """
+        self._check_executed()
+        return self._result._iter_rowdata_packets(self)
+
+    def _fetch_batch(self, rows_per_batch, bytes_per_batch):
+        """Fetch rows until either batch limit is reached."""
+        # Column buffers of the numpy, pandas, polars, and arrow formats
+        # are filled directly by the C extension.
+        out = self._result._read_rowdata_packet_unbuffered(
+            rows_per_batch or 2**62, bytes_per_batch or 0,
+        )
+        if out is None:
+            self.warning_count = self._result.warning_count
+            return []
+        if rows_per_batch == 1:
+            out = [out]
+        self._rownumber += len(out)
+        return out
+
     def scroll(self, value, mode='relative'):
         self._check_executed()
 
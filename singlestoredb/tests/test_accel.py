@@ -0,0 +1,102 @@
+#!/usr/bin/env python
+# type: ignore
+"""Test the text cell parsers of the C extension"""
+import random
+import struct
+import unittest
+
+try:
+    try:
+        import _singlestoredb_accel_full as _singlestoredb_accel
+    except ImportError:
+        import _singlestoredb_accel
+    has_accel = True
+except ImportError:
+    has_accel = False
+
+
+def bits(value):
+    return struct.pack('<d', value)
+
+
+@unittest.skipIf(not has_accel, 'Test requires the C extension')
+class TestParsers(unittest.TestCase):
+
+    def check_double(self, text):
+        out = _singlestoredb_accel._parse_double(text.encode('ascii'))
+        assert bits(out) == bits(float(text)), (text, out, float(text))
+
+    def test_parse_int64(self):
+        parse = _singlestoredb_accel._parse_int64
+        assert parse(b'0') == 0
+        assert parse(b'-1') == -1
+        assert parse(b'00042') == 42
+        assert parse(b'1234567890123456789') == 1234567890123456789
+        assert parse(b'9223372036854775807') == 2**63 - 1
+        assert parse(b'-9223372036854775808') == -2**63
+
+        # Out of range values saturate
+        assert parse(b'9223372036854775808') == 2**63 - 1
+        assert parse(b'-9223372036854775809') == -2**63
+        assert parse(b'99999999999999999999') == 2**63 - 1
+        assert parse(b'-99999999999999999999') == -2**63
+
+    def test_parse_uint64(self):
+        parse = _singlestoredb_accel._parse_uint64
+        assert parse(b'0') == 0
+        assert parse(b'1') == 1
+        assert parse(b'9999999999999999999') == 9999999999999999999
+        assert parse(b'10000000000000000000') == 10000000000000000000
+        assert parse(b'18446744073709551615') == 2**64 - 1
+
+        # Out of range values saturate
+        assert parse(b'18446744073709551616') == 2**64 - 1
+        assert parse(b'99999999999999999999') == 2**64 - 1
+
+    def test_parse_double(self):
+        for text in [
+            '0', '-0', '0.0', '-0.0', '0e999', '1', '-1', '0.1', '1.5', '-2.25',
+            '123.456', '1e22', '1e23', '1E-5', '1e+5', '9007199254740992',
+            '9007199254740993', '9007199254740993e0', '3.141592653589793',
+            '0.30000000000000004', '1.2345678901234567e-100',
+            '1.2345678901234567e+200', '9999999999999999999e10',
+            '123456789012345678901234567890', '0.000000000000000000001',
+        ]:
+            self.check_double(text)
+
+    def test_parse_double_limits(self):
+        for text in [
+            # Largest finite value and overflow
+            '1.7976931348623157e308', '1.7976931348623158e308',
+            '1.7976931348623159e308', '1e309', '-1e309', '1e400',
+            # Smallest normal value
+            '2.2250738585072014e-308', '2.2250738585072011e-308',
+            # Subnormals and underflow
+            '4.9406564584124654e-324', '5e-324', '3e-324',
+            '2.4703282292062328e-324', '2.4703282292062327e-324',
+            '2e-324', '1e-400', '-5e-324',
+            '8.98846567431158e307', '4.4501477170144023e-308',
+        ]:
+            self.check_double(text)
+
+    def test_parse_double_round_trip(self):
+        rnd = random.Random(1234)
+        for _ in range(20000):
+            value = struct.unpack('<d', struct.pack('<Q', rnd.getrandbits(64)))[0]
+            if value != value or value in (float('inf'), float('-inf')):
+                continue
+            self.check_double(repr(value))
+            self.check_double('%.17e' % value)
+            self.check_double('%.*g' % (rnd.randint(1, 19), value))
+
+    def test_parse_double_exponents(self):
+        rnd = random.Random(5678)
+        for _ in range(20000):
+            mantissa = rnd.randint(1, 10 ** rnd.randint(1, 19) - 1)
+            exponent = rnd.randint(-350, 320)
+            self.check_double('%de%d' % (mantissa, exponent))
+
+
+if __name__ == '__main__':
+    import nose2
+    nose2.main()
@@ -1,10 +1,13 @@
 #!/usr/bin/env python
 # type: ignore
 """Basic SingleStoreDB connection testing."""
+import collections.abc
 import datetime
 import decimal
+import json
 import math
 import os
+import pickle
 import unittest
 
 from requests.exceptions import InvalidJSONError
@@ -15,6 +18,12 @@ try:
 except ImportError:
     has_numpy = False
 
+try:
+    import pandas as pd
+    has_pandas = True
+except ImportError:
+    has_pandas = False
+
 try:
     import shapely.wkt
     has_shapely = True
@@ -30,6 +39,7 @@ except ImportError:
 
 import singlestoredb as s2
 from . import utils
+from singlestoredb.mysql.connection import MySQLResultSV
 # import traceback
 
 
@@ -256,6 +266,382 @@ class TestBasics(unittest.TestCase):
         with self.assertRaises(TypeError):
             self.cur.execute('select * from data where id < %s and id > %s', ['d'])
 
+    def test_execute_prepared(self):
+        if self.conn.driver in ['http', 'https']:
+            self.skipTest('Data API does not support prepared statements')
+
+        self.cur.execute('select * from data where id < %s', ['d'], prepared=True)
+        out = self.cur.fetchall()
+        assert sorted(out) == sorted([
+            ('a', 'antelopes', 2),
+            ('b', 'bears', 2),
+            ('c', 'cats', 5),
+        ]), out
+
+        # Binary protocol rows decode the same as text protocol rows
+        for id in [0, 1]:
+            self.cur.execute('select * from alltypes where id = %s', [id])
+            text = self.cur.fetchall()
+            self.cur.execute(
+                'select * from alltypes where id = %(id)s', dict(id=id), prepared=True,
+            )
+            binary = self.cur.fetchall()
+            assert binary == text, (binary, text)
+
+        # Statements are cached per connection
+        self.cur.execute('select * from data where id < %s', ['b'], prepared=True)
+        assert self.cur.fetchall() == [('a', 'antelopes', 2)]
+        assert len(self.conn._prepared_statements) == 2
+
+        # Each connection has its own statement cache
+        with s2.connect(database=type(self).dbname) as conn:
+            assert conn._prepared_statements is not self.conn._prepared_statements
+            assert len(conn._prepared_statements) == 0
+            with conn.cursor() as cur:
+                cur.execute('select * from data where id < %s', ['b'], prepared=True)
+                assert cur.fetchall() == [('a', 'antelopes', 2)]
+        assert len(self.conn._prepared_statements) == 2
+
+        with self.assertRaises(s2.ProgrammingError):
+            self.cur.execute('select * from data where id < %s', [], prepared=True)
+
+        # Without parameters the query is sent unchanged
+        self.cur.execute("select '%s', 'a%%'", prepared=True)
+        assert self.cur.fetchall() == [('%s', 'a%%')]
+
+        with self.assertRaises(s2.ProgrammingError):
+            self.cur.execute(
+                'select * from data where id < %s', dict(id='b'), prepared=True,
+            )
+        with self.assertRaises(s2.ProgrammingError):
+            self.cur.execute(
+                'select * from data where id < %(id)s', ['b'], prepared=True,
+            )
+
+    def test_result_shape_cache(self):
+        if self.conn.driver in ['http', 'https']:
+            self.skipTest('Data API does not cache result shapes')
+
+        self.conn._result_shapes.clear()
+
+        for id in ['b', 'c', 'd']:
+            self.cur.execute('select * from data where id < %s', [id])
+            assert len(self.cur.fetchall()) == ord(id) - ord('a'), id
+            assert [x[0] for x in self.cur.description] == ['id', 'name', 'value']
+
+        # Identical column definitions share one cached layout
+        assert len(self.conn._result_shapes) == 1, self.conn._result_shapes
+
+        self.cur.execute('select name, id from data where id = %s', ['a'])
+        assert self.cur.fetchall() == [('antelopes', 'a')]
+        assert len(self.conn._result_shapes) == 2, self.conn._result_shapes
+
+    def test_interned_categories(self):
+        if self.conn.driver in ['http', 'https']:
+            self.skipTest('Data API does not intern strings')
+
+        self.cur.execute('select `enum`, `set` from alltypes order by id')
+        out = self.cur.fetchall()
+        assert out[0][0] == 'one', out[0]
+        assert out[0][1] in [{'two'}, 'two'], out[0]
+        assert out[1] == (None, None), out[1]
+
+        if getattr(self.conn, 'resultclass', None) is not MySQLResultSV:
+            self.skipTest('Strings are only interned by the C extension')
+
+        # Repeated short strings decode to the same object
+        self.cur.execute(
+            'select name from (select name from data union all '
+            'select name from data) as t order by name',
+        )
+        names = [x[0] for x in self.cur.fetchall()]
+        assert names[0] == 'antelopes' and names[0] is names[1], names
+
+        if not has_pandas:
+            self.skipTest('Test requires pandas')
+
+        with s2.connect(database=type(self).dbname, results_type='pandas') as conn:
+            with conn.cursor() as cur:
+                cur.execute('select id, `enum` from alltypes order by id')
+                out = cur.fetchall()
+                assert isinstance(out['enum'].dtype, pd.CategoricalDtype), \
+                    out['enum'].dtype
+                assert out['enum'][0] == 'one', out['enum'][0]
+                assert pd.isna(out['enum'][1]), out['enum'][1]
+
+    def test_parse_json(self):
+        docs = [
+            '{"a": [1, 2.5, true, null], "b": {"c": "d\\ne"}}',
+            '[1234567890123, -0.5, 0.25]',
+            '"h\\u00e9llo \\ud83d\\ude00"',
+        ]
+        for doc in docs:
+            self.cur.execute('select cast(%s as json)', [doc])
+            out = self.cur.fetchone()[0]
+            assert out == json.loads(doc), (out, doc)
+
+        if getattr(self.conn, 'resultclass', None) is not MySQLResultSV:
+            self.skipTest('Object keys are only shared by the C extension')
+
+        # Object keys are shared between rows
+        self.cur.execute(
+            'select cast(\'{"name": 1}\' as json) union all '
+            'select cast(\'{"name": 2}\' as json)',
+        )
+        out = [x[0] for x in self.cur.fetchall()]
+        assert sorted(x['name'] for x in out) == [1, 2], out
+        assert list(out[0])[0] is list(out[1])[0], out
+
+    def test_contiguous_vectors(self):
+        if self.conn.driver in ['http', 'https']:
+            self.skipTest('Data API does not surface vector information')
+
+        if getattr(self.conn, 'resultclass', None) is not MySQLResultSV:
+            self.skipTest('Vectors are only collected by the C extension')
+
+        if not has_numpy:
+            self.skipTest('Test requires numpy')
+
+        self.cur.execute('show variables like "enable_extended_types_metadata"')
+        out = list(self.cur)
+        if not out or out[0][1].lower() == 'off':
+            self.skipTest('Database engine does not support extended types metadata')
+
+        expected = np.array(
+            [
+                [0.267261237, 0.534522474, 0.801783681],
+                [0.371390671, 0.557085991, 0.742781341],
+                [-0.424264073, -0.565685451, 0.707106829],
+            ], dtype=np.float32,
+        )
+
+        with s2.connect(database=type(self).dbname, results_type='numpy') as conn:
+            with conn.cursor() as cur:
+                cur.execute('select id, a from f32_vectors order by id')
+                out = cur.fetchall()
+                assert out['a'].shape == (3, 3), out['a'].shape
+                assert out['a'].dtype == np.float32, out['a'].dtype
+                np.testing.assert_array_equal(out['a'], expected)
+
+        if not has_pandas:
+            self.skipTest('Test requires pandas')
+
+        with s2.connect(database=type(self).dbname, results_type='pandas') as conn:
+            with conn.cursor() as cur:
+                cur.execute('select id, a from f32_vectors order by id')
+                out = cur.fetchall()
+                np.testing.assert_array_equal(np.stack(out['a']), expected)
+
+    def test_bson(self):
+        if self.conn.driver in ['http', 'https']:
+            self.skipTest('Data API does not surface BSON information')
+
+        if getattr(self.conn, 'resultclass', None) is not MySQLResultSV:
+            self.skipTest('BSON is only decoded natively by the C extension')
+
+        self.cur.execute('show variables like "enable_extended_types_metadata"')
+        out = list(self.cur)
+        if not out or out[0][1].lower() == 'off':
+            self.skipTest('Database engine does not support extended types metadata')
+
+        doc = {'a': 1, 'b': [1, 'two', None], 'c': {'d': 2.5, 'e': True}}
+        try:
+            self.cur.execute('select %s :> BSON', [json.dumps(doc)])
+        except s2.Error:
+            self.skipTest('Database engine does not support BSON')
+        out = self.cur.fetchone()[0]
+        assert out == doc, out
+
+        with s2.connect(database=type(self).dbname, lazy_bson=True) as conn:
+            with conn.cursor() as cur:
+                cur.execute('select %s :> BSON', [json.dumps(doc)])
+                out = cur.fetchone()[0]
+                assert isinstance(out, collections.abc.Mapping), type(out)
+                assert out['c']['d'] == 2.5, out['c']
+                assert sorted(out) == ['a', 'b', 'c'], list(out)
+                assert out == doc, out
+
+    def test_lazy_rows(self):
+        if getattr(self.conn, 'resultclass', None) is not MySQLResultSV:
+            self.skipTest('Lazy rows require the C extension')
+
+        self.cur.execute('select * from alltypes order by id')
+        expected = list(self.cur)
+
+        for buffered in [True, False]:
+            with s2.connect(
+                database=type(self).dbname, results_type='lazyrows',
+                buffered=buffered,
+            ) as conn:
+                with conn.cursor() as cur:
+                    cur.execute('select * from alltypes order by id')
+                    out = list(cur)
+
+            # Rows outlive their connection
+            assert len(out) == len(expected), len(out)
+            row = out[0]
+            assert isinstance(row, collections.abc.Sequence), type(row)
+            assert row.id == 0, row.id
+            assert row['tinyint'] == 80, row['tinyint']
+            assert row[-1] == expected[0][-1], row[-1]
+            assert row[1:3] == expected[0][1:3], row[1:3]
+            assert out == expected, out
+
+    def test_row_type(self):
+        if getattr(self.conn, 'resultclass', None) is not MySQLResultSV:
+            self.skipTest('Row type requires the C extension')
+
+        self.cur.execute('select * from alltypes order by id')
+        expected = list(self.cur)
+
+        for results_type in ['namedtuples', 'structsequences']:
+            with s2.connect(
+                database=type(self).dbname, results_type=results_type,
+            ) as conn:
+                with conn.cursor() as cur:
+                    cur.execute('select * from alltypes order by id')
+                    out = list(cur)
+
+            row = out[0]
+            assert isinstance(row, tuple), type(row)
+            assert type(row) is type(out[1]), type(out[1])
+            assert row.id == 0, row.id
+            assert row['tinyint'] == 80, row['tinyint']
+            assert row.get('no_such_column') is None
+            assert row._asdict()['id'] == 0, row._asdict()
+            assert row.keys() == [x[0] for x in cur.description], row.keys()
+            assert out == expected, out
+
+            assert type(row)._make(row) == row
+            assert row._replace(id=5).id == 5, row._replace(id=5)
+            copy = pickle.loads(pickle.dumps(row))
+            assert copy == row and copy._fields == row._fields, copy
+
+        # Column names that are not identifiers are renamed in _fields,
+        # as with collections.namedtuple(rename=True)
+        with s2.connect(
+            database=type(self).dbname, results_type='namedtuples',
+        ) as conn:
+            with conn.cursor() as cur:
+                cur.execute(
+                    'select count(*), 1 as `a b`, 2 as `class`, 3 as x, 4 as x '
+                    'from alltypes',
+                )
+                row = cur.fetchone()
+
+        assert row._fields == ('_0', '_1', '_2', 'x', '_4'), row._fields
+        assert row['count(*)'] == row._0, row
+        assert row['a b'] == 1 and row._1 == 1, row
+        assert row['class'] == 2 and row.x == 3 and row._4 == 4, row
+        assert row._asdict() == dict(zip(row._fields, row)), row._asdict()
+
+    def test_unbuffered_iteration(self):
+        self.cur.execute('select * from alltypes order by id')
+        expected = list(self.cur)
+
+        with s2.connect(database=type(self).dbname, buffered=False) as conn:
+            with conn.cursor() as cur:
+                cur.execute('select * from alltypes order by id')
+                out = list(cur)
+                assert out == expected, out
+                assert cur.rownumber == len(expected), cur.rownumber
+
+                # Stop early, then finish the result with fetchall
+                cur.execute('select * from alltypes order by id')
+                for row in cur:
+                    break
+                assert row == expected[0], row
+                assert cur.fetchall() == expected[1:]
+
+                # Abandon a result and run another query
+                cur.execute('select * from alltypes order by id')
+                assert next(iter(cur)) == expected[0]
+                cur.execute('select 1')
+                assert list(cur) == [(1,)]
+
+    def test_prefetch(self):
+        self.cur.execute('select * from alltypes order by id')
+        expected = list(self.cur)
+
+        with s2.connect(
+            database=type(self).dbname, buffered=False, prefetch_bytes=2**20,
+        ) as conn:
+            with conn.cursor() as cur:
+                cur.execute('select * from alltypes order by id')
+                assert list(cur) == expected
+
+                # Stop part way, the rest is drained before the next query
+                cur.execute('select * from alltypes order by id')
+                assert cur.fetchone() == expected[0]
+                cur.execute('select * from alltypes order by id')
+                assert cur.fetchmany(2) == expected[:2]
+                assert cur.fetchall() == expected[2:]
+
+    def test_prefetch_large(self):
+        # About 1MB, many times the smallest read-ahead buffer (64KB)
+        query = (
+            'select a.id, b.id, c.id, d.id, e.id, repeat(a.name, 50) as s '
+            'from data a, data b, data c, data d, data e '
+            'order by a.id, b.id, c.id, d.id, e.id'
+        )
+        self.cur.execute(query)
+        expected = list(self.cur)
+        assert len(expected) == 5 ** 5, len(expected)
+
+        with s2.connect(
+            database=type(self).dbname, buffered=False, prefetch_bytes=2**16,
+        ) as conn:
+            with conn.cursor() as cur:
+                for _ in range(3):
+                    cur.execute(query)
+                    assert list(cur) == expected
+
+                # A result that ends in an error packet
+                with self.assertRaises(s2.Error):
+                    cur.execute(
+                        'select a.id, b.id, c.id, d.id, e.id, repeat(a.name, 50), '
+                        "if(e.id = 'e' and d.id = 'e', 'x', '1') :> JSON as j "
+                        'from data a, data b, data c, data d, data e',
+                    )
+                    list(cur)
+
+                # The connection is still usable
+                cur.execute('select 1')
+                assert list(cur) == [(1,)]
+
+    def test_json_vectors(self):
+        if self.conn.driver in ['http', 'https']:
+            self.skipTest('Data API does not surface vector information')
+
+        if not has_numpy:
+            self.skipTest('Test requires numpy')
+
+        self.cur.execute('show variables like "enable_extended_types_metadata"')
+        out = list(self.cur)
+        if not out or out[0][1].lower() == 'off':
+            self.skipTest('Database engine does not support extended types metadata')
+
+        expected = np.array([[1, 2, 3], [4, 5, 6], [-1, -4, 8]], dtype=np.int16)
+
+        for results_type in ['tuples', 'numpy']:
+            with s2.connect(
+                database=type(self).dbname, results_type=results_type,
+            ) as conn:
+                with conn.cursor() as cur:
+                    try:
+                        cur.execute('set vector_type_project_format = JSON')
+                    except s2.Error:
+                        self.skipTest('Database engine can not project vectors as JSON')
+                    cur.execute('select a from i16_vectors order by id')
+                    assert cur.description[0].type_code == 2004, cur.description[0]
+                    out = cur.fetchall()
+                    if results_type == 'numpy':
+                        out = out['a']
+                    else:
+                        out = [x[0] for x in out]
+                        assert out[0].dtype == np.int16, out[0].dtype
+                    np.testing.assert_array_equal(np.stack(out), expected)
+
     def test_execute_with_escaped_positional_substitutions(self):
         self.cur.execute(
             'select `id`, `time` from alltypes where `time` = %s', ['00:07:00'],
@@ -1180,6 +1566,38 @@ class TestBasics(unittest.TestCase):
                 cur.execute('SELECT %s :> DOUBLE AS X', [1.234])
                 self.assertEqual(1.234, list(cur)[0][0])
 
+    def test_decimal_type(self):
+        if self.conn.driver in ['http', 'https']:
+            self.skipTest('Data API does not support decimal_type')
+
+        query = 'SELECT -12.5 :> DECIMAL(10, 2), NULL :> DECIMAL(10, 2)'
+
+        self.cur.execute(query)
+        self.assertEqual((decimal.Decimal('-12.50'), None), self.cur.fetchone())
+
+        with s2.connect(database=type(self).dbname, decimal_type='float') as conn:
+            with conn.cursor() as cur:
+                cur.execute(query)
+                self.assertEqual((-12.5, None), cur.fetchone())
+
+        with s2.connect(database=type(self).dbname, decimal_type='scaled_int') as conn:
+            with conn.cursor() as cur:
+                cur.execute(query)
+                self.assertEqual((-1250, None), cur.fetchone())
+
+                # Wider than 64 and 128 bits
+                cur.execute(
+                    'SELECT -123456789012345678901.12345 :> DECIMAL(30, 5), '
+                    "'{}.{}' :> DECIMAL(65, 10)".format('9' * 55, '0123456789'),
+                )
+                self.assertEqual(
+                    (
+                        -12345678901234567890112345,
+                        int('9' * 55 + '0123456789'),
+                    ),
+                    cur.fetchone(),
+                )
+
     def test_encoding_errors(self):
         with s2.connect(
             database=type(self).dbname,
@@ -2127,6 +2127,37 @@ class TestConnection(unittest.TestCase):
 
         conn.close()
 
+    def test_decimals_arrow(self):
+        if self.conn.driver in ['http', 'https']:
+            self.skipTest('Data API does not surface decimal precision')
+
+        conn = s2.connect(database=type(self).dbname, results_type='arrow')
+        cur = conn.cursor()
+
+        wide = '-{}.{}'.format('9' * 55, '0123456789')
+        cur.execute(
+            'select -12.5 :> decimal(10, 2) as d10, '
+            '-123456789012345678901.12345 :> decimal(30, 5) as d30, '
+            '1234567890123456789012345678.0123456789 :> decimal(38, 10) as d38, '
+            f"'{wide}' :> decimal(65, 10) as d65, "
+            'null :> decimal(65, 10) as n65',
+        )
+        out = cur.fetchone()
+        row = out.to_pylist()[0]
+
+        assert str(out.schema.field('d10').type) == 'decimal128(10, 2)'
+        assert str(out.schema.field('d30').type) == 'decimal128(30, 5)'
+        assert str(out.schema.field('d38').type) == 'decimal128(38, 10)'
+
+        assert row['d10'] == decimal.Decimal('-12.50'), row['d10']
+        assert row['d30'] == decimal.Decimal('-123456789012345678901.12345'), row['d30']
+        assert row['d38'] == \
+            decimal.Decimal('1234567890123456789012345678.0123456789'), row['d38']
+        assert row['d65'] == decimal.Decimal(wide), row['d65']
+        assert row['n65'] is None, row['n65']
+
+        conn.close()
+
     def test_alltypes_nulls(self):
         self.cur.execute('select * from alltypes where id = 1')
         names = [x[0] for x in self.cur.description]
@@ -1,6 +1,9 @@
 #!/usr/bin/env python
 # type: ignore
 """Test external function data parsing and formatting"""
+import asyncio
+import datetime
+import io
 import json
 import unittest
 
@@ -11,6 +14,8 @@ import pyarrow as pa
 from numpy.testing import assert_array_equal
 from parameterized import parameterized
 
+from singlestoredb.functions import udf
+from singlestoredb.functions.ext import asgi
 from singlestoredb.functions.ext import json as jsonx
 from singlestoredb.functions.ext import rowdat_1
 
@@ -29,6 +34,10 @@ FLOAT = 4
 DOUBLE = 5
 STRING = 254
 BINARY = -254
+DATE = 10
+TIME = 11
+DATETIME = 12
+NEWDECIMAL = 246
 
 col_spec = [
     ('tiny', TINYINT),
@@ -809,6 +818,113 @@ class TestRowdat1(unittest.TestCase):
         else:
             np.testing.assert_array_equal(load_res[1][0][0], res, strict=True)
 
+    def test_numpy_accel_temporal(self):
+        row_ids = np.array([1, 2, 3], dtype=np.int64)
+        dates = np.array(['2024-02-29', '1969-12-31', 'NaT'], dtype='datetime64[D]')
+        times = np.array([-3020399000000, 1500000, 'NaT'], dtype='timedelta64[us]')
+        datetimes = np.array(
+            ['1969-12-31T23:59:59.25', '9999-12-31T23:59:59.999999', 'NaT'],
+            dtype='datetime64[us]',
+        )
+        decimals = np.array([-12.5, 1e20, np.nan], dtype=np.float64)
+        types = [DATE, TIME, DATETIME, NEWDECIMAL]
+
+        dump_res = rowdat_1._dump_numpy_accel(
+            types, row_ids,
+            [(dates, None), (times, None), (datetimes, None), (decimals, None)],
+        ).tobytes()
+        ids, cols = rowdat_1._load_numpy_accel(
+            [(str(x), x) for x in types], dump_res,
+        )
+
+        assert_array_equal(ids, row_ids)
+        assert_array_equal(cols[0][0], dates, strict=True)
+        assert_array_equal(cols[1][0], times, strict=True)
+        assert_array_equal(cols[2][0], datetimes, strict=True)
+        assert_array_equal(cols[3][0], decimals, strict=True)
+        for _, mask in cols:
+            assert_array_equal(mask, np.array([False, False, True]))
+
+        # Other units are converted to microseconds
+        dump_res = rowdat_1._dump_numpy_accel(
+            [DATETIME], row_ids, [(datetimes.astype('datetime64[s]'), None)],
+        ).tobytes()
+        _, cols = rowdat_1._load_numpy_accel([('x', DATETIME)], dump_res)
+        assert_array_equal(cols[0][0], datetimes.astype('datetime64[s]'))
+
+        with self.assertRaises(ValueError):
+            rowdat_1._dump_numpy_accel(
+                [TIME], row_ids[:1],
+                [(np.array([839 * 3600], dtype='timedelta64[s]'), None)],
+            )
+
+    def test_numpy_accel_narrow(self):
+        row_ids = np.array([1, 2, 3], dtype=np.int64)
+        ints = np.array([-128, 127, 0], dtype=np.int64)
+        uints = np.array([0, 65535, 7], dtype=np.uint64)
+        floats = np.array([1.5, -2.25, np.nan], dtype=np.float64)
+        colspec = [
+            ('a', BIGINT, TINYINT),
+            ('b', UNSIGNED_BIGINT, UNSIGNED_SMALLINT),
+            ('c', DOUBLE, FLOAT),
+        ]
+
+        dump_res = rowdat_1._dump_numpy_accel(
+            [BIGINT, UNSIGNED_BIGINT, DOUBLE], row_ids,
+            [(ints, None), (uints, None), (floats, np.array([False, False, True]))],
+        ).tobytes()
+
+        # Numbers are sent wide, but loaded as the declared type
+        for load in [rowdat_1._load_numpy_accel, rowdat_1._load_numpy]:
+            ids, cols = load(colspec, dump_res)
+            assert_array_equal(ids, row_ids)
+            assert_array_equal(cols[0][0], ints.astype(np.int8), strict=True)
+            assert_array_equal(cols[1][0], uints.astype(np.uint16), strict=True)
+            assert_array_equal(cols[2][0], floats.astype(np.float32), strict=True)
+
+        dump_res = rowdat_1._dump_numpy_accel(
+            [BIGINT], row_ids[:1], [(np.array([2**15], dtype=np.int64), None)],
+        ).tobytes()
+        with self.assertRaises(ValueError):
+            rowdat_1._load_numpy_accel([('x', BIGINT, SMALLINT)], dump_res)
+
+        with self.assertRaises(TypeError):
+            rowdat_1._load_numpy_accel([('x', BIGINT, FLOAT)], dump_res)
+
+    def test_numpy_accel_variable_rows(self):
+        n = 1000
+        row_ids = np.arange(n, dtype=np.int64)
+        strs = np.array(['x' * (i % 37) for i in range(n)], dtype=object)
+        ints = np.arange(n, dtype=np.int16)
+        mask = row_ids % 3 == 0
+        types = [STRING, SMALLINT, BINARY, DATE]
+        dates = np.arange(n).astype('datetime64[D]')
+
+        dump_res = rowdat_1._dump_numpy_accel(
+            types, row_ids,
+            [
+                (strs, mask), (ints, None),
+                (np.array([x.encode() for x in strs], dtype=object), None),
+                (dates, mask),
+            ],
+        ).tobytes()
+        ids, cols = rowdat_1._load_numpy_accel(
+            [(str(x), x) for x in types], dump_res,
+        )
+
+        assert_array_equal(ids, row_ids)
+        assert_array_equal(cols[0][1], mask)
+        assert_array_equal(cols[0][0][~mask], strs[~mask])
+        assert_array_equal(cols[1][0], ints, strict=True)
+        assert_array_equal(cols[2][0], np.array([x.encode() for x in strs]))
+        assert_array_equal(cols[3][0][~mask], dates[~mask])
+
+        # Range errors are raised before anything is written
+        with self.assertRaises(ValueError):
+            rowdat_1._dump_numpy_accel(
+                [STRING, TINYINT], row_ids, [(strs, None), (ints, None)],
+            )
+
     def test_python(self):
         dump_res = rowdat_1._dump(
             col_types, py_row_ids, py_col_data,
@@ -833,6 +949,63 @@ class TestRowdat1(unittest.TestCase):
         assert ids == py_row_ids
         assert_py_equal(columns, py_col_data)
 
+    def test_dump_into(self):
+        for dump, dump_into in [
+            (rowdat_1._dump_accel, rowdat_1.dump_into),
+            (rowdat_1._dump, rowdat_1._dump_into(rowdat_1._dump)),
+        ]:
+            expected = dump(col_types, py_row_ids, py_col_data)
+
+            # Nothing is written when the buffer is too small
+            out = bytearray(10)
+            size = dump_into(col_types, py_row_ids, py_col_data, out)
+            assert size == len(expected)
+            assert out == bytearray(10)
+
+            out = bytearray(size + 5)
+            assert dump_into(col_types, py_row_ids, py_col_data, out) == size
+            assert bytes(out[:size]) == bytes(expected)
+
+            # Allocators are called once, with the size of the output
+            sizes = []
+
+            def allocate(n):
+                sizes.append(n)
+                return bytearray(n)
+
+            assert dump_into(col_types, py_row_ids, py_col_data, allocate) == size
+            assert sizes == [size]
+
+        # Loaders accept any buffer, not just bytes
+        for data in [bytearray(expected), memoryview(expected)]:
+            ids, columns = rowdat_1._load_accel(col_spec, data)
+            assert ids == py_row_ids
+            assert_py_equal(columns, py_col_data)
+
+        expected = rowdat_1._dump_numpy_accel(
+            col_types, numpy_row_ids, numpy_data,
+        ).tobytes()
+        out = bytearray(len(expected))
+        size = rowdat_1.dump_numpy_into(col_types, numpy_row_ids, numpy_data, out)
+        assert size == len(expected)
+        assert bytes(out) == expected
+
+        outs = []
+
+        def allocate(n):
+            outs.append(bytearray(n))
+            return outs[-1]
+
+        size = rowdat_1.dump_numpy_into(
+            col_types, numpy_row_ids, numpy_data, allocate,
+        )
+        assert size == len(expected)
+        assert len(outs) == 1 and bytes(outs[0]) == expected
+
+        ids, columns = rowdat_1._load_numpy_accel(col_spec, memoryview(out))
+        assert_array_equal(ids, numpy_row_ids)
+        assert_array_equal(columns[0][0], numpy_tiny_arr, strict=True)
+
     def test_polars(self):
         dump_res = rowdat_1._dump_polars(
             col_types, polars_row_ids, polars_data,
@@ -983,6 +1156,47 @@ class TestRowdat1(unittest.TestCase):
         assert_array_equal(columns[12][0], pyarrow_string_arr, strict=True)
         assert_array_equal(columns[13][0], pyarrow_binary_arr, strict=True)
 
+    def test_temporal_udfs(self):
+        # Row-wise codecs can not decode temporal values
+        @udf
+        def py_date(x: datetime.date) -> int:
+            return 0
+
+        @udf(data_format='python')
+        def py_returns_date(x: int) -> datetime.date:
+            return datetime.date(2000, 1, 1)
+
+        for func in [py_date, py_returns_date]:
+            with self.assertRaises(TypeError):
+                asgi.make_func(func.__name__, func)
+            with self.assertRaises(TypeError):
+                asgi.Application(functions=[func])
+
+        @udf(args=['DATE NULL'], returns='DATE NULL', data_format='numpy')
+        def next_day(x):
+            return x + np.timedelta64(1, 'D')
+
+        if not rowdat_1.has_accel:
+            with self.assertRaises(TypeError):
+                asgi.make_func('next_day', next_day)
+            return
+
+        app = asgi.Application(functions=[next_day])
+        row_ids = np.array([1, 2], dtype=np.int64)
+        dates = np.array(['2024-02-28', '1999-12-31'], dtype='datetime64[D]')
+        data_in = rowdat_1._dump_numpy_accel(
+            [DATE], row_ids, [(dates, None)],
+        ).tobytes()
+        data_out = io.BytesIO()
+        asyncio.run(app.call('next_day', data_in, data_out, data_format='rowdat_1'))
+
+        ids, cols = rowdat_1._load_numpy_accel([('x', DATE)], data_out.getvalue())
+        assert_array_equal(ids, row_ids)
+        assert_array_equal(
+            cols[0][0],
+            np.array(['2024-02-29', '2000-01-01'], dtype='datetime64[D]'),
+        )
+
 
 class TestJSON(unittest.TestCase):
 
@@ -4,6 +4,7 @@
 import os
 import unittest
 
+import numpy as np
 import pandas as pd
 
 import singlestoredb as s2
@@ -133,6 +134,74 @@ class TestResults(unittest.TestCase):
                     out = cur.fetchall()
                     assert len(out) == 0, len(out)
 
+    def test_numpy(self):
+        with s2.options(('results.type', 'numpy')):
+            with s2.connect(database=type(self).dbname) as conn:
+                with conn.cursor() as cur:
+                    cur.execute('select * from data_with_nulls order by id')
+                    out = cur.fetchone()
+                    assert type(out) is np.ndarray, type(out)
+                    assert len(out) == 1, len(out)
+
+                    out = cur.fetchmany(2)
+                    assert type(out) is np.ndarray, type(out)
+                    assert list(out['id']) == ['b', 'c'], list(out['id'])
+
+                    out = cur.fetchall()
+                    assert type(out) is np.ndarray, type(out)
+                    assert list(out['id']) == ['d', 'e'], list(out['id'])
+                    assert list(out['name']) == ['dogs', 'elephants'], list(out['name'])
+                    assert out['value'].dtype == np.float64, out['value'].dtype
+                    assert np.isnan(out['value'][0]), out['value']
+                    assert out['value'][1] == 0, out['value']
+
+                    out = cur.fetchall()
+                    assert len(out) == 0, len(out)
+
+    def test_pandas(self):
+        with s2.options(('results.type', 'pandas')):
+            with s2.connect(database=type(self).dbname) as conn:
+                with conn.cursor() as cur:
+                    cur.execute('select * from data_with_nulls order by id')
+                    out = cur.fetchall()
+                    assert type(out) is pd.DataFrame, type(out)
+                    assert list(out.columns) == ['id', 'name', 'value'], out.columns
+                    assert list(out['id']) == ['a', 'b', 'c', 'd', 'e'], out['id']
+                    assert list(out['name']) == \
+                        ['antelopes', None, None, 'dogs', 'elephants'], out['name']
+                    assert list(out['value'].isna()) == \
+                        [False, False, False, True, False], out['value']
+                    assert list(out['value'].fillna(-1)) == \
+                        [2, 2, 5, -1, 0], out['value']
+
+                    out = cur.fetchall()
+                    assert len(out) == 0, len(out)
+
+    def test_fetch_batches(self):
+        with s2.options(('results.type', 'pandas')):
+            with s2.connect(database=type(self).dbname, buffered=False) as conn:
+                with conn.cursor() as cur:
+                    cur.execute('select * from data order by id')
+                    out = list(cur.fetch_batches(rows_per_batch=2))
+                    assert [type(x) for x in out] == [pd.DataFrame] * 3, out
+                    assert [len(x) for x in out] == [2, 2, 1], out
+                    assert list(pd.concat(out)['id']) == \
+                        ['a', 'b', 'c', 'd', 'e'], out
+
+                    cur.execute('select * from data order by id')
+                    out = list(cur.fetch_batches(bytes_per_batch=1))
+                    assert [len(x) for x in out] == [1] * 5, out
+
+                    out = list(cur.fetch_batches())
+                    assert len(out) == 0, out
+
+                    # Warnings are picked up once the result is exhausted
+                    cur.execute("select cast('abc' as signed) as x")
+                    out = list(cur.fetch_batches())
+                    assert sum(len(x) for x in out) == 1, out
+                    assert cur.warning_count == cur._result.warning_count, \
+                        (cur.warning_count, cur._result.warning_count)
+
     def _test_dataframe(self):
         with s2.options(('results.type', 'dataframe')):
             with s2.connect(database=type(self).dbname) as conn:
@@ -106,6 +106,18 @@ if has_numpy:
         254: object,  # String
         -254: object,  # Binary
         255: object,  # Geometry
+        2001: object,  # Float32 Vector JSON
+        2002: object,  # Float64 Vector JSON
+        2003: object,  # Int8 Vector JSON
+        2004: object,  # Int16 Vector JSON
+        2005: object,  # Int32 Vector JSON
+        2006: object,  # Int64 Vector JSON
+        3001: object,  # Float32 Vector
+        3002: object,  # Float64 Vector
+        3003: object,  # Int8 Vector
+        3004: object,  # Int16 Vector
+        3005: object,  # Int32 Vector
+        3006: object,  # Int64 Vector
     }
 else:
     NUMPY_TYPE_MAP = {}
@@ -154,6 +166,18 @@ if has_pyarrow:
         254: pa.string(),  # String
         -254: pa.binary(),  # Binary
         255: pa.string(),  # Geometry
+        2001: pa.list_(pa.float32()),  # Float32 Vector JSON
+        2002: pa.list_(pa.float64()),  # Float64 Vector JSON
+        2003: pa.list_(pa.int8()),  # Int8 Vector JSON
+        2004: pa.list_(pa.int16()),  # Int16 Vector JSON
+        2005: pa.list_(pa.int32()),  # Int32 Vector JSON
+        2006: pa.list_(pa.int64()),  # Int64 Vector JSON
+        3001: pa.list_(pa.float32()),  # Float32 Vector
+        3002: pa.list_(pa.float64()),  # Float64 Vector
+        3003: pa.list_(pa.int8()),  # Int8 Vector
+        3004: pa.list_(pa.int16()),  # Int16 Vector
+        3005: pa.list_(pa.int32()),  # Int32 Vector
+        3006: pa.list_(pa.int64()),  # Int64 Vector
     }
 else:
     PYARROW_TYPE_MAP = {}
@@ -200,6 +224,18 @@ if has_polars:
         254: pl.Utf8,  # String
         -254: pl.Binary,  # Binary
         255: pl.Utf8,  # Geometry
+        2001: pl.List(pl.Float32),  # Float32 Vector JSON
+        2002: pl.List(pl.Float64),  # Float64 Vector JSON
+        2003: pl.List(pl.Int8),  # Int8 Vector JSON
+        2004: pl.List(pl.Int16),  # Int16 Vector JSON
+        2005: pl.List(pl.Int32),  # Int32 Vector JSON
+        2006: pl.List(pl.Int64),  # Int64 Vector JSON
+        3001: pl.List(pl.Float32),  # Float32 Vector
+        3002: pl.List(pl.Float64),  # Float64 Vector
+        3003: pl.List(pl.Int8),  # Int8 Vector
+        3004: pl.List(pl.Int16),  # Int16 Vector
+        3005: pl.List(pl.Int32),  # Int32 Vector
+        3006: pl.List(pl.Int64),  # Int64 Vector
     }
 else:
     POLARS_TYPE_MAP = {}
@@ -5,6 +5,7 @@ import warnings
 from typing import Any
 from typing import Callable
 from typing import Dict
+from typing import Iterator
 from typing import List
 from typing import NamedTuple
 from typing import Optional
@@ -95,6 +96,231 @@ if has_polars:
     })
 
 
+class ColumnarRows:
+    """
+    Block of rows stored column-by-column.
+
+    The C extension decodes numeric and temporal columns for the numpy,
+    pandas, polars, and arrow results types directly into packed buffers.
+    This object wraps those buffers so that cursors can still count, index,
+    and slice rows, while the ``results_to_*`` functions build their
+    outputs from whole columns.
+
+    For the arrow results type, columns are built in Arrow layouts and
+    exported through the Arrow C Data Interface, so they are imported
+    as ``pyarrow.Array`` objects without copying.
+
+    Parameters
+    ----------
+    names : list of str
+        The column names
+    columns : list of tuples or Arrow arrays
+        A ``(values, dtype, mask)`` tuple for each column. If ``dtype`` is
+        None, ``values`` is a list of Python objects. Otherwise, ``values``
+        is a buffer of packed values of that numpy dtype and ``mask`` is
+        a buffer of booleans that are true for NULL values, or None if the
+        column contains no NULLs. A ``(codes, 'int32', mask, categories)``
+        tuple is a dictionary-encoded column whose codes index into the
+        ``categories`` list of str, with -1 for NULLs. A ``dtype`` of the
+        form ``'(dim,)float32'`` is a VECTOR column of ``dim`` elements
+        per row, which is unpacked into a 2-dimensional array whose NULL
+        rows are zeros. A column may also be any object that implements
+        ``__arrow_c_array__``.
+
+    """
+
+    def __init__(
+        self,
+        names: List[str],
+        columns: List[Any],
+    ):
+        self.names = list(names)
+        self.values: List[Any] = []
+        self.masks: List[Any] = []
+        self.categories: List[Optional[List[str]]] = []
+        for column in columns:
+            if hasattr(column, '__arrow_c_array__'):
+                self.values.append(pa.array(column))
+                self.masks.append(None)
+                self.categories.append(None)
+                continue
+            values, dtype, mask = column[:3]
+            self.categories.append(column[3] if len(column) > 3 else None)
+            if dtype is not None:
+                values = np.frombuffer(values, dtype=dtype)
+            if mask is not None:
+                mask = np.frombuffer(mask, dtype=np.bool_)
+            self.values.append(values)
+            self.masks.append(mask)
+        self._length = len(self.values[0]) if self.values else 0
+
+    def __len__(self) -> int:
+        return self._length
+
+    def __iter__(self) -> Iterator[Tuple[Any, ...]]:
+        for i in range(self._length):
+            yield self._row(i)
+
+    def __getitem__(self, index: Any) -> Any:
+        if isinstance(index, slice):
+            # Empty slices match those of lists of rows
+            if not len(range(*index.indices(self._length))):
+                return []
+            out = type(self).__new__(type(self))
+            out.names = self.names
+            out.values = [x[index] for x in self.values]
+            out.masks = [None if x is None else x[index] for x in self.masks]
+            out.categories = self.categories
+            out._length = len(range(*index.indices(self._length)))
+            return out
+        if index < 0:
+            index += self._length
+        if index < 0 or index >= self._length:
+            raise IndexError('row index out of range')
+        return self._row(index)
+
+    def _row(self, index: int) -> Tuple[Any, ...]:
+        """Return a row as a tuple of Python objects."""
+        out = []
+        for values, mask, categories in zip(self.values, self.masks, self.categories):
+            if categories is not None:
+                code = values[index]
+                out.append(None if code < 0 else categories[code])
+            elif type(values) is list:
+                out.append(values[index])
+            elif has_pyarrow and isinstance(values, pa.Array):
+                out.append(values[index].as_py())
+            elif mask is not None and mask[index]:
+                out.append(None)
+            elif values.ndim > 1:
+                # VECTOR values are views of their row of the column block
+                out.append(values[index])
+            else:
+                out.append(values[index].item())
+        return tuple(out)
+
+    def __arrow_c_stream__(self, requested_schema: Any = None) -> Any:
+        """Export the rows as an Arrow C stream of record batches."""
+        arrays = []
+        for values, mask, categories in zip(self.values, self.masks, self.categories):
+            if categories is not None:
+                arrays.append(_dictionary_array(values, mask, categories))
+            elif type(values) is list or isinstance(values, pa.Array):
+                arrays.append(pa.array(values))
+            elif values.ndim > 1:
+                arrays.append(_vector_array(values, mask))
+            else:
+                arrays.append(pa.array(values, mask=mask))
+        table = pa.Table.from_arrays(arrays, names=self.names)
+        return table.__arrow_c_stream__(requested_schema)
+
+
+def _object_array(values: List[Any]) -> 'np.ndarray':
+    """Convert a list of objects to a 1-dimensional object array."""
+    # The trailing None keeps numpy from turning equal-length sequences
+    # (JSON arrays, vectors) into another dimension.
+    return np.array(values + [None], dtype=object)[:-1]
+
+
+def _categories_to_objects(
+    codes: 'np.ndarray',
+    categories: List[str],
+) -> 'np.ndarray':
+    """Convert dictionary codes to an object array of their values."""
+    # Code -1 (NULL) picks the trailing None
+    return _object_array(categories + [None])[codes]
+
+
+def _dictionary_array(
+    codes: 'np.ndarray',
+    mask: Optional['np.ndarray'],
+    categories: List[str],
+) -> 'pa.DictionaryArray':
+    """Convert dictionary codes to an Arrow dictionary array."""
+    return pa.DictionaryArray.from_arrays(
+        pa.array(codes, mask=mask), pa.array(categories, type=pa.string()),
+    )
+
+
+def _vector_array(
+    values: 'np.ndarray',
+    mask: Optional['np.ndarray'],
+) -> 'pa.FixedSizeListArray':
+    """Convert an (n_rows, dim) array to an Arrow fixed-size list array."""
+    items = pa.array(values.reshape(-1))
+    validity = None
+    if mask is not None:
+        validity = pa.py_buffer(np.packbits(~mask, bitorder='little'))
+    return pa.Array.from_buffers(
+        pa.list_(items.type, values.shape[1]), len(values), [validity],
+        children=[items],
+    )
+
+
+def _null_value(dtype: 'np.dtype') -> Any:
+    """Return the value used for NULLs in an array of the given type."""
+    if dtype.kind in 'fc':
+        return np.nan
+    if dtype.kind == 'M':
+        return np.datetime64('NaT')
+    if dtype.kind == 'm':
+        return np.timedelta64('NaT')
+    return None
+
+
+def _columnar_to_arrays(
+    res: ColumnarRows,
+    dtype: 'np.dtype',
+    categorical: bool = False,
+    vector_rows: bool = False,
+) -> List[Any]:
+    """
+    Convert columns to arrays of the fields of a structured dtype.
+
+    If `categorical` is True, dictionary-encoded columns are returned as
+    ``pandas.Categorical`` objects rather than object arrays.
+
+    VECTOR columns are returned as (n_rows, dim) arrays whose NULL rows are
+    NaNs (floats) or zeros (ints). If `vector_rows` is True, they are
+    returned as object arrays of row views instead, with None for NULLs.
+
+    """
+    out: List[Any] = []
+    for i, (values, mask) in enumerate(zip(res.values, res.masks)):
+        field_type = dtype[i]
+        categories = res.categories[i]
+        if categories is not None:
+            if categorical:
+                out.append(pd.Categorical.from_codes(values, categories))
+            else:
+                out.append(_categories_to_objects(values, categories))
+            continue
+        if type(values) is list:
+            if field_type.kind == 'O':
+                out.append(_object_array(values))
+            else:
+                out.append(np.array(values, dtype=field_type))
+            continue
+        if values.ndim > 1:
+            if vector_rows:
+                arr = _object_array(list(values))
+                if mask is not None:
+                    arr[mask] = None
+            else:
+                arr = values
+                if mask is not None and values.dtype.kind == 'f':
+                    arr[mask] = np.nan
+            out.append(arr)
+            continue
+        arr = values.astype(field_type, copy=False)
+        if mask is not None:
+            null = _null_value(field_type)
+            if null is not None:
+                arr[mask] = null
+        out.append(arr)
+    return out
+
+
 INT_TYPES = set([1, 2, 3, 8, 9])
 CHAR_TYPES = set([15, 249, 250, 251, 252, 253, 254])
 DECIMAL_TYPES = set([0, 246])
@@ -217,6 +443,19 @@ def results_to_numpy(
         return res
     if has_numpy:
         schema = _description_to_numpy_schema(desc) if schema is None else schema
+        if isinstance(res, ColumnarRows):
+            dtype = np.dtype(schema['dtype'])
+            arrays = _columnar_to_arrays(res, dtype)
+            # VECTOR columns become subarray fields of shape (dim,)
+            if any(x.ndim > 1 for x in arrays):
+                dtype = np.dtype([
+                    (name, x.dtype, x.shape[1:]) if x.ndim > 1 else (name, dtype[name])
+                    for name, x in zip(dtype.names, arrays)
+                ])
+            out = np.empty(len(res), dtype=dtype)
+            for name, arr in zip(dtype.names, arrays):
+                out[name] = arr
+            return out
         if single:
             return np.array([res], **schema)
         return np.array(list(res), **schema)
@@ -259,6 +498,12 @@ def results_to_pandas(
         return res
     if has_pandas:
         schema = _description_to_pandas_schema(desc) if schema is None else schema
+        if isinstance(res, ColumnarRows):
+            dtype = np.dtype(schema['dtype'])
+            arrays = _columnar_to_arrays(res, dtype, categorical=True, vector_rows=True)
+            out = pd.DataFrame(dict(enumerate(arrays)), copy=False)
+            out.columns = list(dtype.names)
+            return out
         return pd.DataFrame(results_to_numpy(desc, res, single=single, schema=schema))
     warnings.warn(
         'pandas is not available; unable to convert to DataFrame',
@@ -299,6 +544,8 @@ def results_to_polars(
         return res
     if has_polars:
         schema = _description_to_polars_schema(desc) if schema is None else schema
+        if isinstance(res, ColumnarRows):
+            return _columnar_to_polars(res, schema)
         if single:
             out = pl.DataFrame([res], **schema.get('schema', {}))
         else:
@@ -314,6 +561,40 @@ def results_to_polars(
     return res
 
 
+def _columnar_to_polars(
+    res: ColumnarRows,
+    schema: Dict[str, Any],
+) -> 'pl.DataFrame':
+    """Convert columnar results to a polars DataFrame."""
+    columns = []
+    text_columns = set()
+    for (name, dtype), values, mask, categories in zip(
+        schema['schema']['schema'], res.values, res.masks, res.categories,
+    ):
+        if categories is not None:
+            values = _categories_to_objects(values, categories).tolist()
+            columns.append(pl.Series(name, values, dtype=pl.Categorical))
+            continue
+        if type(values) is list:
+            text_columns.add(name)
+            columns.append(pl.Series(name, values, dtype=dtype))
+            continue
+        series = pl.Series(name, values)
+        if mask is not None:
+            series = series.set(pl.Series(mask), None)
+        # Dates and times arrive already parsed rather than as text
+        if values.dtype.kind not in 'mM':
+            series = series.cast(dtype)
+        columns.append(series)
+    out = pl.DataFrame(columns)
+    with_columns = {
+        k: v for k, v in schema.get('with_columns', {}).items() if k in text_columns
+    }
+    if with_columns:
+        return out.with_columns(**with_columns)
+    return out
+
+
 def results_to_arrow(
     desc: List[Description],
     res: Optional[DBAPIResult],
@@ -347,6 +628,37 @@ def results_to_arrow(
     if has_pyarrow:
         names = [x[0] for x in desc]
         schema = _description_to_arrow_schema(desc) if schema is None else schema
+        if isinstance(res, ColumnarRows):
+            arrays = []
+            fields = []
+            for field, values, mask, categories in zip(
+                schema['schema'], res.values, res.masks, res.categories,
+            ):
+                # Dictionary-encoded and VECTOR columns keep their own types
+                if categories is not None:
+                    values = _dictionary_array(values, mask, categories)
+                elif getattr(values, 'ndim', 1) > 1:
+                    values = _vector_array(values, mask)
+                if isinstance(values, pa.Array) and (
+                    pa.types.is_dictionary(values.type) or
+                    pa.types.is_fixed_size_list(values.type)
+                ):
+                    arrays.append(values)
+                    fields.append(field.with_type(values.type))
+                    continue
+                fields.append(field)
+                if type(values) is list:
+                    arrays.append(pa.array(values, type=field.type))
+                elif isinstance(values, pa.Array):
+                    # Strings are exported with 64-bit offsets
+                    if not values.type.equals(field.type):
+                        values = values.cast(field.type)
+                    arrays.append(values)
+                else:
+                    arrays.append(pa.array(values, mask=mask).cast(field.type))
+            return pa.Table.from_arrays(
+                arrays, schema=pa.schema(fields, metadata=schema['schema'].metadata),
+            )
         if single:
             if isinstance(res, dict):
                 return pa.Table.from_pylist([res], **schema)
@@ -497,6 +809,8 @@ _converters: Dict[
     'namedtuples': results_to_namedtuple,
     'dict': results_to_dict,
     'dicts': results_to_dict,
+    'lazyrow': results_to_tuple,
+    'lazyrows': results_to_tuple,
     'numpy': results_to_numpy,
     'pandas': results_to_pandas,
     'polars': results_to_polars,
@@ -517,6 +831,8 @@ _schema_converters: Dict[
     'dicts': _no_schema,
     'structsequence': _no_schema,
     'structsequences': _no_schema,
+    'lazyrow': _no_schema,
+    'lazyrows': _no_schema,
     'numpy': _description_to_numpy_schema,
     'pandas': _description_to_numpy_schema,
     'polars': _description_to_polars_schema,